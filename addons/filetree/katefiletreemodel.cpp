@@ -26,6 +26,7 @@
 #include <QMimeDatabase>
 #include <QIcon>
 #include <QStack>
+#include <QVector>
 
 #include <KColorScheme>
 #include <KColorUtils>
@@ -38,13 +39,31 @@
 
 #include "katefiletreedebug.h"
 
+#include <algorithm>
+
+namespace
+{
+/**
+ * hibernated documents have no url, the application keeps it as property
+ */
+bool isHibernated(const KTextEditor::Document *doc)
+{
+    return doc->property("kateHibernatedUrl").isValid();
+}
+
+QUrl documentUrl(const KTextEditor::Document *doc)
+{
+    return isHibernated(doc) ? doc->property("kateHibernatedUrl").toUrl() : doc->url();
+}
+}
+
 class ProxyItemDir;
 class ProxyItem
 {
     friend class KateFileTreeModel;
 
 public:
-    enum Flag { None = 0, Dir = 1, Modified = 2, ModifiedExternally = 4, DeletedExternally = 8, Empty = 16, ShowFullPath = 32, Host = 64 };
+    enum Flag { None = 0, Dir = 1, Modified = 2, ModifiedExternally = 4, DeletedExternally = 8, Empty = 16, ShowFullPath = 32, Host = 64, Hibernated = 128 };
     Q_DECLARE_FLAGS(Flags, Flag)
 
     ProxyItem(const QString &n, ProxyItemDir *p = nullptr, Flags f = ProxyItem::None);
@@ -52,6 +71,7 @@ public:
 
     int addChild(ProxyItem *p);
     void remChild(ProxyItem *p);
+    void remChildren(int first, int count);
 
     ProxyItemDir *parent() const;
 
@@ -221,6 +241,19 @@ void ProxyItem::remChild(ProxyItem *item)
     item->m_parent = nullptr;
 }
 
+void ProxyItem::remChildren(int first, int count)
+{
+    for (int i = first; i < first + count; i++) {
+        m_children[i]->m_parent = nullptr;
+    }
+
+    m_children.erase(m_children.begin() + first, m_children.begin() + first + count);
+
+    for (int i = first; i < m_children.count(); i++) {
+        m_children[i]->m_row = i;
+    }
+}
+
 ProxyItemDir *ProxyItem::parent() const
 {
     return m_parent;
@@ -351,7 +384,10 @@ const QString &ProxyItem::host() const
 
 void ProxyItem::updateDocumentName()
 {
-    const QString docName = m_doc ? m_doc->documentName() : QString();
+    QString docName;
+    if (m_doc) {
+        docName = isHibernated(m_doc) ? documentUrl(m_doc).fileName() : m_doc->documentName();
+    }
 
     if (flag(ProxyItem::Host)) {
         m_documentName = QString::fromLatin1("[%1]%2").arg(m_host).arg(docName);
@@ -374,6 +410,7 @@ KateFileTreeModel::KateFileTreeModel(QObject *p)
     m_viewShade = KColorUtils::tint(bg, colors.foreground(KColorScheme::VisitedText).color(), 0.5);
     m_shadingEnabled = true;
     m_listMode = false;
+    m_closingDocuments = false;
 
     initModel();
 }
@@ -440,6 +477,16 @@ void KateFileTreeModel::initModel()
     foreach(KTextEditor::Document * doc, KTextEditor::Editor::instance()->application()->documents()) {
         documentOpened(doc);
     }
+
+    // hibernated documents are not in documents(), the host knows them
+    QList<KTextEditor::Document *> hibernatedDocuments;
+    QObject *host = KTextEditor::Editor::instance()->application()->parent();
+    if (host && host->metaObject()->indexOfMethod("hibernatedDocuments()") >= 0
+            && QMetaObject::invokeMethod(host, "hibernatedDocuments", Qt::DirectConnection, Q_RETURN_ARG(QList<KTextEditor::Document *>, hibernatedDocuments))) {
+        foreach(KTextEditor::Document * doc, hibernatedDocuments) {
+            documentHibernationChanged(doc, true);
+        }
+    }
 }
 
 void KateFileTreeModel::clearModel()
@@ -462,11 +509,12 @@ void KateFileTreeModel::clearModel()
 
 void KateFileTreeModel::connectDocument(const KTextEditor::Document *doc)
 {
-    connect(doc, &KTextEditor::Document::documentNameChanged, this, &KateFileTreeModel::documentNameChanged);
-    connect(doc, &KTextEditor::Document::documentUrlChanged, this, &KateFileTreeModel::documentNameChanged);
-    connect(doc, &KTextEditor::Document::modifiedChanged, this, &KateFileTreeModel::documentModifiedChanged);
+    // hibernated documents come back with the same object, connect only once
+    connect(doc, &KTextEditor::Document::documentNameChanged, this, &KateFileTreeModel::documentNameChanged, Qt::UniqueConnection);
+    connect(doc, &KTextEditor::Document::documentUrlChanged, this, &KateFileTreeModel::documentNameChanged, Qt::UniqueConnection);
+    connect(doc, &KTextEditor::Document::modifiedChanged, this, &KateFileTreeModel::documentModifiedChanged, Qt::UniqueConnection);
     connect(doc, SIGNAL(modifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)),
-            this,  SLOT(documentModifiedOnDisc(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)));
+            this,  SLOT(documentModifiedOnDisc(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)), Qt::UniqueConnection);
 }
 
 QModelIndex KateFileTreeModel::docIndex(const KTextEditor::Document *doc) const
@@ -494,7 +542,7 @@ Qt::ItemFlags KateFileTreeModel::flags(const QModelIndex &index) const
             flags |= Qt::ItemIsSelectable;
         }
 
-        if (item->doc() && item->doc()->url().isValid()) {
+        if (item->doc() && documentUrl(item->doc()).isValid()) {
             flags |= Qt::ItemIsDragEnabled;
         }
     }
@@ -518,7 +566,7 @@ QVariant KateFileTreeModel::data(const QModelIndex &index, int role) const
     switch (role) {
     case KateFileTreeModel::PathRole:
         // allow to sort with hostname + path, bug 271488
-        return (item->doc() && !item->doc()->url().isEmpty()) ? item->doc()->url().toString() : item->path();
+        return (item->doc() && !documentUrl(item->doc()).isEmpty()) ? documentUrl(item->doc()).toString() : item->path();
 
     case KateFileTreeModel::DocumentRole:
         return QVariant::fromValue(item->doc());
@@ -544,6 +592,8 @@ QVariant KateFileTreeModel::data(const QModelIndex &index, int role) const
         QString tooltip = item->path();
         if (item->flag(ProxyItem::DeletedExternally) || item->flag(ProxyItem::ModifiedExternally)) {
             tooltip = i18nc("%1 is the full path", "<p><b>%1</b></p><p>The document has been modified by another application.</p>", item->path());
+        } else if (item->flag(ProxyItem::Hibernated)) {
+            tooltip = i18nc("%1 is the full path", "<p><b>%1</b></p><p>The document is hibernated, it is loaded again once it is used.</p>", item->path());
         }
 
         return tooltip;
@@ -551,7 +601,7 @@ QVariant KateFileTreeModel::data(const QModelIndex &index, int role) const
 
     case Qt::ForegroundRole: {
         const KColorScheme colors(QPalette::Active);
-        if (!item->flag(ProxyItem::Dir) && (!item->doc() || item->doc()->openingError())) {
+        if (!item->flag(ProxyItem::Dir) && (!item->doc() || item->doc()->openingError() || item->flag(ProxyItem::Hibernated))) {
             return colors.foreground(KColorScheme::InactiveText).color();
         }
     }
@@ -574,11 +624,11 @@ QMimeData *KateFileTreeModel::mimeData(const QModelIndexList &indexes) const
 
     for (const auto &index : indexes) {
         ProxyItem *item = static_cast<ProxyItem *>(index.internalPointer());
-        if (!item || !item->doc() || !item->doc()->url().isValid()) {
+        if (!item || !item->doc() || !documentUrl(item->doc()).isValid()) {
             continue;
         }
 
-        urls.append(item->doc()->url());
+        urls.append(documentUrl(item->doc()));
     }
 
     if (urls.isEmpty()) {
@@ -713,6 +763,12 @@ void KateFileTreeModel::setListMode(bool lm)
 
 void KateFileTreeModel::documentOpened(KTextEditor::Document *doc)
 {
+    // closing the last documents creates a new one before the batch ends, drop the deleted ones first
+    if (!m_closedDocuments.isEmpty()) {
+        removeDocuments(m_closedDocuments);
+        m_closedDocuments.clear();
+    }
+
     ProxyItem *item = new ProxyItem(QString());
     item->setDoc(doc);
 
@@ -823,6 +879,9 @@ void KateFileTreeModel::documentEdited(const KTextEditor::Document *doc)
 
 void KateFileTreeModel::slotAboutToDeleteDocuments(const QList<KTextEditor::Document *> &docs)
 {
+    // closed documents are collected and removed together once the batch is done
+    m_closingDocuments = true;
+
     foreach(const KTextEditor::Document * doc, docs) {
         disconnect(doc, &KTextEditor::Document::documentNameChanged, this, &KateFileTreeModel::documentNameChanged);
         disconnect(doc, &KTextEditor::Document::documentUrlChanged, this, &KateFileTreeModel::documentNameChanged);
@@ -837,6 +896,10 @@ void KateFileTreeModel::slotDocumentsDeleted(const QList<KTextEditor::Document *
     foreach(const KTextEditor::Document * doc, docs) {
         connectDocument(doc);
     }
+
+    m_closingDocuments = false;
+    removeDocuments(m_closedDocuments);
+    m_closedDocuments.clear();
 }
 
 class EditViewCount
@@ -940,39 +1003,88 @@ void KateFileTreeModel::handleEmptyParents(ProxyItemDir *item)
     }
 }
 
-void KateFileTreeModel::documentClosed(KTextEditor::Document *doc)
+void KateFileTreeModel::documentHibernationChanged(KTextEditor::Document *doc, bool hibernated)
 {
+    // no longer hibernated: closed, or loaded and announced as created again
+    if (!hibernated) {
+        documentClosed(doc);
+        return;
+    }
+
+    // the application dropped the document, it stays listed with its state
     if (!m_docmap.contains(doc)) {
+        documentOpened(doc);
+    }
+
+    ProxyItem *item = m_docmap[doc];
+    item->setFlag(ProxyItem::Hibernated);
+    setupIcon(item);
+
+    const QModelIndex idx = createIndex(item->row(), 0, item);
+    emit dataChanged(idx, idx);
+}
+
+void KateFileTreeModel::documentClosed(KTextEditor::Document *doc)
+{
+    // the documents are deleted before the batch ends, only the pointer is kept
+    if (m_closingDocuments) {
+        m_closedDocuments.append(doc);
         return;
     }
 
-    if (m_shadingEnabled) {
-        ProxyItem *toRemove = m_docmap[doc];
-        if (m_brushes.contains(toRemove)) {
-            m_brushes.remove(toRemove);
-        }
+    removeDocuments(QList<KTextEditor::Document *>() << doc);
+}
 
-        if (m_viewHistory.contains(toRemove)) {
-            m_viewHistory.removeAll(toRemove);
+void KateFileTreeModel::removeDocuments(const QList<KTextEditor::Document *> &docs)
+{
+    /**
+     * forget the items, grouped by parent
+     * the documents may be deleted already, don't touch them
+     */
+    QHash<ProxyItemDir *, QList<ProxyItem *> > itemsByParent;
+    foreach(KTextEditor::Document * doc, docs) {
+        ProxyItem *item = m_docmap.take(doc);
+        if (!item) {
+            continue;
         }
 
-        if (m_editHistory.contains(toRemove)) {
-            m_editHistory.removeAll(toRemove);
-        }
+        m_brushes.remove(item);
+        m_viewHistory.removeAll(item);
+        m_editHistory.removeAll(item);
+        itemsByParent[item->parent()].append(item);
     }
 
-    ProxyItem *node = m_docmap[doc];
-    ProxyItemDir *parent = node->parent();
+    /**
+     * each parent loses its items in contiguous row ranges, bottom up
+     * a parent can't get empty before its own items are removed, so all parents stay valid
+     */
+    for (auto it = itemsByParent.constBegin(); it != itemsByParent.constEnd(); ++it) {
+        ProxyItemDir *parent = it.key();
 
-    const QModelIndex parent_index = (parent == m_root) ? QModelIndex() : createIndex(parent->row(), 0, parent);
-    beginRemoveRows(parent_index, node->row(), node->row());
-    node->parent()->remChild(node);
-    endRemoveRows();
+        QVector<int> rows;
+        rows.reserve(it.value().size());
+        foreach(ProxyItem * item, it.value()) {
+            rows.append(item->row());
+        }
+        std::sort(rows.begin(), rows.end());
 
-    delete node;
-    handleEmptyParents(parent);
+        const QModelIndex parent_index = (parent == m_root) ? QModelIndex() : createIndex(parent->row(), 0, parent);
+        for (int last = rows.size() - 1; last >= 0;) {
+            int first = last;
+            while (first > 0 && rows[first - 1] == rows[first] - 1) {
+                --first;
+            }
+
+            beginRemoveRows(parent_index, rows[first], rows[last]);
+            parent->remChildren(rows[first], rows[last] - rows[first] + 1);
+            endRemoveRows();
+
+            last = first - 1;
+        }
 
-    m_docmap.remove(doc);
+        qDeleteAll(it.value());
+        handleEmptyParents(parent);
+    }
 }
 
 void KateFileTreeModel::documentNameChanged(KTextEditor::Document *doc)
@@ -1276,14 +1388,15 @@ void KateFileTreeModel::updateItemPathAndHost(ProxyItem *item) const
     const KTextEditor::Document *doc = item->doc();
     Q_ASSERT(doc); // this method should not be called at directory items
 
-    QString path = doc->url().path();
+    const QUrl url = documentUrl(doc);
+    QString path = url.path();
     QString host;
-    if (doc->url().isEmpty()) {
+    if (url.isEmpty()) {
         path = doc->documentName();
         item->setFlag(ProxyItem::Empty);
     } else {
         item->clearFlag(ProxyItem::Empty);
-        host = doc->url().host();
+        host = url.host();
         if (!host.isEmpty()) {
             path = QString::fromLatin1("[%1]%2").arg(host).arg(path);
         }
@@ -1315,6 +1428,8 @@ void KateFileTreeModel::setupIcon(ProxyItem *item) const
 
     if (item->flag(ProxyItem::ModifiedExternally) || item->flag(ProxyItem::DeletedExternally)) {
         icon = KIconUtils::addOverlay(icon, QIcon(QLatin1String("emblem-important")), Qt::TopLeftCorner);
+    } else if (item->flag(ProxyItem::Hibernated)) {
+        icon = KIconUtils::addOverlay(icon, QIcon::fromTheme(QLatin1String("media-playback-pause")), Qt::BottomRightCorner);
     }
 
     item->setIcon(icon);
@@ -87,6 +87,8 @@ public:
 public Q_SLOTS:
     void documentOpened(KTextEditor::Document *);
     void documentClosed(KTextEditor::Document *);
+    /* hibernated documents are not announced by the application, they stay listed */
+    void documentHibernationChanged(KTextEditor::Document *, bool hibernated);
     void documentNameChanged(KTextEditor::Document *);
     void documentModifiedChanged(KTextEditor::Document *);
     void documentModifiedOnDisc(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason);
@@ -103,6 +105,7 @@ private:
     void handleInsert(ProxyItem *item);
     void handleNameChange(ProxyItem *item);
     void handleEmptyParents(ProxyItemDir *item);
+    void removeDocuments(const QList<KTextEditor::Document *> &docs);
     void setupIcon(ProxyItem *item) const;
     void updateItemPathAndHost(ProxyItem *item) const;
     void handleDuplicitRootDisplay(ProxyItemDir *item);
@@ -127,6 +130,12 @@ private:
     QColor m_viewShade;
 
     bool m_listMode;
+
+    /**
+     * inside a close batch the closed documents are collected
+     */
+    bool m_closingDocuments;
+    QList<KTextEditor::Document *> m_closedDocuments;
 };
 
 #endif /* KATEFILETREEMODEL_H */
@@ -125,6 +125,7 @@ void KateFileTreePlugin::applyConfig(bool shadingEnabled, QColor viewShade, QCol
 KateFileTreePluginView::KateFileTreePluginView(KTextEditor::MainWindow *mainWindow, KateFileTreePlugin *plug)
     : QObject(mainWindow)
     , m_loadingDocuments(false)
+    , m_closingDocuments(false)
     , m_plug(plug)
     , m_mainWindow(mainWindow)
 {
@@ -181,6 +182,17 @@ KateFileTreePluginView::KateFileTreePluginView(KTextEditor::MainWindow *mainWind
             m_documentModel, &KateFileTreeModel::slotAboutToDeleteDocuments);
     connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::documentsDeleted,
             m_documentModel, &KateFileTreeModel::slotDocumentsDeleted);
+    connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::aboutToDeleteDocuments,
+            this, &KateFileTreePluginView::slotAboutToDeleteDocuments);
+    connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::documentsDeleted,
+            this, &KateFileTreePluginView::slotDocumentsDeleted);
+
+    // hibernated documents are not announced as documents, the host tells about them if it can
+    QObject *host = KTextEditor::Editor::instance()->application()->parent();
+    if (host && host->metaObject()->indexOfSignal("documentHibernationChanged(KTextEditor::Document*,bool)") >= 0) {
+        connect(host, SIGNAL(documentHibernationChanged(KTextEditor::Document*,bool)),
+                this, SLOT(documentHibernationChanged(KTextEditor::Document*,bool)));
+    }
 
     connect(m_documentModel, &KateFileTreeModel::triggerViewChangeAfterNameChange, [=] {
                 KateFileTreePluginView::viewChanged();
@@ -308,9 +320,25 @@ void KateFileTreePluginView::documentOpened(KTextEditor::Document *doc)
 void KateFileTreePluginView::documentClosed(KTextEditor::Document *doc)
 {
     Q_UNUSED(doc);
+
+    // the model removes all closed documents at once, sort afterwards
+    if (m_closingDocuments) {
+        return;
+    }
+
     m_proxyModel->invalidate();
 }
 
+void KateFileTreePluginView::documentHibernationChanged(KTextEditor::Document *doc, bool hibernated)
+{
+    m_documentModel->documentHibernationChanged(doc, hibernated);
+
+    // the model removes all closed documents at once, sort afterwards
+    if (!m_closingDocuments) {
+        m_proxyModel->invalidate();
+    }
+}
+
 void KateFileTreePluginView::viewChanged(KTextEditor::View *)
 {
     KTextEditor::View *view = m_mainWindow->activeView();
@@ -442,6 +470,17 @@ void KateFileTreePluginView::slotDocumentsCreated(const QList<KTextEditor::Docum
     viewChanged();
 }
 
+void KateFileTreePluginView::slotAboutToDeleteDocuments()
+{
+    m_closingDocuments = true;
+}
+
+void KateFileTreePluginView::slotDocumentsDeleted()
+{
+    m_closingDocuments = false;
+    m_proxyModel->invalidate();
+}
+
 void KateFileTreePluginView::slotDocumentSave()
 {
     if (auto view = m_mainWindow->activeView()) {
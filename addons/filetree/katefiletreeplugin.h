@@ -119,6 +119,7 @@ private:
     KateFileTreeModel *m_documentModel;
     bool m_hasLocalPrefs;
     bool m_loadingDocuments;
+    bool m_closingDocuments;
     KateFileTreePlugin *m_plug;
     KTextEditor::MainWindow *m_mainWindow;
 
@@ -130,10 +131,13 @@ private Q_SLOTS:
     void viewChanged(KTextEditor::View * = nullptr);
     void documentOpened(KTextEditor::Document *);
     void documentClosed(KTextEditor::Document *);
+    void documentHibernationChanged(KTextEditor::Document *, bool hibernated);
     void viewModeChanged(bool);
     void sortRoleChanged(int);
     void slotAboutToCreateDocuments();
     void slotDocumentsCreated(const QList<KTextEditor::Document *> &);
+    void slotAboutToDeleteDocuments();
+    void slotDocumentsDeleted();
     void slotDocumentSave();
     void slotDocumentSaveAs();
 };
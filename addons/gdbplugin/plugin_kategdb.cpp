@@ -78,6 +78,9 @@ KatePluginGDBView::KatePluginGDBView(KTextEditor::Plugin *plugin, KTextEditor::M
     m_kateApplication = KTextEditor::Editor::instance()->application();
     m_focusOnInput = true;
     m_activeThread = -1;
+    m_threadCombo = nullptr;
+    m_stackTree = nullptr;
+    m_localsView = nullptr;
 
     KXMLGUIClient::setComponentName (QLatin1String("kategdb"), i18n ("Kate GDB"));
     setXMLFile(QLatin1String("ui.rc"));
@@ -124,35 +127,6 @@ KatePluginGDBView::KatePluginGDBView(KTextEditor::Plugin *plugin, KTextEditor::M
     layout->setContentsMargins(0,0,0,0);
     layout->setSpacing(0);
 
-    // stack page
-    QWidget *stackContainer = new QWidget();
-    QVBoxLayout *stackLayout = new QVBoxLayout(stackContainer);
-    m_threadCombo = new QComboBox();
-    m_stackTree = new QTreeWidget();
-    stackLayout->addWidget(m_threadCombo);
-    stackLayout->addWidget(m_stackTree);
-    stackLayout->setStretch(0, 10);
-    stackLayout->setContentsMargins(0,0,0,0);
-    stackLayout->setSpacing(0);
-    QStringList headers;
-    headers << QStringLiteral("  ") << i18nc("Column label (frame number)", "Nr") << i18nc("Column label", "Frame");
-    m_stackTree->setHeaderLabels(headers);
-    m_stackTree->setRootIsDecorated(false);
-    m_stackTree->resizeColumnToContents(0);
-    m_stackTree->resizeColumnToContents(1);
-    m_stackTree->setAutoScroll(false);
-    connect(m_stackTree, &QTreeWidget::itemActivated, this, &KatePluginGDBView::stackFrameSelected);
-
-    connect(m_threadCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &KatePluginGDBView::threadSelected);
-
-
-    m_localsView = new LocalsView();
-
-    QSplitter *locStackSplitter = new QSplitter(m_localsStackToolView);
-    locStackSplitter->addWidget(m_localsView);
-    locStackSplitter->addWidget(stackContainer);
-    locStackSplitter->setOrientation(Qt::Vertical);
-
     // config page
     m_configView = new ConfigView(nullptr, mainWin);
 
@@ -187,11 +161,16 @@ KatePluginGDBView::KatePluginGDBView(KTextEditor::Plugin *plugin, KTextEditor::M
 
     connect(m_debugView, &DebugView::stackFrameChanged, this, &KatePluginGDBView::stackFrameChanged);
 
-    connect(m_debugView, &DebugView::infoLocal, m_localsView, &LocalsView::addLocal);
-
     connect(m_debugView, &DebugView::threadInfo, this, &KatePluginGDBView::insertThread);
 
-    connect(m_localsView, &LocalsView::localsVisible, m_debugView, &DebugView::slotQueryLocals);
+    // the locals and stack widgets are created once the tool view is shown the first time,
+    // if the host can tell us, else right now. gdb is only asked for locals and stack
+    // while they are visible, so nothing is missed until then
+    if (m_localsStackToolView->metaObject()->indexOfSignal("contentRequested()") >= 0) {
+        connect(m_localsStackToolView, SIGNAL(contentRequested()), this, SLOT(createLocalsStackWidgets()));
+    } else {
+        createLocalsStackWidgets();
+    }
 
     // Actions
     m_configView->registerActions(actionCollection());
@@ -315,7 +294,9 @@ void KatePluginGDBView::slotDebug()
     m_tabWidget->setCurrentWidget(m_gdbPage);
     QScrollBar *sb = m_outputArea->verticalScrollBar();
     sb->setValue(sb->maximum());
-    m_localsView->clear();
+    if (m_localsView) {
+        m_localsView->clear();
+    }
 
     m_debugView->runDebugger(m_configView->currentTarget(), ioFifos);
 }
@@ -326,11 +307,59 @@ void KatePluginGDBView::slotRestart()
     m_tabWidget->setCurrentWidget(m_gdbPage);
     QScrollBar *sb = m_outputArea->verticalScrollBar();
     sb->setValue(sb->maximum());
-    m_localsView->clear();
+    if (m_localsView) {
+        m_localsView->clear();
+    }
 
     m_debugView->slotReRun();
 }
 
+void KatePluginGDBView::createLocalsStackWidgets()
+{
+    if (m_localsView) {
+        return;
+    }
+
+    // stack page
+    QWidget *stackContainer = new QWidget();
+    QVBoxLayout *stackLayout = new QVBoxLayout(stackContainer);
+    m_threadCombo = new QComboBox();
+    m_stackTree = new QTreeWidget();
+    stackLayout->addWidget(m_threadCombo);
+    stackLayout->addWidget(m_stackTree);
+    stackLayout->setStretch(0, 10);
+    stackLayout->setContentsMargins(0,0,0,0);
+    stackLayout->setSpacing(0);
+    QStringList headers;
+    headers << QStringLiteral("  ") << i18nc("Column label (frame number)", "Nr") << i18nc("Column label", "Frame");
+    m_stackTree->setHeaderLabels(headers);
+    m_stackTree->setRootIsDecorated(false);
+    m_stackTree->resizeColumnToContents(0);
+    m_stackTree->resizeColumnToContents(1);
+    m_stackTree->setAutoScroll(false);
+    connect(m_stackTree, &QTreeWidget::itemActivated, this, &KatePluginGDBView::stackFrameSelected);
+
+    connect(m_threadCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &KatePluginGDBView::threadSelected);
+
+
+    m_localsView = new LocalsView();
+
+    QSplitter *locStackSplitter = new QSplitter(m_localsStackToolView);
+    locStackSplitter->addWidget(m_localsView);
+    locStackSplitter->addWidget(stackContainer);
+    locStackSplitter->setOrientation(Qt::Vertical);
+
+    connect(m_debugView, &DebugView::infoLocal, m_localsView, &LocalsView::addLocal);
+
+    connect(m_localsView, &LocalsView::localsVisible, m_debugView, &DebugView::slotQueryLocals);
+
+    // take over the current state of the debugger
+    const bool enable = m_debugView->debuggerRunning() && !m_debugView->debuggerBusy();
+    m_threadCombo->setEnabled(enable);
+    m_stackTree->setEnabled(enable);
+    m_localsView->setEnabled(enable);
+}
+
 void KatePluginGDBView::aboutToShowMenu()
 {
     if (!m_debugView->debuggerRunning() || m_debugView->debuggerBusy()) {
@@ -445,9 +474,11 @@ void KatePluginGDBView::enableDebugActions(bool enable)
     actionCollection()->action(QStringLiteral("rerun"            ))->setEnabled(m_debugView->debuggerRunning());
 
     m_inputArea->setEnabled(enable);
-    m_threadCombo->setEnabled(enable);
-    m_stackTree->setEnabled(enable);
-    m_localsView->setEnabled(enable);
+    if (m_localsView) {
+        m_threadCombo->setEnabled(enable);
+        m_stackTree->setEnabled(enable);
+        m_localsView->setEnabled(enable);
+    }
 
     if (enable)  {
         m_inputArea->setFocusPolicy(Qt::WheelFocus);
@@ -489,9 +520,11 @@ void KatePluginGDBView::programEnded()
 {
     // don't set the execution mark on exit
     m_lastExecLine = -1;
-    m_stackTree->clear();
-    m_localsView->clear();
-    m_threadCombo->clear();
+    if (m_localsView) {
+        m_stackTree->clear();
+        m_localsView->clear();
+        m_threadCombo->clear();
+    }
 
     // Indicate the state change by showing the debug outputArea
     m_mainWin->showToolView(m_toolView);
@@ -501,7 +534,9 @@ void KatePluginGDBView::programEnded()
 void KatePluginGDBView::gdbEnded()
 {
     m_outputArea->clear();
-    m_localsView->clear();
+    if (m_localsView) {
+        m_localsView->clear();
+    }
     m_ioView->clearOutput();
     clearMarks();
 }
@@ -543,6 +578,10 @@ void KatePluginGDBView::slotSendCommand()
 
 void KatePluginGDBView::insertStackFrame(QString const& level, QString const& info)
 {
+    if (!m_stackTree) {
+        return;
+    }
+
     if (level.isEmpty() && info.isEmpty()) {
         m_stackTree->resizeColumnToContents(2);
         return;
@@ -571,17 +610,23 @@ void KatePluginGDBView::stackFrameSelected()
 
 void KatePluginGDBView::stackFrameChanged(int level)
 {
-    QTreeWidgetItem *current = m_stackTree->topLevelItem(m_lastExecFrame);
-    QTreeWidgetItem *next = m_stackTree->topLevelItem(level);
+    if (m_stackTree) {
+        QTreeWidgetItem *current = m_stackTree->topLevelItem(m_lastExecFrame);
+        QTreeWidgetItem *next = m_stackTree->topLevelItem(level);
 
-    if (current) current->setIcon (0, QIcon());
-    if (next)    next->setIcon(0, QIcon::fromTheme(QStringLiteral("arrow-right")));
+        if (current) current->setIcon (0, QIcon());
+        if (next)    next->setIcon(0, QIcon::fromTheme(QStringLiteral("arrow-right")));
+    }
     m_lastExecFrame = level;
 }
 
 
 void KatePluginGDBView::insertThread(int number, bool active)
 {
+    if (!m_threadCombo) {
+        return;
+    }
+
     if (number < 0) {
         m_threadCombo->clear();
         m_activeThread = -1;
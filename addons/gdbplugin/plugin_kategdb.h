@@ -90,6 +90,11 @@ private Q_SLOTS:
     void insertThread(int number, bool active);
     void threadSelected(int thread);
 
+    /**
+     * create the locals and stack widgets, if not already done
+     */
+    void createLocalsStackWidgets();
+
     void showIO(bool show);
     void addOutputText(QString const& text);
     void addErrorText(QString const& text);
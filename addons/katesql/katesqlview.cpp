@@ -54,6 +54,8 @@
 KateSQLView::KateSQLView(KTextEditor::Plugin *plugin, KTextEditor::MainWindow *mw)
 : QObject (mw)
 , KXMLGUIClient()
+, m_outputWidget (nullptr)
+, m_schemaBrowserWidget (nullptr)
 , m_manager (new SQLManager(this))
 , m_mainWindow (mw)
 {
@@ -72,15 +74,23 @@ KateSQLView::KateSQLView(KTextEditor::Plugin *plugin, KTextEditor::MainWindow *m
                                                i18nc("@title:window", "SQL Schema Browser")
                                                );
 
-  m_outputWidget = new KateSQLOutputWidget(m_outputToolView);
-
-  m_schemaBrowserWidget = new SchemaBrowserWidget(m_schemaBrowserToolView, m_manager);
-
   m_connectionsComboBox = new KComboBox(false);
   m_connectionsComboBox->setEditable(false);
   m_connectionsComboBox->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Fixed);
   m_connectionsComboBox->setModel(m_manager->connectionModel());
 
+  /**
+   * the tool view widgets are created once the tool views are shown the first time,
+   * if the host can tell us, else right now
+   */
+  if (m_outputToolView->metaObject()->indexOfSignal("contentRequested()") >= 0) {
+    connect(m_outputToolView, SIGNAL(contentRequested()), this, SLOT(createOutputWidget()));
+    connect(m_schemaBrowserToolView, SIGNAL(contentRequested()), this, SLOT(createSchemaBrowserWidget()));
+  } else {
+    createOutputWidget();
+    createSchemaBrowserWidget();
+  }
+
   setupActions();
 
   m_mainWindow->guiFactory()->addClient(this);
@@ -114,6 +124,25 @@ KateSQLView::~KateSQLView()
 }
 
 
+void KateSQLView::createOutputWidget()
+{
+  if (m_outputWidget)
+    return;
+
+  m_outputWidget = new KateSQLOutputWidget(m_outputToolView);
+}
+
+
+void KateSQLView::createSchemaBrowserWidget()
+{
+  if (m_schemaBrowserWidget)
+    return;
+
+  m_schemaBrowserWidget = new SchemaBrowserWidget(m_schemaBrowserToolView, m_manager);
+  m_schemaBrowserWidget->schemaWidget()->buildTree(m_connectionsComboBox->currentText());
+}
+
+
 void KateSQLView::setupActions()
 {
   QAction* action;
@@ -200,13 +229,15 @@ void KateSQLView::slotConnectionChanged(const QString &connection)
 {
   stateChanged(QLatin1String ("has_connection_selected"), (connection.isEmpty()) ? KXMLGUIClient::StateReverse : KXMLGUIClient::StateNoReverse);
 
-  m_schemaBrowserWidget->schemaWidget()->buildTree(connection);
+  if (m_schemaBrowserWidget)
+    m_schemaBrowserWidget->schemaWidget()->buildTree(connection);
 }
 
 
 void KateSQLView::slotGlobalSettingsChanged()
 {
-  m_outputWidget->dataOutputWidget()->model()->readConfig();
+  if (m_outputWidget)
+    m_outputWidget->dataOutputWidget()->model()->readConfig();
 }
 
 
@@ -316,7 +347,7 @@ void KateSQLView::slotConnectionAboutToBeClosed (const QString& name)
 {
   /// must delete the QSqlQuery object inside the model before closing connection
 
-  if (name == m_currentResultsetConnection)
+  if (m_outputWidget && name == m_currentResultsetConnection)
     m_outputWidget->dataOutputWidget()->clearResults();
 }
 
@@ -351,6 +382,7 @@ void KateSQLView::slotRunQuery()
 
 void KateSQLView::slotError(const QString &message)
 {
+  createOutputWidget();
   m_outputWidget->textOutputWidget()->showErrorMessage(message);
   m_outputWidget->setCurrentWidget(m_outputWidget->textOutputWidget());
   m_mainWindow->showToolView(m_outputToolView);
@@ -360,6 +392,7 @@ void KateSQLView::slotError(const QString &message)
 
 void KateSQLView::slotSuccess(const QString &message)
 {
+  createOutputWidget();
   m_outputWidget->textOutputWidget()->showSuccessMessage(message);
   m_outputWidget->setCurrentWidget(m_outputWidget->textOutputWidget());
   m_mainWindow->showToolView(m_outputToolView);
@@ -373,6 +406,7 @@ void KateSQLView::slotQueryActivated(QSqlQuery &query, const QString &connection
   {
     m_currentResultsetConnection = connection;
 
+    createOutputWidget();
     m_outputWidget->dataOutputWidget()->showQueryResultSets(query);
     m_outputWidget->setCurrentWidget(m_outputWidget->dataOutputWidget());
     m_mainWindow->showToolView(m_outputToolView);
@@ -385,7 +419,8 @@ void KateSQLView::slotConnectionCreated(const QString &name)
 {
   m_connectionsComboBox->setCurrentItem(name);
 
-  m_schemaBrowserWidget->schemaWidget()->buildTree(name);
+  if (m_schemaBrowserWidget)
+    m_schemaBrowserWidget->schemaWidget()->buildTree(name);
 }
 
 //END KateSQLView
@@ -66,6 +66,13 @@ class KateSQLView : public QObject, public KXMLGUIClient
   protected:
     void setupActions();
 
+  private Q_SLOTS:
+    /**
+     * create the tool view widgets, if not already done
+     */
+    void createOutputWidget();
+    void createSchemaBrowserWidget();
+
   private:
     QWidget *m_outputToolView;
     QWidget *m_schemaBrowserToolView;
@@ -20,6 +20,10 @@
 
 #include "test1.h"
 #include "fileutil.h"
+#include "kateprojectsymboltable.h"
+#include "kateprojecttree.h"
+#include "kateprojectcodeanalysiscache.h"
+#include "../../../katefilelistsnapshot.h"
 
 #include <QtTest>
 
@@ -40,4 +44,257 @@ void Test1::testCommonParent()
     QCOMPARE(FileUtil::commonParent(QLatin1String("~/dev/proj1"), QLatin1String("~/dev/proj222")), QLatin1String("~/dev/"));
 }
 
+static void fillSymbolTable(KateProjectSymbolTable &table)
+{
+    const char *lines[] = {
+        "!_TAG_FILE_FORMAT\t2\t/extended format/\n",
+        "readConfig\t/src/b.cpp\t/^void readConfig()$/;\"\tfunction\tline:20\n",
+        "ReadBuffer\t/src/a.h\t/^class ReadBuffer$/;\"\tclass\tline:5\n",
+        "readConfig\t/src/a.cpp\t/^void readConfig()$/;\"\tfunction\tline:10\n",
+        "read_all\t/src/c.c\t42;\"\tkind:function\n",
+        "writeConfig\t/src/b.cpp\t/^void writeConfig()$/;\"\tfunction\tline:30\n",
+        "broken line without tabs\n"
+    };
+
+    for (const char *line : lines) {
+        table.addCtagsLine(line, qstrlen(line));
+    }
+    table.finalize();
+}
+
+void Test1::testSymbolTablePrefix()
+{
+    KateProjectSymbolTable table;
+    fillSymbolTable(table);
+    QCOMPARE(table.size(), 5);
+
+    // case-sensitive, sorted by name, then file
+    QVector<int> matches = table.prefixMatches(QStringLiteral("read"));
+    QCOMPARE(matches.size(), 3);
+    QCOMPARE(table.name(matches[0]), QStringLiteral("readConfig"));
+    QCOMPARE(table.file(matches[0]), QStringLiteral("/src/a.cpp"));
+    QCOMPARE(table.line(matches[0]), 10);
+    QCOMPARE(table.kind(matches[0]), QStringLiteral("function"));
+    QCOMPARE(table.file(matches[1]), QStringLiteral("/src/b.cpp"));
+    QCOMPARE(table.name(matches[2]), QStringLiteral("read_all"));
+    QCOMPARE(table.line(matches[2]), 42);
+
+    // unique names only
+    QCOMPARE(table.prefixMatches(QStringLiteral("read"), Qt::CaseSensitive, true).size(), 2);
+
+    // case-insensitive
+    QCOMPARE(table.prefixMatches(QStringLiteral("READ"), Qt::CaseInsensitive).size(), 4);
+    QCOMPARE(table.prefixMatches(QStringLiteral("READ"), Qt::CaseInsensitive, true).size(), 3);
+
+    // limits and misses
+    QCOMPARE(table.prefixMatches(QStringLiteral("read"), Qt::CaseSensitive, false, 1).size(), 1);
+    QVERIFY(table.prefixMatches(QStringLiteral("zzz")).isEmpty());
+    QVERIFY(table.prefixMatches(QString()).isEmpty());
+}
+
+void Test1::testSymbolTableFuzzy()
+{
+    KateProjectSymbolTable table;
+    fillSymbolTable(table);
+
+    // word starts and prefixes rank first
+    QVector<int> matches = table.fuzzyMatches(QStringLiteral("rc"), 10);
+    QCOMPARE(matches.size(), 2);
+    QCOMPARE(table.name(matches[0]), QStringLiteral("readConfig"));
+    QCOMPARE(table.name(matches[1]), QStringLiteral("writeConfig"));
+
+    matches = table.fuzzyMatches(QStringLiteral("config"), 1);
+    QCOMPARE(matches.size(), 1);
+    QCOMPARE(table.name(matches[0]), QStringLiteral("readConfig"));
+
+    QVERIFY(table.fuzzyMatches(QStringLiteral("xyz"), 10).isEmpty());
+
+    // incremental: the extended pattern only scores the previous matches
+    QVector<quint32> matching;
+    QCOMPARE(table.fuzzyMatches(QStringLiteral("c"), 10, nullptr, &matching).size(), matching.size());
+    QVERIFY(!matching.isEmpty());
+    const QVector<quint32> within = matching;
+    matches = table.fuzzyMatches(QStringLiteral("config"), 10, &within, &matching);
+    QCOMPARE(matches, table.fuzzyMatches(QStringLiteral("config"), 10));
+    QCOMPARE(matching.size(), 2);
+
+    QVERIFY(KateProjectSymbolTable::fuzzyScore("ab", 2, "xaxb") < KateProjectSymbolTable::fuzzyScore("ab", 2, "abxx"));
+}
+
+void Test1::testSymbolTablePersistence()
+{
+    KateProjectSymbolTable table;
+    fillSymbolTable(table);
+
+    // round trip
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        table.save(stream);
+    }
+
+    KateProjectSymbolTable loaded;
+    {
+        QDataStream stream(data);
+        QVERIFY(loaded.load(stream));
+    }
+    QCOMPARE(loaded.size(), table.size());
+    QCOMPARE(loaded.prefixMatches(QStringLiteral("READ"), Qt::CaseInsensitive), table.prefixMatches(QStringLiteral("READ"), Qt::CaseInsensitive));
+
+    // truncated data is rejected
+    {
+        QDataStream stream(data.left(data.size() / 2));
+        QVERIFY(!loaded.load(stream));
+        QVERIFY(loaded.isEmpty());
+    }
+
+    // keep only symbols of unchanged files
+    KateProjectSymbolTable partial;
+    QCOMPARE(partial.addSymbols(table, QSet<QByteArray>() << "/src/b.cpp"), 2);
+    partial.finalize();
+    QCOMPARE(partial.prefixMatches(QStringLiteral("readConfig")).size(), 1);
+    QCOMPARE(partial.line(partial.prefixMatches(QStringLiteral("writeConfig")).at(0)), 30);
+}
+
+void Test1::testProjectTree()
+{
+    KateProjectTree tree;
+    const int project = tree.addNode(KateProjectTree::rootNode(), KateProjectTree::Project, QStringLiteral("kate"));
+    const int src = tree.addNode(project, KateProjectTree::Directory, QStringLiteral("src"));
+    tree.setAnchor(src, QStringLiteral("/home/kate"));
+    const int main = tree.addNode(src, KateProjectTree::File, QStringLiteral("main.cpp"));
+    const int util = tree.addNode(src, KateProjectTree::File, QStringLiteral("util.cpp"));
+    const int readme = tree.addNode(project, KateProjectTree::File, QStringLiteral("README"));
+    tree.setAnchor(readme, QStringLiteral("/home/kate"));
+
+    // files entry for the root directory, anchored at the empty directory
+    const int etc = tree.addNode(project, KateProjectTree::Directory, QStringLiteral("etc"));
+    tree.setAnchor(etc, QString());
+    const int fstab = tree.addNode(etc, KateProjectTree::File, QStringLiteral("fstab"));
+    tree.finalize();
+
+    // structure
+    QCOMPARE(tree.fileCount(), 4);
+    QCOMPARE(tree.childCount(KateProjectTree::rootNode()), 1);
+    QCOMPARE(tree.childCount(project), 3);
+    QCOMPARE(tree.child(project, 1), readme);
+    QCOMPARE(tree.child(src, 1), util);
+    QCOMPARE(tree.row(util), 1);
+    QCOMPARE(tree.parent(main), src);
+    QCOMPARE(tree.type(src), KateProjectTree::Directory);
+    QCOMPARE(tree.name(main), QStringLiteral("main.cpp"));
+
+    // paths
+    QCOMPARE(tree.filePath(main), QStringLiteral("/home/kate/src/main.cpp"));
+    QCOMPARE(tree.filePath(readme), QStringLiteral("/home/kate/README"));
+    QCOMPARE(tree.filePath(fstab), QStringLiteral("/etc/fstab"));
+    QVERIFY(tree.filePath(project).isEmpty());
+    QCOMPARE(tree.files(), QStringList() << QStringLiteral("/home/kate/src/main.cpp") << QStringLiteral("/home/kate/src/util.cpp") << QStringLiteral("/home/kate/README") << QStringLiteral("/etc/fstab"));
+
+    // lookup
+    QCOMPARE(tree.nodeForFile(QStringLiteral("/home/kate/src/util.cpp")), util);
+    QCOMPARE(tree.nodeForFile(QStringLiteral("/home/kate/README")), readme);
+    QCOMPARE(tree.nodeForFile(QStringLiteral("/etc/fstab")), fstab);
+    QCOMPARE(tree.nodeForFile(QStringLiteral("/home/kate/src")), -1);
+    QCOMPARE(tree.nodeForFile(QStringLiteral("/home/kate/src/other.cpp")), -1);
+    QCOMPARE(tree.nodeForFile(QStringLiteral("/home/katekate/README")), -1);
+
+    // lookup in a flat directory, children keep insertion order, names interned out of order
+    KateProjectTree flat;
+    const int flatProject = flat.addNode(KateProjectTree::rootNode(), KateProjectTree::Project, QStringLiteral("flat"));
+    const int other = flat.addNode(flatProject, KateProjectTree::Directory, QStringLiteral("other"));
+    flat.setAnchor(other, QStringLiteral("/flat"));
+    flat.addNode(other, KateProjectTree::File, QStringLiteral("file150"));
+    const int many = flat.addNode(flatProject, KateProjectTree::Directory, QStringLiteral("many"));
+    flat.setAnchor(many, QStringLiteral("/flat"));
+    QVector<int> flatFiles;
+    for (int i = 0; i < 300; ++i) {
+        flatFiles.append(flat.addNode(many, KateProjectTree::File, QStringLiteral("file%1").arg(i)));
+    }
+    flat.finalize();
+    QCOMPARE(flat.child(many, 150), flatFiles[150]);
+    for (int i = 0; i < 300; ++i) {
+        QCOMPARE(flat.nodeForFile(QStringLiteral("/flat/many/file%1").arg(i)), flatFiles[i]);
+    }
+    QCOMPARE(flat.nodeForFile(QStringLiteral("/flat/many/file300")), -1);
+}
+
+void Test1::testCodeAnalysisCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString file = dir.path() + QStringLiteral("/a.cpp");
+    const QString otherFile = dir.path() + QStringLiteral("/b.cpp");
+    const QString toolKey = QStringLiteral("cppcheck -q");
+
+    QFile output(file);
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    output.write("int main() {}\n");
+    output.close();
+
+    const QByteArray hash = KateProjectCodeAnalysisCache::hashFile(file);
+    QVERIFY(!hash.isEmpty());
+    QVERIFY(KateProjectCodeAnalysisCache::hashFile(otherFile).isEmpty());
+
+    KateProjectCodeAnalysisCache cache;
+    KateProjectCodeAnalysisFindings findings;
+    findings.append(QStringList() << file << QStringLiteral("1") << QStringLiteral("style") << QStringLiteral("unused"));
+    cache.insert(toolKey, file, hash, findings);
+    cache.insert(toolKey, otherFile, "other", KateProjectCodeAnalysisFindings());
+
+    // same content and tool => hit
+    KateProjectCodeAnalysisFindings cached;
+    QVERIFY(cache.lookup(toolKey, file, hash, &cached));
+    QCOMPARE(cached, findings);
+
+    // other tool arguments or changed content => miss
+    QVERIFY(!cache.lookup(QStringLiteral("cppcheck"), file, hash, &cached));
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    output.write("int main() { return 0; }\n");
+    output.close();
+    QVERIFY(!cache.lookup(toolKey, file, KateProjectCodeAnalysisCache::hashFile(file), &cached));
+
+    // removed files are forgotten
+    QCOMPARE(cache.size(toolKey), 2);
+    cache.retain(toolKey, QSet<QString>() << file);
+    QCOMPARE(cache.size(toolKey), 1);
+
+    // header findings of several analysed files are united, changed headers replace them
+    const QString header = dir.path() + QStringLiteral("/a.h");
+    const QStringList headerFinding = QStringList() << header << QStringLiteral("3") << QStringLiteral("style") << QStringLiteral("shadow");
+    const QStringList otherHeaderFinding = QStringList() << header << QStringLiteral("4") << QStringLiteral("style") << QStringLiteral("unused");
+    cache.merge(toolKey, header, "h1", KateProjectCodeAnalysisFindings() << headerFinding);
+    cache.merge(toolKey, header, "h1", KateProjectCodeAnalysisFindings() << headerFinding << otherHeaderFinding);
+    QVERIFY(cache.lookup(toolKey, header, "h1", &cached));
+    QCOMPARE(cached, KateProjectCodeAnalysisFindings() << headerFinding << otherHeaderFinding);
+    cache.merge(toolKey, header, "h2", KateProjectCodeAnalysisFindings() << otherHeaderFinding);
+    QVERIFY(cache.lookup(toolKey, header, "h2", &cached));
+    QCOMPARE(cached, KateProjectCodeAnalysisFindings() << otherHeaderFinding);
+
+    // dependencies change the key
+    QCOMPARE(KateProjectCodeAnalysisCache::combineHash(hash, QByteArray()), hash);
+    QVERIFY(KateProjectCodeAnalysisCache::combineHash(QByteArray(), "deps").isEmpty());
+    QVERIFY(KateProjectCodeAnalysisCache::combineHash(hash, "deps") != KateProjectCodeAnalysisCache::combineHash(hash, "other deps"));
+}
+
+void Test1::testFileListSnapshot()
+{
+    const QStringList files = QStringList() << QStringLiteral("/a/b.cpp") << QStringLiteral("/a/c.cpp");
+    const KateFileListSnapshot first(files, 1);
+    QCOMPARE(first.generation(), quint64(1));
+    QCOMPARE(first.files(), files);
+    QCOMPARE(first.size(), 2);
+    QVERIFY(first.contains(QStringLiteral("/a/c.cpp")));
+    QVERIFY(!first.contains(QStringLiteral("/a/d.cpp")));
+
+    // unchanged paths are shared with the previous snapshot
+    const KateFileListSnapshot second(QStringList() << (QStringLiteral("/a/") + QStringLiteral("c.cpp")) << QStringLiteral("/a/d.cpp"), 2, &first);
+    QCOMPARE(second.files().first().constData(), first.files().last().constData());
+    QVERIFY(second.contains(QStringLiteral("/a/d.cpp")));
+    QVERIFY(!second.contains(QStringLiteral("/a/b.cpp")));
+
+    QVERIFY(KateFileListSnapshot().isEmpty());
+    QCOMPARE(KateFileListSnapshot().generation(), quint64(0));
+}
+
 // kate: space-indent on; indent-width 4; replace-tabs on;
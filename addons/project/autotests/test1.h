@@ -33,6 +33,12 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void testCommonParent();
+    void testSymbolTablePrefix();
+    void testSymbolTableFuzzy();
+    void testSymbolTablePersistence();
+    void testProjectTree();
+    void testCodeAnalysisCache();
+    void testFileListSnapshot();
 };
 
 #endif
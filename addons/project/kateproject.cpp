@@ -38,13 +38,25 @@ KateProject::KateProject(ThreadWeaver::Queue *weaver)
     : QObject()
     , m_fileLastModified()
     , m_notesDocument(nullptr)
-    , m_untrackedDocumentsRoot(nullptr)
     , m_weaver(weaver)
+    , m_loadGeneration(new QAtomicInt(0))
+    , m_prioritized(false)
+    , m_loading(false)
+    , m_loadFilesListed(0)
+    , m_loadFilesIndexed(-1)
 {
 }
 
 KateProject::~KateProject()
 {
+    /**
+     * stop loading, a running worker will notice
+     */
+    m_loadGeneration->fetchAndAddOrdered(1);
+    if (m_loadJob) {
+        m_weaver->dequeue(m_loadJob);
+    }
+
     saveNotesDocument();
 }
 
@@ -148,25 +160,74 @@ bool KateProject::load(const QVariantMap &globalProject, bool force)
     emit projectMapChanged();
 
 
-    KateProjectWorker * w = new KateProjectWorker(m_baseDir, m_projectMap);
+    /**
+     * start new load, this supersedes the running one
+     * a superseded job still waiting in the queue is just dropped
+     */
+    const int generation = m_loadGeneration->fetchAndAddOrdered(1) + 1;
+    KateProjectWorker * w = new KateProjectWorker(m_baseDir, m_projectMap, generation, m_loadGeneration);
+    w->setPriority(m_prioritized ? KateProjectWorker::ActivePriority : KateProjectWorker::BackgroundPriority);
     connect(w, &KateProjectWorker::loadDone, this, &KateProject::loadProjectDone);
     connect(w, &KateProjectWorker::loadIndexDone, this, &KateProject::loadIndexDone);
-    m_weaver->stream() << w;
+    connect(w, &KateProjectWorker::loadProgress, this, &KateProject::loadProgress);
+
+    if (m_loadJob) {
+        m_weaver->dequeue(m_loadJob);
+    }
+    m_loadJob = ThreadWeaver::JobPointer(w);
+    m_weaver->enqueue(m_loadJob);
+
+    m_loading = true;
+    m_loadFilesListed = 0;
+    m_loadFilesIndexed = -1;
+    emit loadProgressChanged();
 
     return true;
 }
 
-void KateProject::loadProjectDone(KateProjectSharedQStandardItem topLevel, KateProjectSharedQMapStringItem file2Item)
+void KateProject::setPrioritized(bool prioritized)
 {
-    m_model.clear();
-    m_model.invisibleRootItem()->appendColumn(topLevel->takeColumn(0));
+    if (m_prioritized == prioritized) {
+        return;
+    }
 
-    m_file2Item = file2Item;
+    m_prioritized = prioritized;
+
+    /**
+     * the queue sorts on enqueue, so requeue the waiting job
+     */
+    if (m_loadJob && m_weaver->dequeue(m_loadJob)) {
+        static_cast<KateProjectWorker *>(m_loadJob.data())->setPriority(m_prioritized ? KateProjectWorker::ActivePriority : KateProjectWorker::BackgroundPriority);
+        m_weaver->enqueue(m_loadJob);
+    }
+}
+
+void KateProject::loadProgress(int generation, int filesListed, int filesIndexed)
+{
+    if (generation != m_loadGeneration->load()) {
+        return;
+    }
+
+    m_loadFilesListed = filesListed;
+    m_loadFilesIndexed = filesIndexed;
+    emit loadProgressChanged();
+}
+
+void KateProject::loadProjectDone(int generation, KateProjectSharedProjectTree tree)
+{
+    /**
+     * superseded meanwhile
+     */
+    if (generation != m_loadGeneration->load()) {
+        return;
+    }
+
+    m_model.setTree(tree);
+    invalidateFileSnapshot();
 
     /**
      * readd the documents that are open atm
      */
-    m_untrackedDocumentsRoot = nullptr;
     for (auto i = m_documents.constBegin(); i != m_documents.constEnd(); i++) {
         registerDocument(i.key());
     }
@@ -174,13 +235,27 @@ void KateProject::loadProjectDone(KateProjectSharedQStandardItem topLevel, KateP
     emit modelChanged();
 }
 
-void KateProject::loadIndexDone(KateProjectSharedProjectIndex projectIndex)
+void KateProject::loadIndexDone(int generation, KateProjectSharedProjectIndex projectIndex)
 {
+    /**
+     * superseded meanwhile
+     */
+    if (generation != m_loadGeneration->load()) {
+        return;
+    }
+
     /**
      * move to our project
      */
     m_projectIndex = projectIndex;
 
+    /**
+     * loading is done
+     */
+    m_loadJob.clear();
+    m_loading = false;
+    emit loadProgressChanged();
+
     /**
      * notify external world that data is available
      */
@@ -283,25 +358,17 @@ void KateProject::saveNotesDocument()
 
 void KateProject::slotModifiedChanged(KTextEditor::Document *document)
 {
-    KateProjectItem *item = itemForFile(m_documents.value(document));
-
-    if (!item) {
-        return;
-    }
-
-    item->slotModifiedChanged(document);
+    const QString file = m_documents.value(document);
+    m_model.setDocumentState(file, document->isModified(), m_model.isModifiedOnDisk(file));
 }
 
 void KateProject::slotModifiedOnDisk(KTextEditor::Document *document,
                                      bool isModified, KTextEditor::ModificationInterface::ModifiedOnDiskReason reason)
 {
-    KateProjectItem *item = itemForFile(m_documents.value(document));
+    Q_UNUSED(isModified)
 
-    if (!item) {
-        return;
-    }
-
-    item->slotModifiedOnDisk(document, isModified, reason);
+    const QString file = m_documents.value(document);
+    m_model.setDocumentState(file, document->isModified(), reason != KTextEditor::ModificationInterface::OnDiskUnmodified);
 }
 
 void KateProject::registerDocument(KTextEditor::Document *document)
@@ -311,95 +378,84 @@ void KateProject::registerDocument(KTextEditor::Document *document)
         m_documents[document] = document->url().toLocalFile();
     }
 
-    // try to get item for the document
-    KateProjectItem *item = itemForFile(document->url().toLocalFile());
-
-    // if we got one, we are done, else create a dummy!
-    if (item) {
-        disconnect(document, &KTextEditor::Document::modifiedChanged, this, &KateProject::slotModifiedChanged);
-        disconnect(document, SIGNAL(modifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)), this, SLOT(slotModifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)));
-        item->slotModifiedChanged(document);
-
-        /*FIXME    item->slotModifiedOnDisk(document,document->isModified(),qobject_cast<KTextEditor::ModificationInterface*>(document)->modifiedOnDisk()); FIXME*/
+    // not part of the tree? show it as untracked
+    const QString file = document->url().toLocalFile();
+    if (!m_model.isTracked(file)) {
+        const int untrackedCount = m_model.untrackedFiles().size();
+        m_model.addUntrackedFile(file);
+        if (m_model.untrackedFiles().size() != untrackedCount) {
+            invalidateFileSnapshot();
+        }
+    }
 
-        connect(document, &KTextEditor::Document::modifiedChanged, this, &KateProject::slotModifiedChanged);
-        connect(document, SIGNAL(modifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)), this, SLOT(slotModifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)));
+    // track the modified state for the icons
+    disconnect(document, &KTextEditor::Document::modifiedChanged, this, &KateProject::slotModifiedChanged);
+    disconnect(document, SIGNAL(modifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)), this, SLOT(slotModifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)));
+    m_model.setDocumentState(file, document->isModified(), m_model.isModifiedOnDisk(file));
 
-        return;
-    }
+    connect(document, &KTextEditor::Document::modifiedChanged, this, &KateProject::slotModifiedChanged);
+    connect(document, SIGNAL(modifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)), this, SLOT(slotModifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)));
+}
 
-    registerUntrackedDocument(document);
+void KateProject::unregisterDocument(KTextEditor::Document *document)
+{
+    unregisterDocuments(QList<KTextEditor::Document *>() << document);
 }
 
-void KateProject::registerUntrackedDocument(KTextEditor::Document *document)
+void KateProject::unregisterDocuments(const QList<KTextEditor::Document *> &documents)
 {
-    // perhaps create the parent item
-    if (!m_untrackedDocumentsRoot) {
-        m_untrackedDocumentsRoot = new KateProjectItem(KateProjectItem::Directory, i18n("<untracked>"));
-        m_model.insertRow(0, m_untrackedDocumentsRoot);
-    }
+    QStringList files;
+    for (auto document : documents) {
+        const auto it = m_documents.find(document);
+        if (it == m_documents.end()) {
+            continue;
+        }
 
-    // create document item
-    QFileInfo fileInfo(document->url().toLocalFile());
-    KateProjectItem *fileItem = new KateProjectItem(KateProjectItem::File, fileInfo.fileName());
-    fileItem->setData(document->url().toLocalFile(), Qt::ToolTipRole);
-    fileItem->slotModifiedChanged(document);
-    connect(document, &KTextEditor::Document::modifiedChanged, this, &KateProject::slotModifiedChanged);
-    connect(document, SIGNAL(modifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)), this, SLOT(slotModifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)));
+        disconnect(document, &KTextEditor::Document::modifiedChanged, this, &KateProject::slotModifiedChanged);
+        disconnect(document, SIGNAL(modifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)), this, SLOT(slotModifiedOnDisk(KTextEditor::Document *, bool, KTextEditor::ModificationInterface::ModifiedOnDiskReason)));
 
-    bool inserted = false;
-    for (int i = 0; i < m_untrackedDocumentsRoot->rowCount(); ++i) {
-        if (m_untrackedDocumentsRoot->child(i)->data(Qt::UserRole).toString() > document->url().toLocalFile()) {
-            m_untrackedDocumentsRoot->insertRow(i, fileItem);
-            inserted = true;
-            break;
-        }
+        files.append(it.value());
+        m_documents.erase(it);
     }
-    if (!inserted) {
-        m_untrackedDocumentsRoot->appendRow(fileItem);
+
+    if (files.isEmpty()) {
+        return;
     }
 
-    fileItem->setData(document->url().toLocalFile(), Qt::UserRole);
-    fileItem->setData(QVariant(true), Qt::UserRole + 3);
+    // one model update and at most one new snapshot for all files
+    const int untrackedCount = m_model.untrackedFiles().size();
+    m_model.removeUntrackedFiles(files);
+    if (m_model.untrackedFiles().size() != untrackedCount) {
+        invalidateFileSnapshot();
+    }
 
-    if (!m_file2Item) {
-        m_file2Item = KateProjectSharedQMapStringItem(new QMap<QString, KateProjectItem *> ());
+    for (const QString &file : files) {
+        m_model.clearDocumentState(file);
     }
-    (*m_file2Item)[document->url().toLocalFile()] = fileItem;
 }
 
-void KateProject::unregisterDocument(KTextEditor::Document *document)
+quint64 KateProject::newSnapshotGeneration()
 {
-    if (!m_documents.contains(document)) {
-        return;
-    }
-
-    disconnect(document, &KTextEditor::Document::modifiedChanged, this, &KateProject::slotModifiedChanged);
-
-    const QString &file = m_documents.value(document);
+    static quint64 generation = 0;
+    return ++generation;
+}
 
-    if (m_untrackedDocumentsRoot) {
-        KateProjectItem *item = static_cast<KateProjectItem *>(itemForFile(file));
-        if (item && item->data(Qt::UserRole + 3).toBool()) {
-            unregisterUntrackedItem(item);
-            m_file2Item->remove(file);
-        }
+KateSharedFileListSnapshot KateProject::fileSnapshot() const
+{
+    if (!m_fileSnapshot) {
+        m_fileSnapshot = KateSharedFileListSnapshot(new KateFileListSnapshot(files(), newSnapshotGeneration(), m_outdatedFileSnapshot.data()));
+        m_outdatedFileSnapshot.clear();
     }
 
-    m_documents.remove(document);
+    return m_fileSnapshot;
 }
 
-void KateProject::unregisterUntrackedItem(const KateProjectItem *item)
+void KateProject::invalidateFileSnapshot()
 {
-    for (int i = 0; i < m_untrackedDocumentsRoot->rowCount(); ++i) {
-        if (m_untrackedDocumentsRoot->child(i) == item) {
-            m_untrackedDocumentsRoot->removeRow(i);
-            break;
-        }
+    if (!m_fileSnapshot) {
+        return;
     }
 
-    if (m_untrackedDocumentsRoot->rowCount() < 1) {
-        m_model.removeRow(0);
-        m_untrackedDocumentsRoot = nullptr;
-    }
+    m_outdatedFileSnapshot = m_fileSnapshot;
+    m_fileSnapshot.clear();
 }
@@ -21,24 +21,21 @@
 #ifndef KATE_PROJECT_H
 #define KATE_PROJECT_H
 
+#include <QAtomicInt>
 #include <QDateTime>
 #include <QMap>
 #include <QSharedPointer>
 #include <QTextDocument>
 #include <KTextEditor/ModificationInterface>
+#include <ThreadWeaver/JobPointer>
 #include "kateprojectindex.h"
-#include "kateprojectitem.h"
+#include "kateprojectmodel.h"
+#include "../../katefilelistsnapshot.h"
 
 /**
  * Shared pointer data types.
  * Used to pass pointers over queued connected slots
  */
-typedef QSharedPointer<QStandardItem> KateProjectSharedQStandardItem;
-Q_DECLARE_METATYPE(KateProjectSharedQStandardItem)
-
-typedef QSharedPointer<QMap<QString, KateProjectItem *> > KateProjectSharedQMapStringItem;
-Q_DECLARE_METATYPE(KateProjectSharedQMapStringItem)
-
 typedef QSharedPointer<KateProjectIndex> KateProjectSharedProjectIndex;
 Q_DECLARE_METATYPE(KateProjectSharedProjectIndex)
 
@@ -125,26 +122,32 @@ public:
      * Accessor for the model.
      * @return model of this project
      */
-    QStandardItemModel *model() {
+    KateProjectModel *model() {
         return &m_model;
     }
 
     /**
-     * Flat list of all files in the project
+     * Flat list of all files in the project, including open untracked documents.
+     * The paths are reconstructed from the tree, don't call this too often.
      * @return list of files in project
      */
-    QStringList files() {
-        return m_file2Item ? m_file2Item->keys() : QStringList();
+    QStringList files() const {
+        QStringList files = m_model.tree() ? m_model.tree()->files() : QStringList();
+        files.append(m_model.untrackedFiles());
+        return files;
     }
 
     /**
-     * get item for file
-     * @param file file to get item for
-     * @return item for given file or 0
+     * Immutable snapshot of files(), rebuilt only after the files changed.
+     * @return snapshot of all files in the project
      */
-    KateProjectItem *itemForFile(const QString &file) {
-        return m_file2Item ? m_file2Item->value(file) : 0;
-    }
+    KateSharedFileListSnapshot fileSnapshot() const;
+
+    /**
+     * New generation for file list snapshots, unique in this plugin.
+     * @return generation
+     */
+    static quint64 newSnapshotGeneration();
 
     /**
      * Access to project index.
@@ -156,6 +159,16 @@ public:
         return m_projectIndex.data();
     }
 
+    /**
+     * Access to project index as shared pointer, e.g. to keep it alive
+     * while querying it in a background thread.
+     * May be null.
+     * @return project index
+     */
+    KateProjectSharedProjectIndex sharedProjectIndex() const {
+        return m_projectIndex;
+    }
+
     /**
      * Computes a suitable file name for the given suffix.
      * If you e.g. want to store a "notes" file, you could pass "notes" and get
@@ -189,21 +202,67 @@ public:
      */
     void unregisterDocument(KTextEditor::Document *document);
 
+    /**
+     * Unregister several documents for this project at once.
+     * @param documents documents to unregister
+     */
+    void unregisterDocuments(const QList<KTextEditor::Document *> &documents);
+
+    /**
+     * Load this project before others, e.g. it contains the active document.
+     * A waiting load job is moved forward in the queue.
+     * @param prioritized prioritize the loading of this project?
+     */
+    void setPrioritized(bool prioritized);
+
+    /**
+     * Is the project still loading, e.g. listing or indexing files?
+     * @return loading state
+     */
+    bool isLoading() const {
+        return m_loading;
+    }
+
+    /**
+     * Progress of the current load.
+     * @return files found so far
+     */
+    int loadFilesListed() const {
+        return m_loadFilesListed;
+    }
+
+    /**
+     * Progress of the current load.
+     * @return files indexed so far, -1 while still listing files
+     */
+    int loadFilesIndexed() const {
+        return m_loadFilesIndexed;
+    }
+
 private Q_SLOTS:
     bool load(const QVariantMap &globalProject, bool force = false);
 
     /**
      * Used for worker to send back the results of project loading
-     * @param topLevel new toplevel element for model
-     * @param file2Item new file => item mapping
+     * @param generation generation of the load
+     * @param tree new tree for the model
      */
-    void loadProjectDone(KateProjectSharedQStandardItem topLevel, KateProjectSharedQMapStringItem file2Item);
+    void loadProjectDone(int generation, KateProjectSharedProjectTree tree);
 
     /**
      * Used for worker to send back the results of index loading
+     * @param generation generation of the load
      * @param projectIndex new project index
      */
-    void loadIndexDone(KateProjectSharedProjectIndex projectIndex);
+    void loadIndexDone(int generation, KateProjectSharedProjectIndex projectIndex);
+
+    /**
+     * Used for worker to report progress
+     * @param generation generation of the load
+     * @param filesListed files found so far
+     * @param filesIndexed files indexed so far, -1 while still listing files
+     */
+    void loadProgress(int generation, int filesListed, int filesIndexed);
 
     void slotModifiedChanged(KTextEditor::Document *);
 
@@ -219,7 +278,7 @@ Q_SIGNALS:
 
     /**
      * Emitted on model changes.
-     * This includes the files list, itemForFile mapping!
+     * This includes the files list!
      */
     void modelChanged();
 
@@ -229,11 +288,19 @@ Q_SIGNALS:
      */
     void indexChanged();
 
+    /**
+     * Emitted when the loading state or progress changes.
+     */
+    void loadProgressChanged();
+
 private:
-    void registerUntrackedDocument(KTextEditor::Document *document);
-    void unregisterUntrackedItem(const KateProjectItem *item);
     QVariantMap readProjectFile() const;
 
+    /**
+     * the files did change, the next fileSnapshot() call builds a new one
+     */
+    void invalidateFileSnapshot();
+
 private:
 
     /**
@@ -262,19 +329,20 @@ private:
     QVariantMap m_projectMap;
 
     /**
-     * standard item model with content of this project
+     * item model with content of this project
      */
-    QStandardItemModel m_model;
+    KateProjectModel m_model;
 
     /**
-     * mapping files => items
+     * project index, if any
      */
-    KateProjectSharedQMapStringItem m_file2Item;
+    KateProjectSharedProjectIndex m_projectIndex;
 
     /**
-     * project index, if any
+     * current file snapshot, null if outdated, and the outdated one to intern the paths with
      */
-    KateProjectSharedProjectIndex m_projectIndex;
+    mutable KateSharedFileListSnapshot m_fileSnapshot;
+    mutable KateSharedFileListSnapshot m_outdatedFileSnapshot;
 
     /**
      * notes buffer for project local notes
@@ -286,12 +354,25 @@ private:
      */
     QMap<KTextEditor::Document *, QString> m_documents;
 
+    ThreadWeaver::Queue *m_weaver;
+
     /**
-     * Parent item for existing documents that are not in the project tree
+     * generation of the newest load, shared with the workers to stop superseded ones
      */
-    QStandardItem *m_untrackedDocumentsRoot;
+    QSharedPointer<QAtomicInt> m_loadGeneration;
 
-    ThreadWeaver::Queue *m_weaver;
+    /**
+     * newest load job, to move it forward in the queue
+     */
+    ThreadWeaver::JobPointer m_loadJob;
+
+    /**
+     * load state
+     */
+    bool m_prioritized;
+    bool m_loading;
+    int m_loadFilesListed;
+    int m_loadFilesIndexed;
 
     /**
      * project configuration (read from file or injected)
@@ -0,0 +1,102 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojectcodeanalysiscache.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+
+QByteArray KateProjectCodeAnalysisCache::hashFile(const QString &file)
+{
+    QFile input(file);
+    if (!input.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&input)) {
+        return QByteArray();
+    }
+    return hash.result();
+}
+
+bool KateProjectCodeAnalysisCache::lookup(const QString &toolKey, const QString &file, const QByteArray &hash, KateProjectCodeAnalysisFindings *findings) const
+{
+    const auto tool = m_entries.constFind(toolKey);
+    if (tool == m_entries.constEnd()) {
+        return false;
+    }
+
+    const auto entry = tool->constFind(file);
+    if (entry == tool->constEnd() || entry->hash != hash) {
+        return false;
+    }
+
+    *findings = entry->findings;
+    return true;
+}
+
+void KateProjectCodeAnalysisCache::insert(const QString &toolKey, const QString &file, const QByteArray &hash, const KateProjectCodeAnalysisFindings &findings)
+{
+    Entry &entry = m_entries[toolKey][file];
+    entry.hash = hash;
+    entry.findings = findings;
+}
+
+void KateProjectCodeAnalysisCache::merge(const QString &toolKey, const QString &file, const QByteArray &hash, const KateProjectCodeAnalysisFindings &findings)
+{
+    Entry &entry = m_entries[toolKey][file];
+    if (entry.hash != hash) {
+        entry.hash = hash;
+        entry.findings = findings;
+        return;
+    }
+
+    for (const QStringList &finding : findings) {
+        if (!entry.findings.contains(finding)) {
+            entry.findings.append(finding);
+        }
+    }
+}
+
+QByteArray KateProjectCodeAnalysisCache::combineHash(const QByteArray &hash, const QByteArray &dependencyHash)
+{
+    if (hash.isEmpty() || dependencyHash.isEmpty()) {
+        return hash;
+    }
+
+    return QCryptographicHash::hash(hash + dependencyHash, QCryptographicHash::Sha1);
+}
+
+void KateProjectCodeAnalysisCache::retain(const QString &toolKey, const QSet<QString> &files)
+{
+    const auto tool = m_entries.find(toolKey);
+    if (tool == m_entries.end()) {
+        return;
+    }
+
+    for (auto it = tool->begin(); it != tool->end();) {
+        if (files.contains(it.key())) {
+            ++it;
+        } else {
+            it = tool->erase(it);
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_CODE_ANALYSIS_CACHE_H
+#define KATE_PROJECT_CODE_ANALYSIS_CACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Findings for one file, each finding is file, line, severity, message
+ */
+typedef QVector<QStringList> KateProjectCodeAnalysisFindings;
+
+/**
+ * Cache for code analysis results.
+ * Findings are stored per tool key (tool path and arguments) and file,
+ * they stay valid as long as the content hash of the file is unchanged.
+ */
+class KateProjectCodeAnalysisCache
+{
+public:
+    /**
+     * Content hash of a file.
+     * @param file file to hash
+     * @return hash, empty if the file is not readable
+     */
+    static QByteArray hashFile(const QString &file);
+
+    /**
+     * Get cached findings.
+     * @param toolKey tool path and arguments
+     * @param file analysed file
+     * @param hash current content hash of the file
+     * @param findings filled with the cached findings on success
+     * @return true if the findings for this content are cached
+     */
+    bool lookup(const QString &toolKey, const QString &file, const QByteArray &hash, KateProjectCodeAnalysisFindings *findings) const;
+
+    /**
+     * Remember findings for a file, replaces the findings of older content.
+     * @param toolKey tool path and arguments
+     * @param file analysed file
+     * @param hash content hash of the analysed file
+     * @param findings findings of the file, may be empty
+     */
+    void insert(const QString &toolKey, const QString &file, const QByteArray &hash, const KateProjectCodeAnalysisFindings &findings);
+
+    /**
+     * Add findings for a file reported while analysing other files, e.g. an included header.
+     * Findings for the same content are united, findings of older content are replaced.
+     * @param toolKey tool path and arguments
+     * @param file file the findings are about
+     * @param hash content hash of that file
+     * @param findings findings in the file
+     */
+    void merge(const QString &toolKey, const QString &file, const QByteArray &hash, const KateProjectCodeAnalysisFindings &findings);
+
+    /**
+     * Combine a content hash with the hash of the files it depends on.
+     * @param hash content hash of a file, empty for unreadable files
+     * @param dependencyHash hash of the dependencies, may be empty
+     * @return combined hash, empty if the file is unreadable
+     */
+    static QByteArray combineHash(const QByteArray &hash, const QByteArray &dependencyHash);
+
+    /**
+     * Forget all files of the tool key not in the given set, e.g. removed from the project.
+     * @param toolKey tool path and arguments
+     * @param files files to keep
+     */
+    void retain(const QString &toolKey, const QSet<QString> &files);
+
+    /**
+     * Number of cached files for the tool key.
+     * @param toolKey tool path and arguments
+     * @return number of files
+     */
+    int size(const QString &toolKey) const {
+        return m_entries.value(toolKey).size();
+    }
+
+private:
+    /**
+     * findings for one content hash
+     */
+    struct Entry {
+        QByteArray hash;
+        KateProjectCodeAnalysisFindings findings;
+    };
+
+    /**
+     * tool key => file => entry
+     */
+    QHash<QString, QHash<QString, Entry> > m_entries;
+};
+
+#endif
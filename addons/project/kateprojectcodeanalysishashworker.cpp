@@ -0,0 +1,41 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojectcodeanalysishashworker.h"
+#include "kateprojectcodeanalysiscache.h"
+
+KateProjectCodeAnalysisHashWorker::KateProjectCodeAnalysisHashWorker(const QStringList &files, int generation)
+    : QObject()
+    , ThreadWeaver::Job()
+    , m_files(files)
+    , m_generation(generation)
+{
+}
+
+void KateProjectCodeAnalysisHashWorker::run(ThreadWeaver::JobPointer, ThreadWeaver::Thread *)
+{
+    KateProjectSharedFileHashes hashes(new QHash<QString, QByteArray>());
+    hashes->reserve(m_files.size());
+    for (const QString &file : m_files) {
+        hashes->insert(file, KateProjectCodeAnalysisCache::hashFile(file));
+    }
+
+    emit hashesReady(m_generation, hashes);
+}
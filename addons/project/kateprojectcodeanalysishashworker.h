@@ -0,0 +1,68 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_CODE_ANALYSIS_HASH_WORKER_H
+#define KATE_PROJECT_CODE_ANALYSIS_HASH_WORKER_H
+
+#include <ThreadWeaver/Job>
+
+#include <QHash>
+#include <QSharedPointer>
+#include <QStringList>
+
+/**
+ * Shared pointer data types.
+ * Used to pass the file hashes over queued connected slots
+ */
+typedef QSharedPointer<QHash<QString, QByteArray> > KateProjectSharedFileHashes;
+Q_DECLARE_METATYPE(KateProjectSharedFileHashes)
+
+/**
+ * Background job computing the content hashes of the files of one code
+ * analysis run, used to find the files that changed since the last run.
+ */
+class KateProjectCodeAnalysisHashWorker : public QObject, public ThreadWeaver::Job
+{
+    Q_OBJECT
+
+public:
+    /**
+     * construct new hash job
+     * @param files files to hash
+     * @param generation generation of the analysis run
+     */
+    KateProjectCodeAnalysisHashWorker(const QStringList &files, int generation);
+
+    void run(ThreadWeaver::JobPointer self, ThreadWeaver::Thread *thread) override;
+
+Q_SIGNALS:
+    /**
+     * Emitted once all files are hashed.
+     * @param generation generation of the analysis run
+     * @param hashes file => content hash, empty for unreadable files
+     */
+    void hashesReady(int generation, KateProjectSharedFileHashes hashes);
+
+private:
+    const QStringList m_files;
+    const int m_generation;
+};
+
+#endif
@@ -34,3 +34,15 @@ void KateProjectCodeAnalysisTool::setProject(KateProject *project)
 KateProjectCodeAnalysisTool::~KateProjectCodeAnalysisTool()
 {
 }
+
+bool KateProjectCodeAnalysisTool::isSuccessfulExitCode(int exitCode)
+{
+    return exitCode == 0;
+}
+
+QStringList KateProjectCodeAnalysisTool::dependencies(const QStringList &files)
+{
+    Q_UNUSED(files)
+
+    return QStringList();
+}
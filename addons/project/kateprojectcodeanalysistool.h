@@ -67,9 +67,13 @@ public:
     virtual QString path() = 0;
 
     /**
+     * Arguments for one tool run.
+     * Called with an empty list to get the arguments without any file,
+     * these identify the results in the analysis cache.
+     * @param files files to analyse in this run
      * @return arguments required for the tool
      */
-    virtual QStringList arguments() = 0;
+    virtual QStringList arguments(const QStringList &files) = 0;
 
     /**
      * @return warning message when the tool is not installed
@@ -84,9 +88,25 @@ public:
     virtual QStringList parseLine(const QString &line) = 0;
 
     /**
+     * @param files files to analyse in this run
      * @return messages passed to the tool through stdin
      */
-    virtual QString stdinMessages() = 0;
+    virtual QString stdinMessages(const QStringList &files) = 0;
+
+    /**
+     * Did the tool run properly? Some tools signal findings with their exit code.
+     * @param exitCode exit code of a normally exited tool process
+     * @return true if the output is complete and can be used, default: exit code 0
+     */
+    virtual bool isSuccessfulExitCode(int exitCode);
+
+    /**
+     * Files the findings of every analysed file may depend on, e.g. included headers.
+     * Changes to any of them invalidate all cached findings.
+     * @param files set of files in project
+     * @return files the results depend on, default: none
+     */
+    virtual QStringList dependencies(const QStringList &files);
 };
 
 Q_DECLARE_METATYPE(KateProjectCodeAnalysisTool*)
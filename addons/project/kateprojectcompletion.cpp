@@ -24,11 +24,15 @@
 
 #include <klocalizedstring.h>
 
+#include <ThreadWeaver/Queue>
+
 #include <QIcon>
 
 KateProjectCompletion::KateProjectCompletion(KateProjectPlugin *plugin)
     : KTextEditor::CodeCompletionModel(nullptr)
     , m_plugin(plugin)
+    , m_automatic(false)
+    , m_generation(0)
 {
 }
 
@@ -38,8 +42,51 @@ KateProjectCompletion::~KateProjectCompletion()
 
 void KateProjectCompletion::saveMatches(KTextEditor::View *view, const KTextEditor::Range &range)
 {
+    /**
+     * new request => all running ones are stale
+     */
+    const int generation = m_generation.fetchAndAddOrdered(1) + 1;
+    clearMatches();
+
+    /**
+     * get project for this document, else fail
+     */
+    KateProject *project = m_plugin->projectForDocument(view->document());
+    if (!project || !project->sharedProjectIndex()) {
+        return;
+    }
+
+    /**
+     * let the worker query the project index, the shared pointer keeps it alive
+     */
+    KateProjectCompletionWorker *worker = new KateProjectCompletionWorker(project->sharedProjectIndex(), view->document()->text(range), view->document()->url().toLocalFile(), generation, &m_generation);
+    connect(worker, &KateProjectCompletionWorker::matchesReady, this, &KateProjectCompletion::matchesReady);
+    m_plugin->weaver()->stream() << worker;
+}
+
+void KateProjectCompletion::matchesReady(int generation, KateProjectSharedCompletionItems matches)
+{
+    /**
+     * user did type on, drop outdated result
+     */
+    if (generation != m_generation.load()) {
+        return;
+    }
+
+    beginResetModel();
+    m_matches = *matches;
+    endResetModel();
+}
+
+void KateProjectCompletion::clearMatches()
+{
+    if (m_matches.isEmpty()) {
+        return;
+    }
+
+    beginResetModel();
     m_matches.clear();
-    allMatches(m_matches, view, range);
+    endResetModel();
 }
 
 QVariant KateProjectCompletion::data(const QModelIndex &index, int role) const
@@ -59,7 +106,11 @@ QVariant KateProjectCompletion::data(const QModelIndex &index, int role) const
     }
 
     if (index.column() == KTextEditor::CodeCompletionModel::Name && role == Qt::DisplayRole) {
-        return m_matches.item(index.row())->data(Qt::DisplayRole);
+        return m_matches.at(index.row()).name;
+    }
+
+    if (index.column() == KTextEditor::CodeCompletionModel::Postfix && role == Qt::DisplayRole) {
+        return m_matches.at(index.row()).kind;
     }
 
     if (index.column() == KTextEditor::CodeCompletionModel::Icon && role == Qt::DecorationRole) {
@@ -92,7 +143,7 @@ QModelIndex KateProjectCompletion::index(int row, int column, const QModelIndex
         return QModelIndex();
     }
 
-    if (row < 0 || row >= m_matches.rowCount() || column < 0 || column >= ColumnCount) {
+    if (row < 0 || row >= m_matches.size() || column < 0 || column >= ColumnCount) {
         return QModelIndex();
     }
 
@@ -101,12 +152,12 @@ QModelIndex KateProjectCompletion::index(int row, int column, const QModelIndex
 
 int KateProjectCompletion::rowCount(const QModelIndex &parent) const
 {
-    if (!parent.isValid() && !(m_matches.rowCount() == 0)) {
+    if (!parent.isValid() && !m_matches.isEmpty()) {
         return 1;    //One root node to define the custom group
     } else if (parent.parent().isValid()) {
         return 0;    //Completion-items have no children
     } else {
-        return m_matches.rowCount();
+        return m_matches.size();
     }
 }
 
@@ -165,7 +216,8 @@ void KateProjectCompletion::completionInvoked(KTextEditor::View *view, const KTe
         if (range.columnWidth() >= 3 /*v->config()->wordCompletionMinimalWordLength()*/) {
             saveMatches(view, range);
         } else {
-            m_matches.clear();
+            m_generation.fetchAndAddOrdered(1);
+            clearMatches();
         }
 
         // done here...
@@ -176,26 +228,6 @@ void KateProjectCompletion::completionInvoked(KTextEditor::View *view, const KTe
     saveMatches(view, range);
 }
 
-// Scan throughout the entire document for possible completions,
-// ignoring any dublets
-void KateProjectCompletion::allMatches(QStandardItemModel &model, KTextEditor::View *view, const KTextEditor::Range &range) const
-{
-    /**
-     * get project for this document, else fail
-     */
-    KateProject *project = m_plugin->projectForDocument(view->document());
-    if (!project) {
-        return;
-    }
-
-    /**
-     * let project index fill the completion for this document
-     */
-    if (project->projectIndex()) {
-        project->projectIndex()->findMatches(model, view->document()->text(range), KateProjectIndex::CompletionMatches);
-    }
-}
-
 KTextEditor::CodeCompletionModelControllerInterface::MatchReaction KateProjectCompletion::matchingItem(const QModelIndex & /*matched*/)
 {
     return HideListIfAutomaticInvocation;
@@ -26,10 +26,15 @@
 #include <ktexteditor/codecompletionmodel.h>
 #include <ktexteditor/codecompletionmodelcontrollerinterface.h>
 
-#include <QStandardItemModel>
+#include "kateprojectcompletionworker.h"
+
+#include <QAtomicInt>
+#include <QVector>
 
 /**
  * Project wide completion support.
+ * The matches are computed in the background, see KateProjectCompletionWorker,
+ * the model is reset once they arrive.
  */
 class KateProjectCompletion : public KTextEditor::CodeCompletionModel, public KTextEditor::CodeCompletionModelControllerInterface
 {
@@ -64,6 +69,12 @@ public:
     bool shouldStartCompletion(KTextEditor::View *view, const QString &insertedText, bool userInsertion, const KTextEditor::Cursor &position) override;
     bool shouldAbortCompletion(KTextEditor::View *view, const KTextEditor::Range &range, const QString &currentCompletion) override;
 
+    /**
+     * Start computing the matches for the given range in the background.
+     * Cancels the still running request, if any.
+     * @param view view to complete in
+     * @param range range of the word to complete
+     */
     void saveMatches(KTextEditor::View *view,
                      const KTextEditor::Range &range);
 
@@ -76,7 +87,19 @@ public:
 
     KTextEditor::Range completionRange(KTextEditor::View *view, const KTextEditor::Cursor &position) override;
 
-    void allMatches(QStandardItemModel &model, KTextEditor::View *view, const KTextEditor::Range &range) const;
+private Q_SLOTS:
+    /**
+     * Background request done, take over the matches if still current.
+     * @param generation generation of the finished request
+     * @param matches ranked matches
+     */
+    void matchesReady(int generation, KateProjectSharedCompletionItems matches);
+
+private:
+    /**
+     * remove all matches
+     */
+    void clearMatches();
 
 private:
     /**
@@ -85,9 +108,14 @@ private:
     KateProjectPlugin *m_plugin;
 
     /**
-     * model with matching data
+     * current matches, ranked
+     */
+    QVector<KateProjectCompletionItem> m_matches;
+
+    /**
+     * generation of the newest request, older results are dropped
      */
-    QStandardItemModel m_matches;
+    QAtomicInt m_generation;
 
     /**
      * automatic invocation?
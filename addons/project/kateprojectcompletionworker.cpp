@@ -0,0 +1,157 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojectcompletionworker.h"
+
+#include <QPair>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+/**
+ * kinds of symbols one usually wants to complete
+ */
+int kindBonus(const char *kind)
+{
+    static const char *const preferredKinds[] = {"class", "struct", "function", "method", "prototype", "macro", "typedef", "enum", "namespace", "union", "interface"};
+    for (const char *preferredKind : preferredKinds) {
+        if (qstrcmp(kind, preferredKind) == 0) {
+            return 40;
+        }
+    }
+
+    static const char *const memberKinds[] = {"member", "enumerator", "field", "property"};
+    for (const char *memberKind : memberKinds) {
+        if (qstrcmp(kind, memberKind) == 0) {
+            return 20;
+        }
+    }
+
+    return 0;
+}
+
+QByteArray directoryOf(const QByteArray &file)
+{
+    const int slash = file.lastIndexOf('/');
+    return (slash >= 0) ? file.left(slash + 1) : QByteArray();
+}
+}
+
+KateProjectCompletionWorker::KateProjectCompletionWorker(const KateProjectSharedProjectIndex &index, const QString &prefix, const QString &currentFile, int generation, const QAtomicInt *currentGeneration)
+    : QObject()
+    , ThreadWeaver::Job()
+    , m_index(index)
+    , m_prefix(prefix.toLocal8Bit())
+    , m_currentFile(currentFile.toLocal8Bit())
+    , m_currentDirectory(directoryOf(m_currentFile))
+    , m_generation(generation)
+    , m_currentGeneration(currentGeneration)
+{
+}
+
+int KateProjectCompletionWorker::score(const KateProjectSymbolTable &symbols, int symbol) const
+{
+    int score = 0;
+
+    /**
+     * prefix quality: same case is better than folded case
+     */
+    const char *name = symbols.rawName(symbol);
+    if (qstrncmp(name, m_prefix.constData(), m_prefix.size()) == 0) {
+        score += 100;
+    }
+
+    /**
+     * locality: same file, then same directory
+     */
+    const char *file = symbols.rawFile(symbol);
+    if (!m_currentFile.isEmpty() && m_currentFile == file) {
+        score += 200;
+    } else if (!m_currentDirectory.isEmpty() && qstrncmp(file, m_currentDirectory.constData(), m_currentDirectory.size()) == 0 && !strchr(file + m_currentDirectory.size(), '/')) {
+        score += 80;
+    }
+
+    /**
+     * kind and length, short completions first
+     */
+    score += kindBonus(symbols.rawKind(symbol));
+    score -= qMin(int(qstrlen(name)) - m_prefix.size(), 40);
+    return score;
+}
+
+void KateProjectCompletionWorker::run(ThreadWeaver::JobPointer, ThreadWeaver::Thread *)
+{
+    /**
+     * nothing to do for outdated requests
+     */
+    if (isStale() || !m_index || m_prefix.isEmpty()) {
+        return;
+    }
+
+    /**
+     * all candidates, equal names are adjacent
+     */
+    const KateProjectSymbolTable &symbols = m_index->symbols();
+    const QVector<int> candidates = symbols.prefixMatches(QString::fromLocal8Bit(m_prefix), Qt::CaseInsensitive);
+
+    /**
+     * best score per distinct name
+     */
+    QVector<QPair<int, int> > ranked;
+    for (int i = 0; i < candidates.size(); ++i) {
+        /**
+         * check from time to time if the user did type on
+         */
+        if ((i % 4096) == 0 && isStale()) {
+            return;
+        }
+
+        const int symbol = candidates[i];
+        const int symbolScore = score(symbols, symbol);
+        if (!ranked.isEmpty() && qstrcmp(symbols.rawName(ranked.last().second), symbols.rawName(symbol)) == 0) {
+            if (symbolScore > ranked.last().first) {
+                ranked.last() = qMakePair(symbolScore, symbol);
+            }
+            continue;
+        }
+        ranked.append(qMakePair(symbolScore, symbol));
+    }
+
+    /**
+     * cap the result, best first, equal scores by name
+     */
+    const auto better = [&symbols](const QPair<int, int> &a, const QPair<int, int> &b) {
+        return (a.first != b.first) ? (a.first > b.first) : (qstrcmp(symbols.rawName(a.second), symbols.rawName(b.second)) < 0);
+    };
+    const int count = qMin(ranked.size(), int(MaximalMatches));
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), better);
+
+    KateProjectSharedCompletionItems matches(new QVector<KateProjectCompletionItem>());
+    matches->reserve(count);
+    for (int i = 0; i < count; ++i) {
+        matches->append({symbols.name(ranked[i].second), symbols.kind(ranked[i].second)});
+    }
+
+    if (!isStale()) {
+        emit matchesReady(m_generation, matches);
+    }
+}
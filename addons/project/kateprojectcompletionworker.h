@@ -0,0 +1,110 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_COMPLETION_WORKER_H
+#define KATE_PROJECT_COMPLETION_WORKER_H
+
+#include "kateproject.h"
+
+#include <ThreadWeaver/Job>
+
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QVector>
+
+/**
+ * One ranked project completion match.
+ */
+struct KateProjectCompletionItem {
+    QString name;
+    QString kind;
+};
+
+/**
+ * Shared pointer data types.
+ * Used to pass the matches over queued connected slots
+ */
+typedef QSharedPointer<QVector<KateProjectCompletionItem> > KateProjectSharedCompletionItems;
+Q_DECLARE_METATYPE(KateProjectSharedCompletionItems)
+
+/**
+ * Background job computing the project completion matches for one request.
+ * A job becomes stale as soon as a newer request is started, it will then
+ * stop as early as possible and not report anything.
+ */
+class KateProjectCompletionWorker : public QObject, public ThreadWeaver::Job
+{
+    Q_OBJECT
+
+public:
+    /**
+     * maximal number of matches reported
+     */
+    enum { MaximalMatches = 200 };
+
+    /**
+     * construct new completion job
+     * @param index project index to query, kept alive by the job
+     * @param prefix word to complete
+     * @param currentFile file the completion was invoked in, used for ranking
+     * @param generation generation of this request
+     * @param currentGeneration generation of the newest request, must outlive the job
+     */
+    KateProjectCompletionWorker(const KateProjectSharedProjectIndex &index, const QString &prefix, const QString &currentFile, int generation, const QAtomicInt *currentGeneration);
+
+    void run(ThreadWeaver::JobPointer self, ThreadWeaver::Thread *thread) override;
+
+Q_SIGNALS:
+    /**
+     * Emitted with the ranked matches, best first.
+     * Not emitted for stale requests.
+     * @param generation generation of the request
+     * @param matches ranked matches
+     */
+    void matchesReady(int generation, KateProjectSharedCompletionItems matches);
+
+private:
+    /**
+     * was a newer request started?
+     * @return true if our result is no longer needed
+     */
+    bool isStale() const {
+        return m_currentGeneration->load() != m_generation;
+    }
+
+    /**
+     * Rank one symbol, prefers exact case, symbols near the current file
+     * and type or function like kinds over variables.
+     * @param symbols symbol table
+     * @param symbol symbol to rank
+     * @return score, higher is better
+     */
+    int score(const KateProjectSymbolTable &symbols, int symbol) const;
+
+private:
+    KateProjectSharedProjectIndex m_index;
+    const QByteArray m_prefix;
+    const QByteArray m_currentFile;
+    const QByteArray m_currentDirectory;
+    const int m_generation;
+    const QAtomicInt *m_currentGeneration;
+};
+
+#endif
@@ -20,172 +20,273 @@
 
 #include "kateprojectindex.h"
 
-#include <QProcess>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QSaveFile>
+#include <QStandardPaths>
 
+namespace
+{
 /**
- * include ctags reading
+ * header of the persistent index file, bump the version on format changes
  */
-#include "ctags/readtags.c"
+const quint32 IndexMagic = 0x4b504958;
+const quint32 IndexVersion = 2;
+}
 
-KateProjectIndex::KateProjectIndex(const QStringList &files, const QVariantMap &ctagsMap)
-    : m_ctagsIndexFile(QDir::tempPath() + QStringLiteral("/kate.project.ctags"))
-    , m_ctagsIndexHandle(nullptr)
+KateProjectIndex::KateProjectIndex(const QString &baseDir, const QStringList &files, const QVariantMap &ctagsMap, const ProgressFunction &progress)
+    : m_valid(false)
+    , m_refreshFailed(false)
 {
     /**
-     * load ctags
+     * extra ctags options, the persistent index is only usable for the same ones
      */
-    loadCtags(files, ctagsMap);
-}
+    QStringList options;
+    const QString keyOptions = QStringLiteral("options");
+    for (const QVariant &optVariant : ctagsMap[keyOptions].toList()) {
+        options << optVariant.toString();
+    }
 
-KateProjectIndex::~KateProjectIndex()
-{
     /**
-     * delete ctags handle if any
+     * stamp all files, that is cheap compared to running ctags on them
      */
-    if (m_ctagsIndexHandle) {
-        tagsClose(m_ctagsIndexHandle);
-        m_ctagsIndexHandle = nullptr;
+    FileStamps stamps;
+    stamps.reserve(files.size());
+    for (const QString &file : files) {
+        const QFileInfo info(file);
+        stamps.insert(file, qMakePair(info.lastModified().toMSecsSinceEpoch(), info.size()));
     }
-}
 
-void KateProjectIndex::loadCtags(const QStringList &files, const QVariantMap &ctagsMap)
-{
     /**
-     * create temporary file
-     * if not possible, fail
+     * try the persistent index first
+     * nothing changed => we are done, the stored table is already finalized
      */
-    if (!m_ctagsIndexFile.open()) {
+    const QString cacheFile = cacheFileName(baseDir);
+    KateProjectSymbolTable cachedSymbols;
+    FileStamps cachedStamps;
+    if (loadCache(cacheFile, options, cachedSymbols, cachedStamps) && (cachedStamps == stamps)) {
+        m_symbols = cachedSymbols;
+        m_valid = true;
         return;
     }
 
     /**
-     * close file again, other process will use it
+     * reuse the symbols of unchanged files, only re-tag the others
+     * symbols of removed files are dropped on the way
      */
-    m_ctagsIndexFile.close();
+    QStringList changedFiles;
+    QSet<QByteArray> unchangedFiles;
+    for (const QString &file : files) {
+        const auto it = cachedStamps.constFind(file);
+        if (it != cachedStamps.constEnd() && it.value() == stamps.value(file)) {
+            unchangedFiles.insert(file.toLocal8Bit());
+        } else {
+            changedFiles << file;
+        }
+    }
+    m_symbols.addSymbols(cachedSymbols, unchangedFiles);
+    cachedSymbols.clear();
 
     /**
-     * try to run ctags for all files in this project
-     * output to our ctags index file
+     * load ctags for the changed files
      */
-    QProcess ctags;
-    QStringList args;
-    args << QStringLiteral("-L") << QStringLiteral("-") << QStringLiteral("-f") << m_ctagsIndexFile.fileName() << QStringLiteral("--fields=+K+n");
-    const QString keyOptions = QStringLiteral("options");
-    for (const QVariant &optVariant : ctagsMap[keyOptions].toList()) {
-        args << optVariant.toString();
-    }
-    ctags.start(QStringLiteral("ctags"), args);
-    if (!ctags.waitForStarted()) {
+    if (progress && !progress(unchangedFiles.size())) {
         return;
     }
 
+    const bool ctagsDone = changedFiles.isEmpty() || loadCtags(changedFiles, options, unchangedFiles.size(), progress);
+
     /**
-     * write files list and close write channel
+     * the reused symbols stay usable even if the refresh failed
      */
-    ctags.write(files.join(QStringLiteral("\n")).toLocal8Bit());
-    ctags.closeWriteChannel();
+    m_refreshFailed = !ctagsDone;
+    m_valid = ctagsDone || !unchangedFiles.isEmpty();
 
     /**
-     * wait for done
+     * build lookup structures, even for partial results
      */
-    if (!ctags.waitForFinished()) {
-        return;
-    }
+    m_symbols.finalize();
 
     /**
-     * file not openable, bad
+     * remember the result for the next session, only if ctags did work
      */
-    if (!m_ctagsIndexFile.open()) {
-        return;
+    if (ctagsDone) {
+        saveCache(cacheFile, options, stamps);
     }
+}
 
-    /**
-     * get size
-     */
-    qint64 size = m_ctagsIndexFile.size();
+KateProjectIndex::~KateProjectIndex()
+{
+}
+
+QString KateProjectIndex::cacheFileName(const QString &baseDir)
+{
+    if (baseDir.isEmpty()) {
+        return QString();
+    }
+
+    const QString hash = QString::fromLatin1(QCryptographicHash::hash(baseDir.toUtf8(), QCryptographicHash::Sha1).toHex());
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kate/projects/") + hash + QStringLiteral(".index");
+}
+
+bool KateProjectIndex::loadCache(const QString &fileName, const QStringList &options, KateProjectSymbolTable &symbols, FileStamps &stamps)
+{
+    if (fileName.isEmpty()) {
+        return false;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
 
     /**
-     * close again
+     * check header, wrong version or other ctags options => unusable
      */
-    m_ctagsIndexFile.close();
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_4);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QStringList storedOptions;
+    stream >> magic >> version;
+    if (magic != IndexMagic || version != IndexVersion) {
+        return false;
+    }
+
+    stream >> storedOptions;
+    if (storedOptions != options) {
+        return false;
+    }
 
     /**
-     * empty file, bad
+     * stamps + symbols
      */
-    if (!size) {
+    stream >> stamps;
+    if (stream.status() != QDataStream::Ok || !symbols.load(stream)) {
+        stamps.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void KateProjectIndex::saveCache(const QString &fileName, const QStringList &options, const FileStamps &stamps) const
+{
+    if (fileName.isEmpty() || !QDir().mkpath(QFileInfo(fileName).absolutePath())) {
         return;
     }
 
     /**
-     * try to open ctags file
+     * write to temporary file first, readers never see half written indices
      */
-    tagFileInfo info;
-    memset(&info, 0, sizeof(tagFileInfo));
-    m_ctagsIndexHandle = tagsOpen(m_ctagsIndexFile.fileName().toLocal8Bit().constData(), &info);
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_4);
+    stream << IndexMagic << IndexVersion << options << stamps;
+    m_symbols.save(stream);
+    file.commit();
 }
 
-void KateProjectIndex::findMatches(QStandardItemModel &model, const QString &searchWord, MatchType type)
+bool KateProjectIndex::loadCtags(const QStringList &files, const QStringList &options, int filesIndexed, const ProgressFunction &progress)
 {
     /**
-     * abort if no ctags index
+     * try to run ctags for all files in this project
+     * output to stdout, we parse that directly, no temporary file needed
      */
-    if (!m_ctagsIndexHandle) {
-        return;
+    QProcess ctags;
+    QStringList args;
+    args << QStringLiteral("-L") << QStringLiteral("-") << QStringLiteral("-f") << QStringLiteral("-") << QStringLiteral("--fields=+K+n") << options;
+    ctags.start(QStringLiteral("ctags"), args);
+    if (!ctags.waitForStarted()) {
+        return false;
     }
 
     /**
-     * word to complete
-     * abort if empty
+     * write files list and close write channel
      */
-    QByteArray word = searchWord.toLocal8Bit();
-    if (word.isEmpty()) {
-        return;
+    ctags.write(files.join(QStringLiteral("\n")).toLocal8Bit());
+    ctags.closeWriteChannel();
+
+    /**
+     * stream the output into the symbol table while ctags is running
+     * ctags handles one file after the other, count the file changes for the progress
+     */
+    const int firstSymbol = m_symbols.size();
+    while (ctags.waitForReadyRead(-1)) {
+        const int oldSize = m_symbols.size();
+        m_symbols.addCtagsOutput(&ctags);
+        if (!progress) {
+            continue;
+        }
+
+        for (int i = oldSize; i < m_symbols.size(); ++i) {
+            if (i == firstSymbol || m_symbols.rawFile(i) != m_symbols.rawFile(i - 1)) {
+                ++filesIndexed;
+            }
+        }
+
+        if (!progress(filesIndexed)) {
+            ctags.kill();
+            ctags.waitForFinished(-1);
+            return false;
+        }
     }
 
     /**
-     * try to search entry
-     * fail if none found
+     * wait for done, bail out on crash or failure
      */
-    tagEntry entry;
-    if (tagsFind(m_ctagsIndexHandle, &entry, word.constData(), TAG_PARTIALMATCH  | TAG_OBSERVECASE) != TagSuccess) {
-        return;
+    if (ctags.state() != QProcess::NotRunning && !ctags.waitForFinished(-1)) {
+        return false;
     }
 
     /**
-     * set to show words only once for completion matches
+     * ctags rejecting its options or files fails, its output is not complete
      */
-    QSet<QString> guard;
+    if (ctags.exitStatus() != QProcess::NormalExit || ctags.exitCode() != 0) {
+        return false;
+    }
 
     /**
-     * loop over all found tags
-     * first one is filled by above find, others by find next
+     * read what might be left
      */
-    do {
-        /**
-         * skip if no name
-         */
-        if (!entry.name) {
-            continue;
-        }
+    m_symbols.addCtagsOutput(&ctags);
+    return true;
+}
+
+void KateProjectIndex::findMatches(QStandardItemModel &model, const QString &searchWord, MatchType type)
+{
+    /**
+     * abort if no ctags index or empty word
+     */
+    if (!m_valid || searchWord.isEmpty()) {
+        return;
+    }
 
-        /**
-         * get name
-         */
-        QString name(QString::fromLocal8Bit(entry.name));
+    /**
+     * binary search in the sorted symbols
+     * for completion show words only once, same names are adjacent
+     */
+    const QVector<int> matches = m_symbols.prefixMatches(searchWord, Qt::CaseSensitive, type == CompletionMatches);
 
-        /**
-         * construct right items
-         */
+    /**
+     * construct right items
+     */
+    for (const int symbol : matches) {
         switch (type) {
         case CompletionMatches:
             /**
-             * add new completion item, if new name
+             * add new completion item
              */
-            if (!guard.contains(name)) {
-                model.appendRow(new QStandardItem(name));
-                guard.insert(name);
-            }
+            model.appendRow(new QStandardItem(m_symbols.name(symbol)));
             break;
 
         case FindMatches:
@@ -193,13 +294,12 @@ void KateProjectIndex::findMatches(QStandardItemModel &model, const QString &sea
              * add new find item, contains of multiple columns
              */
             QList<QStandardItem *> items;
-            items << new QStandardItem(name);
-            items << new QStandardItem(entry.kind ? QString::fromLocal8Bit(entry.kind) : QString());
-            items << new QStandardItem(entry.file ? QString::fromLocal8Bit(entry.file) : QString());
-            items << new QStandardItem(QString::number(entry.address.lineNumber));
+            items << new QStandardItem(m_symbols.name(symbol));
+            items << new QStandardItem(m_symbols.kind(symbol));
+            items << new QStandardItem(m_symbols.file(symbol));
+            items << new QStandardItem(QString::number(m_symbols.line(symbol)));
             model.appendRow(items);
             break;
         }
-    } while (tagsFindNext(m_ctagsIndexHandle, &entry) == TagSuccess);
+    }
 }
-
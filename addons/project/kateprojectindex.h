@@ -24,14 +24,14 @@
 #include <ktexteditor/document.h>
 #include <ktexteditor/view.h>
 
+#include <QHash>
+#include <QPair>
 #include <QStringList>
-#include <QTemporaryFile>
 #include <QStandardItemModel>
 
-/**
- * ctags reading
- */
-#include "ctags/readtags.h"
+#include <functional>
+
+#include "kateprojectsymboltable.h"
 
 /**
  * Class representing the index of a project.
@@ -39,16 +39,29 @@
  * Allows you to search for stuff and to get some useful auto-completion.
  * Is created in Worker thread in the background, then passed to project in
  * the main thread for usage.
+ *
+ * The index is persisted per project in the user's cache directory, together
+ * with the modification time and size of each indexed file. On the next load
+ * only files with changed stamps are passed to ctags again.
  */
 class KateProjectIndex
 {
 public:
+    /**
+     * Progress callback, called in the building thread with the number of
+     * files indexed so far. Returning false cancels the indexing, the index
+     * is then invalid.
+     */
+    typedef std::function<bool (int filesIndexed)> ProgressFunction;
+
     /**
      * construct new index for given files
+     * @param baseDir base directory of the project, used to locate the persistent index
      * @param files files to index
      * @param ctagsMap ctags section for extra options
+     * @param progress optional progress callback
      */
-    KateProjectIndex(const QStringList &files, const QVariantMap &ctagsMap);
+    KateProjectIndex(const QString &baseDir, const QStringList &files, const QVariantMap &ctagsMap, const ProgressFunction &progress = ProgressFunction());
 
     /**
      * deconstruct project
@@ -83,30 +96,88 @@ public:
     /**
      * Check if running ctags was successful. This can be used
      * as indicator whether ctags is installed or not.
+     * Stays true if symbols of a previous index could be reused,
+     * even if the refresh of the changed files failed.
      * @return true if a valid index exists, otherwise false
      */
     bool isValid() const {
-        return m_ctagsIndexHandle;
+        return m_valid;
+    }
+
+    /**
+     * Check if running ctags on the changed files failed.
+     * The index may still be valid with the reused symbols, but outdated.
+     * @return true if the refresh failed
+     */
+    bool refreshFailed() const {
+        return m_refreshFailed;
+    }
+
+    /**
+     * Access to the in-memory symbol table for direct queries,
+     * e.g. fuzzy lookups.
+     * @return symbol table, read-only
+     */
+    const KateProjectSymbolTable &symbols() const {
+        return m_symbols;
     }
 
+    /**
+     * Compute the file name of the persistent index for a project.
+     * @param baseDir base directory of the project
+     * @return full path inside the user's cache directory
+     */
+    static QString cacheFileName(const QString &baseDir);
+
 private:
+    /**
+     * file => (modification time in ms since epoch, size)
+     */
+    typedef QHash<QString, QPair<qint64, qint64> > FileStamps;
+
     /**
      * Load ctags tags.
      * @param files files to index
-     * @param ctagsMap ctags section for extra options
+     * @param options extra ctags options
+     * @param filesIndexed number of files already indexed, for progress
+     * @param progress optional progress callback
+     * @return success, false if ctags is missing, crashed or was canceled
      */
-    void loadCtags(const QStringList &files, const QVariantMap &ctagsMap);
+    bool loadCtags(const QStringList &files, const QStringList &options, int filesIndexed, const ProgressFunction &progress);
+
+    /**
+     * Read the persistent index.
+     * @param fileName index file to read
+     * @param options ctags options the index must have been created with
+     * @param symbols table to fill
+     * @param stamps stamps of the indexed files to fill
+     * @return success, false if missing, outdated or corrupt
+     */
+    static bool loadCache(const QString &fileName, const QStringList &options, KateProjectSymbolTable &symbols, FileStamps &stamps);
+
+    /**
+     * Write the persistent index, atomically replacing the old one.
+     * @param fileName index file to write
+     * @param options ctags options used to create the index
+     * @param stamps stamps of the indexed files
+     */
+    void saveCache(const QString &fileName, const QStringList &options, const FileStamps &stamps) const;
 
 private:
     /**
-     * ctags index file
+     * all symbols ctags did find
+     */
+    KateProjectSymbolTable m_symbols;
+
+    /**
+     * did ctags run successfully?
      */
-    QTemporaryFile m_ctagsIndexFile;
+    bool m_valid;
 
     /**
-     * handle to ctags file for querying, if possible
+     * did ctags fail for the changed files?
      */
-    tagFile *m_ctagsIndexHandle;
+    bool m_refreshFailed;
 };
 
 #endif
@@ -20,15 +20,38 @@
 
 #include "kateprojectinfoviewcodeanalysis.h"
 #include "kateprojectpluginview.h"
+#include "kateprojectplugin.h"
 #include "kateprojectcodeanalysistool.h"
 #include "tools/kateprojectcodeanalysisselector.h"
 
+#include <ThreadWeaver/Queue>
+
 #include <QVBoxLayout>
 #include <QHBoxLayout>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFileInfo>
+#include <QThread>
 
 #include <klocalizedstring.h>
-#include <kmessagewidget.h>
+
+namespace
+{
+/**
+ * don't start a process for less files than this
+ */
+const int MinimalShardSize = 16;
+
+/**
+ * delay before new findings are shown, collects output of all processes
+ */
+const int FlushInterval = 100;
+
+/**
+ * lines of unparsable tool output kept per process, shown if the tool fails
+ */
+const int MaximalOutputLines = 20;
+}
 
 KateProjectInfoViewCodeAnalysis::KateProjectInfoViewCodeAnalysis(KateProjectPluginView *pluginView, KateProject *project)
     : QWidget()
@@ -38,9 +61,11 @@ KateProjectInfoViewCodeAnalysis::KateProjectInfoViewCodeAnalysis(KateProjectPlug
     , m_startStopAnalysis(new QPushButton(i18n("Start Analysis...")))
     , m_treeView(new QTreeView())
     , m_model(new QStandardItemModel(m_treeView))
-    , m_analyzer(nullptr)
     , m_analysisTool(nullptr)
     , m_toolSelector(new QComboBox())
+    , m_generation(0)
+    , m_running(false)
+    , m_failed(false)
 {
     /**
      * default style
@@ -81,97 +106,266 @@ KateProjectInfoViewCodeAnalysis::KateProjectInfoViewCodeAnalysis(KateProjectPlug
     hlayout->addWidget(m_startStopAnalysis);
     setLayout(layout);
 
+    /**
+     * findings are added in batches
+     */
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushInterval);
+
     /**
      * connect needed signals
      */
     connect(m_startStopAnalysis, &QPushButton::clicked, this, &KateProjectInfoViewCodeAnalysis::slotStartStopClicked);
     connect(m_treeView, &QTreeView::clicked, this, &KateProjectInfoViewCodeAnalysis::slotClicked);
+    connect(&m_flushTimer, &QTimer::timeout, this, &KateProjectInfoViewCodeAnalysis::slotFlushFindings);
 }
 
 KateProjectInfoViewCodeAnalysis::~KateProjectInfoViewCodeAnalysis()
 {
+    /**
+     * no signals from dying processes
+     */
+    for (auto it = m_shards.constBegin(); it != m_shards.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
 }
 
 void KateProjectInfoViewCodeAnalysis::slotStartStopClicked()
 {
+    /**
+     * running => stop it
+     */
+    if (isRunning()) {
+        stopAnalysis();
+        return;
+    }
+
     /**
      * get files for the external tool
      */
     m_analysisTool = m_toolSelector->currentData(Qt::UserRole + 1).value<KateProjectCodeAnalysisTool*>();
     m_analysisTool->setProject(m_project);
+    m_files = m_analysisTool->filter(m_project->files());
+    m_dependencies = m_analysisTool->dependencies(m_project->files());
+    m_toolKey = m_analysisTool->path() + QLatin1Char(' ') + m_analysisTool->arguments(QStringList()).join(QLatin1Char(' '));
 
     /**
      * clear existing entries
      */
     m_model->removeRows(0, m_model->rowCount(), QModelIndex());
+    m_shownFindings.clear();
+    m_failureOutput.clear();
+
+    if (m_messageWidget) {
+        delete m_messageWidget;
+        m_messageWidget = nullptr;
+    }
 
     /**
-     * launch cppcheck
+     * hash the files in the background, decides what needs to be analysed again
      */
-    m_analyzer = new QProcess(this);
-    m_analyzer->setProcessChannelMode(QProcess::MergedChannels);
+    m_running = true;
+    m_failed = false;
+    m_startStopAnalysis->setText(i18n("Stop Analysis"));
 
-    connect(m_analyzer, &QProcess::readyRead, this, &KateProjectInfoViewCodeAnalysis::slotReadyRead);
-    connect(m_analyzer, static_cast<void(QProcess::*)(int,QProcess::ExitStatus)>(&QProcess::finished),
-            this, &KateProjectInfoViewCodeAnalysis::finished);
+    KateProjectCodeAnalysisHashWorker *worker = new KateProjectCodeAnalysisHashWorker(m_files + m_dependencies, ++m_generation);
+    connect(worker, &KateProjectCodeAnalysisHashWorker::hashesReady, this, &KateProjectInfoViewCodeAnalysis::slotHashesReady);
+    m_pluginView->plugin()->weaver()->stream() << worker;
+}
+
+void KateProjectInfoViewCodeAnalysis::slotHashesReady(int generation, KateProjectSharedFileHashes hashes)
+{
+    /**
+     * stopped or restarted in the meantime
+     */
+    if (generation != m_generation || !isRunning()) {
+        return;
+    }
 
-    m_analyzer->start(m_analysisTool->path(), m_analysisTool->arguments());
+    /**
+     * findings depend on the file and all dependencies, combine their hashes
+     */
+    QStringList dependencies = m_dependencies;
+    dependencies.sort();
+    QCryptographicHash dependencyHash(QCryptographicHash::Sha1);
+    for (const QString &dependency : dependencies) {
+        dependencyHash.addData(dependency.toUtf8());
+        dependencyHash.addData(hashes->value(dependency));
+    }
+    const QByteArray dependencyResult = dependencies.isEmpty() ? QByteArray() : dependencyHash.result();
 
-    if (m_messageWidget) {
-        delete m_messageWidget;
-        m_messageWidget = nullptr;
+    m_fileHashes.clear();
+    for (auto it = hashes->constBegin(); it != hashes->constEnd(); ++it) {
+        m_fileHashes.insert(it.key(), KateProjectCodeAnalysisCache::combineHash(it.value(), dependencyResult));
+    }
+    m_cache.retain(m_toolKey, (m_files + m_dependencies).toSet());
+
+    /**
+     * findings in dependencies, e.g. headers, are reported while analysing other files
+     */
+    for (const QString &dependency : m_dependencies) {
+        const QByteArray hash = m_fileHashes.value(dependency);
+        KateProjectCodeAnalysisFindings findings;
+        if (!hash.isEmpty() && m_cache.lookup(m_toolKey, dependency, hash, &findings)) {
+            m_pendingFindings += findings;
+        }
+    }
+
+    /**
+     * unchanged files => cached findings, others must be analysed
+     */
+    QStringList changedFiles;
+    for (const QString &file : m_files) {
+        const QByteArray hash = m_fileHashes.value(file);
+        KateProjectCodeAnalysisFindings findings;
+        if (!hash.isEmpty() && m_cache.lookup(m_toolKey, file, hash, &findings)) {
+            m_pendingFindings += findings;
+        } else {
+            changedFiles.append(file);
+        }
     }
 
-    if (!m_analyzer->waitForStarted()) {
-        m_messageWidget = new KMessageWidget();
-        m_messageWidget->setCloseButtonVisible(true);
-        m_messageWidget->setMessageType(KMessageWidget::Warning);
-        m_messageWidget->setWordWrap(false);
-        m_messageWidget->setText(m_analysisTool->notInstalledMessage());
-        static_cast<QVBoxLayout *>(layout())->insertWidget(0, m_messageWidget);
-        m_messageWidget->animatedShow();
+    if (changedFiles.isEmpty()) {
+        finishAnalysis();
         return;
     }
+
+    /**
+     * one process per core, but not for just a few files
+     */
+    const int shardCount = qBound(1, (changedFiles.size() + MinimalShardSize - 1) / MinimalShardSize, QThread::idealThreadCount());
+    const int shardSize = (changedFiles.size() + shardCount - 1) / shardCount;
+    for (int i = 0; i < changedFiles.size(); i += shardSize) {
+        if (!startShard(changedFiles.mid(i, shardSize))) {
+            stopAnalysis();
+            showMessage(KMessageWidget::Warning, m_analysisTool->notInstalledMessage());
+            return;
+        }
+    }
+
+    /**
+     * show cached findings while the rest is running
+     */
+    slotFlushFindings();
+}
+
+bool KateProjectInfoViewCodeAnalysis::startShard(const QStringList &files)
+{
+    QProcess *process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+
+    connect(process, &QProcess::readyRead, this, &KateProjectInfoViewCodeAnalysis::slotReadyRead);
+    connect(process, static_cast<void(QProcess::*)(int,QProcess::ExitStatus)>(&QProcess::finished),
+            this, &KateProjectInfoViewCodeAnalysis::finished);
+
+    process->start(m_analysisTool->path(), m_analysisTool->arguments(files));
+    if (!process->waitForStarted()) {
+        delete process;
+        return false;
+    }
+
     /**
      * write files list and close write channel
      */
-    const QString stdinMessage = m_analysisTool->stdinMessages();
+    const QString stdinMessage = m_analysisTool->stdinMessages(files);
     if (!stdinMessage.isEmpty()) {
-        m_analyzer->write(stdinMessage.toLocal8Bit());
+        process->write(stdinMessage.toLocal8Bit());
     }
-    m_analyzer->closeWriteChannel();
+    process->closeWriteChannel();
+
+    Shard &shard = m_shards[process];
+    shard.files = files;
+    shard.fileSet = files.toSet();
+    return true;
 }
 
 void KateProjectInfoViewCodeAnalysis::slotReadyRead()
+{
+    QProcess *process = qobject_cast<QProcess *>(sender());
+    const auto shard = m_shards.find(process);
+    if (shard == m_shards.end()) {
+        return;
+    }
+
+    readOutput(process, shard.value());
+}
+
+void KateProjectInfoViewCodeAnalysis::readOutput(QProcess *process, Shard &shard)
 {
     /**
      * get results of analysis
      */
-    while (m_analyzer->canReadLine()) {
+    while (process->canReadLine()) {
         /**
          * get one line, split it, skip it, if too few elements
          */
-        QString line = QString::fromLocal8Bit(m_analyzer->readLine());
+        QString line = QString::fromLocal8Bit(process->readLine());
         QStringList elements = m_analysisTool->parseLine(line);
         if (elements.size() < 4) {
+            /**
+             * keep some of the rest, e.g. error messages, in case the tool fails
+             */
+            line = line.trimmed();
+            if (!line.isEmpty() && shard.output.size() < MaximalOutputLines) {
+                shard.output.append(line);
+            }
             continue;
         }
 
+        const QStringList finding = QStringList() << elements[0] << elements[1] << elements[2] << elements[3].simplified();
+
+        /**
+         * remember finding for the file it is about, that might be an included header
+         * findings in files we have no hash for can't be cached
+         */
+        const QString file = QDir::cleanPath(elements[0]);
+        if (!m_fileHashes.contains(file)) {
+            shard.cacheable = false;
+        }
+        shard.findings[file].append(finding);
+        m_pendingFindings.append(finding);
+    }
+
+    /**
+     * show in the next batch
+     */
+    if (!m_pendingFindings.isEmpty() && !m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void KateProjectInfoViewCodeAnalysis::slotFlushFindings()
+{
+    m_flushTimer.stop();
+    if (m_pendingFindings.isEmpty()) {
+        return;
+    }
+
+    /**
+     * feed into model
+     */
+    for (const QStringList &finding : m_pendingFindings) {
         /**
-         * feed into model
+         * header findings may be reported by several processes or be cached already
          */
+        const QString key = finding.join(QLatin1Char('\n'));
+        if (m_shownFindings.contains(key)) {
+            continue;
+        }
+        m_shownFindings.insert(key);
+
         QList<QStandardItem *> items;
-        QStandardItem *fileNameItem = new QStandardItem(QFileInfo(elements[0]).fileName());
-        fileNameItem->setToolTip(elements[0]);
+        QStandardItem *fileNameItem = new QStandardItem(QFileInfo(finding[0]).fileName());
+        fileNameItem->setToolTip(finding[0]);
         items << fileNameItem;
-        items << new QStandardItem(elements[1]);
-        items << new QStandardItem(elements[2]);
-        const auto message = elements[3].simplified();
-        auto messageItem = new QStandardItem(message);
-        messageItem->setToolTip(message);
+        items << new QStandardItem(finding[1]);
+        items << new QStandardItem(finding[2]);
+        auto messageItem = new QStandardItem(finding[3]);
+        messageItem->setToolTip(finding[3]);
         items << messageItem;
         m_model->appendRow(items);
     }
+    m_pendingFindings.clear();
 
     /**
      * tree view polish ;)
@@ -208,21 +402,86 @@ void KateProjectInfoViewCodeAnalysis::slotClicked(const QModelIndex &index)
     }
 }
 
-void KateProjectInfoViewCodeAnalysis::finished(int exitCode, QProcess::ExitStatus)
+void KateProjectInfoViewCodeAnalysis::finished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QProcess *process = qobject_cast<QProcess *>(sender());
+    const auto it = m_shards.find(process);
+    if (it == m_shards.end()) {
+        return;
+    }
+
+    Shard shard = it.value();
+    m_shards.erase(it);
+    process->deleteLater();
+
+    /**
+     * get remaining output, the tool decides which exit codes are fine
+     */
+    readOutput(process, shard);
+    if (exitStatus != QProcess::NormalExit || !m_analysisTool->isSuccessfulExitCode(exitCode)) {
+        m_failed = true;
+        m_failureOutput += shard.output;
+    } else if (shard.cacheable) {
+        /**
+         * cache the findings of the analysed files and of the other files they reported
+         */
+        for (const QString &file : shard.files) {
+            const QByteArray hash = m_fileHashes.value(file);
+            if (!hash.isEmpty()) {
+                m_cache.insert(m_toolKey, file, hash, shard.findings.value(file));
+            }
+        }
+
+        for (auto it = shard.findings.constBegin(); it != shard.findings.constEnd(); ++it) {
+            const QByteArray hash = m_fileHashes.value(it.key());
+            if (!shard.fileSet.contains(it.key()) && !hash.isEmpty()) {
+                m_cache.merge(m_toolKey, it.key(), hash, it.value());
+            }
+        }
+    }
+
+    if (m_shards.isEmpty()) {
+        finishAnalysis();
+    }
+}
+
+void KateProjectInfoViewCodeAnalysis::stopAnalysis()
 {
-  m_messageWidget = new KMessageWidget();
-  m_messageWidget->setCloseButtonVisible(true);
-  m_messageWidget->setWordWrap(false);
-
-  if (exitCode == 0) {
-    m_messageWidget->setMessageType(KMessageWidget::Information);
-    m_messageWidget->setText(i18n("Analysis finished."));
-  } else {
-    // unfortunately, output was eaten by slotReadyRead()
-    // TODO: get stderr output, show it here
-    m_messageWidget->setMessageType(KMessageWidget::Warning);
-    m_messageWidget->setText(i18n("Analysis failed!"));
-  }
-  static_cast<QVBoxLayout*>(layout ())->insertWidget(0, m_messageWidget);
-  m_messageWidget->animatedShow ();
+    for (auto it = m_shards.constBegin(); it != m_shards.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+        it.key()->kill();
+        it.key()->deleteLater();
+    }
+    m_shards.clear();
+
+    slotFlushFindings();
+    m_fileHashes.clear();
+    m_running = false;
+    m_startStopAnalysis->setText(i18n("Start Analysis..."));
+}
+
+void KateProjectInfoViewCodeAnalysis::finishAnalysis()
+{
+    stopAnalysis();
+
+    if (m_failed && !m_failureOutput.isEmpty()) {
+        showMessage(KMessageWidget::Warning, i18n("Analysis failed!\n%1", m_failureOutput.join(QLatin1Char('\n'))));
+    } else if (m_failed) {
+        showMessage(KMessageWidget::Warning, i18n("Analysis failed!"));
+    } else {
+        showMessage(KMessageWidget::Information, i18n("Analysis finished."));
+    }
+}
+
+void KateProjectInfoViewCodeAnalysis::showMessage(KMessageWidget::MessageType type, const QString &text)
+{
+    delete m_messageWidget;
+
+    m_messageWidget = new KMessageWidget();
+    m_messageWidget->setCloseButtonVisible(true);
+    m_messageWidget->setMessageType(type);
+    m_messageWidget->setWordWrap(false);
+    m_messageWidget->setText(text);
+    static_cast<QVBoxLayout *>(layout())->insertWidget(0, m_messageWidget);
+    m_messageWidget->animatedShow();
 }
@@ -22,19 +22,26 @@
 #define KATE_PROJECT_INFO_VIEW_CODE_ANALYSIS_H
 
 #include "kateproject.h"
+#include "kateprojectcodeanalysiscache.h"
+#include "kateprojectcodeanalysishashworker.h"
 
 #include <QPushButton>
 #include <QProcess>
 #include <QTreeView>
 #include <QComboBox>
+#include <QTimer>
+
+#include <kmessagewidget.h>
 
 class KateProjectPluginView;
 class KateProjectCodeAnalysisTool;
-class KMessageWidget;
 
 /**
  * View for Code Analysis.
  * cppcheck and perhaps later more...
+ *
+ * The files are split into shards, analysed by parallel tool processes.
+ * Findings are cached per file content, only changed files are analysed again.
  */
 class KateProjectInfoViewCodeAnalysis : public QWidget
 {
@@ -67,11 +74,23 @@ private Q_SLOTS:
      */
     void slotStartStopClicked();
 
+    /**
+     * Content hashes of the files to analyse are there, start the tool processes.
+     * @param generation generation of the analysis run
+     * @param hashes file => content hash
+     */
+    void slotHashesReady(int generation, KateProjectSharedFileHashes hashes);
+
     /**
      * More checker output is available
      */
     void slotReadyRead();
 
+    /**
+     * Append the findings collected so far to the model.
+     */
+    void slotFlushFindings();
+
     /**
      * item got clicked, do stuff, like open document
      * @param index model index of clicked item
@@ -85,6 +104,62 @@ private Q_SLOTS:
      */
     void finished(int exitCode, QProcess::ExitStatus exitStatus);
 
+private:
+    /**
+     * one tool process and the files it analyses
+     * findings are stored per reported file, the process may report included files, too
+     */
+    struct Shard {
+        Shard()
+            : cacheable(true)
+        {
+        }
+
+        QStringList files;
+        QSet<QString> fileSet;
+        QHash<QString, KateProjectCodeAnalysisFindings> findings;
+        QStringList output;
+        bool cacheable;
+    };
+
+    /**
+     * start one tool process for the given files
+     * @param files files to analyse
+     * @return success, false if the tool could not be started
+     */
+    bool startShard(const QStringList &files);
+
+    /**
+     * read all complete lines of tool output
+     * @param process tool process
+     * @param shard shard of this process
+     */
+    void readOutput(QProcess *process, Shard &shard);
+
+    /**
+     * stop running analysis, if any
+     */
+    void stopAnalysis();
+
+    /**
+     * all shards are done, show the result
+     */
+    void finishAnalysis();
+
+    /**
+     * show message above the results, replaces the current one
+     * @param type message type
+     * @param text message text
+     */
+    void showMessage(KMessageWidget::MessageType type, const QString &text);
+
+    /**
+     * analysis running?
+     */
+    bool isRunning() const {
+        return m_running;
+    }
+
 private:
     /**
      * our plugin view
@@ -117,14 +192,55 @@ private:
     QStandardItemModel *m_model;
 
     /**
-     * running analyzer process
+     * running analyzer processes
      */
-    QProcess *m_analyzer;
+    QHash<QProcess *, Shard> m_shards;
 
     KateProjectCodeAnalysisTool *m_analysisTool;
 
     QComboBox *m_toolSelector;
 
+    /**
+     * tool path and arguments of the running analysis, key for the cache
+     */
+    QString m_toolKey;
+
+    /**
+     * files of the running analysis, files their findings depend on
+     * and the content hashes of both, combined with the dependency hash
+     */
+    QStringList m_files;
+    QStringList m_dependencies;
+    QHash<QString, QByteArray> m_fileHashes;
+
+    /**
+     * cached findings of earlier runs
+     */
+    KateProjectCodeAnalysisCache m_cache;
+
+    /**
+     * findings not yet in the model and timer to add them in batches
+     */
+    KateProjectCodeAnalysisFindings m_pendingFindings;
+    QTimer m_flushTimer;
+
+    /**
+     * findings already in the model, to skip duplicates
+     */
+    QSet<QString> m_shownFindings;
+
+    /**
+     * unparsable output of failed processes
+     */
+    QStringList m_failureOutput;
+
+    /**
+     * generation of the current run, to ignore outdated hash results
+     */
+    int m_generation;
+
+    bool m_running;
+    bool m_failed;
 };
 
 #endif
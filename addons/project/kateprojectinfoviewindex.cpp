@@ -141,21 +141,32 @@ void KateProjectInfoViewIndex::indexAvailable()
     m_treeView->setEnabled(valid);
 
     /**
-     * if index exists, hide possible message widget, else create it
+     * if index exists and is up to date, hide possible message widget, else create it
+     * a failed refresh keeps the old symbols usable, just tell the user they are outdated
      */
-    if (valid) {
+    const bool refreshFailed = m_project->projectIndex()->refreshFailed();
+    if (valid && !refreshFailed) {
         if (m_messageWidget && m_messageWidget->isVisible()) {
             m_messageWidget->animatedHide();
         }
-    } else if (!m_messageWidget) {
+        return;
+    }
+
+    if (!m_messageWidget) {
         m_messageWidget = new KMessageWidget();
         m_messageWidget->setCloseButtonVisible(true);
-        m_messageWidget->setMessageType(KMessageWidget::Warning);
         m_messageWidget->setWordWrap(false);
-        m_messageWidget->setText(i18n("The index could not be created. Please install 'ctags'."));
         static_cast<QVBoxLayout *>(layout())->insertWidget(0, m_messageWidget);
     } else {
         m_messageWidget->animatedShow();
     }
+
+    if (valid) {
+        m_messageWidget->setMessageType(KMessageWidget::Information);
+        m_messageWidget->setText(i18n("The index could not be updated, results for changed files may be outdated."));
+    } else {
+        m_messageWidget->setMessageType(KMessageWidget::Warning);
+        m_messageWidget->setText(i18n("The index could not be created. Please install 'ctags'."));
+    }
 }
 
@@ -0,0 +1,95 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojectlookupworker.h"
+
+#include <QFileInfo>
+
+namespace
+{
+const QString ProjectFileName = QStringLiteral(".kateproject");
+const QString GitFolderName = QStringLiteral(".git");
+const QString SubversionFolderName = QStringLiteral(".svn");
+const QString MercurialFolderName = QStringLiteral(".hg");
+}
+
+KateProjectLookupWorker::KateProjectLookupWorker(const QStringList &directories, int markers)
+    : QObject()
+    , ThreadWeaver::Job()
+    , m_directories(directories)
+    , m_markers(markers)
+{
+}
+
+KateProjectDirectoryInfo KateProjectLookupWorker::probe(const QDir &dir, int markers)
+{
+    KateProjectDirectoryInfo info;
+    info.canonicalPath = dir.canonicalPath();
+    info.markers = 0;
+
+    if ((markers & KateProjectDirectoryInfo::ProjectFile) && dir.exists(ProjectFileName)) {
+        info.markers |= KateProjectDirectoryInfo::ProjectFile;
+    }
+
+    // allow .git as dir and file (file for git worktree stuff, https://git-scm.com/docs/git-worktree)
+    if ((markers & KateProjectDirectoryInfo::Git) && dir.exists(GitFolderName)) {
+        info.markers |= KateProjectDirectoryInfo::Git;
+    }
+
+    if ((markers & KateProjectDirectoryInfo::Subversion) && QFileInfo(dir, SubversionFolderName).isDir()) {
+        info.markers |= KateProjectDirectoryInfo::Subversion;
+    }
+
+    if ((markers & KateProjectDirectoryInfo::Mercurial) && QFileInfo(dir, MercurialFolderName).isDir()) {
+        info.markers |= KateProjectDirectoryInfo::Mercurial;
+    }
+
+    return info;
+}
+
+void KateProjectLookupWorker::run(ThreadWeaver::JobPointer, ThreadWeaver::Thread *)
+{
+    KateProjectSharedDirectoryInfos infos(new KateProjectDirectoryInfos());
+
+    for (const QString &directory : m_directories) {
+        /**
+         * walk upwards, stop at directories already known from other walks,
+         * this is the recursion guard, too
+         */
+        QDir dir(directory);
+        while (!infos->contains(dir.absolutePath())) {
+            const KateProjectDirectoryInfo info = probe(dir, m_markers);
+            infos->insert(dir.absolutePath(), info);
+
+            /**
+             * found something, the plugin will decide
+             */
+            if (info.markers) {
+                break;
+            }
+
+            if (!dir.cdUp()) {
+                break;
+            }
+        }
+    }
+
+    emit lookupDone(infos);
+}
@@ -0,0 +1,102 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_LOOKUP_WORKER_H
+#define KATE_PROJECT_LOOKUP_WORKER_H
+
+#include <ThreadWeaver/Job>
+
+#include <QDir>
+#include <QHash>
+#include <QSharedPointer>
+#include <QStringList>
+
+/**
+ * What we know about one directory while searching projects upwards.
+ */
+struct KateProjectDirectoryInfo {
+    /**
+     * project relevant entries found in the directory
+     */
+    enum Marker {
+        ProjectFile = 1
+        , Git = 2
+        , Subversion = 4
+        , Mercurial = 8
+    };
+
+    QString canonicalPath;
+    int markers;
+};
+
+/**
+ * absolute directory path => directory info
+ */
+typedef QHash<QString, KateProjectDirectoryInfo> KateProjectDirectoryInfos;
+
+/**
+ * Shared pointer data types.
+ * Used to pass the directory infos over queued connected slots
+ */
+typedef QSharedPointer<KateProjectDirectoryInfos> KateProjectSharedDirectoryInfos;
+Q_DECLARE_METATYPE(KateProjectSharedDirectoryInfos)
+
+/**
+ * Background job doing the file system work of the project lookup for
+ * a batch of directories, e.g. for all documents of a restored session.
+ * Each directory and its parents are probed at most once, the walk upwards
+ * stops at the first directory containing one of the requested markers.
+ * Opening the projects is left to the plugin in the main thread.
+ */
+class KateProjectLookupWorker : public QObject, public ThreadWeaver::Job
+{
+    Q_OBJECT
+
+public:
+    /**
+     * construct new lookup job
+     * @param directories absolute paths of the directories to resolve
+     * @param markers markers to look for, see KateProjectDirectoryInfo::Marker
+     */
+    KateProjectLookupWorker(const QStringList &directories, int markers);
+
+    void run(ThreadWeaver::JobPointer self, ThreadWeaver::Thread *thread) override;
+
+    /**
+     * Probe one directory for the given markers.
+     * @param dir directory to probe
+     * @param markers markers to look for
+     * @return info for this directory
+     */
+    static KateProjectDirectoryInfo probe(const QDir &dir, int markers);
+
+Q_SIGNALS:
+    /**
+     * Emitted once all directories are probed.
+     * @param infos infos for the requested directories and their walked parents
+     */
+    void lookupDone(KateProjectSharedDirectoryInfos infos);
+
+private:
+    const QStringList m_directories;
+    const int m_markers;
+};
+
+#endif
@@ -0,0 +1,387 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojectmodel.h"
+
+#include <KIconUtils>
+#include <KLocalizedString>
+
+#include <QMimeDatabase>
+
+#include <algorithm>
+
+KateProjectModel::KateProjectModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+KateProjectModel::~KateProjectModel()
+{
+}
+
+void KateProjectModel::setTree(const KateProjectSharedProjectTree &tree)
+{
+    beginResetModel();
+    m_tree = tree;
+    m_untrackedFiles.clear();
+    m_nodeIcons.clear();
+    m_untrackedIcons.clear();
+    endResetModel();
+}
+
+QModelIndex KateProjectModel::indexForNode(int node) const
+{
+    if (!m_tree || node <= KateProjectTree::rootNode()) {
+        return QModelIndex();
+    }
+
+    int row = m_tree->row(node);
+    if (m_tree->parent(node) == KateProjectTree::rootNode()) {
+        row += toplevelOffset();
+    }
+    return createIndex(row, 0, quintptr(node));
+}
+
+QModelIndex KateProjectModel::indexForFile(const QString &file) const
+{
+    /**
+     * tracked file?
+     */
+    if (m_tree) {
+        const int node = m_tree->nodeForFile(file);
+        if (node >= 0) {
+            return indexForNode(node);
+        }
+    }
+
+    /**
+     * untracked file?
+     */
+    const auto it = std::lower_bound(m_untrackedFiles.constBegin(), m_untrackedFiles.constEnd(), file);
+    if (it != m_untrackedFiles.constEnd() && *it == file) {
+        return createIndex(it - m_untrackedFiles.constBegin(), 0, quintptr(UntrackedFileId));
+    }
+
+    return QModelIndex();
+}
+
+void KateProjectModel::addUntrackedFile(const QString &file)
+{
+    const auto it = std::lower_bound(m_untrackedFiles.begin(), m_untrackedFiles.end(), file);
+    if (it != m_untrackedFiles.end() && *it == file) {
+        return;
+    }
+
+    /**
+     * first one => the untracked item itself appears
+     */
+    if (m_untrackedFiles.isEmpty()) {
+        beginInsertRows(QModelIndex(), 0, 0);
+        m_untrackedFiles.append(file);
+        endInsertRows();
+        return;
+    }
+
+    const int row = it - m_untrackedFiles.begin();
+    beginInsertRows(createIndex(0, 0, quintptr(UntrackedRootId)), row, row);
+    m_untrackedFiles.insert(row, file);
+    endInsertRows();
+}
+
+void KateProjectModel::removeUntrackedFile(const QString &file)
+{
+    const auto it = std::lower_bound(m_untrackedFiles.begin(), m_untrackedFiles.end(), file);
+    if (it == m_untrackedFiles.end() || *it != file) {
+        return;
+    }
+
+    /**
+     * last one => the untracked item vanishes
+     */
+    if (m_untrackedFiles.size() == 1) {
+        beginRemoveRows(QModelIndex(), 0, 0);
+        m_untrackedFiles.clear();
+        endRemoveRows();
+        return;
+    }
+
+    const int row = it - m_untrackedFiles.begin();
+    beginRemoveRows(createIndex(0, 0, quintptr(UntrackedRootId)), row, row);
+    m_untrackedFiles.removeAt(row);
+    endRemoveRows();
+}
+
+void KateProjectModel::removeUntrackedFiles(const QStringList &files)
+{
+    /**
+     * rows to remove, sorted
+     */
+    QVector<int> rows;
+    rows.reserve(files.size());
+    for (const QString &file : files) {
+        const auto it = std::lower_bound(m_untrackedFiles.constBegin(), m_untrackedFiles.constEnd(), file);
+        if (it != m_untrackedFiles.constEnd() && *it == file) {
+            rows.append(it - m_untrackedFiles.constBegin());
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    /**
+     * all => the untracked item vanishes
+     */
+    if (rows.size() == m_untrackedFiles.size()) {
+        beginRemoveRows(QModelIndex(), 0, 0);
+        m_untrackedFiles.clear();
+        endRemoveRows();
+        return;
+    }
+
+    /**
+     * else remove contiguous row ranges, bottom up
+     */
+    const QModelIndex parent = createIndex(0, 0, quintptr(UntrackedRootId));
+    for (int last = rows.size() - 1; last >= 0;) {
+        int first = last;
+        while (first > 0 && rows[first - 1] == rows[first] - 1) {
+            --first;
+        }
+
+        beginRemoveRows(parent, rows[first], rows[last]);
+        m_untrackedFiles.erase(m_untrackedFiles.begin() + rows[first], m_untrackedFiles.begin() + rows[last] + 1);
+        endRemoveRows();
+
+        last = first - 1;
+    }
+}
+
+void KateProjectModel::setDocumentState(const QString &file, bool modified, bool modifiedOnDisk)
+{
+    const int state = (modified ? Modified : 0) | (modifiedOnDisk ? ModifiedOnDisk : 0);
+    if (m_documentStates.value(file, -1) == state) {
+        return;
+    }
+
+    m_documentStates.insert(file, state);
+
+    const QModelIndex index = indexForFile(file);
+    invalidateFileIcon(file, index);
+    if (index.isValid()) {
+        emit dataChanged(index, index, QVector<int>() << Qt::DecorationRole);
+    }
+}
+
+void KateProjectModel::clearDocumentState(const QString &file)
+{
+    if (!m_documentStates.remove(file)) {
+        return;
+    }
+
+    const QModelIndex index = indexForFile(file);
+    invalidateFileIcon(file, index);
+    if (index.isValid()) {
+        emit dataChanged(index, index, QVector<int>() << Qt::DecorationRole);
+    }
+}
+
+QModelIndex KateProjectModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (row < 0 || column != 0) {
+        return QModelIndex();
+    }
+
+    /**
+     * toplevel: untracked item first, then the toplevel nodes of the tree
+     */
+    if (!parent.isValid()) {
+        if (row < toplevelOffset()) {
+            return createIndex(row, 0, quintptr(UntrackedRootId));
+        }
+
+        if (!m_tree || (row - toplevelOffset()) >= m_tree->childCount(KateProjectTree::rootNode())) {
+            return QModelIndex();
+        }
+
+        return createIndex(row, 0, quintptr(m_tree->child(KateProjectTree::rootNode(), row - toplevelOffset())));
+    }
+
+    if (parent.internalId() == UntrackedRootId) {
+        return (row < m_untrackedFiles.size()) ? createIndex(row, 0, quintptr(UntrackedFileId)) : QModelIndex();
+    }
+
+    if (parent.internalId() == UntrackedFileId || !m_tree) {
+        return QModelIndex();
+    }
+
+    const int node = parent.internalId();
+    if (row >= m_tree->childCount(node)) {
+        return QModelIndex();
+    }
+
+    return createIndex(row, 0, quintptr(m_tree->child(node, row)));
+}
+
+QModelIndex KateProjectModel::parent(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.internalId() == UntrackedRootId) {
+        return QModelIndex();
+    }
+
+    if (index.internalId() == UntrackedFileId) {
+        return createIndex(0, 0, quintptr(UntrackedRootId));
+    }
+
+    return indexForNode(m_tree->parent(index.internalId()));
+}
+
+int KateProjectModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return toplevelOffset() + (m_tree ? m_tree->childCount(KateProjectTree::rootNode()) : 0);
+    }
+
+    if (parent.column() != 0 || parent.internalId() == UntrackedFileId) {
+        return 0;
+    }
+
+    if (parent.internalId() == UntrackedRootId) {
+        return m_untrackedFiles.size();
+    }
+
+    return m_tree ? m_tree->childCount(parent.internalId()) : 0;
+}
+
+int KateProjectModel::columnCount(const QModelIndex &) const
+{
+    return 1;
+}
+
+QIcon KateProjectModel::fileIcon(const QString &file) const
+{
+    /**
+     * modified documents get the save icon, on disk modified ones an emblem
+     */
+    const int state = m_documentStates.value(file);
+    QString iconName;
+    if (state & Modified) {
+        iconName = QStringLiteral("document-save");
+    } else {
+        iconName = QMimeDatabase().mimeTypeForFile(file, QMimeDatabase::MatchExtension).iconName();
+    }
+
+    const QString key = (state & ModifiedOnDisk) ? (iconName + QStringLiteral("+emblem-important")) : iconName;
+    auto it = m_icons.find(key);
+    if (it == m_icons.end()) {
+        QIcon icon = QIcon::fromTheme(iconName);
+        if (state & ModifiedOnDisk) {
+            icon = KIconUtils::addOverlay(icon, QIcon(QStringLiteral("emblem-important")), Qt::TopLeftCorner);
+        }
+        it = m_icons.insert(key, icon);
+    }
+    return it.value();
+}
+
+void KateProjectModel::invalidateFileIcon(const QString &file, const QModelIndex &index)
+{
+    m_untrackedIcons.remove(file);
+    if (index.isValid() && index.internalId() != UntrackedFileId && index.internalId() != UntrackedRootId) {
+        m_nodeIcons.remove(index.internalId());
+    }
+}
+
+QVariant KateProjectModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    /**
+     * untracked item and its files
+     */
+    if (index.internalId() == UntrackedRootId) {
+        switch (role) {
+        case Qt::DisplayRole:
+            return i18n("<untracked>");
+        case Qt::DecorationRole:
+            return QIcon::fromTheme(QStringLiteral("folder"));
+        default:
+            return QVariant();
+        }
+    }
+
+    if (index.internalId() == UntrackedFileId) {
+        const QString &file = m_untrackedFiles.at(index.row());
+        switch (role) {
+        case Qt::DisplayRole:
+            return file.mid(file.lastIndexOf(QLatin1Char('/')) + 1);
+        case Qt::ToolTipRole:
+        case Qt::UserRole:
+            return file;
+        case Qt::DecorationRole: {
+            auto it = m_untrackedIcons.constFind(file);
+            if (it == m_untrackedIcons.constEnd()) {
+                it = m_untrackedIcons.insert(file, fileIcon(file));
+            }
+            return it.value();
+        }
+        default:
+            return QVariant();
+        }
+    }
+
+    /**
+     * tree nodes
+     */
+    const int node = index.internalId();
+    switch (role) {
+    case Qt::DisplayRole:
+        return m_tree->name(node);
+
+    case Qt::ToolTipRole:
+    case Qt::UserRole:
+        return (m_tree->type(node) == KateProjectTree::File) ? m_tree->filePath(node) : QVariant();
+
+    case Qt::DecorationRole:
+        switch (m_tree->type(node)) {
+        case KateProjectTree::Project:
+            return QIcon::fromTheme(QStringLiteral("folder-documents"));
+        case KateProjectTree::Directory:
+            return QIcon::fromTheme(QStringLiteral("folder"));
+        case KateProjectTree::File: {
+            // resolving the mime type is too expensive for each repaint
+            auto it = m_nodeIcons.constFind(node);
+            if (it == m_nodeIcons.constEnd()) {
+                it = m_nodeIcons.insert(node, fileIcon(m_tree->filePath(node)));
+            }
+            return it.value();
+        }
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return QVariant();
+}
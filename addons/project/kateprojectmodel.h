@@ -0,0 +1,216 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_MODEL_H
+#define KATE_PROJECT_MODEL_H
+
+#include "kateprojecttree.h"
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QIcon>
+#include <QSharedPointer>
+#include <QStringList>
+
+/**
+ * Shared pointer data type.
+ * Used to pass the tree from the worker over queued connected slots
+ */
+typedef QSharedPointer<KateProjectTree> KateProjectSharedProjectTree;
+Q_DECLARE_METATYPE(KateProjectSharedProjectTree)
+
+/**
+ * Item model for the project tree view.
+ * Presents a KateProjectTree, no per item objects are allocated.
+ * Documents that are open but not part of the tree are shown below
+ * an extra "<untracked>" toplevel item.
+ * Qt::UserRole and Qt::ToolTipRole contain the full path for files.
+ */
+class KateProjectModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * construct empty model
+     * @param parent parent object
+     */
+    explicit KateProjectModel(QObject *parent = nullptr);
+
+    /**
+     * deconstruct model
+     */
+    ~KateProjectModel() override;
+
+    /**
+     * Set new tree, resets the model and forgets all untracked files.
+     * @param tree new finalized tree
+     */
+    void setTree(const KateProjectSharedProjectTree &tree);
+
+    /**
+     * Current tree.
+     * May be null.
+     * @return tree
+     */
+    const KateProjectTree *tree() const {
+        return m_tree.data();
+    }
+
+    /**
+     * Index for the given file, tracked or untracked.
+     * @param file full path of file
+     * @return index or invalid index if the file is unknown
+     */
+    QModelIndex indexForFile(const QString &file) const;
+
+    /**
+     * Is the file part of the tree?
+     * @param file full path of file
+     * @return true if the file is part of the project tree
+     */
+    bool isTracked(const QString &file) const {
+        return m_tree && m_tree->nodeForFile(file) >= 0;
+    }
+
+    /**
+     * Untracked files, sorted.
+     * @return list of untracked files
+     */
+    const QStringList &untrackedFiles() const {
+        return m_untrackedFiles;
+    }
+
+    /**
+     * Add/remove file to/from the untracked files.
+     * @param file full path of file
+     */
+    void addUntrackedFile(const QString &file);
+    void removeUntrackedFile(const QString &file);
+
+    /**
+     * Remove several files from the untracked files at once.
+     * @param files full paths of files
+     */
+    void removeUntrackedFiles(const QStringList &files);
+
+    /**
+     * Update the document state of the file, used for the icons.
+     * @param file full path of file
+     * @param modified document is modified
+     * @param modifiedOnDisk document was modified on disk
+     */
+    void setDocumentState(const QString &file, bool modified, bool modifiedOnDisk);
+
+    /**
+     * Forget the document state of the file.
+     * @param file full path of file
+     */
+    void clearDocumentState(const QString &file);
+
+    /**
+     * Document state of the file.
+     */
+    bool isModified(const QString &file) const {
+        return m_documentStates.value(file) & Modified;
+    }
+
+    bool isModifiedOnDisk(const QString &file) const {
+        return m_documentStates.value(file) & ModifiedOnDisk;
+    }
+
+    /**
+     * QAbstractItemModel interface
+     */
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    /**
+     * special internal ids, tree nodes use their node number
+     */
+    enum : quintptr {
+        UntrackedRootId = ~quintptr(0),
+        UntrackedFileId = ~quintptr(0) - 1
+    };
+
+    /**
+     * document state flags
+     */
+    enum DocumentState {
+        Modified = 1,
+        ModifiedOnDisk = 2
+    };
+
+    /**
+     * toplevel row offset, the untracked item comes first
+     */
+    int toplevelOffset() const {
+        return m_untrackedFiles.isEmpty() ? 0 : 1;
+    }
+
+    /**
+     * index for tree node
+     */
+    QModelIndex indexForNode(int node) const;
+
+    /**
+     * icon for a file, uses document state
+     */
+    QIcon fileIcon(const QString &file) const;
+
+    /**
+     * forget the resolved icon of a file, its document state changed
+     */
+    void invalidateFileIcon(const QString &file, const QModelIndex &index);
+
+private:
+    /**
+     * the tree
+     */
+    KateProjectSharedProjectTree m_tree;
+
+    /**
+     * open documents that are not in the tree, sorted
+     */
+    QStringList m_untrackedFiles;
+
+    /**
+     * file => document state flags, only for open documents
+     */
+    QHash<QString, int> m_documentStates;
+
+    /**
+     * icon cache, icon name => icon
+     */
+    mutable QHash<QString, QIcon> m_icons;
+
+    /**
+     * resolved icons, tree node => icon and untracked file => icon
+     * an entry is dropped once the document state of its file changes
+     */
+    mutable QHash<int, QIcon> m_nodeIcons;
+    mutable QHash<QString, QIcon> m_untrackedIcons;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "kateproject.h"
 #include "kateprojectconfigpage.h"
 #include "kateprojectpluginview.h"
+#include "kateprojectcodeanalysishashworker.h"
 
 #include <ktexteditor/editor.h>
 #include <ktexteditor/application.h>
@@ -48,9 +49,6 @@
 namespace
 {
 const QString ProjectFileName = QStringLiteral(".kateproject");
-const QString GitFolderName = QStringLiteral(".git");
-const QString SubversionFolderName = QStringLiteral(".svn");
-const QString MercurialFolderName = QStringLiteral(".hg");
 
 const QString GitConfig = QStringLiteral("git");
 const QString SubversionConfig = QStringLiteral("subversion");
@@ -61,18 +59,33 @@ const QStringList DefaultConfig = QStringList() << GitConfig << SubversionConfig
 
 KateProjectPlugin::KateProjectPlugin(QObject *parent, const QList<QVariant> &)
     : KTextEditor::Plugin(parent)
+    , m_lookupRunning(false)
     , m_completion(this)
+    , m_activeProject(nullptr)
     , m_autoGit(true)
     , m_autoSubversion(true)
     , m_autoMercurial(true)
     , m_weaver(new ThreadWeaver::Queue(this))
 {
-    qRegisterMetaType<KateProjectSharedQStandardItem>("KateProjectSharedQStandardItem");
-    qRegisterMetaType<KateProjectSharedQMapStringItem>("KateProjectSharedQMapStringItem");
+    qRegisterMetaType<KateProjectSharedProjectTree>("KateProjectSharedProjectTree");
+    qRegisterMetaType<KateProjectSharedDirectoryInfos>("KateProjectSharedDirectoryInfos");
     qRegisterMetaType<KateProjectSharedProjectIndex>("KateProjectSharedProjectIndex");
+    qRegisterMetaType<KateProjectSharedCompletionItems>("KateProjectSharedCompletionItems");
+    qRegisterMetaType<KateProjectSharedFileHashes>("KateProjectSharedFileHashes");
+    qRegisterMetaType<KateSharedFileListSnapshot>("KateSharedFileListSnapshot");
 
     connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::documentCreated, this, &KateProjectPlugin::slotDocumentCreated);
+    connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::aboutToDeleteDocuments, this, &KateProjectPlugin::slotAboutToDeleteDocuments);
+    connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::documentsDeleted, this, &KateProjectPlugin::slotDocumentsDeleted);
     connect(&m_fileWatcher, &QFileSystemWatcher::directoryChanged, this, &KateProjectPlugin::slotDirectoryChanged);
+    connect(&m_lookupWatcher, &QFileSystemWatcher::directoryChanged, this, &KateProjectPlugin::slotLookupDirectoryChanged);
+
+    /**
+     * documents are resolved in batches, e.g. all documents of a restored session at once
+     */
+    m_lookupTimer.setSingleShot(true);
+    m_lookupTimer.setInterval(0);
+    connect(&m_lookupTimer, &QTimer::timeout, this, &KateProjectPlugin::slotStartPendingLookup);
 
 #ifdef HAVE_CTERMID
     /**
@@ -137,44 +150,83 @@ KateProject *KateProjectPlugin::createProjectForFileName(const QString &fileName
 
     m_projects.append(project);
     m_fileWatcher.addPath(QFileInfo(fileName).canonicalPath());
+
+    /**
+     * the project might claim a directory that was cached without project
+     */
+    invalidateLookupCache(project->baseDir());
+
     emit projectCreated(project);
     return project;
 }
 
 KateProject *KateProjectPlugin::projectForDir(QDir dir)
+{
+    return resolveDirectory(dir, KateProjectDirectoryInfos());
+}
+
+KateProject *KateProjectPlugin::resolveDirectory(QDir dir, const KateProjectDirectoryInfos &infos)
 {
     /**
      * search projects upwards
      * with recursion guard
      */
-    QSet<QString> seenDirectories;
-    while (!seenDirectories.contains(dir.absolutePath())) {
+    QStringList walkedDirectories;
+    QHash<QString, int> markers;
+    KateProject *project = nullptr;
+    while (!walkedDirectories.contains(dir.absolutePath())) {
+        /**
+         * known directory? done
+         */
+        const QString path = dir.absolutePath();
+        const auto cached = m_directory2Project.constFind(path);
+        if (cached != m_directory2Project.constEnd()) {
+            project = cached.value();
+            break;
+        }
+
         /**
-         * fill recursion guard
+         * fill recursion guard, remember directory for the cache
          */
-        seenDirectories.insert(dir.absolutePath());
+        walkedDirectories.append(path);
 
         /**
-         * check for project and load it if found
+         * probe the directory, if not already done in the background
          */
-        QString canonicalPath = dir.canonicalPath();
-        QString canonicalFileName = dir.filePath(ProjectFileName);
+        const auto known = infos.constFind(path);
+        const KateProjectDirectoryInfo info = (known != infos.constEnd()) ? known.value() : KateProjectLookupWorker::probe(dir, enabledMarkers());
 
-        for (KateProject *project : m_projects) {
-            if (project->baseDir() == canonicalPath || project->fileName() == canonicalFileName) {
-                return project;
+        /**
+         * check for project and load it if found
+         */
+        const QString canonicalFileName = dir.filePath(ProjectFileName);
+        for (KateProject *loadedProject : m_projects) {
+            if (loadedProject->baseDir() == info.canonicalPath || loadedProject->fileName() == canonicalFileName) {
+                project = loadedProject;
+                break;
             }
         }
 
-        if (dir.exists(ProjectFileName)) {
-            return createProjectForFileName(canonicalFileName);
+        if (project) {
+            break;
         }
 
-        KateProject *project;
-        if ((project = detectGit(dir)) || (project = detectSubversion(dir)) || (project = detectMercurial(dir))) {
-            return project;
+        /**
+         * marker found => try to open the project
+         * if that fails, e.g. the repository listing did not work, go on upwards
+         */
+        if (info.markers & enabledMarkers()) {
+            project = openProjectForDirectory(dir, info);
+            if (project) {
+                break;
+            }
         }
 
+        /**
+         * no project here, watch the directory for new markers
+         */
+        markers.insert(path, info.markers);
+
         /**
          * else: cd up, if possible or abort
          */
@@ -183,7 +235,110 @@ KateProject *KateProjectPlugin::projectForDir(QDir dir)
         }
     }
 
-    return nullptr;
+    /**
+     * remember the result for all walked directories
+     */
+    for (const QString &path : walkedDirectories) {
+        m_directory2Project.insert(path, project);
+    }
+
+    /**
+     * only negative results are watched, a new marker may turn them into a project
+     * directories inside a found project stay unwatched, opening projects invalidates them anyway
+     */
+    if (!project && !markers.isEmpty()) {
+        QStringList newlyWatched;
+        for (auto it = markers.constBegin(); it != markers.constEnd(); ++it) {
+            if (!m_lookupMarkers.contains(it.key())) {
+                newlyWatched.append(it.key());
+            }
+            m_lookupMarkers.insert(it.key(), it.value());
+        }
+        if (!newlyWatched.isEmpty()) {
+            m_lookupWatcher.addPaths(newlyWatched);
+        }
+    }
+
+    return project;
+}
+
+KateProject *KateProjectPlugin::openProjectForDirectory(const QDir &dir, const KateProjectDirectoryInfo &info)
+{
+    /**
+     * try all present markers, a failing one must not hide the others
+     */
+    KateProject *project = nullptr;
+    if (info.markers & KateProjectDirectoryInfo::ProjectFile) {
+        project = createProjectForFileName(dir.filePath(ProjectFileName));
+    }
+
+    if (!project && m_autoGit && (info.markers & KateProjectDirectoryInfo::Git)) {
+        project = createProjectForRepository(QStringLiteral("git"), dir);
+    }
+
+    if (!project && m_autoSubversion && (info.markers & KateProjectDirectoryInfo::Subversion)) {
+        project = createProjectForRepository(QStringLiteral("svn"), dir);
+    }
+
+    if (!project && m_autoMercurial && (info.markers & KateProjectDirectoryInfo::Mercurial)) {
+        project = createProjectForRepository(QStringLiteral("hg"), dir);
+    }
+
+    return project;
+}
+
+int KateProjectPlugin::enabledMarkers() const
+{
+    int markers = KateProjectDirectoryInfo::ProjectFile;
+
+    if (m_autoGit) {
+        markers |= KateProjectDirectoryInfo::Git;
+    }
+
+    if (m_autoSubversion) {
+        markers |= KateProjectDirectoryInfo::Subversion;
+    }
+
+    if (m_autoMercurial) {
+        markers |= KateProjectDirectoryInfo::Mercurial;
+    }
+
+    return markers;
+}
+
+void KateProjectPlugin::invalidateLookupCache(const QString &directory)
+{
+    const QString prefix = directory.endsWith(QLatin1Char('/')) ? directory : (directory + QLatin1Char('/'));
+
+    QStringList removedDirectories;
+    for (auto it = m_directory2Project.begin(); it != m_directory2Project.end();) {
+        if (directory.isEmpty() || it.key() == directory || it.key().startsWith(prefix)) {
+            if (m_lookupMarkers.remove(it.key())) {
+                removedDirectories.append(it.key());
+            }
+            it = m_directory2Project.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (!removedDirectories.isEmpty()) {
+        m_lookupWatcher.removePaths(removedDirectories);
+    }
+}
+
+void KateProjectPlugin::slotLookupDirectoryChanged(const QString &path)
+{
+    /**
+     * only new or removed markers matter, not e.g. atomic saves of other files
+     * removed directories lose their watch, forget them in any case
+     */
+    const auto known = m_lookupMarkers.constFind(path);
+    if (known != m_lookupMarkers.constEnd() && QFileInfo(path).isDir() && known.value() == KateProjectLookupWorker::probe(QDir(path), enabledMarkers()).markers) {
+        return;
+    }
+
+    invalidateLookupCache(path);
 }
 
 KateProject *KateProjectPlugin::projectForUrl(const QUrl &url)
@@ -195,6 +350,58 @@ KateProject *KateProjectPlugin::projectForUrl(const QUrl &url)
     return projectForDir(QFileInfo(url.toLocalFile()).absoluteDir());
 }
 
+void KateProjectPlugin::setActiveProject(KateProject *project)
+{
+    if (m_activeProject == project) {
+        return;
+    }
+
+    if (m_activeProject) {
+        m_activeProject->setPrioritized(false);
+    }
+
+    m_activeProject = project;
+
+    if (m_activeProject) {
+        m_activeProject->setPrioritized(true);
+    }
+}
+
+KateSharedFileListSnapshot KateProjectPlugin::allProjectsFileSnapshot() const
+{
+    /**
+     * collect the snapshots of the projects, one project needs no merging
+     */
+    QVector<KateSharedFileListSnapshot> snapshots;
+    QVector<quint64> generations;
+    snapshots.reserve(m_projects.size());
+    generations.reserve(m_projects.size());
+    foreach (KateProject *project, m_projects) {
+        snapshots.append(project->fileSnapshot());
+        generations.append(snapshots.last()->generation());
+    }
+
+    if (snapshots.size() == 1) {
+        return snapshots.first();
+    }
+
+    /**
+     * nothing changed? reuse the merged snapshot
+     */
+    if (m_allProjectsFileSnapshot && generations == m_allProjectsFileGenerations) {
+        return m_allProjectsFileSnapshot;
+    }
+
+    QStringList files;
+    foreach (const KateSharedFileListSnapshot &snapshot, snapshots) {
+        files.append(snapshot->files());
+    }
+
+    m_allProjectsFileSnapshot = KateSharedFileListSnapshot(new KateFileListSnapshot(files, KateProject::newSnapshotGeneration(), m_allProjectsFileSnapshot.data()));
+    m_allProjectsFileGenerations = generations;
+    return m_allProjectsFileSnapshot;
+}
+
 void KateProjectPlugin::slotDocumentCreated(KTextEditor::Document *document)
 {
     connect(document, &KTextEditor::Document::documentUrlChanged, this, &KateProjectPlugin::slotDocumentUrlChanged);
@@ -210,67 +417,142 @@ void KateProjectPlugin::slotDocumentDestroyed(QObject *document)
     }
 
     m_document2Project.remove(document);
+    m_pendingDocuments.remove(static_cast<KTextEditor::Document *>(document));
 }
 
-void KateProjectPlugin::slotDocumentUrlChanged(KTextEditor::Document *document)
+void KateProjectPlugin::slotAboutToDeleteDocuments(const QList<KTextEditor::Document *> &documents)
+{
+    /**
+     * stop tracking, closing would else unregister each document on its url change
+     */
+    QHash<KateProject *, QList<KTextEditor::Document *> > project2Documents;
+    for (auto document : documents) {
+        disconnect(document, &KTextEditor::Document::documentUrlChanged, this, &KateProjectPlugin::slotDocumentUrlChanged);
+        disconnect(document, &KTextEditor::Document::destroyed, this, &KateProjectPlugin::slotDocumentDestroyed);
+        m_pendingDocuments.remove(document);
+
+        if (KateProject *project = m_document2Project.take(document)) {
+            project2Documents[project].append(document);
+        }
+    }
+
+    for (auto it = project2Documents.constBegin(); it != project2Documents.constEnd(); ++it) {
+        it.key()->unregisterDocuments(it.value());
+    }
+}
+
+void KateProjectPlugin::slotDocumentsDeleted(const QList<KTextEditor::Document *> &documents)
 {
-    KateProject *project = projectForUrl(document->url());
+    for (auto document : documents) {
+        slotDocumentCreated(document);
+    }
+}
 
-    if (KateProject *project = m_document2Project.value(document)) {
+void KateProjectPlugin::slotDocumentUrlChanged(KTextEditor::Document *document)
+{
+    if (KateProject *project = m_document2Project.take(document)) {
         project->unregisterDocument(document);
     }
 
-    if (!project) {
-        m_document2Project.remove(document);
-    } else {
-        m_document2Project[document] = project;
+    m_pendingDocuments.remove(document);
+
+    const QUrl url = document->url();
+    if (url.isEmpty() || !url.isLocalFile()) {
+        return;
     }
 
-    if (KateProject *project = m_document2Project.value(document)) {
-        project->registerDocument(document);
+    /**
+     * known directory => assign at once
+     */
+    const auto cached = m_directory2Project.constFind(QFileInfo(url.toLocalFile()).absolutePath());
+    if (cached != m_directory2Project.constEnd()) {
+        assignProject(document, cached.value());
+        return;
+    }
+
+    /**
+     * else collect documents and do the file system work for all of them in the background
+     */
+    m_pendingDocuments.insert(document);
+    if (!m_lookupRunning) {
+        m_lookupTimer.start();
     }
 }
 
-void KateProjectPlugin::slotDirectoryChanged(const QString &path)
+void KateProjectPlugin::assignProject(KTextEditor::Document *document, KateProject *project)
 {
-    QString fileName = QDir(path).filePath(ProjectFileName);
-    for (KateProject * project : m_projects) {
-        if (project->fileName() == fileName) {
-            QDateTime lastModified = QFileInfo(fileName).lastModified();
-            if (project->fileLastModified().isNull() || (lastModified > project->fileLastModified())) {
-                project->reload();
-            }
-            break;
-        }
+    if (!project) {
+        return;
     }
+
+    m_document2Project[document] = project;
+    project->registerDocument(document);
 }
 
-KateProject* KateProjectPlugin::detectGit(const QDir &dir)
+void KateProjectPlugin::slotStartPendingLookup()
 {
-    // allow .git as dir and file (file for git worktree stuff, https://git-scm.com/docs/git-worktree)
-    if (m_autoGit && dir.exists(GitFolderName)) {
-        return createProjectForRepository(QStringLiteral("git"), dir);
+    /**
+     * collect directories not yet known
+     */
+    QSet<QString> directories;
+    for (auto it = m_pendingDocuments.constBegin(); it != m_pendingDocuments.constEnd(); ++it) {
+        KTextEditor::Document *document = *it;
+        const QString directory = QFileInfo(document->url().toLocalFile()).absolutePath();
+        if (!m_directory2Project.contains(directory)) {
+            directories.insert(directory);
+        }
     }
 
-    return nullptr;
+    if (directories.isEmpty()) {
+        resolvePendingDocuments(KateProjectDirectoryInfos());
+        return;
+    }
+
+    m_lookupRunning = true;
+    KateProjectLookupWorker *worker = new KateProjectLookupWorker(directories.toList(), enabledMarkers());
+    connect(worker, &KateProjectLookupWorker::lookupDone, this, &KateProjectPlugin::slotLookupDone);
+    m_weaver->stream() << worker;
 }
 
-KateProject* KateProjectPlugin::detectSubversion(const QDir &dir)
+void KateProjectPlugin::slotLookupDone(KateProjectSharedDirectoryInfos infos)
 {
-    if (m_autoSubversion && dir.exists(SubversionFolderName) && QFileInfo(dir, SubversionFolderName).isDir()) {
-        return createProjectForRepository(QStringLiteral("svn"), dir);
-    }
+    m_lookupRunning = false;
+    resolvePendingDocuments(*infos);
 
-    return nullptr;
+    /**
+     * documents that arrived during the lookup go into the next batch
+     */
+    if (!m_pendingDocuments.isEmpty()) {
+        m_lookupTimer.start();
+    }
 }
 
-KateProject* KateProjectPlugin::detectMercurial(const QDir &dir)
+void KateProjectPlugin::resolvePendingDocuments(const KateProjectDirectoryInfos &infos)
 {
-    if (m_autoMercurial && dir.exists(MercurialFolderName) && QFileInfo(dir, MercurialFolderName).isDir()) {
-        return createProjectForRepository(QStringLiteral("hg"), dir);
+    const QSet<KTextEditor::Document *> documents = m_pendingDocuments;
+    for (KTextEditor::Document *document : documents) {
+        const QString directory = QFileInfo(document->url().toLocalFile()).absolutePath();
+        if (!m_directory2Project.contains(directory) && !infos.contains(directory)) {
+            continue;
+        }
+
+        m_pendingDocuments.remove(document);
+        assignProject(document, resolveDirectory(QDir(directory), infos));
     }
+}
 
-    return nullptr;
+void KateProjectPlugin::slotDirectoryChanged(const QString &path)
+{
+    QString fileName = QDir(path).filePath(ProjectFileName);
+    for (KateProject * project : m_projects) {
+        if (project->fileName() == fileName) {
+            QDateTime lastModified = QFileInfo(fileName).lastModified();
+            if (project->fileLastModified().isNull() || (lastModified > project->fileLastModified())) {
+                project->reload();
+            }
+            break;
+        }
+    }
 }
 
 KateProject *KateProjectPlugin::createProjectForRepository(const QString &type, const QDir &dir)
@@ -285,6 +567,11 @@ KateProject *KateProjectPlugin::createProjectForRepository(const QString &type,
 
     m_projects.append(project);
 
+    /**
+     * the project might claim a directory that was cached without project
+     */
+    invalidateLookupCache(project->baseDir());
+
     emit projectCreated(project);
     return project;
 }
@@ -295,6 +582,11 @@ void KateProjectPlugin::setAutoRepository(bool onGit, bool onSubversion, bool on
     m_autoSubversion = onSubversion;
     m_autoMercurial = onMercurial;
     writeConfig();
+
+    /**
+     * cached lookups did use the old settings
+     */
+    invalidateLookupCache(QString());
 }
 
 bool KateProjectPlugin::autoGit() const
@@ -330,6 +622,11 @@ void KateProjectPlugin::readConfig()
     if (autorepository.contains(MercurialConfig)) {
         m_autoMercurial = true;
     }
+
+    /**
+     * cached lookups did use the old settings
+     */
+    invalidateLookupCache(QString());
 }
 
 void KateProjectPlugin::writeConfig()
@@ -23,6 +23,8 @@
 
 #include <QFileSystemWatcher>
 #include <QDir>
+#include <QSet>
+#include <QTimer>
 
 #include <ktexteditor/document.h>
 #include <ktexteditor/mainwindow.h>
@@ -32,6 +34,7 @@
 
 #include "kateproject.h"
 #include "kateprojectcompletion.h"
+#include "kateprojectlookupworker.h"
 
 namespace ThreadWeaver {
     class Queue;
@@ -63,6 +66,7 @@ public:
      * Search and open project for given dir, if possible.
      * Will search upwards for .kateproject file.
      * Will use internally projectForFileName if project file is found.
+     * The result is cached for all directories walked, until project markers change on disk.
      * @param dir dir to search matching project for
      * @return project or null if not openable
      */
@@ -85,6 +89,12 @@ public:
         return m_projects;
     }
 
+    /**
+     * Snapshot of the files of all open projects, rebuilt only if some project changed.
+     * @return snapshot of all files of all projects
+     */
+    KateSharedFileListSnapshot allProjectsFileSnapshot() const;
+
     /**
      * Get global code completion.
      * @return global completion object for KTextEditor::View
@@ -93,6 +103,14 @@ public:
         return &m_completion;
     }
 
+    /**
+     * Queue for background jobs, like project loading or completion.
+     * @return job queue of this plugin
+     */
+    ThreadWeaver::Queue *weaver() const {
+        return m_weaver;
+    }
+
     /**
      * Map current open documents to projects.
      * @param document document we want to know which project it belongs to
@@ -102,6 +120,12 @@ public:
         return m_document2Project.value(document);
     }
 
+    /**
+     * Set the project of the active document, its loading is prioritized.
+     * @param project project of the active document, may be null
+     */
+    void setActiveProject(KateProject *project);
+
     void setAutoRepository(bool onGit, bool onSubversion, bool onMercurial);
     bool autoGit() const;
     bool autoSubversion() const;
@@ -127,6 +151,18 @@ public Q_SLOTS:
      */
     void slotDocumentDestroyed(QObject *document);
 
+    /**
+     * Documents will be closed, unregister them at once, grouped by project.
+     * @param documents documents to close
+     */
+    void slotAboutToDeleteDocuments(const QList<KTextEditor::Document *> &documents);
+
+    /**
+     * Documents are closed, the ones still alive are registered again.
+     * @param documents documents that were not closed
+     */
+    void slotDocumentsDeleted(const QList<KTextEditor::Document *> &documents);
+
     /**
      * Url changed, to auto-load projects
      */
@@ -138,11 +174,69 @@ public Q_SLOTS:
      */
     void slotDirectoryChanged(const QString &path);
 
+private Q_SLOTS:
+    /**
+     * a directory used for project lookups did change, forget the cached results
+     * @param path name of directory that did change
+     */
+    void slotLookupDirectoryChanged(const QString &path);
+
+    /**
+     * start background lookup for all pending documents
+     */
+    void slotStartPendingLookup();
+
+    /**
+     * background lookup is done, assign projects to the pending documents
+     * @param infos probed directories
+     */
+    void slotLookupDone(KateProjectSharedDirectoryInfos infos);
+
 private:
     KateProject *createProjectForRepository(const QString &type, const QDir &dir);
-    KateProject *detectGit(const QDir &dir);
-    KateProject *detectSubversion(const QDir &dir);
-    KateProject *detectMercurial(const QDir &dir);
+
+    /**
+     * Search project for given dir, using the lookup cache and the given
+     * already probed directories, other directories are probed on demand.
+     * Fills the lookup cache.
+     * @param dir dir to search matching project for
+     * @param infos already probed directories
+     * @return project or null if not openable
+     */
+    KateProject *resolveDirectory(QDir dir, const KateProjectDirectoryInfos &infos);
+
+    /**
+     * Open project for directory with markers.
+     * @param dir directory
+     * @param info probe result for the directory
+     * @return project or null if not openable
+     */
+    KateProject *openProjectForDirectory(const QDir &dir, const KateProjectDirectoryInfo &info);
+
+    /**
+     * markers to search for, depends on the auto repository settings
+     * @return markers, see KateProjectDirectoryInfo::Marker
+     */
+    int enabledMarkers() const;
+
+    /**
+     * Forget cached lookups for given directory and all directories below.
+     * @param directory directory, empty to forget all lookups
+     */
+    void invalidateLookupCache(const QString &directory);
+
+    /**
+     * Assign document to project, after the lookup is done.
+     * @param document document
+     * @param project project or null
+     */
+    void assignProject(KTextEditor::Document *document, KateProject *project);
+
+    /**
+     * Assign projects to all pending documents covered by the cache or the given infos.
+     * @param infos probed directories
+     */
+    void resolvePendingDocuments(const KateProjectDirectoryInfos &infos);
 
     void readConfig();
     void writeConfig();
@@ -164,11 +258,38 @@ private:
      */
     QHash<QObject *, KateProject *> m_document2Project;
 
+    /**
+     * Lookup cache, absolute directory => project, null for directories without project.
+     * Directories without project are watched by m_lookupWatcher, their markers are
+     * remembered, changed markers invalidate them and everything below.
+     */
+    QHash<QString, KateProject *> m_directory2Project;
+    QHash<QString, int> m_lookupMarkers;
+    QFileSystemWatcher m_lookupWatcher;
+
+    /**
+     * Documents waiting for the batched background lookup
+     */
+    QSet<KTextEditor::Document *> m_pendingDocuments;
+    QTimer m_lookupTimer;
+    bool m_lookupRunning;
+
     /**
      * Project completion
      */
     KateProjectCompletion m_completion;
 
+    /**
+     * project of the active document
+     */
+    KateProject *m_activeProject;
+
+    /**
+     * cached snapshot of all project files and the project snapshot generations it was built from
+     */
+    mutable KateSharedFileListSnapshot m_allProjectsFileSnapshot;
+    mutable QVector<quint64> m_allProjectsFileGenerations;
+
     bool m_autoGit : 1;
     bool m_autoSubversion : 1;
     bool m_autoMercurial : 1;
@@ -190,6 +190,7 @@ QPair<KateProjectView *, KateProjectInfoView *> KateProjectPluginView::viewForPr
     m_stackedProjectInfoViews->addWidget(infoView);
     m_stackedProjectInfoViews->setFocusProxy(infoView);
     m_projectsCombo->addItem(QIcon::fromTheme(QStringLiteral("project-open")), project->name(), project->fileName());
+    connect(project, &KateProject::modelChanged, this, &KateProjectPluginView::slotProjectModelChanged);
 
     /**
      * remember and return it
@@ -258,18 +259,23 @@ QVariantMap KateProjectPluginView::projectMap() const
 }
 
 QStringList KateProjectPluginView::projectFiles() const
+{
+    return projectFilesSnapshot()->files();
+}
+
+KateSharedFileListSnapshot KateProjectPluginView::projectFilesSnapshot() const
 {
     // nothing there, skip
     if (!m_toolView) {
-        return QStringList();
+        return KateSharedFileListSnapshot(new KateFileListSnapshot());
     }
 
     KateProjectView *active = static_cast<KateProjectView *>(m_stackedProjectViews->currentWidget());
     if (!active) {
-        return QStringList();
+        return KateSharedFileListSnapshot(new KateFileListSnapshot());
     }
 
-    return active->project()->files();
+    return active->project()->fileSnapshot();
 }
 
 QString KateProjectPluginView::allProjectsCommonBaseDir() const
@@ -295,13 +301,56 @@ QString KateProjectPluginView::allProjectsCommonBaseDir() const
 
 QStringList KateProjectPluginView::allProjectsFiles() const
 {
-    QStringList fileList;
+    return allProjectsFilesSnapshot()->files();
+}
 
-    foreach (auto project, m_plugin->projects()) {
-        fileList.append(project->files());
+KateSharedFileListSnapshot KateProjectPluginView::allProjectsFilesSnapshot() const
+{
+    return m_plugin->allProjectsFileSnapshot();
+}
+
+QVariantList KateProjectPluginView::projectSymbols(const QString &pattern, int limit)
+{
+    // nothing there, skip
+    if (!m_toolView || pattern.isEmpty()) {
+        return QVariantList();
     }
 
-    return fileList;
+    KateProjectView *active = static_cast<KateProjectView *>(m_stackedProjectViews->currentWidget());
+    const KateProjectSharedProjectIndex index = active ? active->project()->sharedProjectIndex() : KateProjectSharedProjectIndex();
+    if (!index) {
+        return QVariantList();
+    }
+
+    /**
+     * the pattern got extended on the same index? only the last matches can still match
+     */
+    const bool incremental = (m_symbolIndex == index) && !m_symbolPattern.isEmpty() && pattern.startsWith(m_symbolPattern, Qt::CaseInsensitive);
+    const QVector<quint32> within = incremental ? m_symbolMatches : QVector<quint32>();
+    const KateProjectSymbolTable &symbols = index->symbols();
+    const QVector<int> matches = symbols.fuzzyMatches(pattern, limit, incremental ? &within : nullptr, &m_symbolMatches);
+    m_symbolIndex = index;
+    m_symbolPattern = pattern;
+
+    /**
+     * expand to all definitions, symbols are sorted by name and equal names are interned
+     */
+    QVariantList result;
+    for (const int match : matches) {
+        for (int symbol = match; symbol < symbols.size() && symbols.rawName(symbol) == symbols.rawName(match) && result.size() < limit; ++symbol) {
+            QVariantMap entry;
+            entry.insert(QStringLiteral("name"), symbols.name(symbol));
+            entry.insert(QStringLiteral("kind"), symbols.kind(symbol));
+            entry.insert(QStringLiteral("file"), symbols.file(symbol));
+            entry.insert(QStringLiteral("line"), symbols.line(symbol));
+            result.append(entry);
+        }
+
+        if (result.size() >= limit) {
+            break;
+        }
+    }
+    return result;
 }
 
 void KateProjectPluginView::slotViewChanged()
@@ -362,6 +411,20 @@ void KateProjectPluginView::slotCurrentChanged(int index)
      */
     emit projectFileNameChanged();
     emit projectMapChanged();
+    emit projectFilesChanged();
+}
+
+void KateProjectPluginView::slotProjectModelChanged()
+{
+    // nothing there, skip
+    if (!m_toolView) {
+        return;
+    }
+
+    KateProjectView *active = static_cast<KateProjectView *>(m_stackedProjectViews->currentWidget());
+    if (active && active->project() == sender()) {
+        emit projectFilesChanged();
+    }
 }
 
 void KateProjectPluginView::slotDocumentUrlChanged(KTextEditor::Document *document)
@@ -381,6 +444,11 @@ void KateProjectPluginView::slotDocumentUrlChanged(KTextEditor::Document *docume
         return;
     }
 
+    /**
+     * load the project of the active document first
+     */
+    m_plugin->setActiveProject(project);
+
     /**
      * select the file FIRST
      */
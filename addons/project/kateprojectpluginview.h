@@ -43,10 +43,12 @@ class KateProjectPluginView : public QObject, public KXMLGUIClient
     Q_PROPERTY(QString projectName READ projectName)
     Q_PROPERTY(QString projectBaseDir READ projectBaseDir)
     Q_PROPERTY(QVariantMap projectMap READ projectMap NOTIFY projectMapChanged)
-    Q_PROPERTY(QStringList projectFiles READ projectFiles)
+    Q_PROPERTY(QStringList projectFiles READ projectFiles NOTIFY projectFilesChanged)
+    Q_PROPERTY(KateSharedFileListSnapshot projectFilesSnapshot READ projectFilesSnapshot NOTIFY projectFilesChanged)
 
     Q_PROPERTY(QString allProjectsCommonBaseDir READ allProjectsCommonBaseDir)
     Q_PROPERTY(QStringList allProjectsFiles READ allProjectsFiles)
+    Q_PROPERTY(KateSharedFileListSnapshot allProjectsFilesSnapshot READ allProjectsFilesSnapshot)
 
 public:
     KateProjectPluginView(KateProjectPlugin *plugin, KTextEditor::MainWindow *mainWindow);
@@ -80,6 +82,12 @@ public:
      */
     QStringList projectFiles() const;
 
+    /**
+     * files for the current active project, as shared immutable snapshot
+     * @return empty snapshot if none, else snapshot of the project files
+     */
+    KateSharedFileListSnapshot projectFilesSnapshot() const;
+
     /**
      * Example: Two projects are loaded with baseDir1="/home/dev/project1" and
      * baseDir2="/home/dev/project2". Then "/home/dev/" is returned.
@@ -93,6 +101,22 @@ public:
      */
     QStringList allProjectsFiles() const;
 
+    /**
+     * @returns snapshot of the files for all open projects (@see also projectFilesSnapshot())
+     */
+    KateSharedFileListSnapshot allProjectsFilesSnapshot() const;
+
+    /**
+     * Fuzzy search for symbols in the ctags index of the current active project.
+     * Each definition is one result, all definitions of a name are returned together.
+     * A pattern extending the one of the last call is answered incrementally.
+     * Used for the symbol mode of quick open.
+     * @param pattern pattern to search for, case is ignored
+     * @param limit maximal number of results
+     * @return list of maps with "name", "kind", "file" and "line" (starting at 1, 0 if unknown), best first
+     */
+    Q_INVOKABLE QVariantList projectSymbols(const QString &pattern, int limit);
+
     /**
      * the main window we belong to
      * @return our main window
@@ -101,6 +125,14 @@ public:
         return m_mainWindow;
     }
 
+    /**
+     * the plugin we belong to
+     * @return our plugin
+     */
+    KateProjectPlugin *plugin() const {
+        return m_plugin;
+    }
+
 public Q_SLOTS:
     /**
      * Create views for given project.
@@ -155,6 +187,11 @@ Q_SIGNALS:
      */
     void projectMapChanged();
 
+    /**
+     * Emitted if projectFiles changed, either another project got active or the active one was reloaded.
+     */
+    void projectFilesChanged();
+
     /**
      * Emitted when a ctags lookup in requested
      * @param word lookup word
@@ -178,6 +215,11 @@ private Q_SLOTS:
      */
     void slotDocumentUrlChanged(KTextEditor::Document *document);
 
+    /**
+     * Model of some project changed, forward it if that is the current one.
+     */
+    void slotProjectModelChanged();
+
     /**
      * Show context menu
      */
@@ -250,6 +292,13 @@ private:
      * lookup action
      */
     QAction *m_lookupAction;
+
+    /**
+     * last symbol search: index, pattern and all matching names, for incremental searches
+     */
+    QWeakPointer<KateProjectIndex> m_symbolIndex;
+    QString m_symbolPattern;
+    QVector<quint32> m_symbolMatches;
 };
 
 #endif
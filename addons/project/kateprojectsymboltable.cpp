@@ -0,0 +1,473 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojectsymboltable.h"
+
+#include <QDataStream>
+#include <QIODevice>
+#include <QPair>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+/**
+ * ASCII only lower casing, ctags names are mostly plain identifiers
+ * this is the one folding rule for sorting, prefix search and fuzzy matching
+ */
+inline char foldCase(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+/**
+ * compare like qstrncmp, but with foldCase, a negative length compares the whole strings
+ */
+int foldedCompare(const char *a, const char *b, int length = -1)
+{
+    for (int i = 0; length < 0 || i < length; ++i) {
+        const uchar ca = uchar(foldCase(a[i]));
+        const uchar cb = uchar(foldCase(b[i]));
+        if (ca != cb) {
+            return (ca < cb) ? -1 : 1;
+        }
+        if (!ca) {
+            break;
+        }
+    }
+    return 0;
+}
+
+inline bool isUpper(char c)
+{
+    return c >= 'A' && c <= 'Z';
+}
+
+inline bool isLower(char c)
+{
+    return c >= 'a' && c <= 'z';
+}
+}
+
+KateProjectSymbolTable::KateProjectSymbolTable()
+{
+}
+
+void KateProjectSymbolTable::clear()
+{
+    m_pool.clear();
+    m_internedStrings.clear();
+    m_names.clear();
+    m_kinds.clear();
+    m_files.clear();
+    m_lines.clear();
+    m_foldedOrder.clear();
+    m_uniqueNames.clear();
+}
+
+quint32 KateProjectSymbolTable::intern(const QByteArray &text)
+{
+    /**
+     * already known? reuse it
+     */
+    const auto it = m_internedStrings.constFind(text);
+    if (it != m_internedStrings.constEnd()) {
+        return it.value();
+    }
+
+    /**
+     * else append to pool, including 0 terminator
+     */
+    const quint32 offset = m_pool.size();
+    m_pool.append(text.constData(), text.size());
+    m_pool.append('\0');
+    m_internedStrings.insert(text, offset);
+    return offset;
+}
+
+void KateProjectSymbolTable::addSymbol(const QByteArray &name, const QByteArray &kind, const QByteArray &file, int line)
+{
+    m_names.append(intern(name));
+    m_kinds.append(intern(kind));
+    m_files.append(intern(file));
+    m_lines.append(quint32(qMax(0, line)));
+}
+
+bool KateProjectSymbolTable::addCtagsLine(const char *line, int length)
+{
+    /**
+     * strip line break
+     */
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+        --length;
+    }
+
+    /**
+     * skip empty lines and pseudo tags like !_TAG_FILE_FORMAT
+     */
+    if (length <= 0 || line[0] == '!') {
+        return false;
+    }
+
+    /**
+     * name<TAB>file<TAB>address, name and file are mandatory
+     */
+    const QByteArray data = QByteArray::fromRawData(line, length);
+    const int nameEnd = data.indexOf('\t');
+    if (nameEnd <= 0) {
+        return false;
+    }
+
+    const int fileEnd = data.indexOf('\t', nameEnd + 1);
+    if (fileEnd < 0) {
+        return false;
+    }
+
+    /**
+     * address might be a plain line number
+     */
+    int lineNumber = 0;
+    if (fileEnd + 1 < length && line[fileEnd + 1] >= '0' && line[fileEnd + 1] <= '9') {
+        lineNumber = atoi(line + fileEnd + 1);
+    }
+
+    /**
+     * extension fields follow the ;" after the address
+     * the kind can be given as plain field or as kind:, line as line:
+     */
+    QByteArray kind;
+    int fieldStart = data.indexOf(";\"\t", fileEnd + 1);
+    if (fieldStart >= 0) {
+        fieldStart += 3;
+        while (fieldStart < length) {
+            int fieldEnd = data.indexOf('\t', fieldStart);
+            if (fieldEnd < 0) {
+                fieldEnd = length;
+            }
+
+            const QByteArray field = QByteArray::fromRawData(line + fieldStart, fieldEnd - fieldStart);
+            if (field.startsWith("line:")) {
+                lineNumber = field.mid(5).toInt();
+            } else if (field.startsWith("kind:")) {
+                kind = field.mid(5);
+            } else if (kind.isEmpty() && !field.contains(':')) {
+                kind = QByteArray(field.constData(), field.size());
+            }
+
+            fieldStart = fieldEnd + 1;
+        }
+    }
+
+    addSymbol(QByteArray(line, nameEnd), kind, QByteArray(line + nameEnd + 1, fileEnd - nameEnd - 1), lineNumber);
+    return true;
+}
+
+int KateProjectSymbolTable::addCtagsOutput(QIODevice *device)
+{
+    int added = 0;
+    while (device->canReadLine()) {
+        const QByteArray line = device->readLine();
+        if (addCtagsLine(line.constData(), line.size())) {
+            ++added;
+        }
+    }
+    return added;
+}
+
+int KateProjectSymbolTable::addSymbols(const KateProjectSymbolTable &other, const QSet<QByteArray> &files)
+{
+    /**
+     * decide once per interned file name, not per symbol
+     */
+    QHash<quint32, bool> copyFile;
+    int added = 0;
+    for (int i = 0; i < other.size(); ++i) {
+        const quint32 file = other.m_files[i];
+        auto it = copyFile.find(file);
+        if (it == copyFile.end()) {
+            it = copyFile.insert(file, files.contains(QByteArray(other.string(file))));
+        }
+
+        if (!it.value()) {
+            continue;
+        }
+
+        addSymbol(QByteArray(other.rawName(i)), QByteArray(other.string(other.m_kinds[i])), QByteArray(other.string(file)), other.m_lines[i]);
+        ++added;
+    }
+    return added;
+}
+
+void KateProjectSymbolTable::finalize()
+{
+    /**
+     * interning map no longer needed, we will not add more strings
+     */
+    m_internedStrings = QHash<QByteArray, quint32>();
+    m_pool.squeeze();
+
+    /**
+     * sort symbols by name, then file, then line
+     */
+    const int count = m_names.size();
+    QVector<quint32> order(count);
+    for (int i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [this](quint32 a, quint32 b) {
+        if (m_names[a] != m_names[b]) {
+            const int cmp = qstrcmp(string(m_names[a]), string(m_names[b]));
+            if (cmp != 0) {
+                return cmp < 0;
+            }
+        }
+        if (m_files[a] != m_files[b]) {
+            return qstrcmp(string(m_files[a]), string(m_files[b])) < 0;
+        }
+        return m_lines[a] < m_lines[b];
+    });
+
+    /**
+     * apply the order to all columns
+     */
+    const auto permute = [&order, count](QVector<quint32> &column) {
+        QVector<quint32> sorted(count);
+        for (int i = 0; i < count; ++i) {
+            sorted[i] = column[order[i]];
+        }
+        column = sorted;
+    };
+    permute(m_names);
+    permute(m_kinds);
+    permute(m_files);
+    permute(m_lines);
+
+    /**
+     * interned names => equal names share the offset
+     * remember first symbol of each run of equal names
+     */
+    m_uniqueNames.clear();
+    for (int i = 0; i < count; ++i) {
+        if (i == 0 || m_names[i] != m_names[i - 1]) {
+            m_uniqueNames.append(i);
+        }
+    }
+    m_uniqueNames.squeeze();
+
+    /**
+     * second permutation for case-insensitive lookups
+     * ties are broken by the case-sensitive order, to keep equal names together
+     */
+    m_foldedOrder.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_foldedOrder[i] = i;
+    }
+    std::sort(m_foldedOrder.begin(), m_foldedOrder.end(), [this](quint32 a, quint32 b) {
+        const int cmp = foldedCompare(string(m_names[a]), string(m_names[b]));
+        return (cmp != 0) ? (cmp < 0) : (a < b);
+    });
+}
+
+void KateProjectSymbolTable::save(QDataStream &stream) const
+{
+    stream << m_pool << m_names << m_kinds << m_files << m_lines << m_foldedOrder << m_uniqueNames;
+}
+
+bool KateProjectSymbolTable::load(QDataStream &stream)
+{
+    clear();
+    stream >> m_pool >> m_names >> m_kinds >> m_files >> m_lines >> m_foldedOrder >> m_uniqueNames;
+
+    /**
+     * reject truncated or inconsistent data, all offsets must point into the pool
+     */
+    const int count = m_names.size();
+    bool valid = (stream.status() == QDataStream::Ok) && (m_kinds.size() == count) && (m_files.size() == count)
+                 && (m_lines.size() == count) && (m_foldedOrder.size() == count) && (m_pool.isEmpty() || m_pool.endsWith('\0'));
+    for (int i = 0; valid && i < count; ++i) {
+        valid = (m_names[i] < quint32(m_pool.size())) && (m_kinds[i] < quint32(m_pool.size())) && (m_files[i] < quint32(m_pool.size()))
+                && (m_foldedOrder[i] < quint32(count));
+    }
+    for (int i = 0; valid && i < m_uniqueNames.size(); ++i) {
+        valid = m_uniqueNames[i] < quint32(count);
+    }
+
+    if (!valid) {
+        clear();
+    }
+    return valid;
+}
+
+QVector<int> KateProjectSymbolTable::prefixMatches(const QString &prefix, Qt::CaseSensitivity caseSensitivity, bool uniqueNames, int limit) const
+{
+    QVector<int> result;
+    const QByteArray key = prefix.toLocal8Bit();
+    if (key.isEmpty() || isEmpty()) {
+        return result;
+    }
+
+    const uint keyLength = key.size();
+    const char *keyData = key.constData();
+
+    /**
+     * collect the matching range, order maps positions to symbols, if any
+     */
+    const auto collect = [&](int begin, int end, const quint32 *order) {
+        int lastSymbol = -1;
+        for (int i = begin; i < end; ++i) {
+            if (limit >= 0 && result.size() >= limit) {
+                break;
+            }
+            const int symbol = order ? int(order[i]) : i;
+            if (uniqueNames && lastSymbol >= 0 && m_names[lastSymbol] == m_names[symbol]) {
+                continue;
+            }
+            result.append(symbol);
+            lastSymbol = symbol;
+        }
+    };
+
+    /**
+     * the names column itself is sorted case-sensitive
+     */
+    if (caseSensitivity == Qt::CaseSensitive) {
+        const auto lower = std::lower_bound(m_names.constBegin(), m_names.constEnd(), keyData, [this, keyLength](quint32 name, const char *key) {
+            return qstrncmp(string(name), key, keyLength) < 0;
+        });
+        const auto upper = std::upper_bound(lower, m_names.constEnd(), keyData, [this, keyLength](const char *key, quint32 name) {
+            return qstrncmp(string(name), key, keyLength) > 0;
+        });
+        collect(lower - m_names.constBegin(), upper - m_names.constBegin(), nullptr);
+        return result;
+    }
+
+    /**
+     * else use the case folded permutation
+     */
+    const auto lower = std::lower_bound(m_foldedOrder.constBegin(), m_foldedOrder.constEnd(), keyData, [this, keyLength](quint32 symbol, const char *key) {
+        return foldedCompare(rawName(symbol), key, int(keyLength)) < 0;
+    });
+    const auto upper = std::upper_bound(lower, m_foldedOrder.constEnd(), keyData, [this, keyLength](const char *key, quint32 symbol) {
+        return foldedCompare(rawName(symbol), key, int(keyLength)) > 0;
+    });
+    collect(lower - m_foldedOrder.constBegin(), upper - m_foldedOrder.constBegin(), m_foldedOrder.constData());
+    return result;
+}
+
+int KateProjectSymbolTable::fuzzyScore(const char *pattern, int patternLength, const char *candidate)
+{
+    int score = 0;
+    int matched = 0;
+    int lastMatch = -2;
+    int i = 0;
+    for (; candidate[i] && matched < patternLength; ++i) {
+        const char c = candidate[i];
+        if (foldCase(c) != pattern[matched]) {
+            continue;
+        }
+
+        /**
+         * prefer matches at the start, consecutive matches and word starts
+         * word starts are after _ or : or on camel case humps
+         */
+        int bonus = 1;
+        if (i == 0) {
+            bonus += 8;
+        } else if (lastMatch == i - 1) {
+            bonus += 5;
+        } else {
+            const char previous = candidate[i - 1];
+            if (previous == '_' || previous == ':' || previous == '.' || (isUpper(c) && isLower(previous))) {
+                bonus += 4;
+            }
+        }
+
+        score += bonus;
+        lastMatch = i;
+        ++matched;
+    }
+
+    if (matched < patternLength) {
+        return -1;
+    }
+
+    /**
+     * shorter candidates win on equal match quality
+     */
+    const int length = i + int(qstrlen(candidate + i));
+    return score * 64 - qMin(length, 63);
+}
+
+QVector<int> KateProjectSymbolTable::fuzzyMatches(const QString &pattern, int limit, const QVector<quint32> *within, QVector<quint32> *matching) const
+{
+    QVector<int> result;
+    if (matching) {
+        matching->clear();
+    }
+
+    QByteArray key = pattern.toLocal8Bit();
+    if (key.isEmpty() || limit <= 0 || isEmpty()) {
+        return result;
+    }
+    for (int i = 0; i < key.size(); ++i) {
+        key[i] = foldCase(key[i]);
+    }
+
+    /**
+     * keep the best limit matches in a min heap, worst match on top
+     * equal scores are ordered by name, as the symbols are sorted by name
+     */
+    typedef QPair<int, int> ScoredSymbol;
+    const auto better = [](const ScoredSymbol &a, const ScoredSymbol &b) {
+        return (a.first != b.first) ? (a.first > b.first) : (a.second < b.second);
+    };
+
+    QVector<ScoredSymbol> heap;
+    heap.reserve(limit + 1);
+    for (const quint32 symbol : (within ? *within : m_uniqueNames)) {
+        const int score = fuzzyScore(key.constData(), key.size(), rawName(symbol));
+        if (score < 0) {
+            continue;
+        }
+
+        if (matching) {
+            matching->append(symbol);
+        }
+
+        const ScoredSymbol scored(score, int(symbol));
+        if (heap.size() < limit) {
+            heap.append(scored);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(scored, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = scored;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), better);
+    result.reserve(heap.size());
+    for (const ScoredSymbol &scored : heap) {
+        result.append(scored.second);
+    }
+    return result;
+}
@@ -0,0 +1,248 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_SYMBOL_TABLE_H
+#define KATE_PROJECT_SYMBOL_TABLE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class QDataStream;
+class QIODevice;
+
+/**
+ * Compact in-memory symbol table, filled from ctags output.
+ *
+ * All strings (names, kinds, files) are interned into one byte pool,
+ * the symbols themselves are just four parallel integer columns.
+ * After finalize() the columns are sorted by name, which allows
+ * O(log n) prefix lookups, a second permutation allows the same
+ * for case-insensitive lookups.
+ *
+ * The table is filled once, e.g. inside the project worker thread,
+ * afterwards it is read-only and can be queried from any thread.
+ */
+class KateProjectSymbolTable
+{
+public:
+    /**
+     * construct empty table
+     */
+    KateProjectSymbolTable();
+
+    /**
+     * remove all symbols and strings
+     */
+    void clear();
+
+    /**
+     * Add one line of ctags output, e.g.
+     * "name<TAB>file<TAB>address;"<TAB>kind<TAB>line:42".
+     * Pseudo tags and malformed lines are skipped.
+     * Only valid before finalize() is called.
+     * @param line start of line, doesn't need to be 0 terminated
+     * @param length length of line, trailing line break is allowed
+     * @return true if a symbol was added
+     */
+    bool addCtagsLine(const char *line, int length);
+
+    /**
+     * Add one symbol.
+     * Only valid before finalize() is called.
+     * @param name symbol name
+     * @param kind symbol kind, like "function"
+     * @param file file containing the symbol
+     * @param line line of the symbol, starting at 1, 0 if unknown
+     */
+    void addSymbol(const QByteArray &name, const QByteArray &kind, const QByteArray &file, int line);
+
+    /**
+     * Read all complete lines of ctags output currently available from the device.
+     * Can be called repeatedly while e.g. a ctags process is still writing.
+     * Only valid before finalize() is called.
+     * @param device device to read from, must be open
+     * @return number of added symbols
+     */
+    int addCtagsOutput(QIODevice *device);
+
+    /**
+     * Copy all symbols of the given table that are located in one of the given files.
+     * Only valid before finalize() is called.
+     * @param other table to copy from
+     * @param files files to copy symbols for, as stored in the file column
+     * @return number of added symbols
+     */
+    int addSymbols(const KateProjectSymbolTable &other, const QSet<QByteArray> &files);
+
+    /**
+     * Sort the columns and build the lookup structures.
+     * Must be called once after all symbols are added.
+     */
+    void finalize();
+
+    /**
+     * Write a finalized table to the given stream.
+     * @param stream stream to write to
+     */
+    void save(QDataStream &stream) const;
+
+    /**
+     * Read a finalized table from the given stream, written by save().
+     * On failure the table is empty.
+     * @param stream stream to read from
+     * @return success
+     */
+    bool load(QDataStream &stream);
+
+    /**
+     * Number of symbols in the table.
+     * @return symbol count
+     */
+    int size() const {
+        return m_names.size();
+    }
+
+    /**
+     * Any symbols around?
+     * @return true if empty
+     */
+    bool isEmpty() const {
+        return m_names.isEmpty();
+    }
+
+    /**
+     * Accessors for the columns of one symbol.
+     * @param symbol symbol index, 0 <= symbol < size()
+     */
+    QString name(int symbol) const {
+        return QString::fromLocal8Bit(rawName(symbol));
+    }
+
+    QString kind(int symbol) const {
+        return QString::fromLocal8Bit(string(m_kinds[symbol]));
+    }
+
+    QString file(int symbol) const {
+        return QString::fromLocal8Bit(string(m_files[symbol]));
+    }
+
+    int line(int symbol) const {
+        return m_lines[symbol];
+    }
+
+    const char *rawName(int symbol) const {
+        return string(m_names[symbol]);
+    }
+
+    const char *rawKind(int symbol) const {
+        return string(m_kinds[symbol]);
+    }
+
+    const char *rawFile(int symbol) const {
+        return string(m_files[symbol]);
+    }
+
+    /**
+     * Find all symbols whose name starts with the given prefix.
+     * The result is sorted by name.
+     * @param prefix prefix to search for, must not be empty
+     * @param caseSensitivity match case or not, insensitive matching only folds ASCII, as the sorting and fuzzyMatches()
+     * @param uniqueNames return only the first symbol for each distinct name
+     * @param limit maximal number of results, -1 for no limit
+     * @return matching symbol indices
+     */
+    QVector<int> prefixMatches(const QString &prefix, Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive, bool uniqueNames = false, int limit = -1) const;
+
+    /**
+     * Find symbols whose name contains the pattern as subsequence,
+     * ignoring ASCII case. The result is ranked, best matches first.
+     * Only the first symbol for each distinct name is returned.
+     * For incremental searches, pass the matching symbols of a shorter pattern
+     * the new one starts with, only those are scored again.
+     * @param pattern pattern to search for, must not be empty
+     * @param limit maximal number of results
+     * @param within first symbols of distinct names to consider, ascending, null for all
+     * @param matching if not null, filled with all matching first symbols, ascending
+     * @return matching symbol indices, best first
+     */
+    QVector<int> fuzzyMatches(const QString &pattern, int limit, const QVector<quint32> *within = nullptr, QVector<quint32> *matching = nullptr) const;
+
+    /**
+     * Score how well the lower-cased pattern matches the candidate as subsequence.
+     * Matches at the start of the candidate, at word boundaries and consecutive
+     * matches are preferred, short candidates win over long ones.
+     * @param pattern lower-cased pattern
+     * @param patternLength length of pattern
+     * @param candidate 0 terminated candidate string
+     * @return score, higher is better, -1 if pattern is no subsequence of candidate
+     */
+    static int fuzzyScore(const char *pattern, int patternLength, const char *candidate);
+
+private:
+    /**
+     * get string from pool
+     * @param offset offset of string in pool
+     * @return 0 terminated string
+     */
+    const char *string(quint32 offset) const {
+        return m_pool.constData() + offset;
+    }
+
+    /**
+     * intern the given string into the pool
+     * @param text string to intern
+     * @return offset in pool
+     */
+    quint32 intern(const QByteArray &text);
+
+private:
+    /**
+     * all strings, each 0 terminated
+     */
+    QByteArray m_pool;
+
+    /**
+     * string => offset in pool, only needed until finalize()
+     */
+    QHash<QByteArray, quint32> m_internedStrings;
+
+    /**
+     * symbol columns, after finalize() sorted by name
+     */
+    QVector<quint32> m_names;
+    QVector<quint32> m_kinds;
+    QVector<quint32> m_files;
+    QVector<quint32> m_lines;
+
+    /**
+     * symbol indices sorted case-insensitive by name
+     */
+    QVector<quint32> m_foldedOrder;
+
+    /**
+     * first symbol index for each distinct name
+     */
+    QVector<quint32> m_uniqueNames;
+};
+
+#endif
@@ -0,0 +1,249 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#include "kateprojecttree.h"
+
+#include <algorithm>
+
+namespace
+{
+inline quint64 anchorKey(quint32 directory, quint32 segment)
+{
+    return (quint64(directory) << 32) | segment;
+}
+}
+
+KateProjectTree::KateProjectTree()
+    : m_fileCount(0)
+{
+    /**
+     * invisible root node
+     */
+    addNode(0, Project, QString());
+}
+
+quint32 KateProjectTree::intern(const QString &segment)
+{
+    const auto it = m_segmentIds.constFind(segment);
+    if (it != m_segmentIds.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 id = m_segments.size();
+    m_segments.append(segment);
+    m_segmentIds.insert(segment, id);
+    return id;
+}
+
+int KateProjectTree::addNode(int parent, Type type, const QString &name)
+{
+    const Node node = { quint32(parent), intern(name), 0, 0, 0, quint8(type) };
+    m_nodes.append(node);
+
+    if (type == File) {
+        ++m_fileCount;
+    }
+
+    return m_nodes.size() - 1;
+}
+
+void KateProjectTree::setAnchor(int node, const QString &directory)
+{
+    m_anchors.insert(node, intern(directory));
+}
+
+void KateProjectTree::finalize()
+{
+    /**
+     * count children, the root node is its own parent and skipped
+     */
+    const int count = m_nodes.size();
+    for (int i = 1; i < count; ++i) {
+        ++m_nodes[m_nodes[i].parent].childCount;
+    }
+
+    /**
+     * assign ranges
+     */
+    quint32 offset = 0;
+    for (int i = 0; i < count; ++i) {
+        m_nodes[i].firstChild = offset;
+        offset += m_nodes[i].childCount;
+    }
+
+    /**
+     * fill child lists, keeps insertion order
+     */
+    m_children.resize(offset);
+    QVector<quint32> filled(count, 0);
+    for (int i = 1; i < count; ++i) {
+        Node &parent = m_nodes[m_nodes[i].parent];
+        const quint32 row = filled[m_nodes[i].parent]++;
+        m_children[parent.firstChild + row] = i;
+        m_nodes[i].row = row;
+    }
+
+    /**
+     * same child lists sorted by segment for the lookups, stable to keep the first match first
+     */
+    m_childrenBySegment = m_children;
+    for (int i = 0; i < count; ++i) {
+        const auto begin = m_childrenBySegment.begin() + m_nodes[i].firstChild;
+        std::stable_sort(begin, begin + m_nodes[i].childCount, [this](quint32 a, quint32 b) {
+            return m_nodes[a].segment < m_nodes[b].segment;
+        });
+    }
+
+    /**
+     * lookup structures for anchored nodes
+     */
+    for (auto it = m_anchors.constBegin(); it != m_anchors.constEnd(); ++it) {
+        if (!m_anchorDirectories.contains(it.value())) {
+            m_anchorDirectories.append(it.value());
+        }
+        m_anchoredNodes.insert(anchorKey(it.value(), m_nodes[it.key()].segment), it.key());
+    }
+
+    m_nodes.squeeze();
+    m_segments.squeeze();
+}
+
+QString KateProjectTree::parentPath(int node, QHash<int, QString> &cache) const
+{
+    /**
+     * anchored => we know the directory
+     */
+    const auto anchor = m_anchors.constFind(node);
+    if (anchor != m_anchors.constEnd()) {
+        return m_segments[anchor.value()] + QLatin1Char('/');
+    }
+
+    /**
+     * else we need a directory as parent
+     */
+    const int parent = m_nodes[node].parent;
+    if (parent == rootNode() || type(parent) != Directory) {
+        return QString();
+    }
+
+    const auto cached = cache.constFind(parent);
+    if (cached != cache.constEnd()) {
+        return cached.value();
+    }
+
+    QString path = parentPath(parent, cache);
+    if (!path.isEmpty()) {
+        path += name(parent) + QLatin1Char('/');
+    }
+    cache.insert(parent, path);
+    return path;
+}
+
+QString KateProjectTree::filePath(int node) const
+{
+    if (node <= rootNode() || type(node) == Project) {
+        return QString();
+    }
+
+    QHash<int, QString> cache;
+    const QString path = parentPath(node, cache);
+    return path.isEmpty() ? QString() : (path + name(node));
+}
+
+int KateProjectTree::findChild(int node, quint32 segment) const
+{
+    const Node &parent = m_nodes[node];
+    const auto begin = m_childrenBySegment.constBegin() + parent.firstChild;
+    const auto end = begin + parent.childCount;
+    const auto it = std::lower_bound(begin, end, segment, [this](quint32 child, quint32 wanted) {
+        return m_nodes[child].segment < wanted;
+    });
+    return (it != end && m_nodes[*it].segment == segment) ? int(*it) : -1;
+}
+
+int KateProjectTree::nodeForFile(const QString &filePath) const
+{
+    for (const quint32 directoryId : m_anchorDirectories) {
+        /**
+         * file must be below the anchor directory
+         */
+        const QString &directory = m_segments[directoryId];
+        if (filePath.size() <= directory.size() + 1 || !filePath.startsWith(directory) || filePath.at(directory.size()) != QLatin1Char('/')) {
+            continue;
+        }
+
+        /**
+         * all segments must be known, else the file can't be in the tree
+         */
+        const QVector<QStringRef> parts = filePath.midRef(directory.size() + 1).split(QLatin1Char('/'));
+        QVector<quint32> segments;
+        segments.reserve(parts.size());
+        for (const QStringRef &part : parts) {
+            const auto it = m_segmentIds.constFind(part.toString());
+            if (it == m_segmentIds.constEnd()) {
+                break;
+            }
+            segments.append(it.value());
+        }
+        if (segments.size() != parts.size()) {
+            continue;
+        }
+
+        /**
+         * descend from each anchored node matching the first segment
+         */
+        const auto candidates = m_anchoredNodes.values(anchorKey(directoryId, segments.first()));
+        for (const quint32 candidate : candidates) {
+            int node = candidate;
+            for (int i = 1; node >= 0 && i < segments.size(); ++i) {
+                node = findChild(node, segments[i]);
+            }
+
+            if (node >= 0 && type(node) == File) {
+                return node;
+            }
+        }
+    }
+
+    return -1;
+}
+
+QStringList KateProjectTree::files() const
+{
+    QStringList files;
+    files.reserve(m_fileCount);
+
+    /**
+     * cache the directory paths, each is needed for all files inside
+     */
+    QHash<int, QString> cache;
+    for (int i = 1; i < m_nodes.size(); ++i) {
+        if (type(i) != File) {
+            continue;
+        }
+
+        const QString path = parentPath(i, cache);
+        if (!path.isEmpty()) {
+            files.append(path + name(i));
+        }
+    }
+
+    return files;
+}
@@ -0,0 +1,223 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PROJECT_TREE_H
+#define KATE_PROJECT_TREE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Compact tree of projects, directories and files.
+ *
+ * All nodes live in one flat array, they only know their parent, their
+ * interned name segment and the range of their children. Full paths are
+ * not stored, they are reconstructed on demand from the segments.
+ * Nodes that start a files entry are anchored at the directory of that entry.
+ *
+ * The tree is built in the project worker thread, finalized and afterwards
+ * only read, no locking needed.
+ */
+class KateProjectTree
+{
+public:
+    /**
+     * Possible node types
+     */
+    enum Type {
+        Project
+        , Directory
+        , File
+    };
+
+    /**
+     * construct tree with just the invisible root node
+     */
+    KateProjectTree();
+
+    /**
+     * the invisible root node, parent of all toplevel nodes
+     * @return root node
+     */
+    static int rootNode() {
+        return 0;
+    }
+
+    /**
+     * Add a new node below the given parent.
+     * Only valid before finalize() is called.
+     * @param parent parent node
+     * @param type type of the new node
+     * @param name display name, for files and directories one path segment
+     * @return new node
+     */
+    int addNode(int parent, Type type, const QString &name);
+
+    /**
+     * Anchor a node at a directory, the paths of this node and all nodes below
+     * are relative to this directory.
+     * @param node node to anchor
+     * @param directory directory path, without trailing slash
+     */
+    void setAnchor(int node, const QString &directory);
+
+    /**
+     * Build the child ranges. Must be called once after all nodes are added.
+     */
+    void finalize();
+
+    /**
+     * Number of nodes, including the root node.
+     * @return node count
+     */
+    int nodeCount() const {
+        return m_nodes.size();
+    }
+
+    /**
+     * Number of file nodes.
+     * @return file count
+     */
+    int fileCount() const {
+        return m_fileCount;
+    }
+
+    /**
+     * Accessors for nodes, only valid after finalize().
+     */
+    int parent(int node) const {
+        return m_nodes[node].parent;
+    }
+
+    int row(int node) const {
+        return m_nodes[node].row;
+    }
+
+    int childCount(int node) const {
+        return m_nodes[node].childCount;
+    }
+
+    int child(int node, int row) const {
+        return m_children[m_nodes[node].firstChild + row];
+    }
+
+    Type type(int node) const {
+        return Type(m_nodes[node].type);
+    }
+
+    const QString &name(int node) const {
+        return m_segments[m_nodes[node].segment];
+    }
+
+    /**
+     * Reconstruct the full path of a file or directory node.
+     * @param node node to get path for
+     * @return full path, empty for projects or nodes without anchor
+     */
+    QString filePath(int node) const;
+
+    /**
+     * Find the node for the given file.
+     * @param filePath full path of the file
+     * @return file node or -1 if not part of the tree
+     */
+    int nodeForFile(const QString &filePath) const;
+
+    /**
+     * All files in the tree, in tree order.
+     * @return full paths of all files
+     */
+    QStringList files() const;
+
+private:
+    /**
+     * intern a path segment
+     * @param segment segment
+     * @return segment id
+     */
+    quint32 intern(const QString &segment);
+
+    /**
+     * Find child of given node by segment, binary search.
+     * @param node node to search children of
+     * @param segment interned segment
+     * @return child node or -1
+     */
+    int findChild(int node, quint32 segment) const;
+
+    /**
+     * Directory path of the given node, with trailing slash.
+     * @param node directory or file node
+     * @param cache cache for directory paths
+     * @return path of the directory containing the node, empty if none
+     */
+    QString parentPath(int node, QHash<int, QString> &cache) const;
+
+private:
+    /**
+     * one node, children are m_children[firstChild, firstChild + childCount)
+     */
+    struct Node {
+        quint32 parent;
+        quint32 segment;
+        quint32 firstChild;
+        quint32 childCount;
+        quint32 row;
+        quint8 type;
+    };
+
+    QVector<Node> m_nodes;
+
+    /**
+     * child node lists of all nodes, concatenated
+     */
+    QVector<quint32> m_children;
+
+    /**
+     * the same child lists, each sorted by segment id, for binary search in findChild()
+     */
+    QVector<quint32> m_childrenBySegment;
+
+    /**
+     * interned segments and lookup
+     */
+    QVector<QString> m_segments;
+    QHash<QString, quint32> m_segmentIds;
+
+    /**
+     * anchored node => segment id of its directory
+     */
+    QHash<quint32, quint32> m_anchors;
+
+    /**
+     * distinct anchor directories and (directory << 32 | segment) => anchored nodes, for lookups
+     */
+    QVector<quint32> m_anchorDirectories;
+    QMultiHash<quint64, quint32> m_anchoredNodes;
+
+    /**
+     * number of files
+     */
+    int m_fileCount;
+};
+
+#endif
@@ -27,6 +27,7 @@
 #include <KLineEdit>
 #include <KLocalizedString>
 
+#include <QProgressBar>
 #include <QSortFilterProxyModel>
 #include <QVBoxLayout>
 #include <QTimer>
@@ -37,6 +38,7 @@ KateProjectView::KateProjectView(KateProjectPluginView *pluginView, KateProject
     , m_project(project)
     , m_treeView(new KateProjectViewTree(pluginView, project))
     , m_filter(new KLineEdit())
+    , m_loadProgress(new QProgressBar())
 {
     /**
      * layout tree view and co.
@@ -45,6 +47,7 @@ KateProjectView::KateProjectView(KateProjectPluginView *pluginView, KateProject
     layout->setSpacing(0);
     layout->setContentsMargins(0, 0, 0, 0);
     layout->addWidget(m_treeView);
+    layout->addWidget(m_loadProgress);
     layout->addWidget(m_filter);
     setLayout(layout);
 
@@ -54,6 +57,13 @@ KateProjectView::KateProjectView(KateProjectPluginView *pluginView, KateProject
     m_filter->setPlaceholderText(i18n("Search"));
     m_filter->setClearButtonEnabled(true);
     connect(m_filter, &KLineEdit::textChanged, this, &KateProjectView::filterTextChanged);
+
+    /**
+     * setup progress
+     */
+    m_loadProgress->setTextVisible(true);
+    connect(m_project, &KateProject::loadProgressChanged, this, &KateProjectView::slotLoadProgressChanged);
+    slotLoadProgressChanged();
 }
 
 KateProjectView::~KateProjectView()
@@ -85,3 +95,24 @@ void KateProjectView::filterTextChanged(QString filterText)
     }
 }
 
+void KateProjectView::slotLoadProgressChanged()
+{
+    if (!m_project->isLoading()) {
+        m_loadProgress->hide();
+        return;
+    }
+
+    /**
+     * listing: total unknown, busy indicator
+     * indexing: indexed of listed files
+     */
+    if (m_project->loadFilesIndexed() < 0) {
+        m_loadProgress->setRange(0, 0);
+        m_loadProgress->setFormat(i18n("Listing files: %1", m_project->loadFilesListed()));
+    } else {
+        m_loadProgress->setRange(0, qMax(1, m_project->loadFilesListed()));
+        m_loadProgress->setValue(qMin(m_project->loadFilesIndexed(), m_project->loadFilesListed()));
+        m_loadProgress->setFormat(i18n("Indexing files: %1/%2", m_project->loadFilesIndexed(), m_project->loadFilesListed()));
+    }
+    m_loadProgress->show();
+}
@@ -25,6 +25,7 @@
 #include "kateprojectviewtree.h"
 
 class KLineEdit;
+class QProgressBar;
 class KateProjectPluginView;
 
 /**
@@ -74,6 +75,11 @@ private Q_SLOTS:
      */
     void filterTextChanged(QString filterText);
 
+    /**
+     * Show loading progress of the project, hidden if done.
+     */
+    void slotLoadProgressChanged();
+
 private:
     /**
      * our plugin view
@@ -94,6 +100,11 @@ private:
      * filter
      */
     KLineEdit *m_filter;
+
+    /**
+     * loading progress
+     */
+    QProgressBar *m_loadProgress;
 };
 
 #endif
@@ -75,7 +75,7 @@ private Q_SLOTS:
 
     /**
      * Triggered on model changes.
-     * This includes the files list, itemForFile mapping!
+     * This includes the files list, indexForFile mapping!
      */
     void slotModelChanged();
 
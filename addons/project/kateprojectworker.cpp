@@ -23,6 +23,7 @@
 
 #include <QDir>
 #include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QProcess>
@@ -31,11 +32,14 @@
 #include <QTime>
 #include <QSettings>
 
-KateProjectWorker::KateProjectWorker(const QString &baseDir, const QVariantMap &projectMap)
+KateProjectWorker::KateProjectWorker(const QString &baseDir, const QVariantMap &projectMap, int generation, const QSharedPointer<QAtomicInt> &currentGeneration)
     : QObject()
     , ThreadWeaver::Job()
     , m_baseDir(baseDir)
     , m_projectMap(projectMap)
+    , m_generation(generation)
+    , m_currentGeneration(currentGeneration)
+    , m_priority(BackgroundPriority)
 {
     Q_ASSERT(!m_baseDir.isEmpty());
 }
@@ -43,19 +47,35 @@ KateProjectWorker::KateProjectWorker(const QString &baseDir, const QVariantMap &
 void KateProjectWorker::run(ThreadWeaver::JobPointer, ThreadWeaver::Thread *)
 {
     /**
-     * Create dummy top level parent item and empty map inside shared pointers
+     * superseded while waiting in the queue?
+     */
+    if (isStale()) {
+        return;
+    }
+
+    /**
+     * Create new tree inside shared pointer
      * then load the project recursively
      */
-    KateProjectSharedQStandardItem topLevel(new QStandardItem());
-    KateProjectSharedQMapStringItem file2Item(new QMap<QString, KateProjectItem *> ());
-    loadProject(topLevel.data(), m_projectMap, file2Item.data());
+    KateProjectSharedProjectTree tree(new KateProjectTree());
+    {
+        QSet<QString> seenFiles;
+        loadProject(tree.data(), KateProjectTree::rootNode(), m_projectMap, &seenFiles);
+    }
+
+    if (isStale()) {
+        return;
+    }
+
+    tree->finalize();
 
     /**
      * create some local backup of some data we need for further processing!
      */
-    QStringList files = file2Item->keys();
+    const QStringList files = tree->files();
 
-    emit loadDone(topLevel, file2Item);
+    emit loadDone(m_generation, tree);
+    emit loadProgress(m_generation, files.size(), 0);
 
     /**
      * load index
@@ -63,7 +83,7 @@ void KateProjectWorker::run(ThreadWeaver::JobPointer, ThreadWeaver::Thread *)
     loadIndex(files);
 }
 
-void KateProjectWorker::loadProject(QStandardItem *parent, const QVariantMap &project, QMap<QString, KateProjectItem *> *file2Item)
+void KateProjectWorker::loadProject(KateProjectTree *tree, int parent, const QVariantMap &project, QSet<QString> *seenFiles)
 {
     /**
      * recurse to sub-projects FIRST
@@ -82,9 +102,8 @@ void KateProjectWorker::loadProject(QStandardItem *parent, const QVariantMap &pr
         /**
          * recurse
          */
-        QStandardItem *subProjectItem = new KateProjectItem(KateProjectItem::Project, subProject[keyName].toString());
-        loadProject(subProjectItem, subProject, file2Item);
-        parent->appendRow(subProjectItem);
+        const int subProjectNode = tree->addNode(parent, KateProjectTree::Project, subProject[keyName].toString());
+        loadProject(tree, subProjectNode, subProject, seenFiles);
     }
 
     /**
@@ -93,17 +112,19 @@ void KateProjectWorker::loadProject(QStandardItem *parent, const QVariantMap &pr
     const QString keyFiles = QStringLiteral("files");
     QVariantList files = project[keyFiles].toList();
     for (const QVariant &fileVariant : files) {
-        loadFilesEntry(parent, fileVariant.toMap(), file2Item);
+        loadFilesEntry(tree, parent, fileVariant.toMap(), seenFiles);
     }
 }
 
 /**
- * small helper to construct directory parent items
- * @param dir2Item map for path => item
- * @param path current path we need item for
- * @return correct parent item for given path, will reuse existing ones
+ * small helper to construct directory parent nodes
+ * @param tree tree to add directory nodes to
+ * @param dir2Node map for path => node
+ * @param path current path we need node for
+ * @param anchor directory the toplevel nodes are anchored at
+ * @return correct parent node for given path, will reuse existing ones
  */
-static QStandardItem *directoryParent(QMap<QString, QStandardItem *> &dir2Item, QString path)
+static int directoryParent(KateProjectTree *tree, QHash<QString, int> &dir2Node, QString path, const QString &anchor)
 {
     /**
      * throw away simple /
@@ -115,8 +136,9 @@ static QStandardItem *directoryParent(QMap<QString, QStandardItem *> &dir2Item,
     /**
      * quick check: dir already seen?
      */
-    if (dir2Item.contains(path)) {
-        return dir2Item[path];
+    const auto it = dir2Node.constFind(path);
+    if (it != dir2Node.constEnd()) {
+        return it.value();
     }
 
     /**
@@ -126,12 +148,13 @@ static QStandardItem *directoryParent(QMap<QString, QStandardItem *> &dir2Item,
 
     /**
      * no slash?
-     * simple, no recursion, append new item toplevel
+     * simple, no recursion, append new node toplevel
      */
     if (slashIndex < 0) {
-        dir2Item[path] = new KateProjectItem(KateProjectItem::Directory, path);
-        dir2Item[QString()]->appendRow(dir2Item[path]);
-        return dir2Item[path];
+        const int node = tree->addNode(dir2Node[QString()], KateProjectTree::Directory, path);
+        tree->setAnchor(node, anchor);
+        dir2Node[path] = node;
+        return node;
     }
 
     /**
@@ -144,19 +167,26 @@ static QStandardItem *directoryParent(QMap<QString, QStandardItem *> &dir2Item,
      * special handling if / with nothing on one side are found
      */
     if (leftPart.isEmpty() || rightPart.isEmpty()) {
-        return directoryParent(dir2Item, leftPart.isEmpty() ? rightPart : leftPart);
+        return directoryParent(tree, dir2Node, leftPart.isEmpty() ? rightPart : leftPart, anchor);
     }
 
     /**
      * else: recurse on left side
      */
-    dir2Item[path] = new KateProjectItem(KateProjectItem::Directory, rightPart);
-    directoryParent(dir2Item, leftPart)->appendRow(dir2Item[path]);
-    return dir2Item[path];
+    const int node = tree->addNode(directoryParent(tree, dir2Node, leftPart, anchor), KateProjectTree::Directory, rightPart);
+    dir2Node[path] = node;
+    return node;
 }
 
-void KateProjectWorker::loadFilesEntry(QStandardItem *parent, const QVariantMap &filesEntry, QMap<QString, KateProjectItem *> *file2Item)
+void KateProjectWorker::loadFilesEntry(KateProjectTree *tree, int parent, const QVariantMap &filesEntry, QSet<QString> *seenFiles)
 {
+    /**
+     * nothing more to do for superseded loads
+     */
+    if (isStale()) {
+        return;
+    }
+
     QDir dir(m_baseDir);
     if (!dir.cd(filesEntry[QStringLiteral("directory")].toString())) {
         return;
@@ -171,16 +201,17 @@ void KateProjectWorker::loadFilesEntry(QStandardItem *parent, const QVariantMap
     files.sort();
 
     /**
-     * construct paths first in tree and items in a map
+     * construct paths first in tree and nodes in a map
+     * all nodes directly below the parent are anchored at the entry directory
      */
-    QMap<QString, QStandardItem *> dir2Item;
-    dir2Item[QString()] = parent;
-    QList<QPair<QStandardItem *, QStandardItem *> > item2ParentPath;
+    const QString anchor = dir.absolutePath() == QStringLiteral("/") ? QString() : dir.absolutePath();
+    QHash<QString, int> dir2Node;
+    dir2Node[QString()] = parent;
     for (const QString &filePath : files) {
         /**
           * skip dupes
           */
-        if (file2Item->contains(filePath)) {
+        if (seenFiles->contains(filePath)) {
             continue;
         }
 
@@ -192,13 +223,6 @@ void KateProjectWorker::loadFilesEntry(QStandardItem *parent, const QVariantMap
             continue;
         }
 
-        /**
-         * construct the item with right directory prefix
-         * already hang in directories in tree
-         */
-        KateProjectItem *fileItem = new KateProjectItem(KateProjectItem::File, fileInfo.fileName());
-        fileItem->setData(filePath, Qt::ToolTipRole);
-
         // get the directory's relative path to the base directory
         QString dirRelPath = dir.relativeFilePath(fileInfo.absolutePath());
         // if the relative path is ".", clean it up
@@ -206,19 +230,18 @@ void KateProjectWorker::loadFilesEntry(QStandardItem *parent, const QVariantMap
             dirRelPath = QString();
         }
 
-        item2ParentPath.append(QPair<QStandardItem *, QStandardItem *>(fileItem, directoryParent(dir2Item, dirRelPath)));
-        fileItem->setData(filePath, Qt::UserRole);
-        (*file2Item)[filePath] = fileItem;
+        /**
+         * construct the node with right directory prefix
+         */
+        const int directoryNode = directoryParent(tree, dir2Node, dirRelPath, anchor);
+        const int fileNode = tree->addNode(directoryNode, KateProjectTree::File, fileInfo.fileName());
+        if (directoryNode == parent) {
+            tree->setAnchor(fileNode, anchor);
+        }
+        seenFiles->insert(filePath);
     }
 
-    /**
-     * plug in the file items to the tree
-     */
-    auto i = item2ParentPath.constBegin();
-    while (i != item2ParentPath.constEnd()) {
-        i->second->appendRow(i->first);
-        ++i;
-    }
+    emit loadProgress(m_generation, tree->fileCount(), -1);
 }
 
 QStringList KateProjectWorker::findFiles(const QDir &dir, const QVariantMap& filesEntry)
@@ -496,12 +519,33 @@ QStringList KateProjectWorker::filesFromDirectory(const QDir &_dir, bool recursi
 
 void KateProjectWorker::loadIndex(const QStringList &files)
 {
+    /**
+     * report progress at most every 100 ms, stop if superseded
+     */
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+    const auto progress = [this, &files, &progressTimer](int filesIndexed) {
+        if (isStale()) {
+            return false;
+        }
+
+        if (progressTimer.elapsed() >= 100) {
+            emit loadProgress(m_generation, files.size(), filesIndexed);
+            progressTimer.restart();
+        }
+        return true;
+    };
+
     /**
      * create new index, this will do the loading in the constructor
      * wrap it into shared pointer for transfer to main thread
      */
     const QString keyCtags = QStringLiteral("ctags");
-    KateProjectSharedProjectIndex index(new KateProjectIndex(files, m_projectMap[keyCtags].toMap()));
+    KateProjectSharedProjectIndex index(new KateProjectIndex(m_baseDir, files, m_projectMap[keyCtags].toMap(), progress));
+
+    if (isStale()) {
+        return;
+    }
 
-    emit loadIndexDone(index);
+    emit loadIndexDone(m_generation, index);
 }
@@ -21,19 +21,21 @@
 #ifndef KATE_PROJECT_WORKER_H
 #define KATE_PROJECT_WORKER_H
 
-#include "kateprojectitem.h"
 #include "kateproject.h"
 
 #include <ThreadWeaver/Job>
 
-#include <QStandardItemModel>
-#include <QMap>
+#include <QAtomicInt>
+#include <QSet>
 
 class QDir;
 
 /**
  * Class representing a project background worker.
  * This worker will build up the model for the project on load and do other stuff in the background.
+ *
+ * A worker is superseded as soon as a newer load for the same project is started,
+ * it will then stop as early as possible and not report anything.
  */
 class KateProjectWorker : public QObject, public ThreadWeaver::Job
 {
@@ -41,35 +43,75 @@ class KateProjectWorker : public QObject, public ThreadWeaver::Job
 
 public:
     /**
-     * Type for QueuedConnection
+     * Job priorities, the project of the active document is loaded first.
      */
-    typedef QMap<QString, KateProjectItem *> MapString2Item;
+    enum Priority {
+        BackgroundPriority = 0,
+        ActivePriority = 1
+    };
 
-    explicit KateProjectWorker(const QString &baseDir, const QVariantMap &projectMap);
+    /**
+     * construct new load job
+     * @param baseDir project base directory
+     * @param projectMap project description
+     * @param generation generation of this load
+     * @param currentGeneration generation of the newest load of the project
+     */
+    KateProjectWorker(const QString &baseDir, const QVariantMap &projectMap, int generation, const QSharedPointer<QAtomicInt> &currentGeneration);
 
     void run(ThreadWeaver::JobPointer self, ThreadWeaver::Thread *thread) override;
 
+    int priority() const override {
+        return m_priority.load();
+    }
+
+    /**
+     * Change the priority, only has an effect before the job is queued.
+     * @param priority new priority
+     */
+    void setPriority(Priority priority) {
+        m_priority.store(priority);
+    }
+
 Q_SIGNALS:
-    void loadDone(KateProjectSharedQStandardItem topLevel, KateProjectSharedQMapStringItem file2Item);
-    void loadIndexDone(KateProjectSharedProjectIndex index);
+    void loadDone(int generation, KateProjectSharedProjectTree tree);
+    void loadIndexDone(int generation, KateProjectSharedProjectIndex index);
+
+    /**
+     * Progress of the load, emitted from time to time.
+     * @param generation generation of the load
+     * @param filesListed files found so far
+     * @param filesIndexed files indexed so far, -1 while still listing files
+     */
+    void loadProgress(int generation, int filesListed, int filesIndexed);
 
 private:
+    /**
+     * was a newer load started?
+     * @return true if our result is no longer needed
+     */
+    bool isStale() const {
+        return m_currentGeneration->load() != m_generation;
+    }
+
     /**
      * Load one project inside the project tree.
-     * Fill data from JSON storage to model and recurse to sub-projects.
-     * @param parent parent standard item in the model
+     * Fill data from JSON storage to tree and recurse to sub-projects.
+     * @param tree tree to fill
+     * @param parent parent node in the tree
      * @param project variant map for this group
-     * @param file2Item mapping file => item, will be filled
+     * @param seenFiles all files already in the tree, will be filled
      */
-    void loadProject(QStandardItem *parent, const QVariantMap &project, QMap<QString, KateProjectItem *> *file2Item);
+    void loadProject(KateProjectTree *tree, int parent, const QVariantMap &project, QSet<QString> *seenFiles);
 
     /**
-     * Load one files entry in the current parent item.
-     * @param parent parent standard item in the model
+     * Load one files entry in the current parent node.
+     * @param tree tree to fill
+     * @param parent parent node in the tree
      * @param filesEntry one files entry specification to load
-     * @param file2Item mapping file => item, will be filled
+     * @param seenFiles all files already in the tree, will be filled
      */
-    void loadFilesEntry(QStandardItem *parent, const QVariantMap &filesEntry, QMap<QString, KateProjectItem *> *file2Item);
+    void loadFilesEntry(KateProjectTree *tree, int parent, const QVariantMap &filesEntry, QSet<QString> *seenFiles);
 
     /**
      * Load index for whole project.
@@ -99,6 +141,10 @@ private:
      */
     QString m_baseDir;
     QVariantMap m_projectMap;
+
+    const int m_generation;
+    const QSharedPointer<QAtomicInt> m_currentGeneration;
+    QAtomicInt m_priority;
 };
 
 #endif
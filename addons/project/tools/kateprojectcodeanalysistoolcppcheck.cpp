@@ -50,8 +50,10 @@ QString KateProjectCodeAnalysisToolCppcheck::path()
     return QStringLiteral("cppcheck");
 }
 
-QStringList KateProjectCodeAnalysisToolCppcheck::arguments()
+QStringList KateProjectCodeAnalysisToolCppcheck::arguments(const QStringList &files)
 {
+    Q_UNUSED(files)
+
     QStringList _args;
 
     _args << QStringLiteral("-q")
@@ -73,13 +75,14 @@ QStringList KateProjectCodeAnalysisToolCppcheck::parseLine(const QString &line)
     return line.split(QRegExp(QStringLiteral("////")), QString::SkipEmptyParts);
 }
 
-QString KateProjectCodeAnalysisToolCppcheck::stdinMessages()
+QString KateProjectCodeAnalysisToolCppcheck::stdinMessages(const QStringList &files)
 {
     // filenames are written to stdin (--file-list=-)
+    return files.join(QStringLiteral("\n"));
+}
 
-    if (!m_project) {
-        return QString();
-    }
-
-    return filter(m_project->files()).join(QStringLiteral("\n"));
+QStringList KateProjectCodeAnalysisToolCppcheck::dependencies(const QStringList &files)
+{
+    // which headers a file includes is unknown, all project headers count
+    return files.filter(QRegularExpression(QStringLiteral("\\.(h|hh|hpp|hxx|h\\+\\+|inl|tcc)$")));
 }
@@ -55,7 +55,7 @@ QString KateProjectCodeAnalysisToolFlake8::path()
     return QStringLiteral("flake8");
 }
 
-QStringList KateProjectCodeAnalysisToolFlake8::arguments()
+QStringList KateProjectCodeAnalysisToolFlake8::arguments(const QStringList &files)
 {
     QStringList _args;
 
@@ -66,9 +66,7 @@ QStringList KateProjectCodeAnalysisToolFlake8::arguments()
            */
           << QStringLiteral("--format=%(path)s////%(row)d////%(code)s////%(text)s");
 
-    if (m_project) {
-        _args.append(filter(m_project->files()));
-    }
+    _args.append(files);
 
     return _args;
 }
@@ -83,7 +81,15 @@ QStringList KateProjectCodeAnalysisToolFlake8::parseLine(const QString &line)
     return line.split(QRegExp(QStringLiteral("////")), QString::SkipEmptyParts);
 }
 
-QString KateProjectCodeAnalysisToolFlake8::stdinMessages()
+QString KateProjectCodeAnalysisToolFlake8::stdinMessages(const QStringList &files)
 {
+    Q_UNUSED(files)
+
     return QString();
 }
+
+bool KateProjectCodeAnalysisToolFlake8::isSuccessfulExitCode(int exitCode)
+{
+    // 1 => violations found, only without --exit-zero
+    return exitCode == 0 || exitCode == 1;
+}
@@ -39,13 +39,15 @@ public:
 
     virtual QString path() override;
 
-    virtual QStringList arguments() override;
+    virtual QStringList arguments(const QStringList &files) override;
 
     virtual QString notInstalledMessage() override;
 
     virtual QStringList parseLine(const QString &line) override;
 
-    virtual QString stdinMessages() override;
+    virtual QString stdinMessages(const QStringList &files) override;
+
+    virtual bool isSuccessfulExitCode(int exitCode) override;
 };
 
 #endif // KATE_PROJECT_CODE_ANALYSIS_TOOL_FLAKE8_H
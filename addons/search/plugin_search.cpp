@@ -21,6 +21,7 @@
 #include "plugin_search.h"
 
 #include "htmldelegate.h"
+#include "../../katefilelistsnapshot.h"
 
 #include <ktexteditor/application.h>
 #include <ktexteditor/editor.h>
@@ -984,6 +985,7 @@ void KatePluginSearchView::startSearch()
          */
         m_resultBaseDir.clear();
         QStringList files;
+        KateSharedFileListSnapshot projectFiles;
         if (m_projectPluginView) {
             if (inCurrentProject) {
                 m_resultBaseDir = m_projectPluginView->property ("projectBaseDir").toString();
@@ -994,23 +996,47 @@ void KatePluginSearchView::startSearch()
             if (!m_resultBaseDir.endsWith(QLatin1Char('/')))
                 m_resultBaseDir += QLatin1Char('/');
 
-            QStringList projectFiles;
             if (inCurrentProject) {
-                projectFiles = m_projectPluginView->property ("projectFiles").toStringList();
+                projectFiles = qvariant_cast<KateSharedFileListSnapshot>(m_projectPluginView->property ("projectFilesSnapshot"));
             } else {
-                projectFiles = m_projectPluginView->property ("allProjectsFiles").toStringList();
+                projectFiles = qvariant_cast<KateSharedFileListSnapshot>(m_projectPluginView->property ("allProjectsFilesSnapshot"));
             }
 
-            files = filterFiles(projectFiles);
+            if (projectFiles) {
+                files = filterFiles(projectFiles->files());
+            }
         }
         addHeaderItem();
 
+        /**
+         * open documents of the project are searched in the editor, the snapshot answers membership
+         * without scanning the file list, the filters are applied once to all of them
+         */
         QList<KTextEditor::Document*> openList;
-        for (int i=0; i<m_kateApp->documents().size(); i++) {
-            int index = files.indexOf(m_kateApp->documents()[i]->url().toString());
-            if (index != -1) {
-                openList << m_kateApp->documents()[i];
-                files.removeAt(index);
+        if (projectFiles) {
+            QHash<QString, KTextEditor::Document*> openDocuments;
+            foreach (KTextEditor::Document *doc, m_kateApp->documents()) {
+                const QString file = doc->url().toLocalFile();
+                if (projectFiles->contains(file)) {
+                    openDocuments.insert(file, doc);
+                }
+            }
+
+            if (!openDocuments.isEmpty()) {
+                const QStringList openFiles = filterFiles(openDocuments.keys());
+                const QSet<QString> openFileSet = openFiles.toSet();
+                foreach (const QString &file, openFiles) {
+                    openList << openDocuments.value(file);
+                }
+
+                QStringList diskFiles;
+                diskFiles.reserve(files.size());
+                foreach (const QString &file, files) {
+                    if (!openFileSet.contains(file)) {
+                        diskFiles << file;
+                    }
+                }
+                files = diskFiles;
             }
         }
         // search order is important: Open files starts immediately and should finish
@@ -51,6 +51,7 @@ KateSessionsModel::KateSessionsModel(QObject *parent)
     dirwatch->addDir( m_sessionsDir );
     
     connect(dirwatch, &KDirWatch::dirty, this, &KateSessionsModel::slotUpdateSessionMenu);
+    initSessionFiles();
     slotUpdateSessionMenu();
 }
 
@@ -61,10 +62,49 @@ KateSessionsModel::~KateSessionsModel()
 
 void KateSessionsModel::slotUpdateSessionMenu()
 {
-   clear();
-   m_sessions.clear();
-   m_fullList.clear();
-   initSessionFiles();
+    QStringList sessions;
+    QDir dir(m_sessionsDir, QStringLiteral("*.katesession"));
+    foreach (QString name, dir.entryList(QDir::Files)) {
+        name.chop(12); // .katesession
+        sessions << QUrl::fromPercentEncoding(name.toLatin1());
+    }
+    qSort(sessions.begin(), sessions.end(), katesessions_compare_sessions);
+
+    // nothing changed, e.g. a session was just saved
+    if (sessions == m_sessions) {
+        return;
+    }
+
+    // both lists are sorted, only the rows of added or removed sessions change
+    const int offset = m_fullList.size() - m_sessions.size();
+    int i = 0;
+    int j = 0;
+    while (i < m_sessions.size() || j < sessions.size()) {
+        if (i < m_sessions.size() && j < sessions.size() && m_sessions[i] == sessions[j]) {
+            ++i;
+            ++j;
+        } else if (j < sessions.size() && (i == m_sessions.size() || !katesessions_compare_sessions(m_sessions[i], sessions[j]))) {
+            m_sessions.insert(i, sessions[j]);
+            m_fullList.insert(offset + i, sessions[j]);
+            insertRow(offset + i, sessionItem(sessions[j]));
+            ++i;
+            ++j;
+        } else {
+            m_sessions.removeAt(i);
+            m_fullList.removeAt(offset + i);
+            removeRow(offset + i);
+        }
+    }
+}
+
+QStandardItem *KateSessionsModel::sessionItem(const QString &session) const
+{
+    QStandardItem *item = new QStandardItem();
+    item->setData(session, Qt::DisplayRole);
+    item->setData(QString(session + QLatin1String(".katesession")), Uuid);
+    item->setData(QIcon::fromTheme(QStringLiteral("document-open")), Qt::DecorationRole);
+    item->setData(2, TypeRole);
+    return item;
 }
 
 void KateSessionsModel::initSessionFiles()
@@ -94,28 +134,6 @@ void KateSessionsModel::initSessionFiles()
     item->setData( QIcon::fromTheme( QStringLiteral("document-new") ), Qt::DecorationRole );
     m_fullList << item->data(Qt::DisplayRole).toString();
     appendRow(item);
-
-    QDir dir(m_sessionsDir, QStringLiteral("*.katesession"));
-
-    for (unsigned int i = 0; i < dir.count(); ++i) {
-        QString name = dir[i];
-        name.chop(12); // .katesession
-        m_sessions << QUrl::fromPercentEncoding(name.toLatin1());
-    }
-    
-   
-    qSort(m_sessions.begin(),m_sessions.end(),katesessions_compare_sessions);
-    QLatin1String ext(".katesession");
-    for(QStringList::ConstIterator it=m_sessions.constBegin();it!=m_sessions.constEnd();++it)
-    {
-        m_fullList << *it;
-        item = new QStandardItem();
-        item->setData(*it, Qt::DisplayRole);
-        item->setData( QString((*it)+ext), Uuid );
-        item->setData( QIcon::fromTheme( QStringLiteral("document-open") ), Qt::DecorationRole );
-        item->setData(2,TypeRole);
-        appendRow( item);
-    }
 }
 
 QHash< int, QByteArray > KateSessionsModel::roleNames() const
@@ -54,6 +54,7 @@ protected Q_SLOTS:
 
 protected:
     void initSessionFiles();
+    QStandardItem *sessionItem(const QString &session) const;
 /*    void createConfigurationInterface(KConfigDialog *parent);
     void configChanged();*/
 private:
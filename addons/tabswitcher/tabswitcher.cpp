@@ -34,7 +34,9 @@
 #include <QAction>
 #include <QMimeDatabase>
 #include <QScrollBar>
+#include <QSet>
 #include <QStandardItemModel>
+#include <QVector>
 
 K_PLUGIN_FACTORY_WITH_JSON(TabSwitcherPluginFactory, "tabswitcherplugin.json", registerPlugin<TabSwitcherPlugin>();)
 
@@ -80,7 +82,11 @@ TabSwitcherPluginView::TabSwitcherPluginView(TabSwitcherPlugin *plugin, KTextEdi
     connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::documentCreated,
             this, &TabSwitcherPluginView::registerDocument);
     connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::documentWillBeDeleted,
-            this, &TabSwitcherPluginView::unregisterDocument);;
+            this, &TabSwitcherPluginView::unregisterDocument);
+    connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::aboutToDeleteDocuments,
+            this, &TabSwitcherPluginView::aboutToDeleteDocuments);
+    connect(KTextEditor::Editor::instance()->application(), &KTextEditor::Application::documentsDeleted,
+            this, &TabSwitcherPluginView::documentsDeleted);
 
     // track lru activation of views to raise the respective documents in the model
     connect(m_mainWindow, &KTextEditor::MainWindow::viewChanged, this, &TabSwitcherPluginView::raiseView);
@@ -128,22 +134,37 @@ static QIcon iconForDocument(KTextEditor::Document * doc)
 
 void TabSwitcherPluginView::setupModel()
 {
-    // initial fill of model
+    // initial fill of model: the views come in lru order, documents without views last
+    QVector<KTextEditor::Document *> documents;
+    QSet<KTextEditor::Document *> seen;
+    foreach (auto view, m_mainWindow->views()) {
+        if (!seen.contains(view->document())) {
+            seen.insert(view->document());
+            documents.append(view->document());
+        }
+    }
     foreach (auto doc, KTextEditor::Editor::instance()->application()->documents()) {
-        registerDocument(doc);
+        if (!seen.contains(doc)) {
+            documents.append(doc);
+        }
+    }
+
+    // each document is inserted on top
+    for (int i = documents.size() - 1; i >= 0; --i) {
+        registerDocument(documents[i]);
     }
 }
 
 void TabSwitcherPluginView::registerDocument(KTextEditor::Document * document)
 {
-    // insert into hash
-    m_documents.insert(document);
-
     // add to model
     auto item = new QStandardItem(iconForDocument(document), document->documentName());
     item->setData(QVariant::fromValue(document));
     m_model->insertRow(0, item);
 
+    // insert into hash
+    m_documents.insert(document, item);
+
     // track document name changes
     connect(document, &KTextEditor::Document::documentNameChanged, this, &TabSwitcherPluginView::updateDocumentName);
 }
@@ -151,50 +172,73 @@ void TabSwitcherPluginView::registerDocument(KTextEditor::Document * document)
 void TabSwitcherPluginView::unregisterDocument(KTextEditor::Document * document)
 {
     // remove from hash
-    if (!m_documents.contains(document)) {
+    const auto it = m_documents.find(document);
+    if (it == m_documents.end()) {
+        return;
+    }
+    QStandardItem *item = it.value();
+    m_documents.erase(it);
+
+    // disconnect documentNameChanged() signal
+    disconnect(document, nullptr, this, nullptr);
+
+    // documents closed together get their rows removed together afterwards
+    if (m_closingDocuments.contains(document)) {
+        m_closingItems.insert(item);
         return;
     }
-    m_documents.remove(document);
 
     // remove from model
-    const auto rowCount = m_model->rowCount();
-    for (int i = 0; i < rowCount; ++i) {
-        auto doc = m_model->item(i)->data().value<KTextEditor::Document*>();
-        if (doc == document) {
-            m_model->removeRow(i);
+    m_model->removeRow(item->row());
+}
 
-            // disconnect documentNameChanged() signal
-            disconnect(document, nullptr, this, nullptr);
+void TabSwitcherPluginView::aboutToDeleteDocuments(const QList<KTextEditor::Document *> &documents)
+{
+    m_closingDocuments = documents.toSet();
+}
+
+void TabSwitcherPluginView::documentsDeleted()
+{
+    m_closingDocuments.clear();
 
-            break;
+    // remove exactly the rows of the documents unregistered in the batch, bottom up in contiguous ranges
+    // new documents may reuse the address of a deleted one, the items identify the rows
+    for (int last = m_model->rowCount() - 1; last >= 0 && !m_closingItems.isEmpty(); --last) {
+        if (!m_closingItems.remove(m_model->item(last))) {
+            continue;
         }
+
+        int first = last;
+        while (first > 0 && m_closingItems.remove(m_model->item(first - 1))) {
+            --first;
+        }
+
+        m_model->removeRows(first, last - first + 1);
+        last = first;
     }
+    m_closingItems.clear();
 }
 
 void TabSwitcherPluginView::updateDocumentName(KTextEditor::Document * document)
 {
-    if (!m_documents.contains(document)) {
-        return;
-    }
-
-    const auto rowCount = m_model->rowCount();
-    for (int i = 0; i < rowCount; ++i) {
-        auto doc = m_model->item(i)->data().value<KTextEditor::Document*>();
-        if (doc == document) {
-            m_model->item(i)->setText(document->documentName());
-            break;
-        }
+    if (auto item = m_documents.value(document)) {
+        item->setText(document->documentName());
     }
 }
 
 void TabSwitcherPluginView::raiseView(KTextEditor::View * view)
 {
-    if (!view || !m_documents.contains(view->document())) {
+    if (!view) {
+        return;
+    }
+
+    auto item = m_documents.value(view->document());
+    if (!item || item->row() == 0) {
         return;
     }
 
-    unregisterDocument(view->document());
-    registerDocument(view->document());
+    // move the row on top, the item is kept
+    m_model->insertRow(0, m_model->takeRow(item->row()));
 }
 
 void TabSwitcherPluginView::walk(const int from, const int to)
@@ -24,6 +24,7 @@
 #include <KTextEditor/Plugin>
 #include <KTextEditor/MainWindow>
 
+#include <QHash>
 #include <QList>
 #include <QSet>
 #include <QVariant>
@@ -32,6 +33,7 @@
 
 class TabSwitcherPluginView;
 class TabSwitcherTreeView;
+class QStandardItem;
 class QStandardItemModel;
 class QModelIndex;
 
@@ -92,6 +94,16 @@ public Q_SLOTS:
      */
     void unregisterDocument(KTextEditor::Document * document);
 
+    /**
+     * Start a batch of closed @p documents, their rows are kept until documentsDeleted().
+     */
+    void aboutToDeleteDocuments(const QList<KTextEditor::Document *> &documents);
+
+    /**
+     * Remove the rows of all documents closed in the batch at once.
+     */
+    void documentsDeleted();
+
     /**
      * Update the name in the model for @p document.
      */
@@ -137,7 +149,9 @@ private:
     TabSwitcherPlugin *m_plugin;
     KTextEditor::MainWindow *m_mainWindow;
     QStandardItemModel * m_model;
-    QSet<KTextEditor::Document *> m_documents;
+    QHash<KTextEditor::Document *, QStandardItem *> m_documents;
+    QSet<KTextEditor::Document *> m_closingDocuments;
+    QSet<QStandardItem *> m_closingItems;
     TabSwitcherTreeView * m_treeView;
 };
 
@@ -0,0 +1,131 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "lrulist_test.h"
+#include "katelrulist.h"
+
+#include <QtTest>
+
+QTEST_MAIN(KateLruListTest)
+
+namespace
+{
+/**
+ * walk the list from the end, must be the reverse of toList()
+ */
+QList<int *> backwards(const KateLruList<int *> &lru)
+{
+    QList<int *> items;
+    for (int *item = lru.last(); item; item = lru.previous(item)) {
+        items.prepend(item);
+    }
+    return items;
+}
+}
+
+void KateLruListTest::touchOrder()
+{
+    int a = 0, b = 0, c = 0;
+    KateLruList<int *> lru;
+    QVERIFY(lru.isEmpty());
+    QVERIFY(!lru.first());
+    QVERIFY(!lru.last());
+
+    lru.touch(&a);
+    lru.touch(&b);
+    lru.touch(&c);
+    QCOMPARE(lru.size(), 3);
+    QCOMPARE(lru.toList(), QList<int *>() << &c << &b << &a);
+    QCOMPARE(backwards(lru), lru.toList());
+
+    // middle to front
+    lru.touch(&b);
+    QCOMPARE(lru.toList(), QList<int *>() << &b << &c << &a);
+    QCOMPARE(backwards(lru), lru.toList());
+
+    // last to front
+    lru.touch(&a);
+    QCOMPARE(lru.toList(), QList<int *>() << &a << &b << &c);
+    QCOMPARE(backwards(lru), lru.toList());
+
+    // first stays first
+    lru.touch(&a);
+    QCOMPARE(lru.toList(), QList<int *>() << &a << &b << &c);
+    QCOMPARE(lru.first(), &a);
+    QCOMPARE(lru.last(), &c);
+    QCOMPARE(lru.next(&a), &b);
+    QCOMPARE(lru.previous(&c), &b);
+    QCOMPARE(lru.size(), 3);
+}
+
+void KateLruListTest::removeLinks()
+{
+    int a = 0, b = 0, c = 0, d = 0;
+    KateLruList<int *> lru;
+    lru.touch(&a);
+    lru.touch(&b);
+    lru.touch(&c);
+    lru.touch(&d);
+
+    QVERIFY(!lru.remove(nullptr));
+
+    // middle
+    QVERIFY(lru.remove(&b));
+    QVERIFY(!lru.remove(&b));
+    QVERIFY(!lru.contains(&b));
+    QCOMPARE(lru.toList(), QList<int *>() << &d << &c << &a);
+    QCOMPARE(backwards(lru), lru.toList());
+
+    // first
+    QVERIFY(lru.remove(&d));
+    QCOMPARE(lru.first(), &c);
+    QCOMPARE(lru.toList(), QList<int *>() << &c << &a);
+    QCOMPARE(backwards(lru), lru.toList());
+
+    // last
+    QVERIFY(lru.remove(&a));
+    QCOMPARE(lru.last(), &c);
+    QCOMPARE(lru.toList(), QList<int *>() << &c);
+
+    QVERIFY(lru.remove(&c));
+    QVERIFY(lru.isEmpty());
+    QVERIFY(!lru.first());
+    QVERIFY(!lru.last());
+
+    // usable again after being emptied
+    lru.touch(&b);
+    QCOMPARE(lru.toList(), QList<int *>() << &b);
+    QCOMPARE(lru.last(), &b);
+}
+
+void KateLruListTest::clear()
+{
+    int a = 0, b = 0;
+    KateLruList<int *> lru;
+    lru.touch(&a);
+    lru.touch(&b);
+
+    lru.clear();
+    QVERIFY(lru.isEmpty());
+    QVERIFY(!lru.contains(&a));
+    QVERIFY(!lru.first());
+    QVERIFY(!lru.last());
+    QVERIFY(lru.toList().isEmpty());
+}
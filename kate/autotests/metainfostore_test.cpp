@@ -0,0 +1,244 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "metainfostore_test.h"
+#include "katemetainfostore.h"
+
+#include <KConfig>
+#include <KConfigGroup>
+
+#include <QtTest>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+QTEST_MAIN(KateMetaInfoStoreTest)
+
+namespace
+{
+QMap<QString, QString> entries(const QString &checksum, const QString &mode = QStringLiteral("C++"))
+{
+    QMap<QString, QString> map;
+    map.insert(QStringLiteral("Checksum"), checksum);
+    map.insert(QStringLiteral("Mode"), mode);
+    return map;
+}
+}
+
+void KateMetaInfoStoreTest::init()
+{
+    m_tempdir = new QTemporaryDir;
+    QVERIFY(m_tempdir->isValid());
+}
+
+void KateMetaInfoStoreTest::cleanup()
+{
+    delete m_tempdir;
+}
+
+QString KateMetaInfoStoreTest::storeFile() const
+{
+    return m_tempdir->path() + QStringLiteral("/kate/metainfos");
+}
+
+void KateMetaInfoStoreTest::roundTrip()
+{
+    {
+        KateMetaInfoStore store(storeFile());
+        QCOMPARE(store.count(), 0);
+        QVERIFY(!store.contains(QStringLiteral("file:///a")));
+
+        store.insert(QStringLiteral("file:///a"), entries(QStringLiteral("aa")));
+        store.insert(QStringLiteral("file:///b"), entries(QStringLiteral("bb")));
+
+        // not yet written, served from memory
+        QCOMPARE(store.value(QStringLiteral("file:///a")), entries(QStringLiteral("aa")));
+
+        // written, read back from disk
+        store.sync();
+        QVERIFY(QFile::exists(storeFile()));
+        QCOMPARE(store.value(QStringLiteral("file:///b")), entries(QStringLiteral("bb")));
+    }
+
+    KateMetaInfoStore store(storeFile());
+    QCOMPARE(store.count(), 2);
+    QVERIFY(store.contains(QStringLiteral("file:///a")));
+    QCOMPARE(store.value(QStringLiteral("file:///a")), entries(QStringLiteral("aa")));
+    QCOMPARE(store.value(QStringLiteral("file:///b")), entries(QStringLiteral("bb")));
+    QVERIFY(store.value(QStringLiteral("file:///c")).isEmpty());
+}
+
+void KateMetaInfoStoreTest::replaceAndRemove()
+{
+    {
+        KateMetaInfoStore store(storeFile());
+        store.insert(QStringLiteral("file:///a"), entries(QStringLiteral("aa")));
+        store.insert(QStringLiteral("file:///b"), entries(QStringLiteral("bb")));
+        store.sync();
+
+        store.insert(QStringLiteral("file:///a"), entries(QStringLiteral("a2")));
+        store.remove(QStringLiteral("file:///b"));
+        QCOMPARE(store.count(), 1);
+        QCOMPARE(store.value(QStringLiteral("file:///a")), entries(QStringLiteral("a2")));
+        QVERIFY(!store.contains(QStringLiteral("file:///b")));
+    }
+
+    KateMetaInfoStore store(storeFile());
+    QCOMPARE(store.count(), 1);
+    QCOMPARE(store.value(QStringLiteral("file:///a")), entries(QStringLiteral("a2")));
+    QVERIFY(!store.contains(QStringLiteral("file:///b")));
+}
+
+void KateMetaInfoStoreTest::unchangedEntries()
+{
+    KateMetaInfoStore store(storeFile());
+    store.insert(QStringLiteral("file:///a"), entries(QStringLiteral("aa")));
+    store.sync();
+    const qint64 size = QFileInfo(storeFile()).size();
+
+    // same entries again => nothing appended
+    store.insert(QStringLiteral("file:///a"), entries(QStringLiteral("aa")));
+    store.sync();
+    QCOMPARE(QFileInfo(storeFile()).size(), size);
+
+    store.insert(QStringLiteral("file:///a"), entries(QStringLiteral("aa"), QStringLiteral("Python")));
+    store.sync();
+    QVERIFY(QFileInfo(storeFile()).size() > size);
+}
+
+void KateMetaInfoStoreTest::importAndExpiry()
+{
+    const QString legacyFile = m_tempdir->path() + QStringLiteral("/katemetainfos");
+    {
+        KConfig config(legacyFile, KConfig::SimpleConfig);
+        KConfigGroup oldGroup(&config, "file:///old");
+        oldGroup.writeEntry("Checksum", "oo");
+        oldGroup.writeEntry("Time", QDateTime(QDate(2000, 1, 1)));
+        KConfigGroup newGroup(&config, "file:///new");
+        newGroup.writeEntry("Checksum", "nn");
+        newGroup.writeEntry("Time", QDateTime::currentDateTimeUtc());
+    }
+
+    KateMetaInfoStore store(storeFile());
+    store.setLegacyConfig(legacyFile);
+    store.setMaximalAge(30);
+    QCOMPARE(store.count(), 2);
+    QVERIFY(!store.contains(QStringLiteral("file:///old")));
+    QVERIFY(store.contains(QStringLiteral("file:///new")));
+
+    // the time is part of the record, not of the entries
+    QMap<QString, QString> expected;
+    expected.insert(QStringLiteral("Checksum"), QStringLiteral("nn"));
+    QCOMPARE(store.value(QStringLiteral("file:///new")), expected);
+
+    // no expiry => old records are back
+    store.setMaximalAge(0);
+    QVERIFY(store.contains(QStringLiteral("file:///old")));
+}
+
+void KateMetaInfoStoreTest::damagedTail()
+{
+    {
+        KateMetaInfoStore store(storeFile());
+        store.insert(QStringLiteral("file:///a"), entries(QStringLiteral("aa")));
+    }
+
+    // simulate a crash in the middle of a write
+    const qint64 size = QFileInfo(storeFile()).size();
+    {
+        QFile file(storeFile());
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        file.write("\0\0\1\0garbage", 11);
+    }
+
+    {
+        KateMetaInfoStore store(storeFile());
+        QCOMPARE(store.count(), 1);
+        QCOMPARE(QFileInfo(storeFile()).size(), size);
+
+        store.insert(QStringLiteral("file:///b"), entries(QStringLiteral("bb")));
+    }
+
+    KateMetaInfoStore store(storeFile());
+    QCOMPARE(store.count(), 2);
+    QCOMPARE(store.value(QStringLiteral("file:///a")), entries(QStringLiteral("aa")));
+    QCOMPARE(store.value(QStringLiteral("file:///b")), entries(QStringLiteral("bb")));
+}
+
+void KateMetaInfoStoreTest::compaction()
+{
+    const QString padding(1024, QLatin1Char('x'));
+    qint64 size = 0;
+    {
+        KateMetaInfoStore store(storeFile());
+        store.insert(QStringLiteral("file:///keep"), entries(QStringLiteral("kk")));
+        for (int i = 0; i < 200; ++i) {
+            store.insert(QStringLiteral("file:///a"), entries(QString::number(i), padding));
+        }
+        store.sync();
+        size = QFileInfo(storeFile()).size();
+    }
+
+    // mostly garbage => rewritten with the live records only
+    QVERIFY(QFileInfo(storeFile()).size() < size / 10);
+
+    KateMetaInfoStore store(storeFile());
+    QCOMPARE(store.count(), 2);
+    QCOMPARE(store.value(QStringLiteral("file:///keep")), entries(QStringLiteral("kk")));
+    QCOMPARE(store.value(QStringLiteral("file:///a")), entries(QStringLiteral("199"), padding));
+}
+
+void KateMetaInfoStoreTest::sharedLog()
+{
+    // two stores on one log, like two Kate processes
+    const QString padding(1024, QLatin1Char('x'));
+    KateMetaInfoStore *first = new KateMetaInfoStore(storeFile());
+    KateMetaInfoStore second(storeFile());
+    first->insert(QStringLiteral("file:///first"), entries(QStringLiteral("11")));
+    first->sync();
+    QCOMPARE(second.count(), 1);
+
+    // appends of the other store are picked up before own appends
+    second.insert(QStringLiteral("file:///second"), entries(QStringLiteral("22")));
+    second.sync();
+    first->insert(QStringLiteral("file:///first"), entries(QStringLiteral("12")));
+    first->sync();
+    QCOMPARE(first->value(QStringLiteral("file:///second")), entries(QStringLiteral("22")));
+
+    // compaction keeps the records of the other store
+    for (int i = 0; i < 200; ++i) {
+        first->insert(QStringLiteral("file:///garbage"), entries(QString::number(i), padding));
+    }
+    delete first;
+
+    // the other store notices the rewritten log on its next append
+    second.insert(QStringLiteral("file:///third"), entries(QStringLiteral("33")));
+    second.sync();
+    QCOMPARE(second.count(), 4);
+    QCOMPARE(second.value(QStringLiteral("file:///first")), entries(QStringLiteral("12")));
+    QCOMPARE(second.value(QStringLiteral("file:///second")), entries(QStringLiteral("22")));
+    QCOMPARE(second.value(QStringLiteral("file:///garbage")), entries(QStringLiteral("199"), padding));
+
+    KateMetaInfoStore third(storeFile());
+    QCOMPARE(third.count(), 4);
+    QCOMPARE(third.value(QStringLiteral("file:///second")), entries(QStringLiteral("22")));
+    QCOMPARE(third.value(QStringLiteral("file:///third")), entries(QStringLiteral("33")));
+}
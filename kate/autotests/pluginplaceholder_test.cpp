@@ -0,0 +1,106 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "pluginplaceholder_test.h"
+#include "katepluginmanager.h"
+#include "katepluginplaceholder.h"
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <QtTest>
+#include <QFile>
+#include <QIcon>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+QTEST_MAIN(KatePluginPlaceholderTest)
+
+void KatePluginPlaceholderTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void KatePluginPlaceholderTest::init()
+{
+    m_tempdir = new QTemporaryDir;
+    QVERIFY(m_tempdir->isValid());
+
+    writeLibrary("one");
+    m_info = new KatePluginInfo;
+    m_info->metaData = KPluginMetaData(QJsonObject(), m_tempdir->path() + QStringLiteral("/testplugin.so"));
+}
+
+void KatePluginPlaceholderTest::cleanup()
+{
+    KSharedConfig::openConfig(QStringLiteral("katepluginplaceholdersrc"), KConfig::SimpleConfig, QStandardPaths::CacheLocation)->deleteGroup(m_info->saveName());
+
+    delete m_info;
+    delete m_tempdir;
+}
+
+void KatePluginPlaceholderTest::writeLibrary(const QByteArray &content) const
+{
+    QFile f(m_tempdir->path() + QStringLiteral("/testplugin.so"));
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write(content);
+    }
+}
+
+void KatePluginPlaceholderTest::recordToolView()
+{
+    QVERIFY(!KatePluginPlaceholder::isCached(*m_info));
+
+    KatePluginPlaceholder::recordToolView(*m_info, QStringLiteral("testtoolview"), 1, QIcon(), QStringLiteral("Test"));
+    QVERIFY(KatePluginPlaceholder::isCached(*m_info));
+
+    // recording again doesn't duplicate
+    KatePluginPlaceholder::recordToolView(*m_info, QStringLiteral("testtoolview"), 2, QIcon(), QStringLiteral("Test"));
+    const KConfigGroup group(KSharedConfig::openConfig(QStringLiteral("katepluginplaceholdersrc"), KConfig::SimpleConfig, QStandardPaths::CacheLocation), m_info->saveName());
+    QCOMPARE(group.readEntry("Tool Views", QStringList()), QStringList(QStringLiteral("testtoolview")));
+    QCOMPARE(KConfigGroup(&group, QStringLiteral("ToolView:testtoolview")).readEntry("Position", 0), 2);
+}
+
+void KatePluginPlaceholderTest::changedLibrary()
+{
+    KatePluginPlaceholder::recordToolView(*m_info, QStringLiteral("old"), 0, QIcon(), QStringLiteral("Old"));
+    QVERIFY(KatePluginPlaceholder::isCached(*m_info));
+
+    // new library => cache no longer valid
+    QTest::qSleep(50);
+    writeLibrary("two");
+    QVERIFY(!KatePluginPlaceholder::isCached(*m_info));
+
+    // recording starts from scratch
+    KatePluginPlaceholder::recordToolView(*m_info, QStringLiteral("new"), 0, QIcon(), QStringLiteral("New"));
+    QVERIFY(KatePluginPlaceholder::isCached(*m_info));
+    const KConfigGroup group(KSharedConfig::openConfig(QStringLiteral("katepluginplaceholdersrc"), KConfig::SimpleConfig, QStandardPaths::CacheLocation), m_info->saveName());
+    QCOMPARE(group.readEntry("Tool Views", QStringList()), QStringList(QStringLiteral("new")));
+    QVERIFY(!group.hasGroup(QStringLiteral("ToolView:old")));
+}
+
+void KatePluginPlaceholderTest::viewWithoutGUI()
+{
+    // plain objects have nothing we could stand in for
+    QObject view;
+    KatePluginPlaceholder::recordView(*m_info, &view);
+    QVERIFY(!KatePluginPlaceholder::isCached(*m_info));
+}
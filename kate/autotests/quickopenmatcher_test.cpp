@@ -0,0 +1,98 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "quickopenmatcher_test.h"
+#include "katequickopenmatcher.h"
+
+#include <QtTest>
+
+QTEST_MAIN(KateQuickOpenMatcherTest)
+
+void KateQuickOpenMatcherTest::emptyQuery()
+{
+    KateQuickOpenMatcher matcher;
+    QCOMPARE(matcher.candidateCount(), 0);
+    QVERIFY(matcher.match(QStringLiteral("a"), 10).isEmpty());
+
+    matcher.setCandidates(QStringList() << QStringLiteral("/a/b") << QStringLiteral("/a/c") << QStringLiteral("/a/d"));
+    QCOMPARE(matcher.candidateCount(), 3);
+    QCOMPARE(matcher.match(QString(), 2), QVector<int>() << 0 << 1);
+    QCOMPARE(matcher.match(QString(), 10), QVector<int>() << 0 << 1 << 2);
+}
+
+void KateQuickOpenMatcherTest::fileNameFirst()
+{
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(QStringList()
+                          << QStringLiteral("/src/main/window.cpp")
+                          << QStringLiteral("/src/other/mainwindow.cpp")
+                          << QStringLiteral("/src/other/readme"));
+
+    // file name matches win over path matches, case is ignored
+    QCOMPARE(matcher.match(QStringLiteral("MainWin"), 10), QVector<int>() << 1 << 0);
+    QCOMPARE(matcher.match(QStringLiteral("mw"), 10), QVector<int>() << 1 << 0);
+    QCOMPARE(matcher.match(QStringLiteral("xyz"), 10), QVector<int>());
+
+    const QString candidate = QStringLiteral("/src/other/mainwindow.cpp");
+    QVERIFY(KateQuickOpenMatcher::score(QStringRef(&candidate), 11, QStringLiteral("mainwindow")) > KateQuickOpenMatcher::score(QStringRef(&candidate), 11, QStringLiteral("mnwdw")));
+    QCOMPARE(KateQuickOpenMatcher::score(QStringRef(&candidate), 11, QStringLiteral("windowmain")), -1);
+}
+
+void KateQuickOpenMatcherTest::extendedQuery()
+{
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(QStringList() << QStringLiteral("/a/abc") << QStringLiteral("/a/abd") << QStringLiteral("/a/xyz"));
+
+    // extending or changing the query must give the same result as a fresh match
+    QCOMPARE(matcher.match(QStringLiteral("a"), 10).size(), 3);
+    QCOMPARE(matcher.match(QStringLiteral("ab"), 10), QVector<int>() << 0 << 1);
+    QCOMPARE(matcher.match(QStringLiteral("abd"), 10), QVector<int>() << 1);
+    QCOMPARE(matcher.match(QStringLiteral("x"), 10), QVector<int>() << 2);
+}
+
+void KateQuickOpenMatcherTest::bounded()
+{
+    QStringList candidates;
+    for (int i = 0; i < 100; ++i) {
+        candidates << QStringLiteral("/dir/file%1.txt").arg(i);
+    }
+
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(candidates);
+    const QVector<int> matches = matcher.match(QStringLiteral("file"), 5);
+    QCOMPARE(matches.size(), 5);
+
+    // shorter names first, equal scores keep the order
+    QCOMPARE(matches, QVector<int>() << 0 << 1 << 2 << 3 << 4);
+}
+
+void KateQuickOpenMatcherTest::chunked()
+{
+    QStringList candidates;
+    for (int i = 0; i < 3 * KateQuickOpenMatcher::ChunkSize; ++i) {
+        candidates << QStringLiteral("/dir/%1/file.txt").arg(i);
+    }
+    candidates << QStringLiteral("/dir/special.txt");
+
+    KateQuickOpenMatcher matcher;
+    matcher.setCandidates(candidates);
+    QCOMPARE(matcher.match(QStringLiteral("spec"), 10), QVector<int>() << candidates.size() - 1);
+    QCOMPARE(matcher.match(QStringLiteral("file"), 3), QVector<int>() << 0 << 1 << 2);
+}
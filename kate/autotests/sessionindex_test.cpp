@@ -0,0 +1,125 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "sessionindex_test.h"
+#include "katesessionindex.h"
+
+#include <QtTest>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+QTEST_MAIN(KateSessionIndexTest)
+
+void KateSessionIndexTest::init()
+{
+    m_tempdir = new QTemporaryDir;
+    QVERIFY(m_tempdir->isValid());
+}
+
+void KateSessionIndexTest::cleanup()
+{
+    delete m_tempdir;
+}
+
+QString KateSessionIndexTest::sessionFile(const QString &name, const QByteArray &content) const
+{
+    const QString file = m_tempdir->path() + QLatin1Char('/') + name + QStringLiteral(".katesession");
+    QFile f(file);
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write(content);
+    }
+    return file;
+}
+
+QString KateSessionIndexTest::indexFile() const
+{
+    return m_tempdir->path() + QStringLiteral("/.sessionindex");
+}
+
+void KateSessionIndexTest::lookup()
+{
+    const QString file = sessionFile(QStringLiteral("one"), "[Open Documents]\nCount=3\n");
+
+    KateSessionIndex index(indexFile());
+    unsigned int documents = 0;
+    QVERIFY(!index.lookup(QFileInfo(file), &documents));
+
+    index.insert(QFileInfo(file), 3);
+    QVERIFY(index.lookup(QFileInfo(file), &documents));
+    QCOMPARE(documents, 3u);
+
+    // changed size => out of date
+    sessionFile(QStringLiteral("one"), "[Open Documents]\nCount=12\n");
+    QVERIFY(!index.lookup(QFileInfo(file), &documents));
+
+    // removed sessions are dropped
+    index.insert(QFileInfo(file), 12);
+    index.retain(QStringList());
+    QVERIFY(!index.lookup(QFileInfo(file), &documents));
+}
+
+void KateSessionIndexTest::persistence()
+{
+    const QString one = sessionFile(QStringLiteral("one"), "a");
+    const QString two = sessionFile(QStringLiteral("two"), "b");
+
+    {
+        KateSessionIndex index(indexFile());
+        index.insert(QFileInfo(one), 1);
+        index.insert(QFileInfo(two), 2);
+        index.retain(QStringList() << QStringLiteral("two.katesession"));
+        index.save();
+    }
+    QVERIFY(QFile::exists(indexFile()));
+
+    KateSessionIndex index(indexFile());
+    unsigned int documents = 0;
+    QVERIFY(!index.lookup(QFileInfo(one), &documents));
+    QVERIFY(index.lookup(QFileInfo(two), &documents));
+    QCOMPARE(documents, 2u);
+}
+
+void KateSessionIndexTest::damagedIndex()
+{
+    const QString one = sessionFile(QStringLiteral("one"), "a");
+    {
+        KateSessionIndex index(indexFile());
+        index.insert(QFileInfo(one), 1);
+        index.save();
+    }
+
+    // cut the last entry in half
+    QFile f(indexFile());
+    QVERIFY(f.open(QIODevice::ReadWrite));
+    QVERIFY(f.resize(f.size() - 4));
+    f.close();
+
+    KateSessionIndex index(indexFile());
+    unsigned int documents = 0;
+    QVERIFY(!index.lookup(QFileInfo(one), &documents));
+
+    // rewritten on next save
+    index.insert(QFileInfo(one), 1);
+    index.save();
+    KateSessionIndex reread(indexFile());
+    QVERIFY(reread.lookup(QFileInfo(one), &documents));
+    QCOMPARE(documents, 1u);
+}
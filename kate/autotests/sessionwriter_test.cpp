@@ -0,0 +1,114 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "sessionwriter_test.h"
+#include "katesessionwriter.h"
+
+#include <KConfig>
+#include <KConfigGroup>
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+QTEST_MAIN(KateSessionWriterTest)
+
+void KateSessionWriterTest::init()
+{
+    m_tempdir = new QTemporaryDir;
+    QVERIFY(m_tempdir->isValid());
+}
+
+void KateSessionWriterTest::cleanup()
+{
+    delete m_tempdir;
+}
+
+void KateSessionWriterTest::captureNested()
+{
+    KConfig config(QString(), KConfig::SimpleConfig);
+    config.group("Open Documents").writeEntry("Count", 2);
+    KConfigGroup window(&config, "MainWindow0 Settings");
+    window.writeEntry("State", "x");
+    window.group("Toolbar mainToolBar").writeEntry("Hidden", true);
+
+    const KateSessionSnapshot snapshot = KateSessionWriter::capture(config);
+    QCOMPARE(snapshot.size(), 3);
+    QCOMPARE(snapshot.value(QStringLiteral("Open Documents")).value(QStringLiteral("Count")), QStringLiteral("2"));
+    QCOMPARE(snapshot.value(QStringLiteral("MainWindow0 Settings")).value(QStringLiteral("State")), QStringLiteral("x"));
+    QCOMPARE(snapshot.value(QStringLiteral("MainWindow0 Settings\x1dToolbar mainToolBar")).value(QStringLiteral("Hidden")), QStringLiteral("true"));
+
+    // replaying gives the same snapshot
+    KConfig copy(QString(), KConfig::SimpleConfig);
+    KateSessionWriter::apply(&copy, snapshot);
+    QCOMPARE(KateSessionWriter::capture(copy), snapshot);
+    QVERIFY(copy.group("MainWindow0 Settings").group("Toolbar mainToolBar").readEntry("Hidden", false));
+}
+
+void KateSessionWriterTest::changes()
+{
+    KateSessionSnapshot saved;
+    saved[QStringLiteral("A")][QStringLiteral("a")] = QStringLiteral("1");
+    saved[QStringLiteral("A")][QStringLiteral("b")] = QStringLiteral("2");
+    saved[QStringLiteral("B")][QStringLiteral("c")] = QStringLiteral("3");
+
+    // nothing changed => nothing to write
+    QVERIFY(KateSessionWriter::changes(saved, saved).isEmpty());
+
+    // removed entries and groups are no change, the file keeps them
+    KateSessionSnapshot current = saved;
+    current.remove(QStringLiteral("B"));
+    current[QStringLiteral("A")].remove(QStringLiteral("b"));
+    QVERIFY(KateSessionWriter::changes(saved, current).isEmpty());
+
+    // changed and new entries
+    current = saved;
+    current[QStringLiteral("A")][QStringLiteral("b")] = QStringLiteral("22");
+    current[QStringLiteral("C")][QStringLiteral("d")] = QStringLiteral("4");
+    const KateSessionSnapshot changes = KateSessionWriter::changes(saved, current);
+    QCOMPARE(changes.size(), 2);
+    QCOMPARE(changes.value(QStringLiteral("A")).size(), 1);
+    QCOMPARE(changes.value(QStringLiteral("A")).value(QStringLiteral("b")), QStringLiteral("22"));
+    QCOMPARE(changes.value(QStringLiteral("C")).value(QStringLiteral("d")), QStringLiteral("4"));
+}
+
+void KateSessionWriterTest::writeMerges()
+{
+    const QString file = m_tempdir->path() + QStringLiteral("/test.katesession");
+    {
+        KConfig config(file, KConfig::SimpleConfig);
+        config.group("Keep").writeEntry("k", "v");
+        config.group("Change").writeEntry("a", "1");
+        config.group("Change").writeEntry("b", "2");
+    }
+
+    KateSessionSnapshot changes;
+    changes[QStringLiteral("Change")][QStringLiteral("b")] = QStringLiteral("3");
+    changes[QStringLiteral("New\x1dNested")][QStringLiteral("n")] = QStringLiteral("4");
+
+    KateSessionWriter writer;
+    writer.write(file, changes);
+    writer.waitForDone();
+
+    KConfig config(file, KConfig::SimpleConfig);
+    QCOMPARE(config.group("Keep").readEntry("k"), QStringLiteral("v"));
+    QCOMPARE(config.group("Change").readEntry("a"), QStringLiteral("1"));
+    QCOMPARE(config.group("Change").readEntry("b"), QStringLiteral("3"));
+    QCOMPARE(config.group("New").group("Nested").readEntry("n"), QStringLiteral("4"));
+}
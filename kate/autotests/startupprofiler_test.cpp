@@ -0,0 +1,119 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "startupprofiler_test.h"
+#include "katestartupprofiler.h"
+
+#include <QtTest>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+QTEST_MAIN(KateStartupProfilerTest)
+
+namespace
+{
+/**
+ * names of the complete events in the trace
+ */
+QStringList spanNames(const QByteArray &trace)
+{
+    QStringList names;
+    const QJsonArray events = QJsonDocument::fromJson(trace).object().value(QStringLiteral("traceEvents")).toArray();
+    foreach (const QJsonValue &event, events) {
+        if (event.toObject().value(QStringLiteral("ph")).toString() == QLatin1String("X")) {
+            names << event.toObject().value(QStringLiteral("name")).toString();
+        }
+    }
+    return names;
+}
+}
+
+void KateStartupProfilerTest::phasesAndSpans()
+{
+    KateStartupProfiler::start("first");
+    QVERIFY(KateStartupProfiler::isRecording());
+    {
+        KateStartupProfiler::Span outer("outer");
+        KateStartupProfiler::Span inner("loadPlugin", QStringLiteral("foo"));
+    }
+    KateStartupProfiler::phase("second");
+    KateStartupProfiler::finish();
+    QVERIFY(!KateStartupProfiler::isRecording());
+
+    // the spans are dropped without trace file
+    QCOMPARE(spanNames(KateStartupProfiler::trace()), QStringList() << QStringLiteral("startup"));
+
+    KateStartupProfiler::start("first");
+    KateStartupProfiler::setTraceFile(QStringLiteral("/dev/null"));
+    {
+        KateStartupProfiler::Span outer("outer");
+        KateStartupProfiler::Span inner("loadPlugin", QStringLiteral("foo"));
+    }
+    KateStartupProfiler::phase("second");
+    KateStartupProfiler::finish();
+
+    const QStringList names = spanNames(KateStartupProfiler::trace());
+    QCOMPARE(names.size(), 5);
+    QVERIFY(names.contains(QStringLiteral("startup")));
+    QVERIFY(names.contains(QStringLiteral("first")));
+    QVERIFY(names.contains(QStringLiteral("second")));
+    QVERIFY(names.contains(QStringLiteral("outer")));
+    QVERIFY(names.contains(QStringLiteral("loadPlugin foo")));
+
+    const QString summary = KateStartupProfiler::summary();
+    QVERIFY(summary.startsWith(QStringLiteral("Startup took ")));
+    QVERIFY(summary.indexOf(QStringLiteral("first")) < summary.indexOf(QStringLiteral("second")));
+    QVERIFY(summary.contains(QStringLiteral("slowest span: ")));
+}
+
+void KateStartupProfilerTest::notRecording()
+{
+    KateStartupProfiler::start("first");
+    KateStartupProfiler::setTraceFile(QStringLiteral("/dev/null"));
+    KateStartupProfiler::finish();
+
+    // spans and phases after the end are ignored, finish is only done once
+    {
+        KateStartupProfiler::Span late("late");
+    }
+    KateStartupProfiler::phase("late phase");
+    KateStartupProfiler::finish();
+    QCOMPARE(spanNames(KateStartupProfiler::trace()), QStringList() << QStringLiteral("startup") << QStringLiteral("first"));
+}
+
+void KateStartupProfilerTest::traceFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString file = dir.path() + QStringLiteral("/trace.json");
+
+    KateStartupProfiler::start("first");
+    KateStartupProfiler::setTraceFile(file);
+    KateStartupProfiler::finish();
+
+    QFile trace(file);
+    QVERIFY(trace.open(QIODevice::ReadOnly));
+    const QJsonObject object = QJsonDocument::fromJson(trace.readAll()).object();
+    QCOMPARE(object.value(QStringLiteral("displayTimeUnit")).toString(), QStringLiteral("ms"));
+    QVERIFY(!object.value(QStringLiteral("traceEvents")).toArray().isEmpty());
+}
@@ -21,6 +21,7 @@
 
 #include "kateviewmanager.h"
 #include "katemainwindow.h"
+#include "katestartupprofiler.h"
 
 #include <KConfig>
 #include <KSharedConfig>
@@ -57,11 +58,14 @@ KateApp::KateApp(const QCommandLineParser &args)
     /**
      * re-route some signals to application wrapper
      */
-    connect(&m_docManager, &KateDocManager::documentCreated, &m_wrapper, &KTextEditor::Application::documentCreated);
-    connect(&m_docManager, &KateDocManager::documentWillBeDeleted, &m_wrapper, &KTextEditor::Application::documentWillBeDeleted);
-    connect(&m_docManager, &KateDocManager::documentDeleted, &m_wrapper, &KTextEditor::Application::documentDeleted);
+    connect(&m_docManager, &KateDocManager::publicDocumentCreated, &m_wrapper, &KTextEditor::Application::documentCreated);
+    connect(&m_docManager, &KateDocManager::publicDocumentWillBeDeleted, &m_wrapper, &KTextEditor::Application::documentWillBeDeleted);
+    connect(&m_docManager, &KateDocManager::publicDocumentDeleted, &m_wrapper, &KTextEditor::Application::documentDeleted);
     connect(&m_docManager, &KateDocManager::aboutToCreateDocuments, &m_wrapper, &KTextEditor::Application::aboutToCreateDocuments);
     connect(&m_docManager, &KateDocManager::documentsCreated, &m_wrapper, &KTextEditor::Application::documentsCreated);
+    connect(&m_docManager, &KateDocManager::aboutToDeleteDocuments, &m_wrapper, &KTextEditor::Application::aboutToDeleteDocuments);
+    connect(&m_docManager, &KateDocManager::documentsDeleted, &m_wrapper, &KTextEditor::Application::documentsDeleted);
+    connect(&m_docManager, &KateDocManager::documentHibernationChanged, this, &KateApp::documentHibernationChanged);
 
     /**
      * handle mac os x like file open request via event filter
@@ -313,6 +317,57 @@ KTextEditor::Document *KateApp::openDocUrl(const QUrl &url, const QString &encod
     return doc;
 }
 
+QList<KTextEditor::Document *> KateApp::openDocUrls(const QList<QUrl> &urls, const QVector<KTextEditor::Cursor> &cursors, const QString &encoding, bool isTempFile)
+{
+    QList<KTextEditor::Document *> result;
+    KateMainWindow *mainWindow = activeKateMainWindow();
+
+    if (!mainWindow) {
+        for (int i = 0; i < urls.size(); ++i) {
+            result.append(nullptr);
+        }
+        return result;
+    }
+
+    QTextCodec *codec = encoding.isEmpty() ? nullptr : QTextCodec::codecForName(encoding.toLatin1());
+
+    // folders can't be opened, warn about them, the rest is opened in one go
+    QList<QUrl> files;
+    for (const QUrl &url : urls) {
+        if (!url.isLocalFile() || !QFileInfo(url.toLocalFile()).isDir()) {
+            files.append(url);
+        } else {
+            KMessageBox::sorry(mainWindow,
+                               i18n("The file '%1' could not be opened: it is not a normal file, it is a folder.", url.url()));
+        }
+    }
+
+    const QList<KTextEditor::Document *> docs = mainWindow->viewManager()->openUrls(files, codec ? QString::fromLatin1(codec->name()) : QString(), isTempFile);
+
+    // map back to the urls, apply the cursors, only these documents need a view now
+    int next = 0;
+    for (int i = 0; i < urls.size(); ++i) {
+        if (next >= docs.size() || files.at(next) != urls.at(i)) {
+            result.append(nullptr);
+            continue;
+        }
+
+        KTextEditor::Document *doc = docs.at(next++);
+        result.append(doc);
+
+        if (i < cursors.size() && cursors.at(i).isValid()) {
+            mainWindow->viewManager()->activateView(doc);
+            setCursor(cursors.at(i).line(), cursors.at(i).column());
+        }
+    }
+
+    if (!docs.isEmpty()) {
+        mainWindow->viewManager()->activateView(docs.last());
+    }
+
+    return result;
+}
+
 bool KateApp::setCursor(int line, int column)
 {
     KateMainWindow *mainWindow = activeKateMainWindow();
@@ -348,6 +403,8 @@ bool KateApp::openInput(const QString &text, const QString &encoding)
 
 KateMainWindow *KateApp::newMainWindow(KConfig *sconfig_, const QString &sgroup_)
 {
+    KateStartupProfiler::Span span("KateApp::newMainWindow");
+
     KConfig *sconfig = sconfig_ ? sconfig_ : KSharedConfig::openConfig().data();
     QString sgroup = !sgroup_.isEmpty() ? sgroup_ : QStringLiteral("MainWindow0");
 
@@ -401,9 +458,9 @@ KateMainWindow *KateApp::mainWindow(int n)
     return nullptr;
 }
 
-void KateApp::emitDocumentClosed(const QString &token)
+void KateApp::emitDocumentsClosed(const QStringList &tokens)
 {
-    m_adaptor.emitDocumentClosed(token);
+    m_adaptor.emitDocumentsClosed(tokens);
 }
 
 KTextEditor::Plugin *KateApp::plugin(const QString &name)
@@ -445,26 +502,20 @@ void KateApp::remoteMessageReceived(const QString &message, QObject *)
         return;
 
     /**
-     * open all passed urls
+     * open all passed urls, in one batch
      */
     const QJsonArray urls = jsonMessage.object().value(QLatin1String("urls")).toArray();
+    QList<QUrl> docUrls;
+    QVector<KTextEditor::Cursor> cursors;
     Q_FOREACH(QJsonValue urlObject, urls) {
         /**
          * get url meta data
          */
-        const QUrl url = urlObject.toObject().value(QLatin1String("url")).toVariant().toUrl();
-        const int line = urlObject.toObject().value(QLatin1String("line")).toVariant().toInt();
-        const int column = urlObject.toObject().value(QLatin1String("column")).toVariant().toInt();
-
-        /**
-         * open file + set line/column if requested
-         */
-        openUrl(url, QString(), false);
-        if (line >= 0 && column >= 0) {
-            setCursor(line, column);
-        }
-
+        docUrls.append(urlObject.toObject().value(QLatin1String("url")).toVariant().toUrl());
+        cursors.append(KTextEditor::Cursor(urlObject.toObject().value(QLatin1String("line")).toVariant().toInt(),
+                                           urlObject.toObject().value(QLatin1String("column")).toVariant().toInt()));
     }
+    openDocUrls(docUrls, cursors, QString(), false);
 
     if (auto win = activeKateMainWindow()) {
         // like QtSingleApplication
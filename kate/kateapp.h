@@ -32,6 +32,7 @@
 
 #include <KConfig>
 #include <QList>
+#include <QVector>
 
 class KateSessionManager;
 class KateMainWindow;
@@ -200,7 +201,22 @@ public:
 
     KTextEditor::Document *openDocUrl(const QUrl &url, const QString &encoding, bool isTempFile);
 
-    void emitDocumentClosed(const QString &token);
+    /**
+     * open several urls at once, as one batch of the document manager
+     * the last document is activated, documents with valid cursor get a view with that cursor
+     * @param urls urls to open
+     * @param cursors cursor per url, invalid for none
+     * @param encoding encoding name
+     * @param isTempFile delete the files once closed
+     * @return document per url, nullptr for the ones not opened
+     */
+    QList<KTextEditor::Document *> openDocUrls(const QList<QUrl> &urls, const QVector<KTextEditor::Cursor> &cursors, const QString &encoding, bool isTempFile);
+
+    /**
+     * tell D-Bus clients waiting for documents that they are closed
+     * @param tokens tokens of the closed documents
+     */
+    void emitDocumentsClosed(const QStringList &tokens);
 
     /**
      * position cursor in current active view
@@ -255,7 +271,17 @@ public Q_SLOTS:
      * @return all documents the application manages
      */
     QList<KTextEditor::Document *> documents() {
-        return m_docManager.documentList();
+        // documents that wait for loading are hidden, findUrl() loads them
+        return m_docManager.publicDocumentList();
+    }
+
+    /**
+     * Get a list of all hibernated documents, they are not part of documents().
+     * Plugins call this by name, e.g. the file tree to list these documents, too.
+     * @return all hibernated documents
+     */
+    QList<KTextEditor::Document *> hibernatedDocuments() {
+        return m_docManager.hibernatedDocumentList();
     }
 
     /**
@@ -265,7 +291,12 @@ public Q_SLOTS:
      * \return the document with the given \p url or NULL, if none found
      */
     KTextEditor::Document *findUrl(const QUrl &url) {
-        return m_docManager.findDocument(url);
+        // plugins get a loaded document
+        KTextEditor::Document *doc = m_docManager.findDocument(url);
+        if (doc) {
+            m_docManager.loadPendingDocument(doc);
+        }
+        return doc;
     }
 
     /**
@@ -327,6 +358,16 @@ public Q_SLOTS:
      */
     void remoteMessageReceived(const QString &message, QObject *socket);
 
+Q_SIGNALS:
+    /**
+     * The \p document was hibernated or is no longer hibernated.
+     * Hibernated documents are not announced through KTextEditor::Application,
+     * plugins connect to this by name to show them anyway.
+     * @param document document that changed its state
+     * @param hibernated is the document hibernated now?
+     */
+    void documentHibernationChanged(KTextEditor::Document *document, bool hibernated);
+
 protected:
     /**
      * Event filter for QApplication to handle mac os like file open
@@ -67,7 +67,7 @@ QString KateAppAdaptor::tokenOpenUrl(QString url, QString encoding)
     if (!doc) {
         return QStringLiteral("ERROR");
     }
-    return QString::fromLatin1("%1").arg((qptrdiff)doc);
+    return documentToken(doc);
 }
 
 QString KateAppAdaptor::tokenOpenUrl(QString url, QString encoding, bool isTempFile)
@@ -77,7 +77,7 @@ QString KateAppAdaptor::tokenOpenUrl(QString url, QString encoding, bool isTempF
     if (!doc) {
         return QStringLiteral("ERROR");
     }
-    return QString::fromLatin1("%1").arg((qptrdiff)doc);
+    return documentToken(doc);
 }
 
 QString KateAppAdaptor::tokenOpenUrlAt(QString url, int line, int column, QString encoding, bool isTempFile)
@@ -88,7 +88,27 @@ QString KateAppAdaptor::tokenOpenUrlAt(QString url, int line, int column, QStrin
         return QStringLiteral("ERROR");
     }
     m_app->setCursor(line, column);
-    return QString::fromLatin1("%1").arg((qptrdiff)doc);
+    return documentToken(doc);
+}
+
+QStringList KateAppAdaptor::tokenOpenUrlsAt(const QStringList &urls, const QList<int> &lines, const QList<int> &columns, const QString &encoding, bool isTempFile)
+{
+    qCDebug(LOG_KATE) << "openURLsAt" << urls.size();
+
+    QList<QUrl> docUrls;
+    QVector<KTextEditor::Cursor> cursors;
+    docUrls.reserve(urls.size());
+    cursors.reserve(urls.size());
+    for (int i = 0; i < urls.size(); ++i) {
+        docUrls.append(QUrl(urls.at(i)));
+        cursors.append(KTextEditor::Cursor(lines.value(i, -1), columns.value(i, -1)));
+    }
+
+    QStringList tokens;
+    foreach (KTextEditor::Document *doc, m_app->openDocUrls(docUrls, cursors, encoding, isTempFile)) {
+        tokens.append(doc ? documentToken(doc) : QStringLiteral("ERROR"));
+    }
+    return tokens;
 }
 //--------
 
@@ -123,8 +143,23 @@ void KateAppAdaptor::emitExiting()
     emit exiting();
 }
 
-void KateAppAdaptor::emitDocumentClosed(const QString &token)
+QString KateAppAdaptor::documentToken(KTextEditor::Document *doc)
 {
-    documentClosed(token);
+    const QString token = QString::number((qptrdiff)doc);
+    m_tokens.insert(token);
+    return token;
+}
+
+void KateAppAdaptor::emitDocumentsClosed(const QStringList &tokens)
+{
+    if (m_tokens.isEmpty()) {
+        return;
+    }
+
+    foreach (const QString &token, tokens) {
+        if (m_tokens.remove(token)) {
+            emit documentClosed(token);
+        }
+    }
 }
 
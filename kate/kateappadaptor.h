@@ -24,6 +24,11 @@
 
 class KateApp;
 
+namespace KTextEditor
+{
+class Document;
+}
+
 class KateAppAdaptor : public QDBusAbstractAdaptor
 {
     Q_OBJECT
@@ -36,7 +41,12 @@ public:
      * emit the exiting signal
      */
     void emitExiting();
-    void emitDocumentClosed(const QString &token);
+
+    /**
+     * emit the documentClosed signal for the tokens handed out by tokenOpenUrl
+     * @param tokens tokens of all closed documents
+     */
+    void emitDocumentsClosed(const QStringList &tokens);
 
 public Q_SLOTS:
     /**
@@ -76,6 +86,18 @@ public Q_SLOTS:
 
     QString tokenOpenUrlAt(QString url, int line, int column, QString encoding, bool isTempFile);
 
+    /**
+     * open several files at once, in one batch
+     * the last file gets activated, files with cursor get a view with the cursor set
+     * @param urls urls of the files
+     * @param lines line per url, negative for none
+     * @param columns column per url, negative for none
+     * @param encoding encoding name
+     * @param isTempFile delete the files once closed, see above
+     * @return token or ERROR per url
+     */
+    QStringList tokenOpenUrlsAt(const QStringList &urls, const QList<int> &lines, const QList<int> &columns, const QString &encoding, bool isTempFile);
+
     /**
      * set cursor of active view in active main window
      * will clear selection
@@ -117,8 +139,19 @@ Q_SIGNALS:
     void documentClosed(const QString &token);
 public:
     QString activeSession();
+private:
+    /**
+     * token for the document, remembered until it is closed
+     */
+    QString documentToken(KTextEditor::Document *doc);
+
 private:
     KateApp *m_app;
+
+    /**
+     * tokens handed out, only for these someone waits on D-Bus
+     */
+    QSet<QString> m_tokens;
 };
 
 #endif
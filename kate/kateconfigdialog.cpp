@@ -184,7 +184,10 @@ KateConfigDialog::KateConfigDialog(KateMainWindow *parent, KTextEditor::View *vi
     KatePluginList &pluginList(KateApp::self()->pluginManager()->pluginList());
     foreach(const KatePluginInfo & plugin, pluginList) {
         if (plugin.load) {
-            addPluginPage(plugin.plugin);
+            // deferred plugins are loaded now, their pages need them
+            if (KTextEditor::Plugin *instance = KateApp::self()->pluginManager()->plugin(plugin.saveName())) {
+                addPluginPage(instance);
+            }
         }
     }
     //END Plugins page
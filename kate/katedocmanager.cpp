@@ -24,6 +24,7 @@
 #include "katemainwindow.h"
 #include "kateviewmanager.h"
 #include "katesavemodifieddialog.h"
+#include "katestartupprofiler.h"
 #include "katedebug.h"
 
 #include <ktexteditor/view.h>
@@ -39,6 +40,9 @@
 #include <QByteArray>
 #include <QDateTime>
 #include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QStandardPaths>
 #include <QTextCodec>
 #include <QTimer>
 #include <QApplication>
@@ -46,9 +50,11 @@
 #include <QProgressDialog>
 #include <QFileDialog>
 
+#include <algorithm>
+
 KateDocManager::KateDocManager(QObject *parent)
     : QObject(parent)
-    , m_metaInfos(QStringLiteral("katemetainfos"), KConfig::NoGlobals)
+    , m_metaInfos(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/kate/metainfos"))
     , m_saveMetaInfos(true)
     , m_daysMetaInfos(0)
     , m_documentStillToRestore(0)
@@ -56,6 +62,19 @@ KateDocManager::KateDocManager(QObject *parent)
     // set our application wrapper
     KTextEditor::Editor::instance()->setApplication(KateApp::self()->wrapper());
 
+    // meta infos of older versions are imported once
+    m_metaInfos.setLegacyConfig(QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + QStringLiteral("/katemetainfos"));
+
+    // lazily restored documents are loaded one by one, the event loop runs in between
+    m_pendingTimer.setSingleShot(true);
+    m_pendingTimer.setInterval(0);
+    connect(&m_pendingTimer, SIGNAL(timeout()), this, SLOT(slotLoadNextPendingDocument()));
+
+    // idle documents are hibernated, checked once a minute
+    m_hibernationTimer.setInterval(60 * 1000);
+    connect(&m_hibernationTimer, SIGNAL(timeout()), this, SLOT(slotHibernateDocuments()));
+    m_hibernationTimer.start();
+
     // create one doc, we always have at least one around!
     createDoc();
 }
@@ -65,25 +84,19 @@ KateDocManager::~KateDocManager()
     // write metainfos?
     if (m_saveMetaInfos) {
         // saving meta-infos when file is saved is not enough, we need to do it once more at the end
+        // old entries expire inside the store
         saveMetaInfos(m_docList);
-
-        // purge saved filesessions
-        if (m_daysMetaInfos > 0) {
-            const QStringList groups = m_metaInfos.groupList();
-            QDateTime def(QDate(1970, 1, 1));
-            for (QStringList::const_iterator it = groups.begin(); it != groups.end(); ++it) {
-                QDateTime last = m_metaInfos.group(*it).readEntry("Time", def);
-                if (last.daysTo(QDateTime::currentDateTimeUtc()) > m_daysMetaInfos) {
-                    m_metaInfos.deleteGroup(*it);
-                }
-            }
-        }
     }
 
     qDeleteAll(m_docInfos);
 }
 
 KTextEditor::Document *KateDocManager::createDoc(const KateDocumentInfo &docInfo)
+{
+    return createDoc(docInfo, nullptr);
+}
+
+KTextEditor::Document *KateDocManager::createDoc(const KateDocumentInfo &docInfo, const QMap<QString, QString> *pendingConfig)
 {
     KTextEditor::Document *doc = KTextEditor::Editor::instance()->createDocument(this);
 
@@ -99,37 +112,96 @@ KTextEditor::Document *KateDocManager::createDoc(const KateDocumentInfo &docInfo
 
     // connect internal signals...
     connect(doc, SIGNAL(modifiedChanged(KTextEditor::Document*)), this, SLOT(slotModChanged1(KTextEditor::Document*)));
+    connect(doc, SIGNAL(documentUrlChanged(KTextEditor::Document*)), this, SLOT(slotDocumentUrlChanged(KTextEditor::Document*)));
     connect(doc, SIGNAL(modifiedOnDisk(KTextEditor::Document*,bool,KTextEditor::ModificationInterface::ModifiedOnDiskReason)),
             this, SLOT(slotModifiedOnDisc(KTextEditor::Document*,bool,KTextEditor::ModificationInterface::ModifiedOnDiskReason)));
 
-    // we have a new document, show it the world
+    // documents that wait for loading know their url before anybody sees them
+    if (pendingConfig) {
+        setPending(doc, *pendingConfig);
+    }
+
+    // we have a new document, show it the world, plugins only see loaded documents
     emit documentCreated(doc);
     emit documentCreatedViewManager(doc);
+    if (!pendingConfig) {
+        emit publicDocumentCreated(doc);
+    }
 
     // return our new document
     return doc;
 }
 
+QList<KTextEditor::Document *> KateDocManager::publicDocumentList() const
+{
+    if (m_pendingDocuments.isEmpty()) {
+        return m_docList;
+    }
+
+    QList<KTextEditor::Document *> documents;
+    documents.reserve(m_docList.size() - m_pendingDocuments.size());
+    foreach(KTextEditor::Document * doc, m_docList) {
+        if (!isPendingDocument(doc)) {
+            documents.append(doc);
+        }
+    }
+    return documents;
+}
+
+QList<KTextEditor::Document *> KateDocManager::hibernatedDocumentList() const
+{
+    QList<KTextEditor::Document *> documents;
+    foreach(KTextEditor::Document * doc, m_docList) {
+        if (m_hibernatedDocuments.contains(doc)) {
+            documents.append(doc);
+        }
+    }
+    return documents;
+}
+
 KateDocumentInfo *KateDocManager::documentInfo(KTextEditor::Document *doc)
 {
     return m_docInfos.contains(doc) ? m_docInfos[doc] : 0;
 }
 
+void KateDocManager::indexDocument(KTextEditor::Document *doc, const QUrl &url)
+{
+    const auto it = m_indexedUrls.find(doc);
+    if (it != m_indexedUrls.end()) {
+        m_urlIndex.remove(it.value(), doc);
+        m_indexedUrls.erase(it);
+    }
+
+    if (!url.isEmpty()) {
+        m_urlIndex.insert(url, doc);
+        m_indexedUrls.insert(doc, url);
+    }
+}
+
+void KateDocManager::slotDocumentUrlChanged(KTextEditor::Document *doc)
+{
+    // documents that are not loaded keep their url
+    if (isPendingDocument(doc)) {
+        return;
+    }
+
+    indexDocument(doc, doc->url());
+}
+
 KTextEditor::Document *KateDocManager::findDocument(const QUrl &url) const
 {
     QUrl u(url.adjusted(QUrl::NormalizePathSegments));
 
+    // known url? no need to ask the file system
+    if (KTextEditor::Document *doc = m_urlIndex.value(u)) {
+        return doc;
+    }
+
     // Resolve symbolic links for local files (done anyway in KTextEditor)
     if (u.isLocalFile()) {
         QString normalizedUrl = QFileInfo(u.toLocalFile()).canonicalFilePath();
-        if (!normalizedUrl.isEmpty()) {
-            u = QUrl::fromLocalFile(normalizedUrl);
-        }
-    }
-
-    foreach(KTextEditor::Document * it, m_docList) {
-        if (it->url() == u) {
-            return it;
+        if (!normalizedUrl.isEmpty() && normalizedUrl != u.toLocalFile()) {
+            return m_urlIndex.value(QUrl::fromLocalFile(normalizedUrl));
         }
     }
 
@@ -157,7 +229,8 @@ KTextEditor::Document *KateDocManager::openUrl(const QUrl &url, const QString &e
     // keep this buffer in mind to close it after opening the new url
     KTextEditor::Document *untitledDoc = nullptr;
     if ((documentList().count() == 1) && (!documentList().at(0)->isModified()
-                                          && documentList().at(0)->url().isEmpty())) {
+                                          && documentList().at(0)->url().isEmpty()
+                                          && !isPendingDocument(documentList().at(0)))) {
         untitledDoc = documentList().first();
     }
 
@@ -170,6 +243,9 @@ KTextEditor::Document *KateDocManager::openUrl(const QUrl &url, const QString &e
     // always new document if url is empty...
     if (!u.isEmpty()) {
         doc = findDocument(u);
+        if (doc) {
+            loadPendingDocument(doc);
+        }
     }
 
     if (!doc) {
@@ -218,43 +294,114 @@ bool KateDocManager::closeDocuments(const QList<KTextEditor::Document *> documen
 
     emit aboutToDeleteDocuments(documents);
 
+    /**
+     * first close all urls, stop at the first failure
+     */
     int last = 0;
     bool success = true;
+    QList<KTextEditor::Document *> closedList;
+    QSet<KTextEditor::Document *> closedDocuments;
     foreach(KTextEditor::Document * doc, documents) {
         if (closeUrl && !doc->closeUrl()) {
             success = false;    // get out on first error
             break;
         }
 
-        if (closeUrl && m_tempFiles.contains(doc)) {
-            QFileInfo fi(m_tempFiles[ doc ].first.toLocalFile());
-            if (fi.lastModified() <= m_tempFiles[ doc ].second ||
+        last++;
+        if (!closedDocuments.contains(doc)) {
+            closedDocuments.insert(doc);
+            closedList.append(doc);
+        }
+    }
+
+    if (closedList.isEmpty()) {
+        emit documentsDeleted(documents.mid(last));
+        return success;
+    }
+
+    /**
+     * temporary files: unmodified ones are deleted with one job, only modified ones need a question
+     */
+    if (closeUrl && !m_tempFiles.isEmpty()) {
+        QList<QUrl> tempFilesToDelete;
+        foreach(KTextEditor::Document * doc, closedList) {
+            const auto tempFile = m_tempFiles.find(doc);
+            if (tempFile == m_tempFiles.end()) {
+                continue;
+            }
+
+            const QUrl url = tempFile.value().first;
+            if (QFileInfo(url.toLocalFile()).lastModified() <= tempFile.value().second ||
                     KMessageBox::questionYesNo(KateApp::self()->activeKateMainWindow(),
                                                i18n("The supposedly temporary file %1 has been modified. "
-                                                    "Do you want to delete it anyway?", m_tempFiles[ doc ].first.url(QUrl::PreferLocalFile)),
+                                                    "Do you want to delete it anyway?", url.url(QUrl::PreferLocalFile)),
                                                i18n("Delete File?")) == KMessageBox::Yes) {
-                KIO::del(m_tempFiles[ doc ].first, KIO::HideProgressInfo);
-                qCDebug(LOG_KATE) << "Deleted temporary file " << m_tempFiles[ doc ].first;
-                m_tempFiles.remove(doc);
+                tempFilesToDelete.append(url);
+                qCDebug(LOG_KATE) << "Deleting temporary file " << url;
             } else {
-                m_tempFiles.remove(doc);
-                qCDebug(LOG_KATE) << "The supposedly temporary file " << m_tempFiles[ doc ].first.url() << " have been modified since loaded, and has not been deleted.";
+                qCDebug(LOG_KATE) << "The supposedly temporary file " << url.url() << " have been modified since loaded, and has not been deleted.";
             }
+            m_tempFiles.erase(tempFile);
+        }
+
+        if (!tempFilesToDelete.isEmpty()) {
+            KIO::del(tempFilesToDelete, KIO::HideProgressInfo);
         }
+    }
+
+    /**
+     * one notification for the whole batch, D-Bus and in process
+     */
+    QStringList tokens;
+    tokens.reserve(closedList.size());
+    foreach(KTextEditor::Document * doc, closedList) {
+        tokens.append(QString::number((qptrdiff)doc));
+    }
+    KateApp::self()->emitDocumentsClosed(tokens);
 
-        KateApp::self()->emitDocumentClosed(QString::number((qptrdiff)doc));
+    emit documentsWillBeDeleted(closedList);
 
-        // document will be deleted, soon
+    QSet<KTextEditor::Document *> publicDocuments;
+    foreach(KTextEditor::Document * doc, closedList) {
+        // document will be deleted, soon, plugins never saw the ones that were not loaded
         emit documentWillBeDeleted(doc);
+        if (!isPendingDocument(doc)) {
+            publicDocuments.insert(doc);
+            emit publicDocumentWillBeDeleted(doc);
+        } else if (m_hibernatedDocuments.contains(doc)) {
+            emit documentHibernationChanged(doc, false);
+        }
 
-        // really delete the document and its infos
+        // forget its infos, the document itself is deleted below
         delete m_docInfos.take(doc);
-        delete m_docList.takeAt(m_docList.indexOf(doc));
+        indexDocument(doc, QUrl());
 
-        // document is gone, emit our signals
-        emit documentDeleted(doc);
+        // closed before it was loaded, counts as restored unless it was hibernated
+        m_lastSeen.remove(doc);
+        if (m_pendingDocuments.remove(doc) && !m_hibernatedDocuments.remove(doc) && --m_documentStillToRestore == 0) {
+            QTimer::singleShot(0, this, SLOT(showRestoreErrors()));
+        }
+    }
 
-        last++;
+    /**
+     * remove all closed documents from the list in one pass, not one search per document
+     * then really delete them and emit our signals
+     */
+    QList<KTextEditor::Document *> remainingDocuments;
+    remainingDocuments.reserve(m_docList.size() - closedDocuments.size());
+    foreach(KTextEditor::Document * doc, m_docList) {
+        if (!closedDocuments.contains(doc)) {
+            remainingDocuments.append(doc);
+        }
+    }
+    m_docList = remainingDocuments;
+
+    foreach(KTextEditor::Document * doc, closedList) {
+        delete doc;
+        emit documentDeleted(doc);
+        if (publicDocuments.contains(doc)) {
+            emit publicDocumentDeleted(doc);
+        }
     }
 
     /**
@@ -426,13 +573,24 @@ void KateDocManager::saveDocumentList(KConfig *config)
     int i = 0;
     foreach(KTextEditor::Document * doc, m_docList) {
         KConfigGroup cg(config, QString::fromLatin1("Document %1").arg(i));
-        doc->writeSessionConfig(cg);
+
+        // not yet loaded documents keep their config
+        const auto pending = m_pendingDocuments.constFind(doc);
+        if (pending != m_pendingDocuments.constEnd()) {
+            for (auto it = pending.value().constBegin(); it != pending.value().constEnd(); ++it) {
+                cg.writeEntry(it.key(), it.value());
+            }
+        } else {
+            doc->writeSessionConfig(cg);
+        }
         i++;
     }
 }
 
 void KateDocManager::restoreDocumentList(KConfig *config)
 {
+    KateStartupProfiler::Span span("KateDocManager::restoreDocumentList");
+
     KConfigGroup openDocGroup(config, "Open Documents");
     unsigned int count = openDocGroup.readEntry("Count", 0);
 
@@ -440,6 +598,38 @@ void KateDocManager::restoreDocumentList(KConfig *config)
         return;
     }
 
+    m_documentStillToRestore = count;
+    m_openingErrors.clear();
+
+    /**
+     * lazy restore: only remember url and config, documents are loaded once they are shown
+     * or in the background, startup doesn't depend on the session size
+     */
+    const KConfigGroup generalGroup(KSharedConfig::openConfig(), "General");
+    if (generalGroup.readEntry("Lazy Document Restore", true)) {
+        for (unsigned int i = 0; i < count; i++) {
+            KConfigGroup cg(config, QString::fromLatin1("Document %1").arg(i));
+            const QMap<QString, QString> entries = cg.entryMap();
+            KTextEditor::Document *doc = nullptr;
+
+            if (i == 0) {
+                // the initial untitled document was already shown to plugins, it vanishes until it is loaded
+                doc = m_docList.first();
+                emit publicDocumentWillBeDeleted(doc);
+                setPending(doc, entries);
+                emit publicDocumentDeleted(doc);
+                emit pendingDocumentChanged(doc);
+            } else {
+                doc = createDoc(KateDocumentInfo(), &entries);
+            }
+
+            m_pendingQueue.append(doc);
+        }
+
+        m_pendingTimer.start();
+        return;
+    }
+
     QProgressDialog progress;
     progress.setWindowTitle(i18n("Starting Up"));
     progress.setLabelText(i18n("Reopening files from the last session..."));
@@ -447,8 +637,6 @@ void KateDocManager::restoreDocumentList(KConfig *config)
     progress.setCancelButton(nullptr);
     progress.setRange(0, count);
 
-    m_documentStillToRestore = count;
-    m_openingErrors.clear();
     for (unsigned int i = 0; i < count; i++) {
         KConfigGroup cg(config, QString::fromLatin1("Document %1").arg(i));
         KTextEditor::Document *doc = nullptr;
@@ -468,6 +656,180 @@ void KateDocManager::restoreDocumentList(KConfig *config)
     }
 }
 
+void KateDocManager::loadPendingDocument(KTextEditor::Document *doc)
+{
+    const auto pending = m_pendingDocuments.find(doc);
+    if (pending == m_pendingDocuments.end()) {
+        return;
+    }
+
+    /**
+     * replay the session config from memory
+     */
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup cg(&config, "Document");
+    for (auto it = pending.value().constBegin(); it != pending.value().constEnd(); ++it) {
+        cg.writeEntry(it.key(), it.value());
+    }
+    m_pendingDocuments.erase(pending);
+    doc->setProperty("kateHibernatedUrl", QVariant());
+    m_lastSeen.insert(doc, QDateTime::currentMSecsSinceEpoch());
+
+    // waking up from hibernation is no session restore
+    if (m_hibernatedDocuments.remove(doc)) {
+        emit documentHibernationChanged(doc, false);
+    } else {
+        connect(doc, SIGNAL(completed()), this, SLOT(documentOpened()));
+        connect(doc, SIGNAL(canceled(QString)), this, SLOT(documentOpened()));
+    }
+
+    // plugins see the document from now on, it gets its content right below
+    emit publicDocumentCreated(doc);
+
+    doc->readSessionConfig(cg);
+}
+
+void KateDocManager::setPending(KTextEditor::Document *doc, const QMap<QString, QString> &config)
+{
+    m_pendingDocuments.insert(doc, config);
+
+    // findDocument and the views must know the url already, tabs show the url it will get
+    const QUrl url(config.value(QStringLiteral("URL")));
+    if (!url.isEmpty()) {
+        indexDocument(doc, url.adjusted(QUrl::NormalizePathSegments));
+        doc->setProperty("kateHibernatedUrl", url);
+    }
+}
+
+void KateDocManager::prioritizePendingDocuments(const QList<KTextEditor::Document *> &docs)
+{
+    for (int i = docs.size() - 1; i >= 0; --i) {
+        if (isPendingDocument(docs[i])) {
+            m_pendingQueue.prepend(docs[i]);
+        }
+    }
+}
+
+void KateDocManager::slotLoadNextPendingDocument()
+{
+    /**
+     * one document per event loop iteration, stale queue entries are skipped
+     */
+    while (!m_pendingQueue.isEmpty()) {
+        KTextEditor::Document *doc = m_pendingQueue.takeFirst();
+        if (isPendingDocument(doc)) {
+            loadPendingDocument(doc);
+            break;
+        }
+    }
+
+    if (!m_pendingQueue.isEmpty()) {
+        m_pendingTimer.start();
+    }
+}
+
+bool KateDocManager::hibernateDocument(KTextEditor::Document *doc)
+{
+    if (isPendingDocument(doc) || doc->isModified() || doc->url().isEmpty() || !doc->views().isEmpty() || m_tempFiles.contains(doc)) {
+        return false;
+    }
+
+    /**
+     * keep what is needed to load it again, meta infos are stored as for closed documents
+     */
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup cg(&config, "Document");
+    doc->writeSessionConfig(cg);
+    saveMetaInfos(QList<KTextEditor::Document *>() << doc);
+
+    /**
+     * plugins see a hibernated document as closed, it is created again once it is loaded
+     */
+    emit publicDocumentWillBeDeleted(doc);
+    setPending(doc, cg.entryMap());
+    m_hibernatedDocuments.insert(doc);
+    m_lastSeen.remove(doc);
+    emit publicDocumentDeleted(doc);
+
+    /**
+     * release the buffer, the url stays indexed
+     */
+    if (!doc->closeUrl()) {
+        m_pendingDocuments.remove(doc);
+        m_hibernatedDocuments.remove(doc);
+        doc->setProperty("kateHibernatedUrl", QVariant());
+        emit publicDocumentCreated(doc);
+        return false;
+    }
+
+    emit documentHibernationChanged(doc, true);
+    return true;
+}
+
+void KateDocManager::slotHibernateDocuments()
+{
+    const KConfigGroup generalGroup(KSharedConfig::openConfig(), "General");
+    const qint64 idleTime = qint64(generalGroup.readEntry("Hibernate Idle Documents After", 0)) * 60 * 1000;
+    const qint64 budget = qint64(generalGroup.readEntry("Hibernation Memory Budget", 0)) * 1024 * 1024;
+    if (idleTime <= 0 && budget <= 0) {
+        return;
+    }
+
+    /**
+     * documents shown right now are seen, the others are candidates, oldest first
+     * the buffer size is only estimated, characters plus some overhead per line
+     */
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVector<QPair<qint64, KTextEditor::Document *> > candidates;
+    QHash<KTextEditor::Document *, qint64> sizes;
+    qint64 liveSize = 0;
+    foreach (KTextEditor::Document *doc, m_docList) {
+        if (isPendingDocument(doc)) {
+            continue;
+        }
+
+        const qint64 size = qint64(doc->totalCharacters()) * sizeof(QChar) + qint64(doc->lines()) * 64;
+        liveSize += size;
+
+        if (!doc->views().isEmpty()) {
+            m_lastSeen.insert(doc, now);
+            continue;
+        }
+
+        auto lastSeen = m_lastSeen.find(doc);
+        if (lastSeen == m_lastSeen.end()) {
+            lastSeen = m_lastSeen.insert(doc, now);
+        }
+        candidates.append(qMakePair(lastSeen.value(), doc));
+        sizes.insert(doc, size);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto &candidate : candidates) {
+        const bool idle = idleTime > 0 && (now - candidate.first) > idleTime;
+        const bool overBudget = budget > 0 && liveSize > budget;
+        if (!idle && !overBudget) {
+            break;
+        }
+
+        if (hibernateDocument(candidate.second)) {
+            liveSize -= sizes.value(candidate.second);
+        }
+    }
+}
+
+QUrl KateDocManager::documentUrl(KTextEditor::Document *doc)
+{
+    const QVariant hibernatedUrl = doc->property("kateHibernatedUrl");
+    return hibernatedUrl.isValid() ? hibernatedUrl.toUrl() : doc->url();
+}
+
+QString KateDocManager::documentName(KTextEditor::Document *doc)
+{
+    const QVariant hibernatedUrl = doc->property("kateHibernatedUrl");
+    return hibernatedUrl.isValid() ? hibernatedUrl.toUrl().fileName() : doc->documentName();
+}
+
 void KateDocManager::slotModifiedOnDisc(KTextEditor::Document *doc, bool b, KTextEditor::ModificationInterface::ModifiedOnDiskReason reason)
 {
     if (m_docInfos.contains(doc)) {
@@ -486,28 +848,34 @@ bool KateDocManager::loadMetaInfos(KTextEditor::Document *doc, const QUrl &url)
         return false;
     }
 
-    if (!m_metaInfos.hasGroup(url.toDisplayString())) {
+    const QString key = url.toDisplayString();
+    if (!m_metaInfos.contains(key)) {
         return false;
     }
 
     const QByteArray checksum = doc->checksum().toHex();
     bool ok = true;
     if (!checksum.isEmpty()) {
-        KConfigGroup urlGroup(&m_metaInfos, url.toDisplayString());
-        const QString old_checksum = urlGroup.readEntry("Checksum");
+        const QMap<QString, QString> entries = m_metaInfos.value(key);
+        const QString old_checksum = entries.value(QStringLiteral("Checksum"));
 
         if (QString::fromLatin1(checksum) == old_checksum) {
+            // the document reads its meta infos from a config group
+            KConfig config(QString(), KConfig::SimpleConfig);
+            KConfigGroup urlGroup(&config, "Meta Infos");
+            for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+                urlGroup.writeEntry(it.key(), it.value());
+            }
+
             QSet<QString> flags;
             if (documentInfo(doc)->openedByUser) {
                 flags << QStringLiteral ("SkipEncoding");
             }
             doc->readSessionConfig(urlGroup, flags);
         } else {
-            urlGroup.deleteGroup();
+            m_metaInfos.remove(key);
             ok = false;
         }
-
-        m_metaInfos.sync();
     }
 
     return ok && doc->url() == url;
@@ -529,7 +897,6 @@ void KateDocManager::saveMetaInfos(const QList<KTextEditor::Document *> &documen
     /**
      * store meta info for all non-modified documents which have some checksum
      */
-    const QDateTime now = QDateTime::currentDateTimeUtc();
     foreach(KTextEditor::Document * doc, documents) {
         /**
          * skip modified docs
@@ -542,23 +909,23 @@ void KateDocManager::saveMetaInfos(const QList<KTextEditor::Document *> &documen
         if (!checksum.isEmpty()) {
 
             /**
-             * write the group with checksum and time
+             * write the group with checksum, the store adds the time
              */
-            KConfigGroup urlGroup(&m_metaInfos, doc->url().toString());
+            KConfig config(QString(), KConfig::SimpleConfig);
+            KConfigGroup urlGroup(&config, "Meta Infos");
             urlGroup.writeEntry("Checksum", QString::fromLatin1(checksum));
-            urlGroup.writeEntry("Time", now);
 
             /**
              * write document session config
              */
             doc->writeSessionConfig(urlGroup);
+
+            /**
+             * appended to the store in the background, nothing is rewritten
+             */
+            m_metaInfos.insert(doc->url().toString(), urlGroup.entryMap());
         }
     }
-
-    /**
-     * sync to not loose data
-     */
-    m_metaInfos.sync();
 }
 
 void KateDocManager::slotModChanged(KTextEditor::Document *doc)
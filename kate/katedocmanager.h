@@ -30,10 +30,15 @@
 #include <QHash>
 #include <QMap>
 #include <QPair>
+#include <QSet>
 #include <QDateTime>
+#include <QTimer>
+#include <QUrl>
 
 #include <KConfig>
 
+#include "katemetainfostore.h"
+
 class KateMainWindow;
 
 class KateDocumentInfo
@@ -75,6 +80,19 @@ public:
         return m_docList;
     }
 
+    /**
+     * Documents handed to plugins: all documents, except the ones that wait for loading.
+     * Plugins are told about a pending document by publicDocumentCreated() once it is loaded.
+     * @return loaded documents
+     */
+    QList<KTextEditor::Document *> publicDocumentList() const;
+
+    /**
+     * Hibernated documents, they are not in publicDocumentList().
+     * @return hibernated documents
+     */
+    QList<KTextEditor::Document *> hibernatedDocumentList() const;
+
     KTextEditor::Document *openUrl(const QUrl &,
                                    const QString &encoding = QString(),
                                    bool isTempFile = false,
@@ -97,6 +115,53 @@ public:
     void saveDocumentList(KConfig *config);
     void restoreDocumentList(KConfig *config);
 
+    /**
+     * Is the document restored lazily or hibernated and not yet loaded?
+     * Such documents are known by url, but have no content yet.
+     * @param doc document to check
+     * @return true if the document waits for loading
+     */
+    bool isPendingDocument(KTextEditor::Document *doc) const {
+        return m_pendingDocuments.contains(doc);
+    }
+
+    /**
+     * Load a lazily restored or hibernated document now, does nothing for other documents.
+     * Called before a document gets its first view, is opened again or is handed to a plugin.
+     * @param doc document to load
+     */
+    void loadPendingDocument(KTextEditor::Document *doc);
+
+    /**
+     * Load these lazily restored documents first in the background,
+     * e.g. the documents of a view space in LRU order.
+     * @param docs documents, most important first
+     */
+    void prioritizePendingDocuments(const QList<KTextEditor::Document *> &docs);
+
+    /**
+     * Hibernate the document: its session config is kept, its buffer is released.
+     * Only unmodified documents with url and without views can be hibernated.
+     * The url stays available as the "kateHibernatedUrl" property of the document.
+     * @param doc document to hibernate
+     * @return true if the document is hibernated now
+     */
+    bool hibernateDocument(KTextEditor::Document *doc);
+
+    /**
+     * Url of the document, for documents that are not loaded the url they will get.
+     * @param doc document
+     * @return url of the document
+     */
+    static QUrl documentUrl(KTextEditor::Document *doc);
+
+    /**
+     * Name of the document, for documents that are not loaded the file name they will get.
+     * @param doc document
+     * @return name of the document
+     */
+    static QString documentName(KTextEditor::Document *doc);
+
     inline bool getSaveMetaInfos() {
         return m_saveMetaInfos;
     }
@@ -109,6 +174,7 @@ public:
     }
     inline void setDaysMetaInfos(int i) {
         m_daysMetaInfos = i;
+        m_metaInfos.setMaximalAge(i);
     }
 
 public Q_SLOTS:
@@ -146,6 +212,40 @@ Q_SIGNALS:
      */
     void documentCreatedViewManager(KTextEditor::Document *document);
 
+    /**
+     * This signal is emitted when the \p document becomes visible for plugins,
+     * after it was created or once it was loaded after a lazy restore or hibernation.
+     */
+    void publicDocumentCreated(KTextEditor::Document *document);
+
+    /**
+     * This signal is emitted when the \p document vanishes for plugins,
+     * before it is deleted or before it is hibernated.
+     */
+    void publicDocumentWillBeDeleted(KTextEditor::Document *document);
+
+    /**
+     * This signal is emitted when the \p document has vanished for plugins,
+     * after it was deleted or hibernated.
+     *
+     *  Warning !!! DO NOT ACCESS THE DATA REFERENCED BY THE POINTER, IT MIGHT BE INVALID
+     */
+    void publicDocumentDeleted(KTextEditor::Document *document);
+
+    /**
+     * This signal is emitted when the \p document was hibernated, after publicDocumentDeleted(),
+     * or when it is no longer hibernated: before publicDocumentCreated() once loaded,
+     * or before it is deleted.
+     * Plugins like the file tree use this to keep listing hibernated documents.
+     */
+    void documentHibernationChanged(KTextEditor::Document *document, bool hibernated);
+
+    /**
+     * This signal is emitted when an existing \p document starts to wait for loading,
+     * its documentName() and documentUrl() changed without any signal of the document itself.
+     */
+    void pendingDocumentChanged(KTextEditor::Document *document);
+
     /**
      * This signal is emitted before a \p document which should be closed is deleted
      * The document is still accessible and usable, but it will be deleted
@@ -155,6 +255,15 @@ Q_SIGNALS:
      */
     void documentWillBeDeleted(KTextEditor::Document *document);
 
+    /**
+     * This signal is emitted once per close transaction, before any of the
+     * \p documents is deleted, before the per document documentWillBeDeleted() signals.
+     * Listeners that can handle all documents in one pass should use this.
+     *
+     * @param documents documents that will be deleted
+     */
+    void documentsWillBeDeleted(const QList<KTextEditor::Document *> &documents);
+
     /**
      * This signal is emitted when the \p document has been deleted.
      *
@@ -197,16 +306,48 @@ private Q_SLOTS:
     void slotModifiedOnDisc(KTextEditor::Document *doc, bool b, KTextEditor::ModificationInterface::ModifiedOnDiskReason reason);
     void slotModChanged(KTextEditor::Document *doc);
     void slotModChanged1(KTextEditor::Document *doc);
+    void slotDocumentUrlChanged(KTextEditor::Document *doc);
 
     void showRestoreErrors();
+
+    /**
+     * load the next lazily restored document in the background
+     */
+    void slotLoadNextPendingDocument();
+
+    /**
+     * hibernate documents idle for too long or over the memory budget
+     */
+    void slotHibernateDocuments();
 private:
+    /**
+     * create a document, with pending config it waits for loading and is not shown to plugins
+     */
+    KTextEditor::Document *createDoc(const KateDocumentInfo &docInfo, const QMap<QString, QString> *pendingConfig);
+
+    /**
+     * remember the session config of a document that is not loaded, index its url
+     */
+    void setPending(KTextEditor::Document *doc, const QMap<QString, QString> &config);
+
     bool loadMetaInfos(KTextEditor::Document *doc, const QUrl &url);
     void saveMetaInfos(const QList<KTextEditor::Document *> &docs);
 
+    /**
+     * (re)index the document with its current url, empty url to remove it from the index
+     */
+    void indexDocument(KTextEditor::Document *doc, const QUrl &url);
+
     QList<KTextEditor::Document *> m_docList;
     QHash<KTextEditor::Document *, KateDocumentInfo *> m_docInfos;
 
-    KConfig m_metaInfos;
+    /**
+     * url => documents and the indexed url of each document, for findDocument
+     */
+    QMultiHash<QUrl, KTextEditor::Document *> m_urlIndex;
+    QHash<KTextEditor::Document *, QUrl> m_indexedUrls;
+
+    KateMetaInfoStore m_metaInfos;
     bool m_saveMetaInfos;
     int m_daysMetaInfos;
 
@@ -215,6 +356,20 @@ private:
     QString m_openingErrors;
     int m_documentStillToRestore;
 
+    /**
+     * lazily restored documents => their session config entries, and the order to load them in the background
+     */
+    QHash<KTextEditor::Document *, QMap<QString, QString> > m_pendingDocuments;
+    QList<KTextEditor::Document *> m_pendingQueue;
+    QTimer m_pendingTimer;
+
+    /**
+     * pending documents that were hibernated and not restored, time a document was last seen with a view
+     */
+    QSet<KTextEditor::Document *> m_hibernatedDocuments;
+    QHash<KTextEditor::Document *, qint64> m_lastSeen;
+    QTimer m_hibernationTimer;
+
 private Q_SLOTS:
     void documentOpened();
 };
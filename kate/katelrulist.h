@@ -0,0 +1,184 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_LRU_LIST_H
+#define KATE_LRU_LIST_H
+
+#include <QHash>
+#include <QList>
+
+/**
+ * Most recently used ordering of items, e.g. views or documents.
+ *
+ * The items are linked in a doubly linked list, the links are stored
+ * in a hash next to the item. Moving an item to the front, removing it
+ * or checking for it is O(1), reading the list in order never sorts.
+ */
+template<typename T>
+class KateLruList
+{
+public:
+    /**
+     * Make @p item the most recently used one, adds it if needed.
+     * @param item item to touch
+     */
+    void touch(T item)
+    {
+        auto it = m_links.find(item);
+        if (it == m_links.end()) {
+            it = m_links.insert(item, Link());
+        } else if (m_first == item) {
+            return;
+        } else {
+            unlink(it.value());
+        }
+
+        // link as new first item
+        it.value().previous = T();
+        it.value().next = m_first;
+        if (m_first) {
+            m_links[m_first].previous = item;
+        } else {
+            m_last = item;
+        }
+        m_first = item;
+    }
+
+    /**
+     * Forget @p item.
+     * @param item item to remove
+     * @return was the item in the list?
+     */
+    bool remove(T item)
+    {
+        const auto it = m_links.find(item);
+        if (it == m_links.end()) {
+            return false;
+        }
+
+        unlink(it.value());
+        m_links.erase(it);
+        return true;
+    }
+
+    /**
+     * Forget all items.
+     */
+    void clear()
+    {
+        m_links.clear();
+        m_first = T();
+        m_last = T();
+    }
+
+    bool contains(T item) const
+    {
+        return m_links.contains(item);
+    }
+
+    int size() const
+    {
+        return m_links.size();
+    }
+
+    bool isEmpty() const
+    {
+        return m_links.isEmpty();
+    }
+
+    /**
+     * Most recently used item, T() if empty.
+     */
+    T first() const
+    {
+        return m_first;
+    }
+
+    /**
+     * Least recently used item, T() if empty.
+     */
+    T last() const
+    {
+        return m_last;
+    }
+
+    /**
+     * Item used before @p item, T() if none.
+     */
+    T next(T item) const
+    {
+        return m_links.value(item).next;
+    }
+
+    /**
+     * Item used after @p item, T() if none.
+     */
+    T previous(T item) const
+    {
+        return m_links.value(item).previous;
+    }
+
+    /**
+     * All items, most recently used first.
+     */
+    QList<T> toList() const
+    {
+        QList<T> items;
+        items.reserve(m_links.size());
+        for (T item = m_first; item; item = m_links.value(item).next) {
+            items.append(item);
+        }
+        return items;
+    }
+
+private:
+    /**
+     * links of one item
+     */
+    struct Link {
+        T previous = T();
+        T next = T();
+    };
+
+    /**
+     * take the item with the given links out of the chain, the links stay
+     */
+    void unlink(const Link &link)
+    {
+        if (link.previous) {
+            m_links[link.previous].next = link.next;
+        } else {
+            m_first = link.next;
+        }
+
+        if (link.next) {
+            m_links[link.next].previous = link.previous;
+        } else {
+            m_last = link.previous;
+        }
+    }
+
+private:
+    QHash<T, Link> m_links;
+    T m_first = T();
+    T m_last = T();
+};
+
+#endif
@@ -566,6 +566,8 @@ void KateMainWindow::readOptions()
     m_modNotification = generalGroup.readEntry("Modified Notification", false);
     KateApp::self()->documentManager()->setSaveMetaInfos(generalGroup.readEntry("Save Meta Infos", true));
     KateApp::self()->documentManager()->setDaysMetaInfos(generalGroup.readEntry("Days Meta Infos", 30));
+    m_viewManager->setMaximalViewsPerViewSpace(generalGroup.readEntry("Maximal Views Per View Space", 10));
+    KateApp::self()->sessionManager()->setAutoSaveInterval(generalGroup.readEntry("Session Autosave Interval", 0));
 
     m_paShowPath->setChecked(generalGroup.readEntry("Show Full Path in Title", false));
     m_paShowStatusBar->setChecked(generalGroup.readEntry("Show Status Bar", true));
@@ -587,6 +589,10 @@ void KateMainWindow::saveOptions()
 
     generalGroup.writeEntry("Days Meta Infos", KateApp::self()->documentManager()->getDaysMetaInfos());
 
+    generalGroup.writeEntry("Maximal Views Per View Space", m_viewManager->maximalViewsPerViewSpace());
+
+    generalGroup.writeEntry("Session Autosave Interval", KateApp::self()->sessionManager()->autoSaveInterval());
+
     generalGroup.writeEntry("Show Full Path in Title", m_paShowPath->isChecked());
     generalGroup.writeEntry("Show Status Bar", m_paShowStatusBar->isChecked());
     generalGroup.writeEntry("Show Menu Bar", m_paShowMenuBar->isChecked());
@@ -993,6 +999,12 @@ void KateMainWindow::saveProperties(KConfigGroup &config)
                 KConfigGroup group(config.config(), QString::fromLatin1("Plugin:%1:MainWindow:%2").arg(item.saveName()).arg(id));
                 interface->writeSessionConfig(group);
             }
+        } else if (item.deferred && !item.viewSessionConfig.isEmpty()) {
+            // not yet loaded, keep the view state we did read
+            KConfigGroup group(config.config(), QString::fromLatin1("Plugin:%1:MainWindow:%2").arg(item.saveName()).arg(id));
+            for (auto it = item.viewSessionConfig.constBegin(); it != item.viewSessionConfig.constEnd(); ++it) {
+                group.writeEntry(it.key(), it.value());
+            }
         }
     }
 
@@ -1150,7 +1162,14 @@ void KateMainWindow::slotQuickOpen()
 QWidget *KateMainWindow::createToolView(KTextEditor::Plugin *plugin, const QString &identifier, KTextEditor::MainWindow::ToolViewPosition pos, const QIcon &icon, const QString &text)
 {
     // FIXME KF5
-    return KateMDI::MainWindow::createToolView(plugin, identifier, (KMultiTabBar::KMultiTabBarPosition)(pos), icon.pixmap(QSize(16, 16)), text);
+    KateMDI::ToolView *toolView = KateMDI::MainWindow::createToolView(plugin, identifier, (KMultiTabBar::KMultiTabBarPosition)(pos), icon.pixmap(QSize(16, 16)), text);
+
+    // remember it, if the plugin is deferred next time, it gets a placeholder for it
+    if (toolView && plugin) {
+        KateApp::self()->pluginManager()->recordToolView(plugin, identifier, pos, icon, text);
+    }
+
+    return toolView;
 }
 
 bool KateMainWindow::moveToolView(QWidget *widget, KTextEditor::MainWindow::ToolViewPosition pos)
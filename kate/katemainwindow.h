@@ -309,10 +309,10 @@ public Q_SLOTS:
 
     /**
      * Get a list of all views for this main window.
-     * @return all views
+     * @return all views, the most recently used first
      */
     QList<KTextEditor::View *> views() {
-        return viewManager()->views();
+        return viewManager()->sortedViews();
     }
 
     /**
@@ -214,6 +214,7 @@ ToolView::ToolView(MainWindow *mainwin, Sidebar *sidebar, QWidget *parent)
     , m_sidebar(sidebar)
     , m_toolbar(nullptr)
     , m_toolVisible(false)
+    , m_contentRequested(false)
     , persistent(false)
 {
     // try to fix resize policy
@@ -248,10 +249,26 @@ void ToolView::setToolVisible(bool vis)
         return;
     }
 
+    // content needed now
+    if (vis) {
+        ensureContent();
+    }
+
     m_toolVisible = vis;
     emit toolVisibleChanged(m_toolVisible);
 }
 
+void ToolView::ensureContent()
+{
+    if (m_contentRequested) {
+        return;
+    }
+    m_contentRequested = true;
+
+    // the content created by the listeners ends up in our layout, see childEvent
+    emit contentRequested();
+}
+
 bool ToolView::toolVisible() const
 {
     return m_toolVisible;
@@ -398,6 +415,9 @@ bool Sidebar::showWidget(ToolView *widget)
         }
     }
 
+    // create lazy content before showing, else it pops up later
+    widget->ensureContent();
+
     setTab(m_widgetToId[widget], true);
 
     /**
@@ -822,6 +842,11 @@ ToolView *MainWindow::toolView(const QString &identifier) const
     return m_idToWidget[identifier];
 }
 
+KMultiTabBar::KMultiTabBarPosition MainWindow::toolViewPosition(ToolView *widget) const
+{
+    return widget->sidebar()->position();
+}
+
 void MainWindow::toolViewDeleted(ToolView *widget)
 {
     if (!widget) {
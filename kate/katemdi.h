@@ -121,6 +121,12 @@ public:
      */
     ~ToolView() override;
 
+    /**
+     * Request the content now, if not already done.
+     * Emits contentRequested() the first time.
+     */
+    Q_INVOKABLE void ensureContent();
+
 Q_SIGNALS:
     /**
      * toolview hidden or shown
@@ -128,6 +134,13 @@ Q_SIGNALS:
      */
     void toolVisibleChanged(bool visible);
 
+    /**
+     * The content is needed, e.g. the toolview is shown the first time.
+     * For plugins, they only see a QWidget and can connect to this by name
+     * to construct their widgets lazily. Emitted at most once.
+     */
+    void contentRequested();
+
     /**
      * some internal methodes needed by the main window and the sidebars
      */
@@ -169,6 +182,11 @@ private:
      */
     bool m_toolVisible;
 
+    /**
+     * content already requested?
+     */
+    bool m_contentRequested;
+
     /**
      * is this view persistent?
      */
@@ -302,6 +320,13 @@ public:
      */
     ToolView *toolView(const QString &identifier) const;
 
+    /**
+     * sidebar position of the given toolview
+     * @param widget toolview
+     * @return position of the sidebar containing the toolview
+     */
+    KMultiTabBar::KMultiTabBarPosition toolViewPosition(ToolView *widget) const;
+
     /**
      * set the toolview's tabbar style.
      * @param style the tabbar style.
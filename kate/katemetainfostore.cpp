@@ -0,0 +1,639 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "katemetainfostore.h"
+#include "katedebug.h"
+
+#include <KConfig>
+#include <KConfigGroup>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QRunnable>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace
+{
+/**
+ * log starts with this magic and a generation, record sizes are stored in front of each record
+ * a new generation is written whenever the log is rewritten
+ */
+const quint32 LogMagic = 0x4B4D4932; // KMI2
+const qint64 HeaderSize = sizeof(quint32) + sizeof(quint64);
+const qint64 SizeFieldSize = sizeof(quint32);
+
+/**
+ * record operations
+ */
+enum Operation : quint8 {
+    Insert = 1,
+    Remove = 2
+};
+
+/**
+ * unchanged entries refresh their time at most once a day
+ */
+const qint64 RefreshInterval = 24 * 60 * 60 * 1000;
+
+/**
+ * less garbage than this is never worth a rewrite
+ */
+const qint64 MinimalGarbage = 64 * 1024;
+
+/**
+ * how long to wait for other processes holding the lock, in ms
+ */
+const int LockTimeout = 5000;
+
+QByteArray serialize(const QMap<QString, QString> &entries)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_4);
+    stream << entries;
+    return data;
+}
+
+QByteArray digest(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+quint64 writeHeader(QIODevice *device)
+{
+    const quint64 generation = (quint64(QDateTime::currentMSecsSinceEpoch()) << 16) ^ quint64(QCoreApplication::applicationPid());
+    QDataStream(device) << LogMagic << generation;
+    return generation;
+}
+
+/**
+ * one record read from the log
+ */
+struct ParsedRecord {
+    qint64 offset;
+    quint32 size;
+    quint8 operation;
+    QString url;
+    qint64 time;
+    QByteArray digest;
+};
+
+/**
+ * Parse the complete records in the data.
+ * @param data records, maybe with a partial record at the end
+ * @param offset offset of the data in the log
+ * @param records filled with the records, if not null
+ * @return offset behind the last complete record
+ */
+qint64 parseRecords(const QByteArray &data, qint64 offset, QVector<ParsedRecord> *records)
+{
+    int pos = 0;
+    while (data.size() - pos >= SizeFieldSize) {
+        QDataStream sizeStream(data.mid(pos, SizeFieldSize));
+        quint32 size = 0;
+        sizeStream >> size;
+        if (qint64(size) > data.size() - pos - SizeFieldSize) {
+            break;
+        }
+
+        const QByteArray payload = data.mid(pos + SizeFieldSize, size);
+        QDataStream stream(payload);
+        stream.setVersion(QDataStream::Qt_5_4);
+        quint8 operation = 0;
+        QString url;
+        qint64 time = 0;
+        stream >> operation >> url >> time;
+        if (stream.status() != QDataStream::Ok || (operation != Insert && operation != Remove)) {
+            break;
+        }
+
+        if (records) {
+            const ParsedRecord record = { offset + pos, quint32(SizeFieldSize + size), operation, url, time, digest(payload.mid(stream.device()->pos())) };
+            records->append(record);
+        }
+        pos += SizeFieldSize + size;
+    }
+
+    return offset + pos;
+}
+}
+
+/**
+ * appends one batch to the log, in the writer thread
+ */
+class KateMetaInfoStoreWriter : public QRunnable
+{
+public:
+    KateMetaInfoStoreWriter(KateMetaInfoStore *store, const QByteArray &batch)
+        : m_store(store)
+        , m_batch(batch)
+    {
+    }
+
+    void run() override
+    {
+        QDir().mkpath(QFileInfo(m_store->m_fileName).absolutePath());
+
+        /**
+         * under the lock: pick up what other processes appended, append behind it
+         */
+        bool success = false;
+        bool reset = false;
+        qint64 tailOffset = 0;
+        qint64 batchOffset = 0;
+        QByteArray tail;
+        QLockFile lock(m_store->m_lockFileName);
+        QFile file(m_store->m_fileName);
+        if (lock.tryLock(LockTimeout) && file.open(QIODevice::ReadWrite)) {
+            tail = KateMetaInfoStore::readTail(file, &m_store->m_log, &reset, &tailOffset);
+            batchOffset = m_store->m_log.end;
+            success = file.seek(batchOffset)
+                      && file.write(m_batch) == m_batch.size()
+                      && file.flush();
+            if (success) {
+                m_store->m_log.end += m_batch.size();
+            }
+        }
+
+        QMetaObject::invokeMethod(m_store, "batchWritten", Qt::QueuedConnection, Q_ARG(bool, success), Q_ARG(bool, reset)
+                                  , Q_ARG(qint64, tailOffset), Q_ARG(QByteArray, tail), Q_ARG(qint64, batchOffset));
+    }
+
+private:
+    KateMetaInfoStore *const m_store;
+    const QByteArray m_batch;
+};
+
+KateMetaInfoStore::KateMetaInfoStore(const QString &fileName, QObject *parent)
+    : QObject(parent)
+    , m_fileName(fileName)
+    , m_lockFileName(fileName + QStringLiteral(".lock"))
+    , m_loaded(false)
+    , m_maximalAge(0)
+    , m_serial(0)
+    , m_failed(false)
+{
+    m_log.generation = 0;
+    m_log.end = 0;
+
+    /**
+     * collect changes for a while, the writer appends them in order
+     */
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(2000);
+    connect(&m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    m_writer.setMaxThreadCount(1);
+}
+
+KateMetaInfoStore::~KateMetaInfoStore()
+{
+    if (!m_loaded) {
+        return;
+    }
+
+    sync();
+    if (!m_failed) {
+        compact();
+    }
+}
+
+void KateMetaInfoStore::setMaximalAge(int days)
+{
+    m_maximalAge = qint64(days) * 24 * 60 * 60 * 1000;
+}
+
+QByteArray KateMetaInfoStore::readTail(QFile &file, LogState *state, bool *reset, qint64 *tailOffset)
+{
+    *reset = false;
+
+    /**
+     * new or unknown log => start a new one
+     */
+    quint32 magic = 0;
+    quint64 generation = 0;
+    if (file.size() >= HeaderSize && file.seek(0)) {
+        QDataStream(&file) >> magic >> generation;
+    }
+    if (magic != LogMagic) {
+        if (file.size() > 0) {
+            qCWarning(LOG_KATE) << "Discarding invalid meta info store" << file.fileName();
+        }
+        file.resize(0);
+        file.seek(0);
+        generation = writeHeader(&file);
+    }
+
+    /**
+     * rewritten by someone else => everything is new
+     */
+    if (generation != state->generation || state->end < HeaderSize || state->end > file.size()) {
+        *reset = true;
+        state->generation = generation;
+        state->end = HeaderSize;
+    }
+
+    /**
+     * cut off a partially written tail, appends continue after the last good record
+     */
+    file.seek(state->end);
+    QByteArray tail = file.readAll();
+    const qint64 end = parseRecords(tail, state->end, nullptr);
+    if (end < state->end + tail.size()) {
+        qCWarning(LOG_KATE) << "Truncating damaged meta info store" << file.fileName() << "at" << end;
+        file.resize(end);
+        tail.truncate(end - state->end);
+    }
+
+    *tailOffset = state->end;
+    state->end = end;
+    return tail;
+}
+
+void KateMetaInfoStore::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    /**
+     * other processes might write right now
+     */
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+    QLockFile lock(m_lockFileName);
+    QFile file(m_fileName);
+    if (!lock.tryLock(LockTimeout) || !file.open(QIODevice::ReadWrite)) {
+        qCWarning(LOG_KATE) << "Can't open meta info store" << m_fileName;
+        m_failed = true;
+        return;
+    }
+
+    /**
+     * no valid log yet => import the old config afterwards
+     */
+    quint32 magic = 0;
+    QDataStream(&file) >> magic;
+    const bool fresh = (magic != LogMagic);
+
+    /**
+     * read all records, only url and time are kept
+     */
+    bool reset = false;
+    qint64 tailOffset = 0;
+    const QByteArray tail = readTail(file, &m_log, &reset, &tailOffset);
+    indexRecords(true, tailOffset, tail);
+    file.close();
+    lock.unlock();
+
+    /**
+     * keep the reader open, a rewrite by another process doesn't move our records then
+     */
+    m_reader.setFileName(m_fileName);
+    m_reader.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    if (fresh) {
+        importConfig();
+    }
+}
+
+void KateMetaInfoStore::indexRecords(bool reset, qint64 offset, const QByteArray &data)
+{
+    /**
+     * new log => the records on disk moved, only the ones not yet written stay
+     */
+    if (reset) {
+        for (auto it = m_index.begin(); it != m_index.end();) {
+            if (it->offset >= 0) {
+                it = m_index.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        m_reader.close();
+    }
+
+    QVector<ParsedRecord> records;
+    parseRecords(data, offset, &records);
+    foreach (const ParsedRecord &parsed, records) {
+        const auto it = m_index.find(parsed.url);
+        if (it != m_index.end() && it->offset < 0) {
+            continue;
+        }
+
+        if (parsed.operation == Insert) {
+            const Record record = { parsed.offset, parsed.time, parsed.size, 0, parsed.digest };
+            m_index.insert(parsed.url, record);
+        } else if (it != m_index.end()) {
+            m_index.erase(it);
+        }
+    }
+}
+
+void KateMetaInfoStore::importConfig()
+{
+    if (m_legacyConfig.isEmpty() || !QFile::exists(m_legacyConfig)) {
+        return;
+    }
+
+    const KConfig config(m_legacyConfig, KConfig::SimpleConfig);
+    const QDateTime def(QDate(1970, 1, 1));
+    foreach (const QString &group, config.groupList()) {
+        const KConfigGroup urlGroup(&config, group);
+        QMap<QString, QString> entries = urlGroup.entryMap();
+        entries.remove(QStringLiteral("Time"));
+        store(group, entries, serialize(entries), urlGroup.readEntry("Time", def).toMSecsSinceEpoch());
+    }
+
+    flush();
+}
+
+bool KateMetaInfoStore::isExpired(const Record &record) const
+{
+    return m_maximalAge > 0 && (QDateTime::currentMSecsSinceEpoch() - record.time) > m_maximalAge;
+}
+
+bool KateMetaInfoStore::contains(const QString &url)
+{
+    load();
+
+    const auto it = m_index.constFind(url);
+    return it != m_index.constEnd() && !isExpired(*it);
+}
+
+QMap<QString, QString> KateMetaInfoStore::value(const QString &url)
+{
+    load();
+
+    const auto it = m_index.constFind(url);
+    if (it == m_index.constEnd() || isExpired(*it)) {
+        return QMap<QString, QString>();
+    }
+
+    /**
+     * not yet on disk?
+     */
+    if (it->offset < 0) {
+        return m_unwritten.value(it->serial);
+    }
+
+    QDataStream stream(readRecord(*it));
+    stream.setVersion(QDataStream::Qt_5_4);
+    quint32 size = 0;
+    quint8 operation = 0;
+    QString storedUrl;
+    qint64 time = 0;
+    QMap<QString, QString> entries;
+    stream >> size >> operation >> storedUrl >> time >> entries;
+    if (stream.status() != QDataStream::Ok || storedUrl != url) {
+        qCWarning(LOG_KATE) << "Can't read meta infos for" << url;
+        return QMap<QString, QString>();
+    }
+
+    return entries;
+}
+
+void KateMetaInfoStore::insert(const QString &url, const QMap<QString, QString> &entries)
+{
+    load();
+
+    /**
+     * unchanged => avoid growing the log, just keep the record from expiring
+     */
+    const QByteArray data = serialize(entries);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const auto it = m_index.constFind(url);
+    if (it != m_index.constEnd() && (now - it->time) < RefreshInterval && it->digest == digest(data)) {
+        return;
+    }
+
+    store(url, entries, data, now);
+}
+
+void KateMetaInfoStore::store(const QString &url, const QMap<QString, QString> &entries, const QByteArray &data, qint64 time)
+{
+    const auto it = m_index.constFind(url);
+    if (it != m_index.constEnd() && it->offset < 0) {
+        m_unwritten.remove(it->serial);
+    }
+
+    const Record record = append(url, time, &data);
+    m_index.insert(url, record);
+    m_unwritten.insert(record.serial, entries);
+}
+
+void KateMetaInfoStore::remove(const QString &url)
+{
+    load();
+
+    const auto it = m_index.find(url);
+    if (it == m_index.end()) {
+        return;
+    }
+
+    if (it->offset < 0) {
+        m_unwritten.remove(it->serial);
+    }
+    m_index.erase(it);
+
+    append(url, 0, nullptr);
+}
+
+int KateMetaInfoStore::count()
+{
+    load();
+    return m_index.size();
+}
+
+KateMetaInfoStore::Record KateMetaInfoStore::append(const QString &url, qint64 time, const QByteArray *data)
+{
+    QByteArray payload;
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_4);
+        stream << quint8(data ? Insert : Remove) << url << time;
+    }
+    if (data) {
+        payload += *data;
+    }
+
+    QByteArray sizeField;
+    QDataStream(&sizeField, QIODevice::WriteOnly) << quint32(payload.size());
+    m_batch += sizeField;
+    m_batch += payload;
+
+    /**
+     * the offset is known once the batch is written
+     */
+    const Record record = { -1, time, quint32(SizeFieldSize + payload.size()), ++m_serial, data ? digest(*data) : QByteArray() };
+    const PendingRecord pending = { url, record.serial, record.size, !data };
+    m_batchRecords.append(pending);
+
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+
+    return record;
+}
+
+QByteArray KateMetaInfoStore::readRecord(const Record &record)
+{
+    /**
+     * unbuffered, the writers append behind our back
+     */
+    if (!m_reader.isOpen()) {
+        m_reader.setFileName(m_fileName);
+        if (!m_reader.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+            return QByteArray();
+        }
+    }
+
+    if (!m_reader.seek(record.offset)) {
+        return QByteArray();
+    }
+
+    const QByteArray data = m_reader.read(record.size);
+    return (data.size() == int(record.size)) ? data : QByteArray();
+}
+
+void KateMetaInfoStore::flush()
+{
+    m_flushTimer.stop();
+    if (m_batch.isEmpty()) {
+        return;
+    }
+
+    /**
+     * after a failed write everything stays in memory
+     */
+    if (!m_failed) {
+        m_batchesInFlight.append(m_batchRecords);
+        m_writer.start(new KateMetaInfoStoreWriter(this, m_batch));
+    }
+    m_batch.clear();
+    m_batchRecords.clear();
+}
+
+void KateMetaInfoStore::batchWritten(bool success, bool reset, qint64 tailOffset, const QByteArray &tail, qint64 batchOffset)
+{
+    const QVector<PendingRecord> records = m_batchesInFlight.takeFirst();
+
+    /**
+     * records of other processes come first in the log
+     */
+    indexRecords(reset, tailOffset, tail);
+
+    if (!success) {
+        qCWarning(LOG_KATE) << "Can't write meta info store" << m_fileName;
+        m_failed = true;
+        return;
+    }
+
+    /**
+     * our records are on disk now, unless replaced in the meantime
+     */
+    qint64 offset = batchOffset;
+    foreach (const PendingRecord &pending, records) {
+        const auto it = m_index.find(pending.url);
+        if (pending.removal) {
+            if (it != m_index.end() && it->offset >= 0) {
+                m_index.erase(it);
+            }
+        } else if (it != m_index.end() && it->serial == pending.serial) {
+            it->offset = offset;
+            m_unwritten.remove(pending.serial);
+        }
+        offset += pending.size;
+    }
+}
+
+void KateMetaInfoStore::sync()
+{
+    flush();
+    m_writer.waitForDone();
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+void KateMetaInfoStore::compact()
+{
+    /**
+     * under the lock, with the records of other processes indexed, too
+     */
+    QLockFile lock(m_lockFileName);
+    QFile file(m_fileName);
+    if (!lock.tryLock(LockTimeout) || !file.open(QIODevice::ReadWrite)) {
+        return;
+    }
+
+    bool reset = false;
+    qint64 tailOffset = 0;
+    const QByteArray tail = readTail(file, &m_log, &reset, &tailOffset);
+    indexRecords(reset, tailOffset, tail);
+
+    /**
+     * live records in log order, expired ones count as garbage
+     */
+    QVector<Record> live;
+    live.reserve(m_index.size());
+    qint64 liveSize = 0;
+    foreach (const Record &record, m_index) {
+        if (record.offset >= 0 && !isExpired(record)) {
+            live.append(record);
+            liveSize += record.size;
+        }
+    }
+
+    const qint64 garbage = m_log.end - HeaderSize - liveSize;
+    if (garbage <= liveSize || garbage < MinimalGarbage) {
+        return;
+    }
+
+    std::sort(live.begin(), live.end(), [](const Record &a, const Record &b) {
+        return a.offset < b.offset;
+    });
+
+    /**
+     * new generation, other processes index the new log from scratch
+     */
+    QSaveFile output(m_fileName);
+    if (!output.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    writeHeader(&output);
+    foreach (const Record &record, live) {
+        const QByteArray data = (file.seek(record.offset)) ? file.read(record.size) : QByteArray();
+        if (data.size() != int(record.size)) {
+            output.cancelWriting();
+            break;
+        }
+        output.write(data);
+    }
+
+    file.close();
+    m_reader.close();
+    output.commit();
+}
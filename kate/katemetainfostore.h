@@ -0,0 +1,307 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_META_INFO_STORE_H
+#define KATE_META_INFO_STORE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+#include "kateprivate_export.h"
+
+/**
+ * Store for the meta infos of documents, keyed by url.
+ *
+ * The store is one append-only log of records. Only an index of
+ * url => (offset, time) is kept in memory, the entries of a record are read
+ * on demand. Changes are collected and appended in batches by a background
+ * thread, a replaced or removed record just becomes garbage.
+ *
+ * Several Kate processes share the log. Appends and compaction take a lock
+ * file, under the lock the records other processes appended since are read
+ * and indexed first, the own batch is appended behind them. Compaction
+ * writes a log with a new generation in its header, a process seeing a new
+ * generation indexes the whole log again.
+ *
+ * Records older than the maximal age are ignored on lookup and dropped when
+ * the log is compacted. Compaction only happens on destruction and only if
+ * more than half of the log is garbage.
+ */
+class KATE_TESTS_EXPORT KateMetaInfoStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Construct store, the log is read on first access.
+     * @param fileName file name of the log
+     * @param parent parent object
+     */
+    explicit KateMetaInfoStore(const QString &fileName, QObject *parent = nullptr);
+
+    /**
+     * deconstruct store, writes all changes and compacts the log if needed
+     */
+    ~KateMetaInfoStore() override;
+
+    /**
+     * Set the maximal age of records.
+     * @param days maximal age in days, 0 to keep records forever
+     */
+    void setMaximalAge(int days);
+
+    /**
+     * Is there a not expired record for the url?
+     * @param url url of the document
+     * @return true if a record exists
+     */
+    bool contains(const QString &url);
+
+    /**
+     * Entries of the record for the url.
+     * @param url url of the document
+     * @return entries, empty if no record exists
+     */
+    QMap<QString, QString> value(const QString &url);
+
+    /**
+     * Insert or replace the record for the url, with the current time.
+     * Unchanged entries only refresh the time once in a while.
+     * @param url url of the document
+     * @param entries entries to store
+     */
+    void insert(const QString &url, const QMap<QString, QString> &entries);
+
+    /**
+     * Remove the record for the url.
+     * @param url url of the document
+     */
+    void remove(const QString &url);
+
+    /**
+     * Import this old KConfig based meta info file if the log doesn't exist yet.
+     * @param fileName full path of the config file
+     */
+    void setLegacyConfig(const QString &fileName) {
+        m_legacyConfig = fileName;
+    }
+
+    /**
+     * number of records, including expired ones
+     * @return record count
+     */
+    int count();
+
+    /**
+     * Hand all changes to the writer thread and wait until they are on disk.
+     */
+    void sync();
+
+private Q_SLOTS:
+    /**
+     * hand the collected changes to the writer thread
+     */
+    void flush();
+
+    /**
+     * the writer thread did append a batch
+     * @param success was the batch written?
+     * @param reset was the log replaced by another process?
+     * @param tailOffset offset of the records of other processes
+     * @param tail records of other processes appended before the batch
+     * @param batchOffset offset the batch was written at
+     */
+    void batchWritten(bool success, bool reset, qint64 tailOffset, const QByteArray &tail, qint64 batchOffset);
+
+private:
+    friend class KateMetaInfoStoreWriter;
+
+    /**
+     * Position in the log file the index is up to date with.
+     * Owned by the writer thread while batches are written.
+     */
+    struct LogState {
+        quint64 generation;
+        qint64 end;
+    };
+
+    /**
+     * Bring the log file up to date, must be called with the lock held.
+     * Creates the header of a new log, cuts off a damaged tail and reads the
+     * records appended since the state was last updated.
+     * @param file log file, open for reading and writing
+     * @param state state to update
+     * @param reset set to true if the log was replaced, the whole log is in the tail then
+     * @param tailOffset set to the offset of the tail
+     * @return the records appended since the last update
+     */
+    static QByteArray readTail(QFile &file, LogState *state, bool *reset, qint64 *tailOffset);
+
+    /**
+     * one record in the index
+     * records not yet on disk have offset -1, their entries are in m_unwritten
+     */
+    struct Record {
+        qint64 offset;
+        qint64 time;
+        quint32 size;
+        quint64 serial;
+        QByteArray digest;
+    };
+
+    /**
+     * one record of a batch, to find its offset once the batch is written
+     */
+    struct PendingRecord {
+        QString url;
+        quint64 serial;
+        quint32 size;
+        bool removal;
+    };
+
+    /**
+     * read the index from the log, once
+     */
+    void load();
+
+    /**
+     * import the legacy config, done once if no log exists
+     */
+    void importConfig();
+
+    /**
+     * Index records read from the log.
+     * Records this process did change later are left alone, the own batches follow them in the log.
+     * @param reset the log was replaced, forget all records on disk first
+     * @param offset offset of the data in the log
+     * @param data complete records
+     */
+    void indexRecords(bool reset, qint64 offset, const QByteArray &data);
+
+    /**
+     * Insert or replace the record for the url.
+     * @param url url of the document
+     * @param entries entries to store
+     * @param data serialized entries
+     * @param time time in ms since epoch
+     */
+    void store(const QString &url, const QMap<QString, QString> &entries, const QByteArray &data, qint64 time);
+
+    /**
+     * Append a record to the current batch.
+     * @param url url of the document
+     * @param time time in ms since epoch, ignored for removals
+     * @param data serialized entries, nullptr for a removal
+     * @return the appended record, not yet on disk
+     */
+    Record append(const QString &url, qint64 time, const QByteArray *data);
+
+    /**
+     * is the record expired?
+     */
+    bool isExpired(const Record &record) const;
+
+    /**
+     * Read the raw record at the offset.
+     * @param record record to read
+     * @return record data, empty on error
+     */
+    QByteArray readRecord(const Record &record);
+
+    /**
+     * rewrite the log with only the live records, including the ones of other processes
+     */
+    void compact();
+
+private:
+    /**
+     * file name of the log and of its lock
+     */
+    const QString m_fileName;
+    const QString m_lockFileName;
+
+    /**
+     * old config to import
+     */
+    QString m_legacyConfig;
+
+    /**
+     * log read yet?
+     */
+    bool m_loaded;
+
+    /**
+     * url => record
+     */
+    QHash<QString, Record> m_index;
+
+    /**
+     * part of the log the index knows, see LogState
+     */
+    LogState m_log;
+
+    /**
+     * maximal age in ms, 0 for forever
+     */
+    qint64 m_maximalAge;
+
+    /**
+     * records not yet handed to the writer, batches handed to the writer but not yet written
+     * and entries of records not yet on disk, by serial
+     */
+    QByteArray m_batch;
+    QVector<PendingRecord> m_batchRecords;
+    QList<QVector<PendingRecord> > m_batchesInFlight;
+    QHash<quint64, QMap<QString, QString> > m_unwritten;
+
+    /**
+     * serial of the last appended record
+     */
+    quint64 m_serial;
+
+    /**
+     * reader for records on disk
+     */
+    QFile m_reader;
+
+    /**
+     * collects changes before flushing
+     */
+    QTimer m_flushTimer;
+
+    /**
+     * single writer thread, batches are appended in order
+     */
+    QThreadPool m_writer;
+
+    /**
+     * did a write fail? then changes are only kept in memory
+     */
+    bool m_failed;
+};
+
+#endif
@@ -24,12 +24,15 @@
 
 #include "kateapp.h"
 #include "katemainwindow.h"
+#include "katepluginplaceholder.h"
+#include "katestartupprofiler.h"
 #include "katedebug.h"
 
 #include <KConfig>
 #include <KConfigGroup>
 #include <KPluginFactory>
 #include <KPluginLoader>
+#include <KSharedConfig>
 
 #include <QFile>
 #include <QFileInfo>
@@ -50,6 +53,9 @@ KatePluginManager::~KatePluginManager()
 {
     // than unload the plugins
     unloadAllPlugins();
+
+    // keep what we know about the plugin GUIs
+    KatePluginPlaceholder::syncCache();
 }
 
 void KatePluginManager::setupPluginList()
@@ -100,6 +106,8 @@ void KatePluginManager::setupPluginList()
 
 void KatePluginManager::loadConfig(KConfig *config)
 {
+    KateStartupProfiler::Span span("KatePluginManager::loadConfig");
+
     // first: unload the plugins
     unloadAllPlugins();
 
@@ -115,11 +123,25 @@ void KatePluginManager::loadConfig(KConfig *config)
         }
     }
 
+    /**
+     * plugins not loaded per default may wait until first use, if we know their GUI
+     */
+    const bool deferLoading = KConfigGroup(KSharedConfig::openConfig(), "General").readEntry("Deferred Plugin Loading", false);
+
     /**
      * load plugins
      */
     for (KatePluginList::iterator it = m_pluginList.begin(); it != m_pluginList.end(); ++it) {
-        if (it->load) {
+        if (it->load && deferLoading && !it->defaultLoad && KatePluginPlaceholder::isCached(*it)) {
+            /**
+             * keep the config for later + add placeholders to already existing main windows
+             */
+            it->deferred = true;
+            if (config) {
+                it->sessionConfig = KConfigGroup(config, QString::fromLatin1("Plugin:%1:").arg(it->saveName())).entryMap();
+            }
+            enablePluginGUI(&(*it));
+        } else if (it->load) {
             /**
              * load plugin + trigger update of GUI for already existing main windows
              */
@@ -149,6 +171,11 @@ void KatePluginManager::writeConfig(KConfig *config)
         if (auto interface = qobject_cast<KTextEditor::SessionConfigInterface *> (plugin.plugin)) {
             KConfigGroup group(config, QString::fromLatin1("Plugin:%1:").arg(saveName));
             interface->writeSessionConfig(group);
+        } else if (plugin.deferred) {
+            KConfigGroup group(config, QString::fromLatin1("Plugin:%1:").arg(saveName));
+            for (auto it = plugin.sessionConfig.constBegin(); it != plugin.sessionConfig.constEnd(); ++it) {
+                group.writeEntry(it.key(), it.value());
+            }
         }
     }
 }
@@ -156,7 +183,7 @@ void KatePluginManager::writeConfig(KConfig *config)
 void KatePluginManager::unloadAllPlugins()
 {
     for (KatePluginList::iterator it = m_pluginList.begin(); it != m_pluginList.end(); ++it) {
-        if (it->plugin) {
+        if (it->plugin || it->deferred) {
             unloadPlugin(&(*it));
         }
     }
@@ -165,7 +192,7 @@ void KatePluginManager::unloadAllPlugins()
 void KatePluginManager::enableAllPluginsGUI(KateMainWindow *win, KConfigBase *config)
 {
     for (KatePluginList::iterator it = m_pluginList.begin(); it != m_pluginList.end(); ++it) {
-        if (it->plugin) {
+        if (it->plugin || it->deferred) {
             enablePluginGUI(&(*it), win, config);
         }
     }
@@ -174,7 +201,7 @@ void KatePluginManager::enableAllPluginsGUI(KateMainWindow *win, KConfigBase *co
 void KatePluginManager::disableAllPluginsGUI(KateMainWindow *win)
 {
     for (KatePluginList::iterator it = m_pluginList.begin(); it != m_pluginList.end(); ++it) {
-        if (it->plugin) {
+        if (it->plugin || it->deferred) {
             disablePluginGUI(&(*it), win);
         }
     }
@@ -182,6 +209,8 @@ void KatePluginManager::disableAllPluginsGUI(KateMainWindow *win)
 
 bool KatePluginManager::loadPlugin(KatePluginInfo *item)
 {
+    KateStartupProfiler::Span span("loadPlugin", item->saveName());
+
     /**
      * try to load the plugin
      */
@@ -208,16 +237,85 @@ void KatePluginManager::unloadPlugin(KatePluginInfo *item)
     KTextEditor::Plugin *plugin = item->plugin;
     item->plugin = nullptr;
     item->load = false;
-    emit KateApp::self()->wrapper()->pluginDeleted(item->saveName(), plugin);
+    item->deferred = false;
+    item->sessionConfig.clear();
+    item->viewSessionConfig.clear();
+    if (plugin) {
+        emit KateApp::self()->wrapper()->pluginDeleted(item->saveName(), plugin);
+    }
+}
+
+bool KatePluginManager::loadDeferredPlugin(KatePluginInfo *item)
+{
+    if (!item->deferred) {
+        return item->plugin != nullptr;
+    }
+    item->deferred = false;
+
+    /**
+     * session config to pass on, like loadConfig and the main windows would do
+     */
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup pluginGroup(&config, QString::fromLatin1("Plugin:%1:").arg(item->saveName()));
+    for (auto it = item->sessionConfig.constBegin(); it != item->sessionConfig.constEnd(); ++it) {
+        pluginGroup.writeEntry(it.key(), it.value());
+    }
+    KConfigGroup viewGroup(&config, QString::fromLatin1("Plugin:%1:MainWindow:0").arg(item->saveName()));
+    for (auto it = item->viewSessionConfig.constBegin(); it != item->viewSessionConfig.constEnd(); ++it) {
+        viewGroup.writeEntry(it.key(), it.value());
+    }
+    item->sessionConfig.clear();
+    item->viewSessionConfig.clear();
+
+    /**
+     * placeholders must go first, the real tool views use the same identifiers
+     */
+    QList<KatePluginPlaceholder *> placeholders;
+    for (int i = 0; i < KateApp::self()->mainWindowsCount(); i++) {
+        KatePluginPlaceholder *placeholder = KateApp::self()->mainWindow(i)->findChild<KatePluginPlaceholder *>(item->saveName(), Qt::FindDirectChildrenOnly);
+        if (placeholder) {
+            placeholder->discard();
+        }
+        placeholders.append(placeholder);
+    }
+
+    const bool loaded = loadPlugin(item);
+    for (int i = 0; i < placeholders.size(); i++) {
+        if (loaded) {
+            enablePluginGUI(item, KateApp::self()->mainWindow(i), &config);
+        }
+        if (placeholders[i]) {
+            placeholders[i]->handOver();
+        }
+    }
+
+    if (auto interface = qobject_cast<KTextEditor::SessionConfigInterface *> (item->plugin)) {
+        interface->readSessionConfig(pluginGroup);
+    }
+
+    return loaded;
 }
 
 void KatePluginManager::enablePluginGUI(KatePluginInfo *item, KateMainWindow *win, KConfigBase *config)
 {
+    // deferred => keep the view config for later, placeholders only
+    if (item->deferred) {
+        if (config) {
+            item->viewSessionConfig = KConfigGroup(config, QString::fromLatin1("Plugin:%1:MainWindow:0").arg(item->saveName())).entryMap();
+        }
+        if (!win->findChild<KatePluginPlaceholder *>(item->saveName(), Qt::FindDirectChildrenOnly)) {
+            new KatePluginPlaceholder(*item, win);
+        }
+        return;
+    }
+
     // plugin around at all?
     if (!item->plugin) {
         return;
     }
 
+    KateStartupProfiler::Span span("createPluginView", item->saveName());
+
     // lookup if there is already a view for it..
     QObject *createdView = nullptr;
     if (!win->pluginViews().contains(item->plugin)) {
@@ -225,6 +323,7 @@ void KatePluginManager::enablePluginGUI(KatePluginInfo *item, KateMainWindow *wi
         createdView = item->plugin->createView(win->wrapper());
         if (createdView) {
             win->pluginViews().insert(item->plugin, createdView);
+            KatePluginPlaceholder::recordView(*item, createdView);
         }
     }
 
@@ -244,7 +343,7 @@ void KatePluginManager::enablePluginGUI(KatePluginInfo *item, KateMainWindow *wi
 void KatePluginManager::enablePluginGUI(KatePluginInfo *item)
 {
     // plugin around at all?
-    if (!item->plugin) {
+    if (!item->plugin && !item->deferred) {
         return;
     }
 
@@ -256,6 +355,12 @@ void KatePluginManager::enablePluginGUI(KatePluginInfo *item)
 
 void KatePluginManager::disablePluginGUI(KatePluginInfo *item, KateMainWindow *win)
 {
+    // deferred => just the placeholders
+    if (item->deferred) {
+        delete win->findChild<KatePluginPlaceholder *>(item->saveName(), Qt::FindDirectChildrenOnly);
+        return;
+    }
+
     // plugin around at all?
     if (!item->plugin) {
         return;
@@ -276,7 +381,7 @@ void KatePluginManager::disablePluginGUI(KatePluginInfo *item, KateMainWindow *w
 void KatePluginManager::disablePluginGUI(KatePluginInfo *item)
 {
     // plugin around at all?
-    if (!item->plugin) {
+    if (!item->plugin && !item->deferred) {
         return;
     }
 
@@ -297,7 +402,9 @@ KTextEditor::Plugin *KatePluginManager::plugin(const QString &name)
 
     /**
      * real plugin instance, if any ;)
+     * deferred plugins are loaded on first request
      */
+    loadDeferredPlugin(m_name2Plugin.value(name));
     return m_name2Plugin.value(name)->plugin;
 }
 
@@ -318,7 +425,11 @@ class KTextEditor::Plugin *KatePluginManager::loadPlugin(const QString &name, bo
     /**
      * load, bail out on error
      */
-    loadPlugin(m_name2Plugin.value(name));
+    if (m_name2Plugin.value(name)->deferred) {
+        loadDeferredPlugin(m_name2Plugin.value(name));
+    } else {
+        loadPlugin(m_name2Plugin.value(name));
+    }
     if (!m_name2Plugin.value(name)->plugin) {
         return nullptr;
     }
@@ -350,3 +461,12 @@ void KatePluginManager::unloadPlugin(const QString &name, bool permanent)
     m_name2Plugin.value(name)->load = !permanent;
 }
 
+void KatePluginManager::recordToolView(KTextEditor::Plugin *plugin, const QString &identifier, int position, const QIcon &icon, const QString &text)
+{
+    for (KatePluginList::iterator it = m_pluginList.begin(); it != m_pluginList.end(); ++it) {
+        if (it->plugin == plugin) {
+            KatePluginPlaceholder::recordToolView(*it, identifier, position, icon, text);
+            return;
+        }
+    }
+}
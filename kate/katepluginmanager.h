@@ -31,6 +31,7 @@
 #include <QList>
 #include <QMap>
 
+class QIcon;
 class KConfig;
 class KateMainWindow;
 
@@ -40,13 +41,27 @@ public:
     KatePluginInfo()
         : load(false)
         , defaultLoad(false)
+        , deferred(false)
         , plugin(nullptr)
     {}
     bool load;
     bool defaultLoad;
+
+    /**
+     * to be loaded, but waiting for first use, only placeholders are around
+     */
+    bool deferred;
+
     KPluginMetaData metaData;
     KTextEditor::Plugin *plugin;
     QString saveName() const;
+
+    /**
+     * session config of deferred plugins, for the plugin and its views
+     * kept to be passed on once loaded or written back on save
+     */
+    QMap<QString, QString> sessionConfig;
+    QMap<QString, QString> viewSessionConfig;
 };
 
 typedef QList<KatePluginInfo> KatePluginList;
@@ -86,9 +101,22 @@ public:
     KTextEditor::Plugin *loadPlugin(const QString &name, bool permanent = true);
     void unloadPlugin(const QString &name, bool permanent = true);
 
+    /**
+     * Remember a tool view created by a plugin, deferred plugins get a
+     * placeholder for it.
+     */
+    void recordToolView(KTextEditor::Plugin *plugin, const QString &identifier, int position, const QIcon &icon, const QString &text);
+
 private:
     void setupPluginList();
 
+    /**
+     * Load a deferred plugin, replaces its placeholders by real views.
+     * @param item plugin to load
+     * @return success, true for plugins already loaded
+     */
+    bool loadDeferredPlugin(KatePluginInfo *item);
+
     /**
      * all known plugins
      */
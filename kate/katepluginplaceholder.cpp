@@ -0,0 +1,245 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "katepluginplaceholder.h"
+
+#include "kateapp.h"
+#include "katemainwindow.h"
+#include "katemdi.h"
+#include "katepluginmanager.h"
+
+#include <KActionCollection>
+#include <KConfigGroup>
+#include <KSharedConfig>
+#include <KXMLGUIFactory>
+
+#include <QAction>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QIcon>
+#include <QKeySequence>
+#include <QStandardPaths>
+#include <QTimer>
+
+namespace
+{
+/**
+ * the cache, one group per plugin
+ */
+KSharedConfig::Ptr cache()
+{
+    return KSharedConfig::openConfig(QStringLiteral("katepluginplaceholdersrc"), KConfig::SimpleConfig, QStandardPaths::CacheLocation);
+}
+
+qint64 libraryTimestamp(const KatePluginInfo &info)
+{
+    return QFileInfo(info.metaData.fileName()).lastModified().toMSecsSinceEpoch();
+}
+
+/**
+ * cache group of the plugin, emptied if recorded for another plugin library
+ */
+KConfigGroup recordGroup(const KatePluginInfo &info)
+{
+    KConfigGroup group(cache(), info.saveName());
+    const qint64 timestamp = libraryTimestamp(info);
+    if (group.readEntry("Library Modified", qint64(0)) != timestamp) {
+        group.deleteGroup();
+        group.writeEntry("Library Modified", timestamp);
+    }
+    return group;
+}
+}
+
+KatePluginPlaceholder::KatePluginPlaceholder(const KatePluginInfo &info, KateMainWindow *mainWindow)
+    : QObject(mainWindow)
+    , KXMLGUIClient()
+    , m_name(info.saveName())
+    , m_mainWindow(mainWindow)
+{
+    setObjectName(m_name);
+
+    const KConfigGroup group(cache(), m_name);
+
+    /**
+     * tool views, shown they load the plugin
+     */
+    foreach (const QString &identifier, group.readEntry("Tool Views", QStringList())) {
+        const KConfigGroup toolViewGroup(&group, QStringLiteral("ToolView:") + identifier);
+        const QIcon icon = QIcon::fromTheme(toolViewGroup.readEntry("Icon", info.metaData.iconName()));
+        const KMultiTabBar::KMultiTabBarPosition position = KMultiTabBar::KMultiTabBarPosition(toolViewGroup.readEntry("Position", int(KMultiTabBar::Left)));
+        KateMDI::ToolView *toolView = m_mainWindow->KateMDI::MainWindow::createToolView(nullptr, identifier, position, icon, toolViewGroup.readEntry("Text", info.metaData.name()));
+        if (!toolView) {
+            continue;
+        }
+
+        m_toolViews.insert(identifier, toolView);
+        connect(toolView, &KateMDI::ToolView::toolVisibleChanged, this, [this](bool visible) {
+            if (visible) {
+                activate();
+            }
+        });
+    }
+
+    /**
+     * actions, merged into the GUI like the plugin view would do
+     */
+    const QStringList actions = group.readEntry("Actions", QStringList());
+    if (actions.isEmpty()) {
+        return;
+    }
+
+    setComponentName(group.readEntry("Component", m_name), info.metaData.name());
+    foreach (const QString &name, actions) {
+        const KConfigGroup actionGroup(&group, QStringLiteral("Action:") + name);
+        QAction *action = actionCollection()->addAction(name);
+        action->setText(actionGroup.readEntry("Text", QString()));
+        action->setIcon(QIcon::fromTheme(actionGroup.readEntry("Icon", QString())));
+        action->setShortcuts(QKeySequence::listFromString(actionGroup.readEntry("Shortcuts", QString()), QKeySequence::PortableText));
+        connect(action, &QAction::triggered, this, [this, name]() {
+            activate(name);
+        });
+    }
+
+    setXML(group.readEntry("GUI", QString()));
+    m_mainWindow->guiFactory()->addClient(this);
+}
+
+KatePluginPlaceholder::~KatePluginPlaceholder()
+{
+    discard();
+}
+
+bool KatePluginPlaceholder::isCached(const KatePluginInfo &info)
+{
+    const KConfigGroup group(cache(), info.saveName());
+    if (group.readEntry("Library Modified", qint64(0)) != libraryTimestamp(info)) {
+        return false;
+    }
+
+    return !group.readEntry("Tool Views", QStringList()).isEmpty() || !group.readEntry("Actions", QStringList()).isEmpty();
+}
+
+void KatePluginPlaceholder::recordView(const KatePluginInfo &info, QObject *view)
+{
+    KConfigGroup group = recordGroup(info);
+
+    KXMLGUIClient *client = dynamic_cast<KXMLGUIClient *>(view);
+    if (!client) {
+        return;
+    }
+
+    QStringList actions;
+    foreach (QAction *action, client->actionCollection()->actions()) {
+        if (action->objectName().isEmpty()) {
+            continue;
+        }
+
+        actions.append(action->objectName());
+        KConfigGroup actionGroup(&group, QStringLiteral("Action:") + action->objectName());
+        actionGroup.writeEntry("Text", action->text());
+        actionGroup.writeEntry("Icon", action->icon().name());
+        actionGroup.writeEntry("Shortcuts", QKeySequence::listToString(action->shortcuts(), QKeySequence::PortableText));
+    }
+
+    group.writeEntry("Component", client->componentName());
+    group.writeEntry("GUI", client->domDocument().toString());
+    group.writeEntry("Actions", actions);
+}
+
+void KatePluginPlaceholder::recordToolView(const KatePluginInfo &info, const QString &identifier, int position, const QIcon &icon, const QString &text)
+{
+    KConfigGroup group = recordGroup(info);
+
+    QStringList toolViews = group.readEntry("Tool Views", QStringList());
+    if (!toolViews.contains(identifier)) {
+        toolViews.append(identifier);
+        group.writeEntry("Tool Views", toolViews);
+    }
+
+    KConfigGroup toolViewGroup(&group, QStringLiteral("ToolView:") + identifier);
+    toolViewGroup.writeEntry("Position", position);
+    toolViewGroup.writeEntry("Icon", icon.name());
+    toolViewGroup.writeEntry("Text", text);
+}
+
+void KatePluginPlaceholder::syncCache()
+{
+    cache()->sync();
+}
+
+void KatePluginPlaceholder::discard()
+{
+    /**
+     * no longer to be found as placeholder
+     */
+    setObjectName(QString());
+
+    for (auto it = m_toolViews.constBegin(); it != m_toolViews.constEnd(); ++it) {
+        if (!it.value()) {
+            continue;
+        }
+
+        m_positions.insert(it.key(), m_mainWindow->toolViewPosition(it.value()));
+        if (it.value()->toolVisible()) {
+            m_visible.insert(it.key());
+        }
+        delete it.value().data();
+    }
+    m_toolViews.clear();
+
+    if (factory()) {
+        factory()->removeClient(this);
+    }
+}
+
+void KatePluginPlaceholder::handOver()
+{
+    for (auto it = m_positions.constBegin(); it != m_positions.constEnd(); ++it) {
+        QWidget *toolView = m_mainWindow->toolView(it.key());
+        if (!toolView) {
+            continue;
+        }
+
+        m_mainWindow->moveToolView(toolView, KTextEditor::MainWindow::ToolViewPosition(it.value()));
+        if (m_visible.contains(it.key())) {
+            m_mainWindow->showToolView(toolView);
+        }
+    }
+
+    deleteLater();
+}
+
+void KatePluginPlaceholder::activate(const QString &action)
+{
+    QTimer::singleShot(0, this, [this, action]() {
+        /**
+         * loading hands the tool views over, visible ones are shown
+         */
+        if (!KateApp::self()->pluginManager()->plugin(m_name) || action.isEmpty()) {
+            return;
+        }
+
+        KXMLGUIClient *client = dynamic_cast<KXMLGUIClient *>(m_mainWindow->pluginView(m_name));
+        if (QAction *realAction = client ? client->actionCollection()->action(action) : nullptr) {
+            realAction->trigger();
+        }
+    });
+}
@@ -0,0 +1,146 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_PLUGIN_PLACEHOLDER_H
+#define KATE_PLUGIN_PLACEHOLDER_H
+
+#include <KXMLGUIClient>
+
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+
+#include "kateprivate_export.h"
+
+class QIcon;
+class KateMainWindow;
+class KatePluginInfo;
+
+namespace KateMDI
+{
+class ToolView;
+}
+
+/**
+ * Stand-in for the view of a deferred plugin in one main window.
+ *
+ * Offers the tool views and actions the plugin view had the last time it was
+ * created. These are recorded in a cache, per plugin and only valid as long as
+ * the plugin library stays unchanged. Showing one of the tool views or
+ * triggering one of the actions loads the plugin, afterwards the real tool
+ * view is shown or the real action is triggered.
+ *
+ * The placeholder is a child of its main window, named like the plugin.
+ */
+class KATE_TESTS_EXPORT KatePluginPlaceholder : public QObject, public KXMLGUIClient
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Create the placeholder tool views and actions from the cache.
+     * @param info plugin to stand in for
+     * @param mainWindow main window to add the placeholders to
+     */
+    KatePluginPlaceholder(const KatePluginInfo &info, KateMainWindow *mainWindow);
+
+    /**
+     * Remove the placeholder GUI, if not already done.
+     */
+    ~KatePluginPlaceholder() override;
+
+    /**
+     * Is enough known about the plugin to stand in for it?
+     * @param info plugin
+     * @return true if tool views or actions are cached for the current plugin library
+     */
+    static bool isCached(const KatePluginInfo &info);
+
+    /**
+     * Record the actions and GUI description of a created plugin view.
+     * @param info plugin the view belongs to
+     * @param view plugin view, only used if it is a KXMLGUIClient
+     */
+    static void recordView(const KatePluginInfo &info, QObject *view);
+
+    /**
+     * Record a tool view created by a plugin.
+     * @param info plugin the tool view belongs to
+     * @param identifier unique identifier of the tool view
+     * @param position preferred sidebar position
+     * @param icon icon of the tool view
+     * @param text text of the tool view
+     */
+    static void recordToolView(const KatePluginInfo &info, const QString &identifier, int position, const QIcon &icon, const QString &text);
+
+    /**
+     * Write the cache to disk, if changed.
+     */
+    static void syncCache();
+
+    /**
+     * Remove the placeholder GUI, before the real plugin view is created.
+     * The positions and visibility of the tool views are remembered for handOver().
+     */
+    void discard();
+
+    /**
+     * Move the real tool views to where their placeholders were, show the ones
+     * that were visible and delete this placeholder later.
+     */
+    void handOver();
+
+private:
+    /**
+     * Load the plugin, then trigger the real action. Visible tool views are
+     * shown by handOver(). Delayed, loading the plugin deletes the placeholder GUI.
+     * @param action name of action to trigger, empty for tool views
+     */
+    void activate(const QString &action = QString());
+
+private:
+    /**
+     * plugin name
+     */
+    const QString m_name;
+
+    /**
+     * main window we belong to
+     */
+    KateMainWindow *m_mainWindow;
+
+    /**
+     * identifier => placeholder tool view
+     */
+    QMap<QString, QPointer<KateMDI::ToolView> > m_toolViews;
+
+    /**
+     * identifier => sidebar position, filled by discard()
+     */
+    QMap<QString, int> m_positions;
+
+    /**
+     * identifiers of the visible tool views, filled by discard()
+     */
+    QSet<QString> m_visible;
+};
+
+#endif
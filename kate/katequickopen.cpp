@@ -18,10 +18,9 @@
 */
 
 #include "katequickopen.h"
+#include "katequickopenmodel.h"
 
 #include "katemainwindow.h"
-#include "kateviewmanager.h"
-#include "kateapp.h"
 
 #include <ktexteditor/document.h>
 #include <ktexteditor/view.h>
@@ -34,22 +33,14 @@
 #include <KLocalizedString>
 
 #include <QEvent>
-#include <QFileInfo>
-#include <QSortFilterProxyModel>
+#include <QKeyEvent>
 #include <QCoreApplication>
 #include <QPointer>
-#include <QStandardItemModel>
 #include <QDesktopWidget>
 #include <QBoxLayout>
 #include <QLabel>
 #include <QTreeView>
 
-Q_DECLARE_METATYPE(QPointer<KTextEditor::Document>)
-
-static const int DocumentRole = Qt::UserRole + 1;
-static const int UrlRole = Qt::UserRole + 2;
-static const int SortFilterRole = Qt::UserRole + 3;
-
 KateQuickOpen::KateQuickOpen(QWidget *parent, KateMainWindow *mainWindow)
     : QWidget(parent)
     , m_mainWindow(mainWindow)
@@ -62,6 +53,7 @@ KateQuickOpen::KateQuickOpen(QWidget *parent, KateMainWindow *mainWindow)
     m_inputLine = new KLineEdit();
     setFocusProxy(m_inputLine);
     m_inputLine->setPlaceholderText(i18n("Quick Open Search"));
+    m_inputLine->setToolTip(i18n("Type to search open documents and project files, start with @ to search project symbols"));
 
     layout->addWidget(m_inputLine);
 
@@ -69,23 +61,14 @@ KateQuickOpen::KateQuickOpen(QWidget *parent, KateMainWindow *mainWindow)
     layout->addWidget(m_listView, 1);
     m_listView->setTextElideMode(Qt::ElideLeft);
 
-    m_base_model = new QStandardItemModel(0, 2, this);
-
-    m_model = new QSortFilterProxyModel(this);
-    m_model->setFilterRole(SortFilterRole);
-    m_model->setSortRole(SortFilterRole);
-    m_model->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    m_model->setSortCaseSensitivity(Qt::CaseInsensitive);
+    m_model = new KateQuickOpenModel(m_mainWindow, this);
 
-    connect(m_inputLine, &KLineEdit::textChanged, m_model, &QSortFilterProxyModel::setFilterWildcard);
+    connect(m_inputLine, &KLineEdit::textChanged, this, &KateQuickOpen::slotQueryChanged);
     connect(m_inputLine, &KLineEdit::returnPressed, this, &KateQuickOpen::slotReturnPressed);
-    connect(m_model, &QSortFilterProxyModel::rowsInserted, this, &KateQuickOpen::reselectFirst);
-    connect(m_model, &QSortFilterProxyModel::rowsRemoved, this, &KateQuickOpen::reselectFirst);
 
     connect(m_listView, &QTreeView::activated, this, &KateQuickOpen::slotReturnPressed);
 
     m_listView->setModel(m_model);
-    m_model->setSourceModel(m_base_model);
 
     m_inputLine->installEventFilter(this);
     m_listView->installEventFilter(this);
@@ -142,136 +125,29 @@ void KateQuickOpen::reselectFirst()
     m_listView->setCurrentIndex(index);
 }
 
-void KateQuickOpen::update()
+void KateQuickOpen::slotQueryChanged(const QString &query)
 {
-    /**
-     * new base mode creation
-     * remove from proxy model before populating to avoid wasting time
-     * with repeatedly sorting it
-     */
-    m_base_model->clear();
-    m_model->setSourceModel(nullptr);
-
-    /**
-     * remember local file names to avoid dupes with project files
-     */
-    QSet<QString> alreadySeenFiles;
-    QSet<KTextEditor::Document *> alreadySeenDocs;
-
-    /**
-     * get views in lru order
-     */
-    const QList<KTextEditor::View *> sortedViews(m_mainWindow->viewManager()->sortedViews());
-
-    /**
-     * now insert them in order
-     */
-    QModelIndex idxToSelect;
-    int linecount = 0;
-    foreach (KTextEditor::View *view, sortedViews) {
-        KTextEditor::Document *doc = view->document();
-
-        if (alreadySeenDocs.contains(doc)) {
-            continue;
-        }
-
-        alreadySeenDocs.insert(doc);
-
-        //QStandardItem *item=new QStandardItem(i18n("%1: %2",doc->documentName(),doc->url().toString()));
-        QStandardItem *itemName = new QStandardItem(doc->documentName());
-
-        itemName->setData(qVariantFromValue(QPointer<KTextEditor::Document> (doc)), DocumentRole);
-        itemName->setData(QString::fromLatin1("%1: %2").arg(doc->documentName()).arg(doc->url().toString()), SortFilterRole);
-        itemName->setEditable(false);
-        QFont font = itemName->font();
-        font.setBold(true);
-        itemName->setFont(font);
-
-        QStandardItem *itemUrl = new QStandardItem(doc->url().toString());
-        itemUrl->setEditable(false);
-        m_base_model->setItem(linecount, 0, itemName);
-        m_base_model->setItem(linecount, 1, itemUrl);
-        linecount++;
-
-        if (!doc->url().isEmpty() && doc->url().isLocalFile()) {
-            alreadySeenFiles.insert(doc->url().toLocalFile());
-        }
-
-        // select second document, that is the last used (beside the active one)
-        if (linecount == 2) {
-            idxToSelect = itemName->index();
-        }
-    }
+    m_model->setQuery(query);
+    reselectFirst();
+}
 
+void KateQuickOpen::update()
+{
     /**
-     * get all open documents
+     * the model is kept up to date, only the LRU order and changed project files are refreshed
      */
-    QList<KTextEditor::Document *> docs = KateApp::self()->documentManager()->documentList();
-    foreach(KTextEditor::Document * doc, docs) {
-        /**
-         * skip docs already open
-         */
-        if (alreadySeenDocs.contains(doc)) {
-            continue;
-        }
-
-        //QStandardItem *item=new QStandardItem(i18n("%1: %2",doc->documentName(),doc->url().toString()));
-        QStandardItem *itemName = new QStandardItem(doc->documentName());
-
-        itemName->setData(qVariantFromValue(QPointer<KTextEditor::Document> (doc)), DocumentRole);
-        itemName->setData(QString::fromLatin1("%1: %2").arg(doc->documentName()).arg(doc->url().toString()), SortFilterRole);
-        itemName->setEditable(false);
-        QFont font = itemName->font();
-        font.setBold(true);
-        itemName->setFont(font);
-
-        QStandardItem *itemUrl = new QStandardItem(doc->url().toString());
-        itemUrl->setEditable(false);
-        m_base_model->setItem(linecount, 0, itemName);
-        m_base_model->setItem(linecount, 1, itemUrl);
-        linecount++;
-
-        if (!doc->url().isEmpty() && doc->url().isLocalFile()) {
-            alreadySeenFiles.insert(doc->url().toLocalFile());
-        }
-    }
+    m_model->refresh();
+    m_model->setQuery(m_inputLine->text());
 
     /**
-     * insert all project files, if any project around
+     * select second document, that is the last used (beside the active one)
      */
-    if (QObject *projectView = m_mainWindow->pluginView(QStringLiteral("kateprojectplugin"))) {
-        QStringList projectFiles = projectView->property("projectFiles").toStringList();
-        foreach(const QString & file, projectFiles) {
-            /**
-             * skip files already open
-             */
-            if (alreadySeenFiles.contains(file)) {
-                continue;
-            }
-
-            QFileInfo fi(file);
-            QStandardItem *itemName = new QStandardItem(fi.fileName());
-
-            itemName->setData(qVariantFromValue(QUrl::fromLocalFile(file)), UrlRole);
-            itemName->setData(QString::fromLatin1("%1: %2").arg(fi.fileName()).arg(file), SortFilterRole);
-            itemName->setEditable(false);
-
-            QStandardItem *itemUrl = new QStandardItem(file);
-            itemUrl->setEditable(false);
-            m_base_model->setItem(linecount, 0, itemName);
-            m_base_model->setItem(linecount, 1, itemUrl);
-            linecount++;
-        }
-    }
-
-    if (idxToSelect.isValid()) {
-        m_listView->setCurrentIndex(m_model->mapFromSource(idxToSelect));
+    if (m_inputLine->text().isEmpty() && m_model->documentRowCount() >= 2) {
+        m_listView->setCurrentIndex(m_model->index(1, 0));
     } else {
         reselectFirst();
     }
 
-    m_model->setSourceModel(m_base_model);
-
     /**
      * adjust view
      */
@@ -286,13 +162,18 @@ void KateQuickOpen::slotReturnPressed()
      */
     // our data is in column 0 (clicking on column 1 results in no data, therefore, create new index)
     const QModelIndex index = m_listView->model()->index(m_listView->currentIndex().row(), 0);
-    KTextEditor::Document *doc = index.data(DocumentRole).value<QPointer<KTextEditor::Document> >();
+    KTextEditor::Document *doc = index.data(KateQuickOpenModel::DocumentRole).value<QPointer<KTextEditor::Document> >();
     if (doc) {
         m_mainWindow->wrapper()->activateView(doc);
     } else {
-        QUrl url = index.data(UrlRole).value<QUrl>();
+        QUrl url = index.data(KateQuickOpenModel::UrlRole).value<QUrl>();
         if (!url.isEmpty()) {
-            m_mainWindow->wrapper()->openUrl(url);
+            // symbols know their line
+            KTextEditor::View *view = m_mainWindow->wrapper()->openUrl(url);
+            const int line = index.data(KateQuickOpenModel::LineRole).toInt();
+            if (view && line > 0) {
+                view->setCursorPosition(KTextEditor::Cursor(line - 1, 0));
+            }
         }
     }
 
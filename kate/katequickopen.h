@@ -23,11 +23,9 @@
 #include <QWidget>
 
 class KateMainWindow;
+class KateQuickOpenModel;
 class KLineEdit;
 
-class QModelIndex;
-class QStandardItemModel;
-class QSortFilterProxyModel;
 class QTreeView;
 
 class KateQuickOpen : public QWidget
@@ -36,8 +34,8 @@ class KateQuickOpen : public QWidget
 public:
     KateQuickOpen(QWidget *parent, KateMainWindow *mainWindow);
     /**
-     * update state
-     * will fill model with current open documents, project documents, ...
+     * update state before the dialog is shown
+     * the model is kept up to date, only the LRU order of the documents is checked
      */
     void update();
 
@@ -47,6 +45,12 @@ protected:
 private Q_SLOTS:
     void reselectFirst();
 
+    /**
+     * Query changed, match it and show the best matches
+     * @param query new query
+     */
+    void slotQueryChanged(const QString &query);
+
     /**
      * Return pressed, activate the selected document
      * and go back to background
@@ -59,14 +63,9 @@ private:
     KLineEdit *m_inputLine;
 
     /**
-     * our model we search in
-     */
-    QStandardItemModel *m_base_model;
-
-    /**
-     * filtered model we search in
+     * model with the open documents and project files, shows the best matches
      */
-    QSortFilterProxyModel *m_model;
+    KateQuickOpenModel *m_model;
 };
 
 #endif
@@ -0,0 +1,284 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "katequickopenmatcher.h"
+
+#include <QPair>
+#include <QRunnable>
+#include <QThread>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+/**
+ * score and candidate index
+ */
+typedef QPair<int, int> Match;
+
+/**
+ * higher score first, equal scores keep the candidate order
+ */
+inline bool better(const Match &a, const Match &b)
+{
+    return (a.first != b.first) ? (a.first > b.first) : (a.second < b.second);
+}
+
+inline bool isBoundary(QChar c)
+{
+    return c == QLatin1Char('/') || c == QLatin1Char('_') || c == QLatin1Char('-') || c == QLatin1Char('.') || c == QLatin1Char(' ') || c == QLatin1Char(':');
+}
+
+/**
+ * Match the query as subsequence of candidate[from, size), greedy.
+ * @return score or -1 if not all query characters are found
+ */
+int subsequenceScore(const QChar *candidate, int from, int size, const QChar *query, int querySize)
+{
+    int score = 0;
+    int matched = 0;
+    int last = -2;
+    for (int i = from; i < size && matched < querySize; ++i) {
+        if (candidate[i] != query[matched]) {
+            continue;
+        }
+
+        score += 1;
+        if (i == last + 1) {
+            score += 5;
+        }
+        if (i == from || isBoundary(candidate[i - 1])) {
+            score += 8;
+        }
+
+        last = i;
+        ++matched;
+    }
+
+    return (matched == querySize) ? score : -1;
+}
+}
+
+struct KateQuickOpenMatcher::Chunk {
+    const QString *query;
+    const QVector<int> *subset;
+    int begin;
+    int end;
+    int maximalMatches;
+
+    /**
+     * all matching candidates, ascending, and the best ones as bounded heap, worst on top
+     */
+    QVector<int> matches;
+    std::vector<Match> best;
+};
+
+/**
+ * runs one chunk in the thread pool
+ */
+class KateQuickOpenMatcherRunnable : public QRunnable
+{
+public:
+    KateQuickOpenMatcherRunnable(const KateQuickOpenMatcher *matcher, KateQuickOpenMatcher::Chunk *chunk)
+        : m_matcher(matcher)
+        , m_chunk(chunk)
+    {
+    }
+
+    void run() override {
+        m_matcher->matchChunk(*m_chunk);
+    }
+
+private:
+    const KateQuickOpenMatcher *m_matcher;
+    KateQuickOpenMatcher::Chunk *m_chunk;
+};
+
+KateQuickOpenMatcher::KateQuickOpenMatcher()
+    : m_offsets(1, 0)
+{
+}
+
+KateQuickOpenMatcher::~KateQuickOpenMatcher()
+{
+    m_pool.waitForDone();
+}
+
+void KateQuickOpenMatcher::setCandidates(const QStringList &candidates)
+{
+    m_lastQuery.clear();
+    m_lastMatches.clear();
+
+    int size = 0;
+    for (const QString &candidate : candidates) {
+        size += candidate.size();
+    }
+
+    m_buffer.clear();
+    m_buffer.reserve(size);
+    m_offsets.clear();
+    m_offsets.reserve(candidates.size() + 1);
+    m_offsets.append(0);
+    m_fileNameStarts.clear();
+    m_fileNameStarts.reserve(candidates.size());
+
+    /**
+     * lowercase once, lowercasing may change the length, the file name start is computed afterwards
+     */
+    for (const QString &candidate : candidates) {
+        const QString lowered = candidate.toLower();
+        m_buffer.append(lowered);
+        m_offsets.append(m_buffer.size());
+        m_fileNameStarts.append(lowered.lastIndexOf(QLatin1Char('/')) + 1);
+    }
+}
+
+int KateQuickOpenMatcher::score(const QStringRef &candidate, int fileNameStart, const QString &query)
+{
+    /**
+     * the query must match somewhere in the path
+     */
+    const QChar *data = candidate.unicode();
+    const int size = candidate.size();
+    int score = subsequenceScore(data, 0, size, query.unicode(), query.size());
+    if (score < 0) {
+        return -1;
+    }
+
+    /**
+     * matches inside the file name are preferred, even more as substring
+     */
+    const int fileNameScore = subsequenceScore(data, fileNameStart, size, query.unicode(), query.size());
+    if (fileNameScore >= 0) {
+        score = fileNameScore + 100;
+
+        const int index = candidate.indexOf(query, fileNameStart);
+        if (index == fileNameStart) {
+            score += 100;
+        } else if (index > fileNameStart) {
+            score += 50;
+        }
+    }
+
+    /**
+     * shorter paths first
+     */
+    return score - qMin(size, 320) / 16;
+}
+
+void KateQuickOpenMatcher::matchChunk(Chunk &chunk) const
+{
+    const QString &query = *chunk.query;
+    for (int i = chunk.begin; i < chunk.end; ++i) {
+        const int candidate = chunk.subset ? chunk.subset->at(i) : i;
+        const int offset = m_offsets[candidate];
+        const int candidateScore = score(QStringRef(&m_buffer, offset, m_offsets[candidate + 1] - offset), m_fileNameStarts[candidate], query);
+        if (candidateScore < 0) {
+            continue;
+        }
+
+        chunk.matches.append(candidate);
+
+        /**
+         * bounded heap, replace the worst if this one is better
+         */
+        const Match match(candidateScore, candidate);
+        if (int(chunk.best.size()) < chunk.maximalMatches) {
+            chunk.best.push_back(match);
+            std::push_heap(chunk.best.begin(), chunk.best.end(), better);
+        } else if (better(match, chunk.best.front())) {
+            std::pop_heap(chunk.best.begin(), chunk.best.end(), better);
+            chunk.best.back() = match;
+            std::push_heap(chunk.best.begin(), chunk.best.end(), better);
+        }
+    }
+}
+
+QVector<int> KateQuickOpenMatcher::match(const QString &query, int maximalMatches)
+{
+    QVector<int> result;
+    if (maximalMatches <= 0) {
+        return result;
+    }
+
+    /**
+     * empty query: candidates in their order
+     */
+    const QString lowered = query.toLower();
+    if (lowered.isEmpty()) {
+        m_lastQuery.clear();
+        m_lastMatches.clear();
+
+        const int count = qMin(candidateCount(), maximalMatches);
+        result.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            result.append(i);
+        }
+        return result;
+    }
+
+    /**
+     * extended query: only the previous matches can still match
+     */
+    const bool incremental = !m_lastQuery.isEmpty() && lowered.startsWith(m_lastQuery);
+    const QVector<int> subset = incremental ? m_lastMatches : QVector<int>();
+    const int total = incremental ? subset.size() : candidateCount();
+
+    /**
+     * split huge lists into chunks, the first one is done in this thread
+     */
+    const int chunkCount = qBound(1, (total + int(ChunkSize) - 1) / int(ChunkSize), qMax(1, QThread::idealThreadCount()));
+    const int chunkSize = (total + chunkCount - 1) / chunkCount;
+    QVector<Chunk> chunks(chunkCount);
+    for (int i = 0; i < chunkCount; ++i) {
+        Chunk &chunk = chunks[i];
+        chunk.query = &lowered;
+        chunk.subset = incremental ? &subset : nullptr;
+        chunk.begin = qMin(i * chunkSize, total);
+        chunk.end = qMin(chunk.begin + chunkSize, total);
+        chunk.maximalMatches = maximalMatches;
+    }
+
+    for (int i = 1; i < chunkCount; ++i) {
+        m_pool.start(new KateQuickOpenMatcherRunnable(this, &chunks[i]));
+    }
+    matchChunk(chunks[0]);
+    m_pool.waitForDone();
+
+    /**
+     * merge, remember all matches for the next extended query
+     */
+    std::vector<Match> best;
+    m_lastMatches.clear();
+    for (const Chunk &chunk : chunks) {
+        best.insert(best.end(), chunk.best.begin(), chunk.best.end());
+        m_lastMatches += chunk.matches;
+    }
+    m_lastQuery = lowered;
+
+    const int count = qMin(int(best.size()), maximalMatches);
+    std::partial_sort(best.begin(), best.begin() + count, best.end(), better);
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        result.append(best[i].second);
+    }
+    return result;
+}
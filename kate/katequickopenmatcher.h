@@ -0,0 +1,132 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_QUICK_OPEN_MATCHER_H
+#define KATE_QUICK_OPEN_MATCHER_H
+
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include "kateprivate_export.h"
+
+/**
+ * Fuzzy matcher for the quick open dialog.
+ *
+ * All candidates are lowercased once into one contiguous buffer. A query
+ * matches a candidate if its characters appear in order, matches inside
+ * the file name, at word boundaries and consecutive characters score higher.
+ * Only the best matches are kept, in a bounded heap.
+ *
+ * If the query extends the previous one, only the previous matches are
+ * scanned again. Huge candidate lists are scanned in parallel chunks.
+ */
+class KATE_TESTS_EXPORT KateQuickOpenMatcher
+{
+public:
+    /**
+     * candidate lists larger than this are split into chunks for the thread pool
+     */
+    enum {
+        ChunkSize = 32768
+    };
+
+    /**
+     * construct matcher without candidates
+     */
+    KateQuickOpenMatcher();
+
+    /**
+     * deconstruct matcher, waits for running chunks
+     */
+    ~KateQuickOpenMatcher();
+
+    /**
+     * Set the candidates, forgets the previous query.
+     * @param candidates candidates, e.g. full paths of files
+     */
+    void setCandidates(const QStringList &candidates);
+
+    /**
+     * number of candidates
+     * @return candidate count
+     */
+    int candidateCount() const {
+        return m_offsets.size() - 1;
+    }
+
+    /**
+     * Match the query against all candidates.
+     * An empty query matches the first candidates in their order.
+     * @param query query as typed by the user, case is ignored
+     * @param maximalMatches maximal number of matches to return
+     * @return indices of the best matching candidates, best first
+     */
+    QVector<int> match(const QString &query, int maximalMatches);
+
+    /**
+     * Score one lowercased candidate.
+     * @param candidate lowercased candidate
+     * @param fileNameStart start of the file name inside the candidate
+     * @param query lowercased query, not empty
+     * @return score, -1 if the query doesn't match
+     */
+    static int score(const QStringRef &candidate, int fileNameStart, const QString &query);
+
+private:
+    /**
+     * matches of one chunk
+     */
+    struct Chunk;
+
+    /**
+     * Score the candidates of one chunk.
+     * @param chunk chunk to fill
+     */
+    void matchChunk(Chunk &chunk) const;
+
+    friend class KateQuickOpenMatcherRunnable;
+
+private:
+    /**
+     * all lowercased candidates, concatenated, candidate i is [m_offsets[i], m_offsets[i + 1])
+     */
+    QString m_buffer;
+    QVector<int> m_offsets;
+
+    /**
+     * start of the file name for each candidate, relative to its offset
+     */
+    QVector<int> m_fileNameStarts;
+
+    /**
+     * last lowercased query and all candidates it matched, ascending
+     */
+    QString m_lastQuery;
+    QVector<int> m_lastMatches;
+
+    /**
+     * threads for huge candidate lists
+     */
+    QThreadPool m_pool;
+};
+
+#endif
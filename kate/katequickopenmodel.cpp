@@ -0,0 +1,322 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "katequickopenmodel.h"
+
+#include "kateapp.h"
+#include "katedocmanager.h"
+#include "katemainwindow.h"
+#include "kateviewmanager.h"
+
+#include <ktexteditor/view.h>
+
+/**
+ * queries starting with this search symbols
+ */
+static const QLatin1Char SymbolPrefix('@');
+
+KateQuickOpenModel::KateQuickOpenModel(KateMainWindow *mainWindow, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_mainWindow(mainWindow)
+    , m_documentsDirty(true)
+    , m_symbolMode(false)
+{
+    m_documentFont.setBold(true);
+
+    /**
+     * track documents
+     */
+    KateDocManager *documentManager = KateApp::self()->documentManager();
+    connect(documentManager, &KateDocManager::documentCreated, this, &KateQuickOpenModel::slotDocumentCreated);
+    connect(documentManager, &KateDocManager::documentsWillBeDeleted, this, &KateQuickOpenModel::slotDocumentsChanged);
+    connect(documentManager, &KateDocManager::pendingDocumentChanged, this, &KateQuickOpenModel::slotDocumentsChanged);
+    foreach (KTextEditor::Document *document, documentManager->documentList()) {
+        slotDocumentCreated(document);
+    }
+
+    /**
+     * project files change in bursts while projects load
+     */
+    m_projectFilesTimer.setSingleShot(true);
+    m_projectFilesTimer.setInterval(0);
+    connect(&m_projectFilesTimer, &QTimer::timeout, this, &KateQuickOpenModel::slotUpdateProjectFiles);
+}
+
+void KateQuickOpenModel::slotDocumentCreated(KTextEditor::Document *document)
+{
+    connect(document, &KTextEditor::Document::documentNameChanged, this, &KateQuickOpenModel::slotDocumentsChanged);
+    connect(document, &KTextEditor::Document::documentUrlChanged, this, &KateQuickOpenModel::slotDocumentsChanged);
+    slotDocumentsChanged();
+}
+
+void KateQuickOpenModel::slotDocumentsChanged()
+{
+    m_documentsDirty = true;
+}
+
+void KateQuickOpenModel::slotProjectFilesChanged()
+{
+    m_projectFilesTimer.start();
+}
+
+void KateQuickOpenModel::slotUpdateProjectFiles()
+{
+    if (!updateProjectFiles()) {
+        return;
+    }
+
+    beginResetModel();
+    match();
+    endResetModel();
+}
+
+bool KateQuickOpenModel::updateDocuments()
+{
+    /**
+     * documents shown in this window in LRU order first, then the others
+     */
+    const KateLruList<KTextEditor::Document *> &lru = m_mainWindow->viewManager()->documentLru();
+    const QList<KTextEditor::Document *> allDocuments = KateApp::self()->documentManager()->documentList();
+    QVector<KTextEditor::Document *> documents;
+    documents.reserve(allDocuments.size());
+    for (KTextEditor::Document *document = lru.first(); document; document = lru.next(document)) {
+        documents.append(document);
+    }
+    foreach (KTextEditor::Document *document, allDocuments) {
+        if (!lru.contains(document)) {
+            documents.append(document);
+        }
+    }
+
+    /**
+     * same documents in the same order => nothing to do
+     */
+    if (!m_documentsDirty && documents.size() == m_documents.size()) {
+        bool changed = false;
+        for (int i = 0; i < documents.size() && !changed; ++i) {
+            changed = (m_documents[i].document != documents[i]);
+        }
+        if (!changed) {
+            return false;
+        }
+    }
+
+    m_documentsDirty = false;
+    m_documents.clear();
+    m_documents.reserve(documents.size());
+    m_documentFiles.clear();
+    QStringList candidates;
+    foreach (KTextEditor::Document *document, documents) {
+        const QUrl url = KateDocManager::documentUrl(document);
+        const DocumentEntry entry = { document, KateDocManager::documentName(document), url.toString() };
+        m_documents.append(entry);
+
+        /**
+         * match the path if possible
+         */
+        if (url.isEmpty()) {
+            candidates << entry.name;
+        } else if (url.isLocalFile()) {
+            candidates << url.toLocalFile();
+            m_documentFiles.insert(candidates.last());
+        } else {
+            candidates << entry.url;
+        }
+    }
+    m_documentMatcher.setCandidates(candidates);
+    return true;
+}
+
+bool KateQuickOpenModel::updateProjectFiles()
+{
+    /**
+     * the project plugin might be loaded later, connect once it is there
+     */
+    if (!m_projectView) {
+        m_projectView = m_mainWindow->pluginView(QStringLiteral("kateprojectplugin"));
+        if (m_projectView) {
+            connect(m_projectView, SIGNAL(projectFilesChanged()), this, SLOT(slotProjectFilesChanged()));
+        }
+    }
+
+    /**
+     * same snapshot => nothing to do, the matcher keeps its lowercased copy
+     */
+    const KateSharedFileListSnapshot files = m_projectView ? qvariant_cast<KateSharedFileListSnapshot>(m_projectView->property("projectFilesSnapshot")) : KateSharedFileListSnapshot();
+    const quint64 generation = files ? files->generation() : 0;
+    if (generation == (m_projectFiles ? m_projectFiles->generation() : 0)) {
+        return false;
+    }
+
+    m_projectFiles = files;
+    m_projectMatcher.setCandidates(files ? files->files() : QStringList());
+    return true;
+}
+
+void KateQuickOpenModel::refresh()
+{
+    const bool documentsChanged = updateDocuments();
+    const bool projectFilesChanged = updateProjectFiles();
+    if (!documentsChanged && !projectFilesChanged) {
+        return;
+    }
+
+    beginResetModel();
+    match();
+    endResetModel();
+}
+
+void KateQuickOpenModel::setQuery(const QString &query)
+{
+    if (query == m_query) {
+        return;
+    }
+
+    beginResetModel();
+    m_query = query;
+    match();
+    endResetModel();
+}
+
+void KateQuickOpenModel::match()
+{
+    m_symbolMode = m_query.startsWith(SymbolPrefix);
+    if (m_symbolMode) {
+        matchSymbols();
+        return;
+    }
+    m_symbols.clear();
+
+    m_documentMatches = m_documentMatcher.match(m_query, MaximalMatches);
+
+    /**
+     * open project files are already shown as documents
+     */
+    m_projectMatches.clear();
+    const int wanted = MaximalMatches - m_documentMatches.size();
+    if (wanted <= 0 || !m_projectFiles) {
+        return;
+    }
+
+    const QVector<int> matches = m_projectMatcher.match(m_query, wanted + m_documentFiles.size());
+    for (const int match : matches) {
+        if (m_projectMatches.size() == wanted) {
+            break;
+        }
+
+        if (!m_documentFiles.contains(m_projectFiles->files().at(match))) {
+            m_projectMatches.append(match);
+        }
+    }
+}
+
+void KateQuickOpenModel::matchSymbols()
+{
+    m_documentMatches.clear();
+    m_projectMatches.clear();
+    m_symbols.clear();
+
+    /**
+     * the project plugin view does the search in its index
+     */
+    QVariantList symbols;
+    if (!m_projectView || !QMetaObject::invokeMethod(m_projectView, "projectSymbols", Qt::DirectConnection, Q_RETURN_ARG(QVariantList, symbols), Q_ARG(QString, m_query.mid(1)), Q_ARG(int, MaximalMatches))) {
+        return;
+    }
+
+    m_symbols.reserve(symbols.size());
+    foreach (const QVariant &symbol, symbols) {
+        const QVariantMap map = symbol.toMap();
+        const SymbolEntry entry = { map.value(QStringLiteral("name")).toString(), map.value(QStringLiteral("kind")).toString(), map.value(QStringLiteral("file")).toString(), map.value(QStringLiteral("line")).toInt() };
+        m_symbols.append(entry);
+    }
+}
+
+int KateQuickOpenModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_symbolMode ? m_symbols.size() : (m_documentMatches.size() + m_projectMatches.size());
+}
+
+int KateQuickOpenModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant KateQuickOpenModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    /**
+     * symbols
+     */
+    if (m_symbolMode) {
+        const SymbolEntry &entry = m_symbols[index.row()];
+        switch (role) {
+        case Qt::DisplayRole:
+            if (index.column() == 0) {
+                return entry.name;
+            }
+            return (entry.line > 0) ? QStringLiteral("%1:%2").arg(entry.file).arg(entry.line) : entry.file;
+        case Qt::ToolTipRole:
+            return entry.kind;
+        case UrlRole:
+            return QUrl::fromLocalFile(entry.file);
+        case LineRole:
+            return entry.line;
+        default:
+            return QVariant();
+        }
+    }
+
+    /**
+     * open documents
+     */
+    if (index.row() < m_documentMatches.size()) {
+        const DocumentEntry &entry = m_documents[m_documentMatches[index.row()]];
+        switch (role) {
+        case Qt::DisplayRole:
+            return (index.column() == 0) ? entry.name : entry.url;
+        case Qt::FontRole:
+            return (index.column() == 0) ? QVariant(m_documentFont) : QVariant();
+        case DocumentRole:
+            return QVariant::fromValue(entry.document);
+        default:
+            return QVariant();
+        }
+    }
+
+    /**
+     * project files
+     */
+    const QString &file = m_projectFiles->files().at(m_projectMatches[index.row() - m_documentMatches.size()]);
+    switch (role) {
+    case Qt::DisplayRole:
+        return (index.column() == 0) ? file.mid(file.lastIndexOf(QLatin1Char('/')) + 1) : file;
+    case UrlRole:
+        return QUrl::fromLocalFile(file);
+    default:
+        return QVariant();
+    }
+}
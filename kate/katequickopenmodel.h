@@ -0,0 +1,203 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_QUICK_OPEN_MODEL_H
+#define KATE_QUICK_OPEN_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QFont>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+#include <ktexteditor/document.h>
+
+#include "katequickopenmatcher.h"
+#include "../katefilelistsnapshot.h"
+
+class KateMainWindow;
+
+Q_DECLARE_METATYPE(QPointer<KTextEditor::Document>)
+
+/**
+ * Model for the quick open dialog.
+ *
+ * It is kept up to date while the dialog is hidden: open documents are
+ * tracked via the document manager signals, the project files via the
+ * file list snapshot of the project plugin view and its projectFilesChanged
+ * signal. Showing the dialog only compares the LRU order of the documents.
+ *
+ * The model shows the best matches for the current query: the open
+ * documents first, then the project files that are not open.
+ *
+ * Queries starting with @ search the symbols of the ctags index of the
+ * current project instead, one row per definition.
+ */
+class KateQuickOpenModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Role {
+        DocumentRole = Qt::UserRole + 1,
+        UrlRole,
+        LineRole
+    };
+
+    /**
+     * maximal number of shown rows
+     */
+    enum {
+        MaximalMatches = 1000
+    };
+
+    /**
+     * construct model for the given main window
+     * @param mainWindow main window to show documents and project files of
+     * @param parent parent object
+     */
+    KateQuickOpenModel(KateMainWindow *mainWindow, QObject *parent);
+
+    /**
+     * Update before the dialog is shown, cheap if nothing changed.
+     */
+    void refresh();
+
+    /**
+     * Show the best matches for the query.
+     * @param query query as typed by the user
+     */
+    void setQuery(const QString &query);
+
+    /**
+     * number of rows that are open documents, they come first
+     * @return document row count
+     */
+    int documentRowCount() const {
+        return m_symbolMode ? 0 : m_documentMatches.size();
+    }
+
+    /**
+     * QAbstractItemModel interface
+     */
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private Q_SLOTS:
+    /**
+     * Documents were added, removed or renamed.
+     */
+    void slotDocumentsChanged();
+
+    /**
+     * New document, track its name and url.
+     * @param document new document
+     */
+    void slotDocumentCreated(KTextEditor::Document *document);
+
+    /**
+     * The project files changed, prepare the matcher in advance, delayed
+     * to merge multiple changes.
+     */
+    void slotProjectFilesChanged();
+
+    /**
+     * Update the matcher for the project files now.
+     */
+    void slotUpdateProjectFiles();
+
+private:
+    /**
+     * Update the documents, if they or their LRU order changed.
+     * @return true if anything changed
+     */
+    bool updateDocuments();
+
+    /**
+     * Update the project files, if the snapshot changed.
+     * @return true if anything changed
+     */
+    bool updateProjectFiles();
+
+    /**
+     * Match the current query, no model reset.
+     */
+    void match();
+
+    /**
+     * Search the symbols for the current query, no model reset.
+     */
+    void matchSymbols();
+
+private:
+    /**
+     * main window we belong to
+     */
+    KateMainWindow *m_mainWindow;
+
+    /**
+     * open documents in LRU order, their local files and the matcher for them
+     */
+    struct DocumentEntry {
+        QPointer<KTextEditor::Document> document;
+        QString name;
+        QString url;
+    };
+    QVector<DocumentEntry> m_documents;
+    QSet<QString> m_documentFiles;
+    KateQuickOpenMatcher m_documentMatcher;
+    bool m_documentsDirty;
+
+    /**
+     * project files and the matcher for them, rebuilt if the snapshot changed
+     */
+    QPointer<QObject> m_projectView;
+    KateSharedFileListSnapshot m_projectFiles;
+    KateQuickOpenMatcher m_projectMatcher;
+    QTimer m_projectFilesTimer;
+
+    /**
+     * current query and the matching rows
+     */
+    QString m_query;
+    QVector<int> m_documentMatches;
+    QVector<int> m_projectMatches;
+
+    /**
+     * symbol mode: matching symbols from the project index
+     */
+    struct SymbolEntry {
+        QString name;
+        QString kind;
+        QString file;
+        int line;
+    };
+    bool m_symbolMode;
+    QVector<SymbolEntry> m_symbols;
+
+    /**
+     * font for open documents
+     */
+    QFont m_documentFont;
+};
+
+#endif
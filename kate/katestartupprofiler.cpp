@@ -0,0 +1,254 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "katestartupprofiler.h"
+#include "katedebug.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QVector>
+
+namespace
+{
+/**
+ * one recorded span, times in microseconds since start
+ */
+struct Event {
+    QString name;
+    qint64 start;
+    qint64 duration;
+    int depth;
+};
+
+/**
+ * state of the profiler, phases have depth 0
+ */
+struct Profiler {
+    QElapsedTimer clock;
+    bool recording = false;
+    bool postRoutineAdded = false;
+    QString traceFile;
+    QVector<Event> events;
+    const char *phase = nullptr;
+    qint64 phaseStart = 0;
+    qint64 end = 0;
+    int depth = 0;
+};
+
+Profiler &profiler()
+{
+    static Profiler instance;
+    return instance;
+}
+
+qint64 now()
+{
+    return profiler().clock.nsecsElapsed() / 1000;
+}
+
+QString spanName(const char *name, const QString &detail)
+{
+    const QString span = QString::fromLatin1(name);
+    return detail.isEmpty() ? span : (span + QLatin1Char(' ') + detail);
+}
+
+void endPhase()
+{
+    Profiler &p = profiler();
+    if (p.phase) {
+        const Event event = { QString::fromLatin1(p.phase), p.phaseStart, now() - p.phaseStart, 0 };
+        p.events.append(event);
+        p.phase = nullptr;
+    }
+}
+}
+
+void KateStartupProfiler::start(const char *phase)
+{
+    Profiler &p = profiler();
+    p.events.clear();
+    p.depth = 0;
+    p.end = 0;
+    p.recording = true;
+    p.traceFile = QString::fromLocal8Bit(qgetenv("KATE_STARTUP_TRACE"));
+    p.clock.start();
+
+    p.phase = phase;
+    p.phaseStart = 0;
+
+    /**
+     * early exits of main() still get their trace
+     */
+    if (!p.postRoutineAdded) {
+        p.postRoutineAdded = true;
+        qAddPostRoutine(KateStartupProfiler::finish);
+    }
+}
+
+void KateStartupProfiler::setTraceFile(const QString &fileName)
+{
+    profiler().traceFile = fileName;
+}
+
+void KateStartupProfiler::phase(const char *phase)
+{
+    Profiler &p = profiler();
+    if (!p.recording) {
+        return;
+    }
+
+    endPhase();
+    p.phase = phase;
+    p.phaseStart = now();
+}
+
+bool KateStartupProfiler::isRecording()
+{
+    return profiler().recording;
+}
+
+void KateStartupProfiler::finish()
+{
+    Profiler &p = profiler();
+    if (!p.recording) {
+        return;
+    }
+
+    endPhase();
+    p.end = now();
+    p.recording = false;
+
+    if (p.traceFile.isEmpty()) {
+        p.events.clear();
+        return;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+    qCInfo(LOG_KATE).noquote() << summary();
+#else
+    qCDebug(LOG_KATE).noquote() << summary();
+#endif
+
+    QFile file(p.traceFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(trace()) < 0) {
+        qCWarning(LOG_KATE) << "Can't write startup trace" << p.traceFile;
+    }
+}
+
+QByteArray KateStartupProfiler::trace()
+{
+    const Profiler &p = profiler();
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray events;
+
+    // name the process for the viewers
+    QJsonObject process;
+    process[QStringLiteral("name")] = QStringLiteral("process_name");
+    process[QStringLiteral("ph")] = QStringLiteral("M");
+    process[QStringLiteral("pid")] = pid;
+    process[QStringLiteral("tid")] = 0;
+    QJsonObject processArgs;
+    processArgs[QStringLiteral("name")] = QStringLiteral("kate");
+    process[QStringLiteral("args")] = processArgs;
+    events.append(process);
+
+    // whole startup, then the phases and spans
+    QJsonObject startup;
+    startup[QStringLiteral("name")] = QStringLiteral("startup");
+    startup[QStringLiteral("cat")] = QStringLiteral("startup");
+    startup[QStringLiteral("ph")] = QStringLiteral("X");
+    startup[QStringLiteral("ts")] = 0;
+    startup[QStringLiteral("dur")] = p.end;
+    startup[QStringLiteral("pid")] = pid;
+    startup[QStringLiteral("tid")] = 0;
+    events.append(startup);
+
+    foreach (const Event &event, p.events) {
+        QJsonObject span;
+        span[QStringLiteral("name")] = event.name;
+        span[QStringLiteral("cat")] = (event.depth == 0) ? QStringLiteral("phase") : QStringLiteral("span");
+        span[QStringLiteral("ph")] = QStringLiteral("X");
+        span[QStringLiteral("ts")] = event.start;
+        span[QStringLiteral("dur")] = event.duration;
+        span[QStringLiteral("pid")] = pid;
+        span[QStringLiteral("tid")] = 0;
+        events.append(span);
+    }
+
+    QJsonObject trace;
+    trace[QStringLiteral("traceEvents")] = events;
+    trace[QStringLiteral("displayTimeUnit")] = QStringLiteral("ms");
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+QString KateStartupProfiler::summary()
+{
+    const Profiler &p = profiler();
+
+    /**
+     * phases in order and the slowest nested span
+     */
+    QStringList phases;
+    const Event *slowest = nullptr;
+    for (int i = 0; i < p.events.size(); ++i) {
+        const Event &event = p.events[i];
+        if (event.depth == 0) {
+            phases << QStringLiteral("%1 %2 ms").arg(event.name).arg(event.duration / 1000);
+        } else if (!slowest || event.duration > slowest->duration) {
+            slowest = &event;
+        }
+    }
+
+    QString summary = QStringLiteral("Startup took %1 ms: %2").arg(p.end / 1000).arg(phases.join(QStringLiteral(", ")));
+    if (slowest) {
+        summary += QStringLiteral("; slowest span: %1 %2 ms").arg(slowest->name).arg(slowest->duration / 1000);
+    }
+    return summary;
+}
+
+KateStartupProfiler::Span::Span(const char *name, const QString &detail)
+    : m_name(name)
+    , m_detail(detail)
+    , m_start(-1)
+{
+    Profiler &p = profiler();
+    if (p.recording) {
+        m_start = now();
+        ++p.depth;
+    }
+}
+
+KateStartupProfiler::Span::~Span()
+{
+    Profiler &p = profiler();
+    if (m_start < 0 || !p.recording) {
+        return;
+    }
+
+    const Event event = { spanName(m_name, m_detail), m_start, now() - m_start, p.depth };
+    p.events.append(event);
+    --p.depth;
+}
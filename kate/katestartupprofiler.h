@@ -0,0 +1,114 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_STARTUP_PROFILER_H
+#define KATE_STARTUP_PROFILER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "kateprivate_export.h"
+
+/**
+ * Records timed spans during startup.
+ *
+ * Startup is split into sequential phases, code inside a phase can add nested
+ * spans, e.g. one per plugin. Recording starts in main() and ends with the
+ * first event loop iteration. If a trace file is set, either by the
+ * KATE_STARTUP_TRACE environment variable or the --startup-trace option, a
+ * one-line summary is logged and the spans are written as Chrome trace JSON,
+ * viewable in chrome://tracing or Perfetto. Else the spans are just dropped.
+ *
+ * Only to be used from the GUI thread.
+ */
+class KATE_TESTS_EXPORT KateStartupProfiler
+{
+public:
+    /**
+     * Start the clock and the first phase, drops all recorded spans.
+     * Reads the KATE_STARTUP_TRACE environment variable.
+     * @param phase name of the first phase
+     */
+    static void start(const char *phase);
+
+    /**
+     * Set the file to write the trace to.
+     * @param fileName trace file, empty to only drop the spans
+     */
+    static void setTraceFile(const QString &fileName);
+
+    /**
+     * End the current phase and start the next one.
+     * @param phase name of the next phase
+     */
+    static void phase(const char *phase);
+
+    /**
+     * End recording, log the summary and write the trace if a trace file is set.
+     * Does nothing if not recording.
+     */
+    static void finish();
+
+    /**
+     * still recording?
+     * @return true between start() and finish()
+     */
+    static bool isRecording();
+
+    /**
+     * The recorded spans as Chrome trace JSON.
+     * @return trace
+     */
+    static QByteArray trace();
+
+    /**
+     * One line summary of the phases.
+     * @return summary
+     */
+    static QString summary();
+
+    /**
+     * Nested span, recorded from construction to destruction.
+     */
+    class Span
+    {
+    public:
+        /**
+         * Start span.
+         * @param name name of the span, must stay valid, e.g. a literal
+         * @param detail optional detail, e.g. the plugin name
+         */
+        explicit Span(const char *name, const QString &detail = QString());
+
+        /**
+         * end span
+         */
+        ~Span();
+
+    private:
+        Q_DISABLE_COPY(Span)
+
+        const char *const m_name;
+        const QString m_detail;
+        qint64 m_start;
+    };
+};
+
+#endif
@@ -19,17 +19,36 @@
  */
 
 #include "katetabbar.h"
-#include "katetabbutton.h"
+
+#include <KLocalizedString>
 
 #include <math.h> // ceil
 
 // #include <QDebug>
+#include <QApplication>
+#include <QDrag>
+#include <QHelpEvent>
 #include <QMimeData>
 #include <QPainter>
 #include <QResizeEvent>
-#include <QStyleOptionTab>
+#include <QStyleOption>
+#include <QToolTip>
+#include <QUrl>
 #include <QWheelEvent>
 
+/**
+ * Data of one tab, the tabs are painted by the tab bar.
+ */
+class KateTabData
+{
+public:
+    int id = -1;
+    QString text;
+    QString toolTip;
+    QUrl url;
+    QIcon icon;
+};
+
 class KateTabBarPrivate
 {
 public:
@@ -49,89 +68,256 @@ public:
 
     bool isActive;
 
-    QVector<KateTabButton *> tabButtons;
-    QHash<int, KateTabButton *> idToTab;
+    // all tabs, in display order
+    QVector<KateTabData> tabs;
 
-    KateTabButton *activeButton;
+    // id of the active tab, -1 if none
+    int activeId;
 
     int nextID;
 
+    // mouse state: hovered tab and whether its close button is hovered,
+    // tab whose close button is pressed, tab that might get dragged
+    int hoverIndex;
+    bool hoverClose;
+    int pressedCloseIndex;
+    int dragIndex;
+    QPoint mouseDownPosition;
+
 public: // functions
     /**
-     * Set tab geometry. The tabs are animated only if @p animate is @e true.
+     * Index of the tab with @p id, -1 if there is no such tab.
      */
-    void updateButtonPositions(bool animate = false)
+    int indexOf(int id) const
     {
-        // if there are no tabs there is nothing to do
-        if (tabButtons.count() == 0) {
-            return;
+        for (int i = 0; i < tabs.size(); ++i) {
+            if (tabs[i].id == id) {
+                return i;
+            }
         }
+        return -1;
+    }
 
-        // check whether an animation is still running, in that case,
-        // continue animations to avoid jumping tabs
-        const int maxi = tabButtons.size();
-        if (!animate) {
-            for (int i = 0; i < maxi; ++i) {
-                if (tabButtons.value(i)->geometryAnimationRunning()) {
-                    animate = true;
-                    break;
-                }
-            }
+    /**
+     * Number of tabs that fit into the tab bar, only those are painted.
+     */
+    int visibleTabCount() const
+    {
+        return qMin(tabs.size(), q->maxTabCount());
+    }
+
+    /**
+     * Compute the tab width. No geometry is stored per tab, the tab
+     * rectangles are derived from the tab width on demand.
+     */
+    void updateTabWidth()
+    {
+        // if there are no tabs there is nothing to do
+        const int visibleCount = visibleTabCount();
+        if (visibleCount == 0) {
+            q->update();
+            return;
         }
 
         const int barWidth = q->width();
-        const int maxCount = q->maxTabCount();
-
-        // how many tabs do we show?
-        const int visibleTabCount = qMin(q->count(), maxCount);
 
         // new tab width of each tab
         qreal tabWidth;
-        const bool keepWidth = keepTabWidth && ceil(currentTabWidth) * visibleTabCount < barWidth;
+        const bool keepWidth = keepTabWidth && ceil(currentTabWidth) * visibleCount < barWidth;
         if (keepWidth) {
             // only keep tab width if the tabs still fit
             tabWidth = currentTabWidth;
         } else {
-            tabWidth = qMin(static_cast<qreal>(barWidth) / visibleTabCount, static_cast<qreal>(maximumTabWidth));
+            tabWidth = qMin(static_cast<qreal>(barWidth) / visibleCount, static_cast<qreal>(maximumTabWidth));
         }
 
         // if the last tab was closed through the close button, make sure the
         // close button of the new tab is again under the mouse
         if (keepWidth) {
             const int xPos = q->mapFromGlobal(QCursor::pos()).x();
-            if (tabWidth * visibleTabCount < xPos) {
-                tabWidth = qMin(static_cast<qreal>(tabWidth * (visibleTabCount + 1.0)) / visibleTabCount, static_cast<qreal>(maximumTabWidth));
+            if (tabWidth * visibleCount < xPos) {
+                tabWidth = qMin(static_cast<qreal>(tabWidth * (visibleCount + 1.0)) / visibleCount, static_cast<qreal>(maximumTabWidth));
             }
         }
 
         // now save the current tab width for future adaptation
         currentTabWidth = tabWidth;
 
-        // now set the sizes
-        const int w = ceil(tabWidth);
-        const int h = q->height();
-        for (int i = 0; i < maxi; ++i) {
-            KateTabButton *tabButton = tabButtons.value(i);
-            if (i >= maxCount) {
-                tabButton->hide();
-            } else {
-                QRect endGeometry(i * tabWidth, 0, w, h);
-                if (i > 0) {
-                    // make sure the tab button starts exactly next to the previous tab (avoid rounding errors)
-                    endGeometry.setLeft((i-1) * tabWidth + w);
-                }
-
-                if (animate) {
-                    const QRect startGeometry = tabButton->isVisible() ? tabButton->geometry()
-                    : QRect(i * tabWidth, 0, 0, h);
-                    tabButton->setAnimatedGeometry(startGeometry, endGeometry);
-                } else {
-                    // two times endGeometry. Takes care of stopping a running animation
-                    tabButton->setAnimatedGeometry(endGeometry, endGeometry);
-                }
-                tabButton->show();
+        q->update();
+    }
+
+    /**
+     * Rectangle of the visible tab at @p index.
+     */
+    QRect tabRect(int index) const
+    {
+        const int w = ceil(currentTabWidth);
+        QRect rect(index * currentTabWidth, 0, w, q->height());
+        if (index > 0) {
+            // make sure the tab starts exactly next to the previous tab (avoid rounding errors)
+            rect.setLeft((index - 1) * currentTabWidth + w);
+        }
+        return rect;
+    }
+
+    /**
+     * Rectangle of the close button of the visible tab at @p index.
+     */
+    QRect closeButtonRect(int index) const
+    {
+        const QRect rect = tabRect(index);
+        const int margin = q->style()->pixelMetric(QStyle::PM_ButtonMargin, nullptr, q);
+        const int w = q->style()->pixelMetric(QStyle::PM_TabCloseIndicatorWidth, nullptr, q);
+        const int h = q->style()->pixelMetric(QStyle::PM_TabCloseIndicatorHeight, nullptr, q);
+        return QRect(rect.right() + 1 - margin - w, rect.top() + (rect.height() - h) / 2, w, h);
+    }
+
+    /**
+     * Index of the visible tab at @p pos, -1 if there is none.
+     */
+    int tabAt(const QPoint &pos) const
+    {
+        if (currentTabWidth <= 0 || pos.x() < 0 || pos.y() < 0 || pos.y() >= q->height()) {
+            return -1;
+        }
+
+        // the rounding of the tab rectangles can shift the border by one pixel
+        int index = pos.x() / currentTabWidth;
+        if (index > 0 && !tabRect(index).contains(pos)) {
+            --index;
+        }
+
+        return (index < visibleTabCount() && tabRect(index).contains(pos)) ? index : -1;
+    }
+
+    /**
+     * Activate the tab at @p index. Emits \p currentChanged() with the tab's ID.
+     */
+    void activateTab(int index)
+    {
+        const int id = tabs[index].id;
+        if (id == activeId) {
+            // make sure we are the currently active view space
+            if (! q->isActive()) {
+                emit q->activateViewSpaceRequested();
             }
+            return;
+        }
+
+        activeId = id;
+        q->update();
+        emit q->currentChanged(id);
+    }
+
+    /**
+     * The user wants to close the tab at @p index, send a close request.
+     */
+    void requestClose(int index)
+    {
+        // keep width
+        if (q->underMouse()) {
+            keepTabWidth = true;
         }
+
+        emit q->closeTabRequested(tabs[index].id);
+    }
+
+    /**
+     * Update the hovered tab for the mouse at @p pos.
+     */
+    void updateHover(const QPoint &pos)
+    {
+        const int index = tabAt(pos);
+        const bool close = index >= 0 && closeButtonRect(index).contains(pos);
+        if (index != hoverIndex || close != hoverClose) {
+            hoverIndex = index;
+            hoverClose = close;
+            q->update();
+        }
+    }
+
+    /**
+     * Forget the mouse state, e.g. if tabs are removed.
+     */
+    void resetMouseState()
+    {
+        hoverIndex = -1;
+        hoverClose = false;
+        pressedCloseIndex = -1;
+        dragIndex = -1;
+    }
+
+    /**
+     * Paint the visible tab at @p index.
+     */
+    void paintTab(QPainter &p, int index) const
+    {
+        const KateTabData &tab = tabs[index];
+        const QRect rect = tabRect(index);
+        const bool checked = tab.id == activeId;
+        const bool hovered = index == hoverIndex;
+
+        QColor barColor(q->palette().color(QPalette::Highlight));
+
+        // inactive tab bars are grayed out
+        if (!isActive) {
+            // if inactive, convert color to gray value
+            const int g = qGray(barColor.rgb());
+            barColor = QColor(g, g, g);
+        }
+
+        // compute sane margins
+        const int margin = q->style()->pixelMetric(QStyle::PM_ButtonMargin, nullptr, q);
+        const int barMargin = margin / 2;
+        const int barHeight = ceil(rect.height() / 10.0);
+        const QRect barRect(rect.left() + barMargin, rect.bottom() + 1 - barHeight, rect.width() - 2 * barMargin, barHeight);
+
+        // paint bar if inactive but hovered
+        if (!checked && hovered) {
+            barColor.setAlpha(80);
+            p.fillRect(barRect, barColor);
+        }
+
+        // paint bar
+        if (checked) {
+            barColor.setAlpha(255);
+            p.fillRect(barRect, barColor);
+        }
+
+        // icon, if applicable
+        int leftMargin = margin;
+        if (! tab.icon.isNull()) {
+            const int y = (rect.height() - 16) / 2;
+            tab.icon.paint(&p, rect.left() + margin, y, 16, 16);
+            leftMargin += 16;
+            leftMargin += margin;
+        }
+
+        // the width of the text is reduced by the close button + 2 * margin
+        const QRect closeRect = closeButtonRect(index);
+        const int w = rect.width() // width of tab
+                    - closeRect.width() - 2 * margin // close button
+                    - leftMargin; // modified button
+
+        // draw text, we need to elide to xxx...xxx is too long
+        const QString elidedText = q->fontMetrics().elidedText(tab.text, Qt::ElideMiddle, w);
+        const QRect textRect(rect.left() + leftMargin, rect.top(), w, rect.height());
+        q->style()->drawItemText(&p, textRect, Qt::AlignHCenter | Qt::AlignVCenter, q->palette(), true, elidedText, QPalette::WindowText);
+
+        // close button, raised if hovered or the tab is active
+        QStyleOption opt;
+        opt.initFrom(q);
+        opt.rect = closeRect;
+        opt.state &= ~QStyle::State_MouseOver;
+        if (hovered && hoverClose) {
+            opt.state |= QStyle::State_MouseOver;
+        }
+        if (index == pressedCloseIndex) {
+            opt.state |= QStyle::State_Sunken;
+        } else if (checked || (hovered && hoverClose)) {
+            opt.state |= QStyle::State_Raised;
+        }
+        q->style()->drawPrimitive(QStyle::PE_IndicatorTabClose, &opt, &p, q);
     }
 };
 
@@ -150,12 +336,17 @@ KateTabBar::KateTabBar(QWidget *parent)
 
     d->isActive = false;
 
-    d->activeButton = nullptr;
+    d->activeId = -1;
 
     d->nextID = 0;
 
+    d->resetMouseState();
+
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
     setAcceptDrops(true);
+
+    // hover feedback for the painted tabs
+    setMouseTracking(true);
 }
 
 /**
@@ -181,72 +372,60 @@ bool KateTabBar::isActive() const
 
 int KateTabBar::addTab(const QString &text)
 {
-    return insertTab(d->tabButtons.size(), text);
+    return insertTab(d->tabs.size(), text);
 }
 
 int KateTabBar::insertTab(int position, const QString & text)
 {
-    Q_ASSERT(position <= d->tabButtons.size());
+    Q_ASSERT(position <= d->tabs.size());
 
     // -1 is append
     if (position < 0) {
-        position = d->tabButtons.size();
+        position = d->tabs.size();
     }
 
-    KateTabButton *tabButton = new KateTabButton(text, this);
+    KateTabData tab;
+    tab.id = d->nextID;
+    tab.text = text;
+    d->tabs.insert(position, tab);
 
-    d->tabButtons.insert(position, tabButton);
-    d->idToTab[d->nextID] = tabButton;
-    connect(tabButton, &KateTabButton::activated, this, &KateTabBar::tabButtonActivated);
-    connect(tabButton, &KateTabButton::closeRequest, this, &KateTabBar::tabButtonCloseRequest);
+    // the indices of the mouse state are outdated
+    d->resetMouseState();
 
     // abort potential keeping of width
     d->keepTabWidth = false;
 
-    d->updateButtonPositions(true);
+    d->updateTabWidth();
 
     return d->nextID++;
 }
 
 int KateTabBar::currentTab() const
 {
-    return d->idToTab.key(d->activeButton, -1);
+    return d->activeId;
 }
 
 void KateTabBar::setCurrentTab(int id)
 {
-    Q_ASSERT(d->idToTab.contains(id));
+    Q_ASSERT(d->indexOf(id) >= 0);
 
-    KateTabButton *tabButton = d->idToTab.value(id, nullptr);
-    if (d->activeButton == tabButton) {
+    if (d->activeId == id) {
         return;
     }
 
-    if (d->activeButton) {
-        d->activeButton->setChecked(false);
-    }
-
-    d->activeButton = tabButton;
-    if (d->activeButton) {
-        d->activeButton->setChecked(true);
-    }
+    d->activeId = id;
+    update();
 }
 
 int KateTabBar::prevTab() const
 {
-    const int curId = currentTab();
-
-    if (curId >= 0) {
-        KateTabButton *tabButton = d->idToTab.value(curId, nullptr);
-        const int index = d->tabButtons.indexOf(tabButton);
-        Q_ASSERT(index >= 0);
+    const int index = d->indexOf(d->activeId);
 
-        if (index > 0) {
-            return d->idToTab.key(d->tabButtons[index - 1], -1);
-        } else if (count() > 1) {
-            // cycle through tabbar
-            return d->idToTab.key(d->tabButtons.last(), -1);
-        }
+    if (index > 0) {
+        return d->tabs[index - 1].id;
+    } else if (index == 0 && count() > 1) {
+        // cycle through tabbar
+        return d->tabs.last().id;
     }
 
     return -1;
@@ -254,19 +433,13 @@ int KateTabBar::prevTab() const
 
 int KateTabBar::nextTab() const
 {
-    const int curId = currentTab();
-
-    if (curId >= 0) {
-        KateTabButton *tabButton = d->idToTab.value(curId, nullptr);
-        const int index = d->tabButtons.indexOf(tabButton);
-        Q_ASSERT(index >= 0);
+    const int index = d->indexOf(d->activeId);
 
-        if (index < d->tabButtons.size() - 1) {
-            return d->idToTab.key(d->tabButtons[index + 1], -1);
-        } else if (count() > 1) {
-            // cycle through tabbar
-            return d->idToTab.key(d->tabButtons.first(), -1);
-        }
+    if (index >= 0 && index < d->tabs.size() - 1) {
+        return d->tabs[index + 1].id;
+    } else if (index >= 0 && count() > 1) {
+        // cycle through tabbar
+        return d->tabs.first().id;
     }
 
     return -1;
@@ -274,172 +447,115 @@ int KateTabBar::nextTab() const
 
 int KateTabBar::removeTab(int id)
 {
-    Q_ASSERT(d->idToTab.contains(id));
-
-    KateTabButton *tabButton = d->idToTab.value(id, nullptr);
+    const int position = d->indexOf(id);
+    Q_ASSERT(position >= 0);
 
-    if (tabButton == d->activeButton) {
-        d->activeButton = Q_NULLPTR;
+    if (id == d->activeId) {
+        d->activeId = -1;
     }
 
-    const int position = d->tabButtons.indexOf(tabButton);
-
     if (position != -1) {
-        d->idToTab.remove(id);
-        d->tabButtons.removeAt(position);
+        d->tabs.remove(position);
     }
 
-    if (tabButton) {
-        // delete the button with deleteLater() because the button itself might
-        // have send a close-request. So the app-execution is still in the
-        // button, a delete tabButton; would lead to a crash.
-        tabButton->hide();
-        tabButton->deleteLater();
-    }
+    // the indices of the mouse state are outdated
+    d->resetMouseState();
 
-    d->updateButtonPositions(true);
+    d->updateTabWidth();
 
     return position;
 }
 
 bool KateTabBar::containsTab(int id) const
 {
-    return d->idToTab.contains(id);
+    return d->indexOf(id) >= 0;
 }
 
 void KateTabBar::setTabText(int id, const QString &text)
 {
-    Q_ASSERT(d->idToTab.contains(id));
-    KateTabButton * tabButton = d->idToTab.value(id, nullptr);
-    if (tabButton) {
-        tabButton->setText(text);
+    const int index = d->indexOf(id);
+    Q_ASSERT(index >= 0);
+    if (index >= 0 && d->tabs[index].text != text) {
+        d->tabs[index].text = text;
+        if (index < d->visibleTabCount()) {
+            update(d->tabRect(index));
+        }
     }
 }
 
 QString KateTabBar::tabText(int id) const
 {
-    Q_ASSERT(d->idToTab.contains(id));
-    KateTabButton * tabButton = d->idToTab.value(id, nullptr);
-    if (tabButton) {
-        return tabButton->text();
-    }
-    return QString();
+    const int index = d->indexOf(id);
+    Q_ASSERT(index >= 0);
+    return (index >= 0) ? d->tabs[index].text : QString();
 }
 
 void KateTabBar::setTabToolTip(int id, const QString &tip)
 {
-    Q_ASSERT(d->idToTab.contains(id));
-    KateTabButton * tabButton = d->idToTab.value(id, nullptr);
-    if (tabButton) {
-        tabButton->setToolTip(tip);
+    const int index = d->indexOf(id);
+    Q_ASSERT(index >= 0);
+    if (index >= 0) {
+        d->tabs[index].toolTip = tip;
     }
 }
 
 QString KateTabBar::tabToolTip(int id) const
 {
-    Q_ASSERT(d->idToTab.contains(id));
-    KateTabButton * tabButton = d->idToTab.value(id, nullptr);
-    if (tabButton) {
-        return tabButton->toolTip();
-    }
-    return QString();
+    const int index = d->indexOf(id);
+    Q_ASSERT(index >= 0);
+    return (index >= 0) ? d->tabs[index].toolTip : QString();
 }
 
 void KateTabBar::setTabUrl(int id, const QUrl &url)
 {
-    Q_ASSERT(d->idToTab.contains(id));
-    KateTabButton * tabButton = d->idToTab.value(id, nullptr);
-    if (tabButton) {
-        tabButton->setUrl(url);
+    const int index = d->indexOf(id);
+    Q_ASSERT(index >= 0);
+    if (index >= 0) {
+        d->tabs[index].url = url;
     }
 }
 
 QUrl KateTabBar::tabUrl(int id) const
 {
-    Q_ASSERT(d->idToTab.contains(id));
-    KateTabButton * tabButton = d->idToTab.value(id, nullptr);
-    if (tabButton) {
-        return tabButton->url();
-    }
-    return QUrl();
+    const int index = d->indexOf(id);
+    Q_ASSERT(index >= 0);
+    return (index >= 0) ? d->tabs[index].url : QUrl();
 }
 
 void KateTabBar::setTabIcon(int id, const QIcon &icon)
 {
-    Q_ASSERT(d->idToTab.contains(id));
-    KateTabButton * tabButton = d->idToTab.value(id, nullptr);
-    if (tabButton) {
-        tabButton->setIcon(icon);
+    const int index = d->indexOf(id);
+    Q_ASSERT(index >= 0);
+    if (index >= 0) {
+        d->tabs[index].icon = icon;
+        if (index < d->visibleTabCount()) {
+            update(d->tabRect(index));
+        }
     }
 }
 
 QIcon KateTabBar::tabIcon(int id) const
 {
-    Q_ASSERT(d->idToTab.contains(id));
-    KateTabButton * tabButton = d->idToTab.value(id, nullptr);
-    if (tabButton) {
-        return tabButton->icon();
-    }
-    return QIcon();
+    const int index = d->indexOf(id);
+    Q_ASSERT(index >= 0);
+    return (index >= 0) ? d->tabs[index].icon : QIcon();
 }
 
 int KateTabBar::count() const
 {
-    return d->tabButtons.count();
-}
-
-void KateTabBar::tabButtonActivated(KateTabButton *tabButton)
-{
-    if (!tabButton) {
-        return;
-    }
-
-    if (tabButton == d->activeButton) {
-        // make sure we are the currently active view space
-        if (! isActive()) {
-            emit activateViewSpaceRequested();
-        }
-        return;
-    }
-
-    if (d->activeButton) {
-        d->activeButton->setChecked(false);
-    }
-
-    d->activeButton = tabButton;
-    d->activeButton->setChecked(true);
-
-    const int id = d->idToTab.key(d->activeButton, -1);
-    Q_ASSERT(id >= 0);
-    if (id >= 0) {
-        emit currentChanged(id);
-    }
-}
-
-void KateTabBar::tabButtonCloseRequest(KateTabButton *tabButton)
-{
-    // keep width
-    if (underMouse()) {
-        d->keepTabWidth = true;
-    }
-
-    const int id = d->idToTab.key(tabButton, -1);
-    Q_ASSERT(id >= 0);
-    if (id >= 0) {
-        emit closeTabRequested(id);
-    }
+    return d->tabs.count();
 }
 
 void KateTabBar::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event)
 
-    // fix button positions
+    // fix tab width
     if (!d->keepTabWidth || event->size().width() < event->oldSize().width()) {
-        d->updateButtonPositions();
+        d->updateTabWidth();
     }
 
-    const int tabDiff = maxTabCount() - d->tabButtons.size();
+    const int tabDiff = maxTabCount() - d->tabs.size();
     if (tabDiff > 0) {
         emit moreTabsRequested(tabDiff);
     } else if (tabDiff < 0) {
@@ -455,22 +571,95 @@ int KateTabBar::maxTabCount() const
 void KateTabBar::mouseDoubleClickEvent(QMouseEvent *event)
 {
     event->accept();
-    emit newTabRequested();
+
+    // double clicks on tabs are eaten
+    if (d->tabAt(event->pos()) < 0) {
+        emit newTabRequested();
+    }
 }
 
 void KateTabBar::mousePressEvent(QMouseEvent *event)
 {
+    const int index = d->tabAt(event->pos());
+    if (index >= 0 && (event->button() == Qt::LeftButton || event->button() == Qt::MiddleButton)) {
+        event->accept();
+
+        // save mouse position for possible drag start event
+        d->mouseDownPosition = event->globalPos();
+
+        if (event->button() == Qt::MiddleButton) {
+            d->requestClose(index);
+        } else if (d->closeButtonRect(index).contains(event->pos())) {
+            // close on release, like a button
+            d->pressedCloseIndex = index;
+            update(d->tabRect(index));
+        } else {
+            d->dragIndex = index;
+            d->activateTab(index);
+        }
+        return;
+    }
+
     if (! isActive()) {
         emit activateViewSpaceRequested();
     }
     QWidget::mousePressEvent(event);
 }
 
-void KateTabBar::leaveEvent(QEvent *event) 
+void KateTabBar::mouseReleaseEvent(QMouseEvent *event)
 {
+    const int pressedCloseIndex = d->pressedCloseIndex;
+    d->pressedCloseIndex = -1;
+    d->dragIndex = -1;
+
+    if (pressedCloseIndex < 0) {
+        QWidget::mouseReleaseEvent(event);
+        return;
+    }
+
+    event->accept();
+    update();
+
+    // only close if the mouse is still on the close button
+    if (event->button() == Qt::LeftButton && d->closeButtonRect(pressedCloseIndex).contains(event->pos())) {
+        d->requestClose(pressedCloseIndex);
+    }
+}
+
+void KateTabBar::mouseMoveEvent(QMouseEvent *event)
+{
+    // possibly start drag event
+    if ((event->buttons() & Qt::LeftButton) && d->dragIndex >= 0
+        && QPoint(event->globalPos() - d->mouseDownPosition).manhattanLength() > QApplication::startDragDistance())
+    {
+        QMimeData *mimeData = new QMimeData;
+        mimeData->setData(QStringLiteral("application/x-dndkatetabbutton"), QByteArray());
+        mimeData->setUrls({d->tabs[d->dragIndex].url});
+
+        auto drag = new QDrag(this);
+        drag->setMimeData(mimeData);
+        drag->setDragCursor(QPixmap(), Qt::MoveAction);
+        drag->exec(Qt::MoveAction);
+
+        d->dragIndex = -1;
+        event->accept();
+        return;
+    }
+
+    d->updateHover(event->pos());
+    QWidget::mouseMoveEvent(event);
+}
+
+void KateTabBar::leaveEvent(QEvent *event)
+{
+    d->hoverIndex = -1;
+    d->hoverClose = false;
+
     if (d->keepTabWidth) {
         d->keepTabWidth = false;
-        d->updateButtonPositions(true);
+        d->updateTabWidth();
+    } else {
+        update();
     }
 
     QWidget::leaveEvent(event);
@@ -478,48 +667,70 @@ void KateTabBar::leaveEvent(QEvent *event)
 
 void KateTabBar::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event)
-
-    const int buttonCount = d->tabButtons.size();
-    if (buttonCount < 1) {
+    const int visibleCount = d->visibleTabCount();
+    if (visibleCount < 1) {
         return;
     }
 
+    QPainter painter(this);
+
+    // only the tabs in the dirty region are painted
+    const int first = qMax(0, d->tabAt(QPoint(event->rect().left(), 0)));
+    int last = d->tabAt(QPoint(event->rect().right(), 0));
+    if (last < 0) {
+        last = visibleCount - 1;
+    }
+
+    for (int i = first; i <= last; ++i) {
+        d->paintTab(painter, i);
+    }
+
     // draw separators
     QStyleOption option;
-    option.initFrom(d->tabButtons[0]);
+    option.initFrom(this);
     option.state |= QStyle::State_Horizontal;
     const int w = style()->pixelMetric(QStyle::PM_ToolBarSeparatorExtent, nullptr, this);
     const int offset = w / 2;
     option.rect.setWidth(w);
     option.rect.moveTop(0);
 
-    QPainter painter(this);
-
     // first separator
-    option.rect.moveLeft(d->tabButtons[0]->geometry().left() - offset);
-    style()->drawPrimitive(QStyle::PE_IndicatorToolBarSeparator, &option, &painter);
+    if (first == 0) {
+        option.rect.moveLeft(d->tabRect(0).left() - offset);
+        style()->drawPrimitive(QStyle::PE_IndicatorToolBarSeparator, &option, &painter);
+    }
 
     // all other separators
-    for (int i = 0; i < buttonCount; ++i) {
-        option.rect.moveLeft(d->tabButtons[i]->geometry().right() - offset);
+    for (int i = first; i <= last; ++i) {
+        option.rect.moveLeft(d->tabRect(i).right() - offset);
         style()->drawPrimitive(QStyle::PE_IndicatorToolBarSeparator, &option, &painter);
     }
 }
 
-void KateTabBar::contextMenuEvent(QContextMenuEvent *ev)
+bool KateTabBar::event(QEvent *event)
 {
-    int id = -1;
-    foreach (KateTabButton * button, d->tabButtons) {
-        if (button->rect().contains(button->mapFromGlobal(ev->globalPos()))) {
-            id = d->idToTab.key(button, -1);
-            Q_ASSERT(id >= 0);
-            break;
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        const int index = d->tabAt(helpEvent->pos());
+        if (index >= 0) {
+            const bool onClose = d->closeButtonRect(index).contains(helpEvent->pos());
+            const QString tip = onClose ? i18n("Close Document") : d->tabs[index].toolTip;
+            QToolTip::showText(helpEvent->globalPos(), tip, this, onClose ? d->closeButtonRect(index) : d->tabRect(index));
+        } else {
+            QToolTip::hideText();
+            event->ignore();
         }
+        return true;
     }
 
-    if (id >= 0) {
-        emit contextMenuRequest(id, ev->globalPos());
+    return QWidget::event(event);
+}
+
+void KateTabBar::contextMenuEvent(QContextMenuEvent *ev)
+{
+    const int index = d->tabAt(ev->pos());
+    if (index >= 0) {
+        emit contextMenuRequest(d->tabs[index].id, ev->globalPos());
     }
 }
 
@@ -531,10 +742,10 @@ void KateTabBar::wheelEvent(QWheelEvent * event)
     const int delta = event->angleDelta().x() + event->angleDelta().y();
     const int id = (delta > 0) ? prevTab() : nextTab();
     if (id >= 0) {
-        Q_ASSERT(d->idToTab.contains(id));
-        KateTabButton *tabButton = d->idToTab.value(id, nullptr);
-        if (tabButton) {
-            tabButtonActivated(tabButton);
+        const int index = d->indexOf(id);
+        Q_ASSERT(index >= 0);
+        if (index >= 0) {
+            d->activateTab(index);
         }
     }
 }
@@ -543,7 +754,7 @@ void KateTabBar::dragEnterEvent(QDragEnterEvent *event)
 {
     const bool sameApplication = event->source() != nullptr;
     if (sameApplication && event->mimeData()->hasFormat(QStringLiteral("application/x-dndkatetabbutton"))) {
-        if (event->source()->parent() == this) {
+        if (event->source() == this) {
             event->setDropAction(Qt::MoveAction);
             event->accept();
         } else {
@@ -557,32 +768,31 @@ void KateTabBar::dragEnterEvent(QDragEnterEvent *event)
 
 void KateTabBar::dragMoveEvent(QDragMoveEvent *event)
 {
-    // first of all, make sure the dragged button is from this tabbar
-    auto button = qobject_cast<KateTabButton *>(event->source());
-    if (!button) {
+    // first of all, make sure the dragged tab is from this tabbar
+    if (event->source() != this || d->dragIndex < 0) {
         event->ignore();
         return;
     }
 
-    // save old tab position
-    const int oldButtonIndex = d->tabButtons.indexOf(button);
-    d->tabButtons.removeAt(oldButtonIndex);
-
-    // find new position
+    // find new position, compared to the current positions of the other tabs
+    const int oldIndex = d->dragIndex;
     const qreal currentPos = event->pos().x();
-    int index = d->tabButtons.size();
-    for (int i = 0; i < d->tabButtons.size(); ++i) {
-        auto tab = d->tabButtons[i];
-        if (tab->geometry().center().x() > currentPos) {
-            index = i;
+    int index = 0;
+    for (int i = 0; i < d->visibleTabCount(); ++i) {
+        if (i == oldIndex) {
+            continue;
+        }
+        if (d->tabRect(i).center().x() > currentPos) {
             break;
         }
+        ++index;
     }
-    d->tabButtons.insert(index, button);
 
     // trigger rearrange if required
-    if (oldButtonIndex != index) {
-        d->updateButtonPositions(true);
+    if (oldIndex != index) {
+        d->tabs.insert(index, d->tabs.takeAt(oldIndex));
+        d->dragIndex = index;
+        update();
     }
 
     event->accept();
@@ -27,7 +27,6 @@
 #include <QHash>
 #include <QIcon>
 
-class KateTabButton;
 class KateTabBarPrivate;
 
 /**
@@ -35,6 +34,10 @@ class KateTabBarPrivate;
  *
  * The API closely follows the API of QTabBar.
  *
+ * The tabs are no widgets, the tab bar keeps a small data record per tab
+ * and paints the visible tabs itself. Inserting, removing or reordering
+ * tabs therefore never creates widgets or triggers a relayout.
+ *
  * @author Dominik Haumann
  */
 class KateTabBar : public QWidget
@@ -215,34 +218,31 @@ Q_SIGNALS:
      */
     void activateViewSpaceRequested();
 
-protected Q_SLOTS:
-    /**
-     * Active button changed. Emit signal \p currentChanged() with the button's ID.
-     */
-    void tabButtonActivated(KateTabButton *tabButton);
-
-    /**
-     * If the user wants to close a tab with the context menu, it sends a close
-     * request.
-     */
-    void tabButtonCloseRequest(KateTabButton *tabButton);
-
 protected:
-    //! Recalculate geometry for all tabs.
+    //! Recalculate the tab width.
     void resizeEvent(QResizeEvent *event) override;
 
-    //! Override to avoid requesting a new tab.
+    //! Request a new tab if the free space was double clicked.
     void mouseDoubleClickEvent(QMouseEvent *event) override;
 
-    //! Override to request making the tab bar active.
+    //! Activate or close tabs, request making the tab bar active.
     void mousePressEvent(QMouseEvent *event) override;
 
+    //! Close the tab if its close button was clicked.
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
+    //! Track hovered tab, possibly start dragging a tab
+    void mouseMoveEvent(QMouseEvent *event) override;
+
     //! trigger repaint on hover leave event
     void leaveEvent(QEvent *event) override;
 
-    //! Paint tab separators
+    //! Paint the visible tabs and their separators
     void paintEvent(QPaintEvent *event) override;
 
+    //! Show the tool tip of the tab under the mouse
+    bool event(QEvent *event) override;
+
     //! Request context menu
     void contextMenuEvent(QContextMenuEvent *ev) override;
 
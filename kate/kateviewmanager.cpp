@@ -24,6 +24,7 @@
 #include "kateapp.h"
 #include "katemainwindow.h"
 #include "kateviewspace.h"
+#include "katestartupprofiler.h"
 #include "kateupdatedisabler.h"
 
 #include <KTextEditor/View>
@@ -57,7 +58,8 @@ KateViewManager::KateViewManager(QWidget *parentW, KateMainWindow *parent)
     , m_mainWindow(parent)
     , m_blockViewCreationAndActivation(false)
     , m_activeViewRunning(false)
-    , m_minAge(0)
+    , m_activeView(nullptr)
+    , m_maximalViewsPerViewSpace(10)
     , m_guiMergedView(nullptr)
 {
     // while init
@@ -79,8 +81,8 @@ KateViewManager::KateViewManager(QWidget *parentW, KateMainWindow *parent)
     /**
      * before document is really deleted: cleanup all views!
      */
-    connect(KateApp::self()->documentManager(), SIGNAL(documentWillBeDeleted(KTextEditor::Document*))
-        , this, SLOT(documentWillBeDeleted(KTextEditor::Document*)));
+    connect(KateApp::self()->documentManager(), SIGNAL(documentsWillBeDeleted(QList<KTextEditor::Document*>))
+        , this, SLOT(documentsWillBeDeleted(QList<KTextEditor::Document*>)));
 
     /**
      * handle document deletion transactions
@@ -257,8 +259,9 @@ void KateViewManager::slotDocumentOpen()
     // activate view of last opened document
     KateDocumentInfo docInfo;
     docInfo.openedByUser = true;
-    if (KTextEditor::Document *lastID = openUrls(urls, QString(), false, docInfo)) {
-        activateView(lastID);
+    const QList<KTextEditor::Document *> docs = openUrls(urls, QString(), false, docInfo);
+    if (!docs.isEmpty()) {
+        activateView(docs.last());
     }
 }
 
@@ -308,7 +311,7 @@ KTextEditor::Document *KateViewManager::openUrl(const QUrl &url,
     return doc;
 }
 
-KTextEditor::Document *KateViewManager::openUrls(const QList<QUrl> &urls,
+QList<KTextEditor::Document *> KateViewManager::openUrls(const QList<QUrl> &urls,
         const QString &encoding,
         bool isTempFile,
         const KateDocumentInfo &docInfo)
@@ -321,7 +324,7 @@ KTextEditor::Document *KateViewManager::openUrls(const QList<QUrl> &urls,
         }
     }
 
-    return docs.isEmpty() ? 0 : docs.last();
+    return docs;
 }
 
 KTextEditor::View *KateViewManager::openUrlWithView(const QUrl &url, const QString &encoding)
@@ -446,6 +449,9 @@ KTextEditor::View *KateViewManager::createView(KTextEditor::Document *doc, KateV
         doc = KateApp::self()->documentManager()->createDoc();
     }
 
+    // lazily restored documents are loaded once they are shown
+    KateApp::self()->documentManager()->loadPendingDocument(doc);
+
     /**
      * create view, registers its XML gui itself
      * pass the view the correct main window
@@ -453,11 +459,12 @@ KTextEditor::View *KateViewManager::createView(KTextEditor::Document *doc, KateV
     KTextEditor::View *view = (vs ? vs : activeViewSpace())->createView(doc);
 
     /**
-     * remember this view, active == false, min age set
+     * remember this view, it is the most recently used one
      * create activity resource
      */
-    m_views[view].active = false;
-    m_views[view].lruAge = m_minAge--;
+    m_views[view] = ViewData();
+    m_viewLru.touch(view);
+    m_documentLru.touch(doc);
 
 #ifdef KActivities_FOUND
     m_views[view].activityResource = new KActivities::ResourceInstance(view->window()->winId(), view);
@@ -498,12 +505,33 @@ bool KateViewManager::deleteView(KTextEditor::View *view)
         m_guiMergedView = nullptr;
     }
 
+    if (m_activeView == view) {
+        m_activeView = nullptr;
+    }
+
     // remove view from mapping and memory !!
     m_views.remove(view);
+    m_viewLru.remove(view);
+
     delete view;
     return true;
 }
 
+void KateViewManager::disposeIdleViews(KateViewSpace *vs)
+{
+    if (m_maximalViewsPerViewSpace <= 0 || m_blockViewCreationAndActivation) {
+        return;
+    }
+
+    /**
+     * keep the state of the views, they are created again if their tab is activated
+     */
+    Q_FOREACH (KTextEditor::View *view, vs->idleViews(m_maximalViewsPerViewSpace)) {
+        vs->rememberViewConfig(view);
+        deleteView(view);
+    }
+}
+
 KateViewSpace *KateViewManager::activeViewSpace()
 {
     for (QList<KateViewSpace *>::const_iterator it = m_viewSpaceList.constBegin();
@@ -529,17 +557,12 @@ KTextEditor::View *KateViewManager::activeView()
         return nullptr;
     }
 
-    m_activeViewRunning = true;
-
-    QHashIterator<KTextEditor::View *, ViewData> it(m_views);
-    while (it.hasNext()) {
-        it.next();
-        if (it.value().active) {
-            m_activeViewRunning = false;
-            return it.key();
-        }
+    if (m_activeView) {
+        return m_activeView;
     }
 
+    m_activeViewRunning = true;
+
     // if we get to here, no view isActive()
     // first, try to get one from activeViewSpace()
     KateViewSpace *vs = activeViewSpace();
@@ -550,9 +573,9 @@ KTextEditor::View *KateViewManager::activeView()
         return vs->currentView();
     }
 
-    // last attempt: just pick first
-    if (!m_views.isEmpty()) {
-        KTextEditor::View *v = m_views.begin().key();
+    // last attempt: just pick the most recently used one
+    if (!m_viewLru.isEmpty()) {
+        KTextEditor::View *v = m_viewLru.first();
         activateView(v);
         m_activeViewRunning = false;
         return v;
@@ -575,13 +598,7 @@ void KateViewManager::setActiveSpace(KateViewSpace *vs)
 
 void KateViewManager::setActiveView(KTextEditor::View *view)
 {
-    if (activeView()) {
-        m_views[activeView()].active = false;
-    }
-
-    if (view) {
-        m_views[view].active = true;
-    }
+    m_activeView = view;
 }
 
 void KateViewManager::activateSpace(KTextEditor::View *v)
@@ -602,7 +619,7 @@ void KateViewManager::reactivateActiveView()
 {
     KTextEditor::View *view = activeView();
     if (view) {
-        m_views[view].active = false;
+        m_activeView = nullptr;
         activateView(view);
     }
 }
@@ -614,7 +631,7 @@ void KateViewManager::activateView(KTextEditor::View *view)
     }
 
     Q_ASSERT (m_views.contains(view));
-    if (!m_views[view].active) {
+    if (m_activeView != view) {
         // avoid flicker
         KateUpdateDisabler disableUpdates (mainWindow());
 
@@ -646,8 +663,9 @@ void KateViewManager::activateView(KTextEditor::View *view)
             mainWindow()->toolBar()->show();
         }
 
-        // remember age of this view
-        m_views[view].lruAge = m_minAge--;
+        // this view and its document are the most recently used ones now
+        m_viewLru.touch(view);
+        m_documentLru.touch(view->document());
 
         emit viewChanged(view);
 
@@ -656,6 +674,9 @@ void KateViewManager::activateView(KTextEditor::View *view)
         m_views[view].activityResource->setUri(view->document()->url());
         m_views[view].activityResource->notifyFocusedIn();
 #endif
+
+        // the views of long inactive tabs are not kept around
+        disposeIdleViews(activeViewSpace());
     }
 }
 
@@ -708,21 +729,37 @@ void KateViewManager::activatePrevView()
     activateView(m_viewSpaceList.at(i)->currentView());
 }
 
-void KateViewManager::documentWillBeDeleted(KTextEditor::Document *doc)
+void KateViewManager::documentsWillBeDeleted(const QList<KTextEditor::Document *> &documents)
 {
     /**
-     * collect all views of that document that belong to this manager
+     * collect all views of these documents that belong to this manager
      */
     QList<KTextEditor::View *> closeList;
-    Q_FOREACH (KTextEditor::View *v, doc->views()) {
-        if (m_views.contains(v)) {
-            closeList.append(v);
+    Q_FOREACH (KTextEditor::Document *doc, documents) {
+        Q_FOREACH (KTextEditor::View *v, doc->views()) {
+            if (m_views.contains(v)) {
+                closeList.append(v);
+            }
         }
     }
 
     while (!closeList.isEmpty()) {
         deleteView(closeList.takeFirst());
     }
+
+    /**
+     * documents leave the lru list only when they are closed, not with their last view
+     */
+    Q_FOREACH (KTextEditor::Document *doc, documents) {
+        m_documentLru.remove(doc);
+    }
+
+    /**
+     * the view spaces forget the documents and their tabs in one pass
+     */
+    Q_FOREACH (KateViewSpace *vs, m_viewSpaceList) {
+        vs->documentsWillBeDeleted(documents);
+    }
 }
 
 void KateViewManager::closeView(KTextEditor::View *view)
@@ -1008,6 +1045,8 @@ void KateViewManager::saveViewConfiguration(KConfigGroup &config)
 
 void KateViewManager::restoreViewConfiguration(const KConfigGroup &config)
 {
+    KateStartupProfiler::Span span("KateViewManager::restoreViewConfiguration");
+
     /**
      * remove the single client that is registered at the factory, if any
      */
@@ -1026,9 +1065,11 @@ void KateViewManager::restoreViewConfiguration(const KConfigGroup &config)
      * delete mapping of now deleted views
      */
     m_views.clear();
+    m_activeView = nullptr;
 
     // reset lru history, too!
-    m_minAge = 0;
+    m_viewLru.clear();
+    m_documentLru.clear();
 
     // start recursion for the root splitter (Splitter 0)
     restoreSplitter(config.config(), config.name() + QStringLiteral("-Splitter 0"), this, config.name());
@@ -22,6 +22,7 @@
 #define __KATE_VIEWMANAGER_H__
 
 #include "katedocmanager.h"
+#include "katelrulist.h"
 
 #include <QPointer>
 #include <QList>
@@ -76,10 +77,10 @@ public:
                                    bool isTempFile = false,
                                    const KateDocumentInfo &docInfo = KateDocumentInfo());
 
-    KTextEditor::Document *openUrls(const QList<QUrl> &url,
-                                    const QString &encoding,
-                                    bool isTempFile = false,
-                                    const KateDocumentInfo &docInfo = KateDocumentInfo());
+    QList<KTextEditor::Document *> openUrls(const QList<QUrl> &url,
+                                            const QString &encoding,
+                                            bool isTempFile = false,
+                                            const KateDocumentInfo &docInfo = KateDocumentInfo());
 
     KTextEditor::View *openUrlWithView(const QUrl &url, const QString &encoding);
 
@@ -118,9 +119,27 @@ public:
      */
     KTextEditor::View *createView(KTextEditor::Document *doc = nullptr, KateViewSpace *vs = nullptr);
 
+    /**
+     * Views per view space that are kept alive, older ones are disposed.
+     * Their cursor and scroll state is restored once they are shown again.
+     * @param maxViews number of views to keep, 0 keeps all views
+     */
+    void setMaximalViewsPerViewSpace(int maxViews) {
+        m_maximalViewsPerViewSpace = maxViews;
+    }
+
+    int maximalViewsPerViewSpace() const {
+        return m_maximalViewsPerViewSpace;
+    }
+
 private:
     bool deleteView(KTextEditor::View *view);
 
+    /**
+     * Dispose the views of @p vs that were not used for long.
+     */
+    void disposeIdleViews(KateViewSpace *vs);
+
     void moveViewtoSplit(KTextEditor::View *view);
     void moveViewtoStack(KTextEditor::View *view);
 
@@ -145,7 +164,7 @@ private Q_SLOTS:
     void slotViewChanged();
 
     void documentCreated(KTextEditor::Document *doc);
-    void documentWillBeDeleted(KTextEditor::Document *doc);
+    void documentsWillBeDeleted(const QList<KTextEditor::Document *> &documents);
 
     void documentSavedOrUploaded(KTextEditor::Document *document, bool saveAs);
 
@@ -264,13 +283,17 @@ public Q_SLOTS:
      */
     QList<KTextEditor::View *> sortedViews() const
     {
-        QMap<qint64, KTextEditor::View *> sortedViews;
-        QHashIterator<KTextEditor::View *, ViewData> i(m_views);
-        while (i.hasNext()) {
-            i.next();
-            sortedViews[i.value().lruAge] = i.key();
-        }
-        return sortedViews.values();
+        return m_viewLru.toList();
+    }
+
+    /**
+     * Documents shown in this window in lru order, the most recently used first.
+     * Documents stay in the list until they are closed, even if their views are disposed.
+     * @return lru ordered list of documents
+     */
+    const KateLruList<KTextEditor::Document *> &documentLru() const
+    {
+        return m_documentLru;
     }
 
 private:
@@ -303,23 +326,10 @@ private:
              * Default constructor
              */
             ViewData()
-                : active(false)
-                , lruAge(0)
-                , activityResource(Q_NULLPTR)
+                : activityResource(Q_NULLPTR)
             {
             }
 
-            /**
-             * view active?
-             */
-            bool active;
-
-            /**
-             * lru age of the view
-             * important: smallest age ==> latest used view
-             */
-            qint64 lruAge;
-
             /**
              * activity resource for the view
              */
@@ -333,9 +343,20 @@ private:
     QHash<KTextEditor::View *, ViewData> m_views;
 
     /**
-     * current minimal age
+     * the active view, nullptr if none
+     */
+    KTextEditor::View *m_activeView;
+
+    /**
+     * views and their documents in lru order, updated on each activation
+     */
+    KateLruList<KTextEditor::View *> m_viewLru;
+    KateLruList<KTextEditor::Document *> m_documentLru;
+
+    /**
+     * views per view space kept alive, 0 => unlimited
      */
-    qint64 m_minAge;
+    int m_maximalViewsPerViewSpace;
 
     /**
      * the view that is ATM merged to the xml gui factory
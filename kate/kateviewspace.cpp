@@ -30,6 +30,7 @@
 #include "kateupdatedisabler.h"
 
 #include <KAcceleratorManager>
+#include <KConfig>
 #include <KConfigGroup>
 #include <KLocalizedString>
 // remove #ifdef, once Kate depends on KF 5.24
@@ -43,6 +44,7 @@
 #include <QDesktopServices>
 #include <QHelpEvent>
 #include <QMenu>
+#include <QSet>
 #include <QStackedWidget>
 #include <QToolButton>
 #include <QToolTip>
@@ -129,6 +131,7 @@ KateViewSpace::KateViewSpace(KateViewManager *viewManager,
     updateQuickOpen();
     connect(KateApp::self()->documentManager(), SIGNAL(documentCreated(KTextEditor::Document*)), this, SLOT(updateQuickOpen()));
     connect(KateApp::self()->documentManager(), SIGNAL(documentsDeleted(const QList<KTextEditor::Document*>&)), this, SLOT(updateQuickOpen()));
+    connect(KateApp::self()->documentManager(), SIGNAL(pendingDocumentChanged(KTextEditor::Document*)), this, SLOT(updatePendingDocument(KTextEditor::Document*)));
 }
 
 bool KateViewSpace::eventFilter(QObject *obj, QEvent *event)
@@ -218,7 +221,17 @@ KTextEditor::View *KateViewSpace::createView(KTextEditor::Document *doc)
     v->setStatusBarEnabled(m_viewManager->mainWindow()->showStatusBar());
 
     // restore the config of this view if possible
-    if (!m_group.isEmpty()) {
+    // a disposed view of this document wins over the session
+    const auto disposed = m_viewConfigs.find(doc);
+    if (disposed != m_viewConfigs.end()) {
+        KConfig config(QString(), KConfig::SimpleConfig);
+        KConfigGroup cg(&config, "View");
+        for (auto it = disposed.value().constBegin(); it != disposed.value().constEnd(); ++it) {
+            cg.writeEntry(it.key(), it.value());
+        }
+        v->readSessionConfig(cg);
+        m_viewConfigs.erase(disposed);
+    } else if (!m_group.isEmpty()) {
         QString fn = v->document()->url().toString();
         if (! fn.isEmpty()) {
             QString vgroup = QString::fromLatin1("%1 %2").arg(m_group).arg(fn);
@@ -255,6 +268,37 @@ void KateViewSpace::removeView(KTextEditor::View *v)
     stack->removeWidget(v);
 }
 
+QList<KTextEditor::View *> KateViewSpace::idleViews(int maxViews) const
+{
+    /**
+     * walk the lru list from the most recently used document on, keep the first views
+     */
+    QList<KTextEditor::View *> views;
+    int kept = 0;
+    for (int i = m_lruDocList.size() - 1; i >= 0; --i) {
+        KTextEditor::View *view = m_docToView.value(m_lruDocList[i]);
+        if (!view) {
+            continue;
+        }
+
+        if (kept < maxViews || view == stack->currentWidget()) {
+            ++kept;
+        } else {
+            views.prepend(view);
+        }
+    }
+
+    return views;
+}
+
+void KateViewSpace::rememberViewConfig(KTextEditor::View *view)
+{
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup cg(&config, "View");
+    view->writeSessionConfig(cg);
+    m_viewConfigs.insert(view->document(), cg.entryMap());
+}
+
 bool KateViewSpace::showView(KTextEditor::Document *document)
 {
     const int index = m_lruDocList.lastIndexOf(document);
@@ -352,8 +396,8 @@ void KateViewSpace::insertTab(int index, KTextEditor::Document * doc)
     // doc should not have a id
     Q_ASSERT(! m_docToTabId.contains(doc));
 
-    const int id = m_tabBar->insertTab(index, doc->documentName());
-    m_tabBar->setTabToolTip(id, doc->url().toDisplayString());
+    const int id = m_tabBar->insertTab(index, KateDocManager::documentName(doc));
+    m_tabBar->setTabToolTip(id, KateDocManager::documentUrl(doc).toDisplayString());
     m_docToTabId[doc] = id;
     updateDocumentState(doc);
 
@@ -469,6 +513,7 @@ void KateViewSpace::documentDestroyed(QObject *doc)
 
     Q_ASSERT(m_lruDocList.contains(invalidDoc));
     m_lruDocList.remove(m_lruDocList.indexOf(invalidDoc));
+    m_viewConfigs.remove(invalidDoc);
 
     // disconnect entirely
     disconnect(doc, nullptr, this, nullptr);
@@ -494,19 +539,60 @@ void KateViewSpace::documentDestroyed(QObject *doc)
     Q_ASSERT(! m_docToTabId.contains(invalidDoc));
 }
 
+void KateViewSpace::documentsWillBeDeleted(const QList<KTextEditor::Document *> &documents)
+{
+    /**
+     * one pass over the lru list, tabs of closed documents are removed on the way
+     */
+    const QSet<KTextEditor::Document *> closed = documents.toSet();
+    QVector<KTextEditor::Document *> remaining;
+    remaining.reserve(m_lruDocList.size());
+    for (KTextEditor::Document *doc : m_lruDocList) {
+        if (!closed.contains(doc)) {
+            remaining.append(doc);
+            continue;
+        }
+
+        // no documentDestroyed() for this one
+        disconnect(doc, nullptr, this, nullptr);
+        m_viewConfigs.remove(doc);
+        if (m_docToTabId.contains(doc)) {
+            removeTab(doc, true);
+        }
+        Q_ASSERT(!m_docToView.contains(doc));
+    }
+
+    if (remaining.size() == m_lruDocList.size()) {
+        return;
+    }
+    m_lruDocList = remaining;
+
+    // fill up the tab bar once
+    addTabs(m_tabBar->maxTabCount() - m_tabBar->count());
+    updateQuickOpen();
+}
+
 void KateViewSpace::updateDocumentName(KTextEditor::Document *doc)
 {
     const int buttonId = m_docToTabId[doc];
     Q_ASSERT(buttonId >= 0);
-    m_tabBar->setTabText(buttonId, doc->documentName());
-    m_tabBar->setTabToolTip(buttonId, doc->url().toDisplayString());
+    m_tabBar->setTabText(buttonId, KateDocManager::documentName(doc));
+    m_tabBar->setTabToolTip(buttonId, KateDocManager::documentUrl(doc).toDisplayString());
 }
 
 void KateViewSpace::updateDocumentUrl(KTextEditor::Document *doc)
 {
     const int buttonId = m_docToTabId[doc];
     Q_ASSERT(buttonId >= 0);
-    m_tabBar->setTabUrl(buttonId, doc->url());
+    m_tabBar->setTabUrl(buttonId, KateDocManager::documentUrl(doc));
+}
+
+void KateViewSpace::updatePendingDocument(KTextEditor::Document *doc)
+{
+    if (m_docToTabId.contains(doc)) {
+        updateDocumentName(doc);
+        updateDocumentUrl(doc);
+    }
 }
 
 void KateViewSpace::updateDocumentState(KTextEditor::Document *doc)
@@ -574,7 +660,7 @@ void KateViewSpace::focusNextTab()
 
 int KateViewSpace::hiddenDocuments() const
 {
-    const int hiddenDocs = KateApp::self()->documents().count() - m_tabBar->count();
+    const int hiddenDocs = KateApp::self()->documentManager()->documentList().count() - m_tabBar->count();
     Q_ASSERT(hiddenDocs >= 0);
     return hiddenDocs;
 }
@@ -630,9 +716,18 @@ void KateViewSpace::saveConfig(KConfigBase *config, int myIndex , const QString
     QVector<KTextEditor::View*> views;
     QStringList lruList;
     Q_FOREACH(KTextEditor::Document* doc, m_lruDocList) {
-        lruList << doc->url().toString();
+        // documents that are not loaded yet have no url, use the one they will get
+        const QUrl url = KateDocManager::documentUrl(doc);
+        lruList << url.toString();
         if (m_docToView.contains(doc)) {
             views.append(m_docToView[doc]);
+        } else if (m_viewConfigs.contains(doc) && !url.isEmpty()) {
+            // disposed view: keep its state for the next session, too
+            KConfigGroup viewGroup(config, QString::fromLatin1("%1 %2").arg(groupname).arg(url.toString()));
+            const QMap<QString, QString> &entries = m_viewConfigs[doc];
+            for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+                viewGroup.writeEntry(it.key(), it.value());
+            }
         }
     }
 
@@ -680,6 +775,13 @@ void KateViewSpace::restoreConfig(KateViewManager *viewMan, const KConfigBase *c
         }
     }
 
+    // lazily restored documents of this view space are loaded first, most recently used first
+    QList<KTextEditor::Document *> pendingDocs;
+    for (int i = m_lruDocList.size() - 1; i >= 0; --i) {
+        pendingDocs.append(m_lruDocList[i]);
+    }
+    KateApp::self()->documentManager()->prioritizePendingDocuments(pendingDocs);
+
     // restore active view properties
     const QString fn = group.readEntry("Active View");
     if (!fn.isEmpty()) {
@@ -26,6 +26,7 @@
 #include <ktexteditor/modificationinterface.h>
 
 #include <QHash>
+#include <QMap>
 #include <QWidget>
 
 class KConfigBase;
@@ -60,6 +61,21 @@ public:
     KTextEditor::View *createView(KTextEditor::Document *doc);
     void removeView(KTextEditor::View *v);
 
+    /**
+     * Views beyond the @p maxViews most recently used ones.
+     * The current view is never part of the result.
+     * @param maxViews number of views to keep
+     * @return views that can be disposed, least recently used first
+     */
+    QList<KTextEditor::View *> idleViews(int maxViews) const;
+
+    /**
+     * Remember the cursor and scroll state of @p view before it is disposed.
+     * The next view created for its document in this view space restores it.
+     * @param view view that will be deleted
+     */
+    void rememberViewConfig(KTextEditor::View *view);
+
     bool showView(KTextEditor::View *view) {
         return showView(view->document());
     }
@@ -104,12 +120,25 @@ public:
      */
     void focusNextTab();
 
+    /**
+     * Forget the documents, they are deleted next.
+     * Used for bulk closing instead of one documentDestroyed() per document.
+     * Their views must be gone already.
+     * @param documents documents that will be deleted
+     */
+    void documentsWillBeDeleted(const QList<KTextEditor::Document *> &documents);
+
 public Q_SLOTS:
     void documentDestroyed(QObject *doc);
     void updateDocumentName(KTextEditor::Document *doc);
     void updateDocumentUrl(KTextEditor::Document *doc);
     void updateDocumentState(KTextEditor::Document *doc);
 
+    /**
+     * the document waits for loading now, its tab shows the url it will get
+     */
+    void updatePendingDocument(KTextEditor::Document *doc);
+
 private Q_SLOTS:
     void statusBarToggled();
     void tabBarToggled();
@@ -198,6 +227,9 @@ private:
     // note: the number of entries match stack->count();
     QHash<KTextEditor::Document*, KTextEditor::View*> m_docToView;
 
+    // session config of disposed views, restored if the document is shown again
+    QHash<KTextEditor::Document*, QMap<QString, QString> > m_viewConfigs;
+
     // tab bar that contains viewspace tabs
     KateTabBar *m_tabBar;
     
@@ -21,6 +21,7 @@
 
 #include "kateapp.h"
 #include "katerunninginstanceinfo.h"
+#include "katestartupprofiler.h"
 #include "katewaiter.h"
 
 #include <KAboutData>
@@ -39,10 +40,13 @@
 #include <QVariant>
 #include <QDBusInterface>
 #include <QDBusMessage>
+#include <QDBusPendingCall>
+#include <QDBusPendingReply>
 #include <QDBusReply>
 #include <QApplication>
 #include <QDir>
 #include <QSessionManager>
+#include <QTimer>
 
 #include "../urlinfo.h"
 
@@ -54,10 +58,16 @@
 #include <unistd.h>
 #endif
 #include <iostream>
+#include <limits>
 
 
 int main(int argc, char **argv)
 {
+    /**
+     * time the startup, only exported if wanted
+     */
+    KateStartupProfiler::start("QApplication");
+
 #ifndef Q_OS_WIN
     // Prohibit using sudo or kdesu (but allow using the root user directly)
     if (getuid() == 0) {
@@ -84,6 +94,8 @@ int main(int argc, char **argv)
     QApplication app(argc, argv);
 #endif
 
+    KateStartupProfiler::phase("command line");
+
     /**
      * Enforce application name even if the executable is renamed
      */
@@ -222,6 +234,10 @@ int main(int argc, char **argv)
     const QCommandLineOption tempfileOption(QStringList() << QStringLiteral("tempfile"), i18n("The files/URLs opened by the application will be deleted after use"));
     parser.addOption(tempfileOption);
 
+    // startup trace option
+    const QCommandLineOption startupTraceOption(QStringList() << QStringLiteral("startup-trace"), i18n("Write a trace of the startup to this file, in Chrome trace format."), i18n("file"));
+    parser.addOption(startupTraceOption);
+
     // urls to open
     parser.addPositionalArgument(QStringLiteral("urls"), i18n("Documents to open."), i18n("[urls...]"));
 
@@ -235,6 +251,10 @@ int main(int argc, char **argv)
      */
     aboutData.processCommandLine(&parser);
 
+    if (parser.isSet(startupTraceOption)) {
+        KateStartupProfiler::setTraceFile(parser.value(startupTraceOption));
+    }
+
     /**
      * remember the urls we shall open
      */
@@ -270,14 +290,19 @@ int main(int argc, char **argv)
      * use dbus, if available for linux and co.
      * allows for resuse of running Kate instances
      */
+    KateStartupProfiler::phase("instance probing");
+
 #ifndef USE_QT_SINGLE_APP
     if (QDBusConnectionInterface * const sessionBusInterface = QDBusConnection::sessionBus().interface()) {
         /**
          * try to get the current running kate instances
          */
         KateRunningInstanceMap mapSessionRii;
-        if (!fillinRunningKateAppInstances(&mapSessionRii)) {
-            return 1;
+        {
+            KateStartupProfiler::Span span("fillinRunningKateAppInstances");
+            if (!fillinRunningKateAppInstances(&mapSessionRii)) {
+                return 1;
+            }
         }
 
         QString currentActivity;
@@ -415,57 +440,92 @@ int main(int argc, char **argv)
 
             bool tempfileSet = parser.isSet(tempfileOption);
 
-            QStringList tokens;
-
-            // open given files...
+            // open given files, all in one batch, the reply is only needed later on
+            QStringList dbusUrls;
+            QList<int> lines;
+            QList<int> columns;
             foreach(const QString & url, urls) {
+                UrlInfo info(url);
+                dbusUrls.append(info.url.toString());
+                lines.append(info.cursor.line());
+                columns.append(info.cursor.column());
+            }
+
+            QDBusPendingCall openCall = QDBusPendingCall::fromCompletedCall(QDBusMessage());
+            if (!dbusUrls.isEmpty()) {
                 QDBusMessage m = QDBusMessage::createMethodCall(serviceName,
-                                QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("tokenOpenUrlAt"));
+                                QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("tokenOpenUrlsAt"));
 
-                UrlInfo info(url);
                 QList<QVariant> dbusargs;
-
-                // convert to an url
-                dbusargs.append(info.url.toString());
-                dbusargs.append(info.cursor.line());
-                dbusargs.append(info.cursor.column());
+                dbusargs.append(dbusUrls);
+                dbusargs.append(QVariant::fromValue(lines));
+                dbusargs.append(QVariant::fromValue(columns));
                 dbusargs.append(enc);
                 dbusargs.append(tempfileSet);
                 m.setArguments(dbusargs);
 
-                QDBusMessage res = QDBusConnection::sessionBus().call(m);
-                if (res.type() == QDBusMessage::ReplyMessage) {
-                    if (res.arguments().count() == 1) {
-                        QVariant v = res.arguments()[0];
-                        if (v.isValid()) {
-                            QString s = v.toString();
-                            if ((!s.isEmpty()) && (s != QStringLiteral("ERROR"))) {
-                                tokens << s;
-                            }
-                        }
-                    }
-                }
+                // no timeout, many files take a while and the tokens are needed for --block
+                openCall = QDBusConnection::sessionBus().asyncCall(m, std::numeric_limits<int>::max());
             }
 
+            // read stdin while the files are opened
+            QTextCodec *codec = nullptr;
+            QString text;
             if (parser.isSet(readStdInOption)) {
                 QTextStream input(stdin, QIODevice::ReadOnly);
 
                 // set chosen codec
-                QTextCodec *codec = parser.isSet(useEncodingOption) ?
-                                    QTextCodec::codecForName(parser.value(useEncodingOption).toUtf8()) : nullptr;
+                codec = parser.isSet(useEncodingOption) ?
+                        QTextCodec::codecForName(parser.value(useEncodingOption).toUtf8()) : nullptr;
 
                 if (codec) {
                     input.setCodec(codec);
                 }
 
                 QString line;
-                QString text;
 
                 do {
                     line = input.readLine();
                     text.append(line + QLatin1Char('\n'));
                 } while (!line.isNull());
+            }
+
+            // collect the tokens, instances without the batch call get the files one by one
+            QStringList tokens;
+            QStringList replyTokens;
+            if (!dbusUrls.isEmpty()) {
+                openCall.waitForFinished();
+                QDBusPendingReply<QStringList> reply = openCall;
+                if (reply.isError() && reply.error().type() == QDBusError::UnknownMethod) {
+                    for (int i = 0; i < dbusUrls.size(); ++i) {
+                        QDBusMessage m = QDBusMessage::createMethodCall(serviceName,
+                                        QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("tokenOpenUrlAt"));
+
+                        QList<QVariant> dbusargs;
+                        dbusargs.append(dbusUrls.at(i));
+                        dbusargs.append(lines.at(i));
+                        dbusargs.append(columns.at(i));
+                        dbusargs.append(enc);
+                        dbusargs.append(tempfileSet);
+                        m.setArguments(dbusargs);
 
+                        QDBusMessage res = QDBusConnection::sessionBus().call(m);
+                        if (res.type() == QDBusMessage::ReplyMessage && res.arguments().count() == 1) {
+                            replyTokens << res.arguments()[0].toString();
+                        }
+                    }
+                } else if (reply.isValid()) {
+                    replyTokens = reply.value();
+                }
+            }
+
+            foreach(const QString & s, replyTokens) {
+                if ((!s.isEmpty()) && (s != QStringLiteral("ERROR"))) {
+                    tokens << s;
+                }
+            }
+
+            if (parser.isSet(readStdInOption)) {
                 QDBusMessage m = QDBusMessage::createMethodCall(serviceName,
                                 QStringLiteral("/MainApplication"), QStringLiteral("org.kde.Kate.Application"), QStringLiteral("openInput"));
 
@@ -603,6 +663,8 @@ int main(int argc, char **argv)
         }
     }
 
+    KateStartupProfiler::phase("KateApp");
+
     /**
      * construct the real kate app object ;)
      * behaves like a singleton, one unique instance
@@ -615,10 +677,13 @@ int main(int argc, char **argv)
      * if this returns false, we shall exit
      * else we may enter the main event loop
      */
+    KateStartupProfiler::phase("KateApp::init");
     if (!kateApp.init()) {
         return 0;
     }
 
+    KateStartupProfiler::phase("D-Bus service");
+
 #ifndef USE_QT_SINGLE_APP
     /**
      * finally register this kate instance for dbus, don't die if no dbus is around!
@@ -633,6 +698,12 @@ int main(int argc, char **argv)
 #endif
 
 
+    /**
+     * the first event loop iteration shows the windows, startup ends afterwards
+     */
+    KateStartupProfiler::phase("first event loop iteration");
+    QTimer::singleShot(0, &KateStartupProfiler::finish);
+
     /**
      * start main event loop for our application
      */
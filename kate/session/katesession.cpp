@@ -56,6 +56,17 @@ KateSession::KateSession(const QString &file, const QString &name, const bool an
     m_documents = config()->group(opGroupName).readEntry(keyCount, 0);
 }
 
+KateSession::KateSession(const QString &file, const QString &name, unsigned int documents, const QDateTime &timestamp)
+    : m_name(name)
+    , m_file(file)
+    , m_anonymous(false)
+    , m_documents(documents)
+    , m_config(nullptr)
+    , m_timestamp(timestamp)
+{
+    Q_ASSERT(!m_file.isEmpty());
+}
+
 KateSession::~KateSession()
 {
     delete m_config;
@@ -72,6 +83,12 @@ void KateSession::setDocuments(const unsigned int number)
     m_documents = number;
 }
 
+void KateSession::setMetaData(unsigned int documents, const QDateTime &timestamp)
+{
+    m_documents = documents;
+    m_timestamp = timestamp;
+}
+
 void KateSession::setFile(const QString &filename)
 {
     if (m_config) {
@@ -103,6 +120,11 @@ KateSession::Ptr KateSession::create(const QString &file, const QString &name)
     return Ptr(new KateSession(file, name, false));
 }
 
+KateSession::Ptr KateSession::create(const QString &file, const QString &name, unsigned int documents, const QDateTime &timestamp)
+{
+    return Ptr(new KateSession(file, name, documents, timestamp));
+}
+
 KateSession::Ptr KateSession::createFrom(const KateSession::Ptr &session, const QString &file, const QString &name)
 {
     return Ptr(new KateSession(file, name, false, session->config()));
@@ -22,12 +22,19 @@
 #define __KATE_SESSION_H__
 
 #include <QExplicitlySharedDataPointer>
+#include <QMap>
 #include <QString>
 #include <QDateTime>
 #include "kateprivate_export.h"
 
 class KConfig;
 
+/**
+ * Entries of a session config, group => key => value.
+ * Names of nested groups are joined with '\x1d', like KConfig does.
+ */
+typedef QMap<QString, QMap<QString, QString> > KateSessionSnapshot;
+
 class KATE_TESTS_EXPORT KateSession : public QSharedData
 {
 public:
@@ -94,6 +101,7 @@ public:
      */
 public:
     static KateSession::Ptr create(const QString &file, const QString &name);
+    static KateSession::Ptr create(const QString &file, const QString &name, unsigned int documents, const QDateTime &timestamp);
     static KateSession::Ptr createFrom(const KateSession::Ptr &session, const QString &file, const QString &name);
     static KateSession::Ptr createAnonymous(const QString &file);
     static KateSession::Ptr createAnonymousFrom(const KateSession::Ptr &session, const QString &file);
@@ -123,6 +131,20 @@ private:
      */
     KateSession(const QString &file, const QString &name, const bool anonymous, const KConfig *config = nullptr);
 
+    /**
+     * create a session from known metadata, the file is not opened
+     * @param file configuration file
+     * @param name name of this session
+     * @param documents count of documents in this session
+     * @param timestamp last save time of this session
+     */
+    KateSession(const QString &file, const QString &name, unsigned int documents, const QDateTime &timestamp);
+
+    /**
+     * update the metadata, e.g. after the file was saved
+     */
+    void setMetaData(unsigned int documents, const QDateTime &timestamp);
+
 private:
     QString m_name;
     QString m_file;
@@ -130,6 +152,11 @@ private:
     unsigned int m_documents;
     KConfig *m_config;
     QDateTime m_timestamp;
+
+    /**
+     * entries of the session file as last saved by us, empty if not yet known
+     */
+    KateSessionSnapshot m_saved;
 };
 
 #endif
@@ -0,0 +1,147 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "katesessionindex.h"
+#include "katedebug.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QStringList>
+
+namespace
+{
+/**
+ * index starts with this magic
+ */
+const quint32 IndexMagic = 0x4B534931; // KSI1
+}
+
+KateSessionIndex::KateSessionIndex(const QString &fileName)
+    : m_fileName(fileName)
+    , m_loaded(false)
+    , m_changed(false)
+{
+}
+
+void KateSessionIndex::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_4);
+
+    quint32 magic = 0;
+    quint32 count = 0;
+    stream >> magic >> count;
+    if (magic != IndexMagic) {
+        return;
+    }
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString name;
+        Entry entry;
+        stream >> name >> entry.modified >> entry.size >> entry.documents;
+        if (stream.status() == QDataStream::Ok) {
+            m_entries.insert(name, entry);
+        }
+    }
+
+    /**
+     * damaged index, start again
+     */
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(LOG_KATE) << "Damaged session index" << m_fileName;
+        m_entries.clear();
+        m_changed = true;
+    }
+}
+
+bool KateSessionIndex::lookup(const QFileInfo &info, unsigned int *documents)
+{
+    load();
+
+    const auto it = m_entries.constFind(info.fileName());
+    if (it == m_entries.constEnd() || it.value().modified != info.lastModified().toMSecsSinceEpoch() || it.value().size != info.size()) {
+        return false;
+    }
+
+    *documents = it.value().documents;
+    return true;
+}
+
+void KateSessionIndex::insert(const QFileInfo &info, unsigned int documents)
+{
+    load();
+
+    const Entry entry = { info.lastModified().toMSecsSinceEpoch(), info.size(), documents };
+    m_entries.insert(info.fileName(), entry);
+    m_changed = true;
+}
+
+void KateSessionIndex::retain(const QStringList &fileNames)
+{
+    load();
+
+    const QSet<QString> keep = fileNames.toSet();
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (keep.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_entries.erase(it);
+            m_changed = true;
+        }
+    }
+}
+
+void KateSessionIndex::save()
+{
+    if (!m_changed) {
+        return;
+    }
+
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(LOG_KATE) << "Can't write session index" << m_fileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_4);
+    stream << IndexMagic << quint32(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        stream << it.key() << it.value().modified << it.value().size << it.value().documents;
+    }
+
+    if (file.commit()) {
+        m_changed = false;
+    }
+}
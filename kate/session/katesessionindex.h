@@ -0,0 +1,106 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_SESSION_INDEX_H
+#define KATE_SESSION_INDEX_H
+
+#include <QHash>
+#include <QStringList>
+
+#include "kateprivate_export.h"
+
+class QFileInfo;
+
+/**
+ * Index of the metadata of the session files in one directory.
+ *
+ * For each session file the modification time, the size and the number of
+ * documents are stored. As long as time and size match, the session file
+ * doesn't need to be opened to list the session.
+ */
+class KATE_TESTS_EXPORT KateSessionIndex
+{
+public:
+    /**
+     * Construct index, it is read on first access.
+     * @param fileName file name of the index
+     */
+    explicit KateSessionIndex(const QString &fileName);
+
+    /**
+     * Document count of an unchanged session file.
+     * @param info session file
+     * @param documents set to the document count if the file is unchanged
+     * @return true if the entry is up to date
+     */
+    bool lookup(const QFileInfo &info, unsigned int *documents);
+
+    /**
+     * Insert or replace the entry of a session file.
+     * @param info session file
+     * @param documents document count
+     */
+    void insert(const QFileInfo &info, unsigned int documents);
+
+    /**
+     * Drop the entries of all session files not in the list.
+     * @param fileNames file names, without path, of the existing session files
+     */
+    void retain(const QStringList &fileNames);
+
+    /**
+     * Write the index, if changed.
+     */
+    void save();
+
+private:
+    /**
+     * read the index, once
+     */
+    void load();
+
+private:
+    /**
+     * metadata of one session file
+     */
+    struct Entry {
+        qint64 modified;
+        qint64 size;
+        quint32 documents;
+    };
+
+    /**
+     * file name of the index
+     */
+    const QString m_fileName;
+
+    /**
+     * index read yet? changed since?
+     */
+    bool m_loaded;
+    bool m_changed;
+
+    /**
+     * session file name, without path => metadata
+     */
+    QHash<QString, Entry> m_entries;
+};
+
+#endif
@@ -18,17 +18,18 @@
  *  Boston, MA 02110-1301, USA.
  */
 
-#include "config.h"
-
 #include "katesessionmanager.h"
 
 #include "katesessionchooser.h"
 #include "katesessionmanagedialog.h"
+#include "katesessionindex.h"
 #include "katesessionopendialog.h"
+#include "katesessionwriter.h"
 
 #include "kateapp.h"
 #include "katepluginmanager.h"
 #include "katerunninginstanceinfo.h"
+#include "katestartupprofiler.h"
 
 #include <KConfigGroup>
 #include <KSharedConfig>
@@ -43,18 +44,18 @@
 #include <QApplication>
 #include <QCryptographicHash>
 #include <QDir>
+#include <QFileInfo>
 #include <QInputDialog>
 #include <QScopedPointer>
 #include <QUrl>
 
-#ifndef Q_OS_WIN
-#include <unistd.h>
-#endif
-
 //BEGIN KateSessionManager
 
 KateSessionManager::KateSessionManager(QObject *parent, const QString &sessionsDir)
     : QObject(parent)
+    , m_index(nullptr)
+    , m_writer(new KateSessionWriter(this))
+    , m_activeSessionChanged(true)
 {
     if (sessionsDir.isEmpty()) {
         m_sessionsDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/kate/sessions");
@@ -65,6 +66,9 @@ KateSessionManager::KateSessionManager(QObject *parent, const QString &sessionsD
     // create dir if needed
     QDir().mkpath(m_sessionsDir);
 
+    // hidden file, not matched as session
+    m_index = new KateSessionIndex(m_sessionsDir + QStringLiteral("/.sessionindex"));
+
     m_dirWatch = new KDirWatch(this);
     m_dirWatch->addDir(m_sessionsDir);
     connect(m_dirWatch, SIGNAL(dirty(QString)), this, SLOT(updateSessionList()));
@@ -72,49 +76,79 @@ KateSessionManager::KateSessionManager(QObject *parent, const QString &sessionsD
     updateSessionList();
 
     m_activeSession = KateSession::createAnonymous(anonymousSessionFile());
+
+    connect(m_writer, SIGNAL(writeFailed(QString)), this, SLOT(sessionWriteFailed(QString)));
+    connect(&m_autoSaveTimer, SIGNAL(timeout()), this, SLOT(autoSave()));
 }
 
 KateSessionManager::~KateSessionManager()
 {
     delete m_dirWatch;
+
+    // all session files must be written
+    delete m_writer;
+
+    delete m_index;
 }
 
 void KateSessionManager::updateSessionList()
 {
     QStringList list;
+    QStringList fileNames;
+    QHash<QString, KateSession::Ptr> sessions;
 
-    // Let's get a list of all session we have atm
+    // Let's get a list of all session we have atm, unchanged files are not opened
     QDir dir(m_sessionsDir, QStringLiteral("*.katesession"));
-
-    for (unsigned int i = 0; i < dir.count(); ++i) {
-        QString name = dir[i];
+    foreach (const QFileInfo &info, dir.entryInfoList(QDir::Files)) {
+        QString name = info.fileName();
+        fileNames << name;
         name.chop(12); // .katesession
-        list << QUrl::fromPercentEncoding(name.toLatin1());
+        name = QUrl::fromPercentEncoding(name.toLatin1());
+        list << name;
+
+        unsigned int documents = 0;
+        if (!m_index->lookup(info, &documents)) {
+            documents = readDocumentCount(info, name);
+            m_index->insert(info, documents);
+        }
+
+        // keep known sessions, just update them
+        KateSession::Ptr session = m_sessions.value(name);
+        if (session) {
+            session->setMetaData(documents, info.lastModified());
+        } else {
+            session = KateSession::create(sessionFileForName(name), name, documents, info.lastModified());
+        }
+        sessions.insert(name, session);
     }
 
-    // write jump list actions to disk in the kate.desktop file
-    updateJumpListActions(list);
+    m_index->retain(fileNames);
+    m_index->save();
+
+    // if active, ignore missing config
+    if (!m_activeSession->isAnonymous() && !sessions.contains(m_activeSession->name()) && m_sessions.value(m_activeSession->name()) == m_activeSession) {
+        sessions.insert(m_activeSession->name(), m_activeSession);
+    }
 
-    // delete old items;
-    QMutableHashIterator<QString, KateSession::Ptr> i(m_sessions);
+    m_sessions = sessions;
 
-    while (i.hasNext()) {
-        i.next();
-        const int idx = list.indexOf(i.key());
-        if (idx == -1) { // the key is invalid, remove it from m_session
-            if (i.value() != m_activeSession) { // if active, ignore missing config
-                i.remove();
-            }
-        } else { // remove it from scan list
-            list.removeAt(idx);
-        }
+    // write jump list actions to disk in the kate.desktop file, only if the sessions did change
+    if (list != m_jumpListSessions) {
+        m_jumpListSessions = list;
+        updateJumpListActions(list);
     }
+}
 
-    // load the new ones
-    foreach(const QString & newName, list) {
-        const QString file = sessionFileForName(newName);
-        m_sessions[newName] = KateSession::create(file, newName);
+unsigned int KateSessionManager::readDocumentCount(const QFileInfo &info, const QString &name) const
+{
+    // we know what we did save
+    const KateSession::Ptr session = m_sessions.value(name);
+    if (session && !session->m_saved.isEmpty()) {
+        return session->m_saved.value(QStringLiteral("Open Documents")).value(QStringLiteral("Count")).toUInt();
     }
+
+    const KConfig config(info.absoluteFilePath(), KConfig::SimpleConfig);
+    return config.group("Open Documents").readEntry("Count", 0);
 }
 
 bool KateSessionManager::activateSession(KateSession::Ptr session,
@@ -161,6 +195,7 @@ bool KateSessionManager::activateSession(KateSession::Ptr session,
 
     // set the new session
     m_activeSession = session;
+    m_activeSessionChanged = true;
 
     // there is one case in which we don't want the restoration and that is
     // when restoring session from session manager.
@@ -175,6 +210,8 @@ bool KateSessionManager::activateSession(KateSession::Ptr session,
 
 void KateSessionManager::loadSession(const KateSession::Ptr &session) const
 {
+    KateStartupProfiler::Span span("KateSessionManager::loadSession", session->name());
+
     // open the new session
     KSharedConfigPtr sharedConfig = KSharedConfig::openConfig();
     KConfig *sc = session->config();
@@ -246,14 +283,19 @@ KateSession::Ptr KateSessionManager::giveSession(const QString &name)
         return m_sessions.value(name);
     }
 
+    // the session list is read from disk, the file must exist
     KateSession::Ptr s = KateSession::create(sessionFileForName(name), name);
-    saveSessionTo(s->config());
+    saveSessionTo(s, true);
     m_sessions[name] = s;
     return s;
 }
 
 void KateSessionManager::deleteSession(KateSession::Ptr session)
 {
+    // a pending write would recreate the file
+    m_writer->waitForDone();
+    session->m_saved.clear();
+
     QFile::remove(session->file());
     if (session != activeSession()) {
         m_sessions.remove(session->name());
@@ -277,6 +319,7 @@ bool KateSessionManager::renameSession(KateSession::Ptr session, const QString &
         return false;
     }
 
+    m_writer->waitForDone();
     session->config()->sync();
 
     const QUrl srcUrl = QUrl::fromLocalFile(session->file());
@@ -301,49 +344,72 @@ bool KateSessionManager::renameSession(KateSession::Ptr session, const QString &
     return true;
 }
 
-void KateSessionManager::saveSessionTo(KConfig *sc) const
+void KateSessionManager::saveSessionTo(const KateSession::Ptr &session, bool wait)
 {
+    /**
+     * capture the state in memory, the disk is not touched here
+     */
+    KConfig config(QString(), KConfig::SimpleConfig);
+
     // save plugin configs and which plugins to load
-    KateApp::self()->pluginManager()->writeConfig(sc);
+    KateApp::self()->pluginManager()->writeConfig(&config);
 
     // save document configs + which documents to load
-    KateApp::self()->documentManager()->saveDocumentList(sc);
+    KateApp::self()->documentManager()->saveDocumentList(&config);
 
-    sc->group("Open MainWindows").writeEntry("Count", KateApp::self()->mainWindowsCount());
+    config.group("Open MainWindows").writeEntry("Count", KateApp::self()->mainWindowsCount());
 
     // save config for all windows around ;)
     bool saveWindowConfig = KConfigGroup(KSharedConfig::openConfig(), "General").readEntry("Restore Window Configuration", true);
     for (int i = 0; i < KateApp::self()->mainWindowsCount(); ++i) {
-        KConfigGroup cg(sc, QString::fromLatin1("MainWindow%1").arg(i));
+        KConfigGroup cg(&config, QString::fromLatin1("MainWindow%1").arg(i));
         KateApp::self()->mainWindow(i)->saveProperties(cg);
         if (saveWindowConfig) {
-            KateApp::self()->mainWindow(i)->saveWindowConfig(KConfigGroup(sc, QString::fromLatin1("MainWindow%1 Settings").arg(i)));
+            KateApp::self()->mainWindow(i)->saveWindowConfig(KConfigGroup(&config, QString::fromLatin1("MainWindow%1 Settings").arg(i)));
         }
     }
 
-    sc->sync();
+    const KateSessionSnapshot snapshot = KateSessionWriter::capture(config);
 
     /**
-     * try to sync file to disk
+     * first save to this session: start from what is on disk
+     * pending writes might target the same file, e.g. for the anonymous session
      */
-    QFile fileToSync(sc->name());
-    if (fileToSync.open(QIODevice::ReadOnly)) {
-#ifndef Q_OS_WIN
-        // ensure that the file is written to disk
-#ifdef HAVE_FDATASYNC
-        fdatasync(fileToSync.handle());
-#else
-        fsync(fileToSync.handle());
-#endif
-#endif
+    KConfig *sc = session->config();
+    if (session->m_saved.isEmpty()) {
+        m_writer->waitForDone();
+        sc->reparseConfiguration();
+        session->m_saved = KateSessionWriter::capture(*sc);
+    }
+
+    /**
+     * only the changed entries are written, nothing at all if nothing changed
+     * the config of the session stays up to date, it is read for new windows and views
+     */
+    const KateSessionSnapshot changes = KateSessionWriter::changes(session->m_saved, snapshot);
+    if (!changes.isEmpty()) {
+        KateSessionWriter::apply(sc, changes);
+        sc->markAsClean();
+
+        for (auto group = changes.constBegin(); group != changes.constEnd(); ++group) {
+            QMap<QString, QString> &saved = session->m_saved[group.key()];
+            for (auto it = group.value().constBegin(); it != group.value().constEnd(); ++it) {
+                saved.insert(it.key(), it.value());
+            }
+        }
+
+        m_writer->write(session->file(), changes);
+    }
+
+    if (wait) {
+        m_writer->waitForDone();
     }
 }
 
 bool KateSessionManager::saveActiveSession(bool rememberAsLast)
 {
-    KConfig *sc = activeSession()->config();
-
-    saveSessionTo(sc);
+    saveSessionTo(activeSession());
+    m_activeSessionChanged = false;
 
     if (rememberAsLast) {
         KSharedConfigPtr c = KSharedConfig::openConfig();
@@ -353,6 +419,55 @@ bool KateSessionManager::saveActiveSession(bool rememberAsLast)
     return true;
 }
 
+void KateSessionManager::setAutoSaveInterval(int minutes)
+{
+    if (minutes <= 0) {
+        m_autoSaveTimer.stop();
+        m_autoSaveTimer.setInterval(0);
+        return;
+    }
+
+    /**
+     * cheap hints that the session did change: documents come and go, the user moves around
+     */
+    if (!m_autoSaveTimer.isActive()) {
+        connect(KateApp::self()->documentManager(), SIGNAL(documentCreated(KTextEditor::Document*)), this, SLOT(markActiveSessionChanged()), Qt::UniqueConnection);
+        connect(KateApp::self()->documentManager(), SIGNAL(documentDeleted(KTextEditor::Document*)), this, SLOT(markActiveSessionChanged()), Qt::UniqueConnection);
+        connect(qApp, SIGNAL(focusChanged(QWidget*,QWidget*)), this, SLOT(markActiveSessionChanged()), Qt::UniqueConnection);
+    }
+
+    m_autoSaveTimer.start(minutes * 60000);
+}
+
+void KateSessionManager::markActiveSessionChanged()
+{
+    m_activeSessionChanged = true;
+}
+
+void KateSessionManager::autoSave()
+{
+    if (!m_activeSessionChanged) {
+        return;
+    }
+
+    saveActiveSession();
+}
+
+void KateSessionManager::sessionWriteFailed(const QString &file)
+{
+    /**
+     * the next save starts again from what is on disk
+     */
+    if (m_activeSession->file() == file) {
+        m_activeSession->m_saved.clear();
+    }
+    foreach (const KateSession::Ptr &session, m_sessions) {
+        if (session->file() == file) {
+            session->m_saved.clear();
+        }
+    }
+}
+
 bool KateSessionManager::chooseSession()
 {
     const KConfigGroup c(KSharedConfig::openConfig(), "General");
@@ -374,7 +489,12 @@ bool KateSessionManager::chooseSession()
     }
 
     QScopedPointer<KateSessionChooser> chooser(new KateSessionChooser(nullptr, lastSession));
-    const int res = chooser->exec();
+    int res = 0;
+    {
+        // waits for the user, keep that apart in the startup trace
+        KateStartupProfiler::Span span("session chooser");
+        res = chooser->exec();
+    }
     bool success = true;
 
     switch (res) {
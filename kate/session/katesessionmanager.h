@@ -25,6 +25,11 @@
 
 #include <QObject>
 #include <QHash>
+#include <QTimer>
+
+class KateSessionIndex;
+class KateSessionWriter;
+class QFileInfo;
 
 typedef QList<KateSession::Ptr> KateSessionList;
 
@@ -88,6 +93,21 @@ public:
      */
     bool chooseSession();
 
+    /**
+     * Set the interval of the periodic save of the active session.
+     * The session is only saved if anything did happen since the last save.
+     * @param minutes interval in minutes, 0 disables the autosave
+     */
+    void setAutoSaveInterval(int minutes);
+
+    /**
+     * interval of the periodic save of the active session
+     * @return interval in minutes, 0 if disabled
+     */
+    int autoSaveInterval() const {
+        return m_autoSaveTimer.interval() / 60000;
+    }
+
 public Q_SLOTS:
     /**
      * try to start a new session
@@ -160,6 +180,22 @@ private Q_SLOTS:
      */
     void updateSessionList();
 
+    /**
+     * the active session might have changed, used for the autosave
+     */
+    void markActiveSessionChanged();
+
+    /**
+     * save the active session if it might have changed
+     */
+    void autoSave();
+
+    /**
+     * writing a session file failed, forget what we know about its content
+     * @param file session file
+     */
+    void sessionWriteFailed(const QString &file);
+
 private:
     /**
      * Asks the user for a new session name. Used by save as for example.
@@ -177,9 +213,22 @@ private:
     QString anonymousSessionFile() const;
 
     /**
-      * helper function to save the session to a given config object
-      */
-    void saveSessionTo(KConfig *sc) const;
+     * Document count of a changed session file.
+     * Known sessions we did save ourselves are not read again.
+     * @param info session file
+     * @param name session name
+     * @return document count
+     */
+    unsigned int readDocumentCount(const QFileInfo &info, const QString &name) const;
+
+    /**
+     * Helper function to save the state to the given session.
+     * The state is captured in memory, only the changes since the last save
+     * are written, in the background.
+     * @param session session to save to
+     * @param wait wait until the session file is written
+     */
+    void saveSessionTo(const KateSession::Ptr &session, bool wait = false);
 
     /**
      * restore sessions documents, windows, etc...
@@ -208,6 +257,31 @@ private:
     KateSession::Ptr m_activeSession;
 
     class KDirWatch *m_dirWatch;
+
+    /**
+     * metadata of the session files, avoids to open them for the session list
+     */
+    KateSessionIndex *m_index;
+
+    /**
+     * sessions last written as jump list actions
+     */
+    QStringList m_jumpListSessions;
+
+    /**
+     * writes the session files in the background
+     */
+    KateSessionWriter *m_writer;
+
+    /**
+     * periodic save of the active session, if enabled
+     */
+    QTimer m_autoSaveTimer;
+
+    /**
+     * did anything happen since the active session was saved?
+     */
+    bool m_activeSessionChanged;
 };
 
 #endif
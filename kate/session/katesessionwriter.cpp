@@ -0,0 +1,193 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include "katesessionwriter.h"
+#include "katedebug.h"
+
+#include <KConfig>
+#include <KConfigGroup>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QRunnable>
+
+#ifndef Q_OS_WIN
+#include <unistd.h>
+#endif
+
+namespace
+{
+/**
+ * separator of nested group names, the same KConfig uses internally
+ */
+const QChar GroupSeparator(0x1d);
+
+void captureGroup(const KConfigGroup &group, const QString &path, KateSessionSnapshot &snapshot)
+{
+    const QMap<QString, QString> entries = group.entryMap();
+    if (!entries.isEmpty()) {
+        snapshot.insert(path, entries);
+    }
+
+    foreach (const QString &name, group.groupList()) {
+        captureGroup(group.group(name), path + GroupSeparator + name, snapshot);
+    }
+}
+}
+
+/**
+ * merges changes into one session file, in the writer thread
+ */
+class KateSessionWriterJob : public QRunnable
+{
+public:
+    KateSessionWriterJob(KateSessionWriter *writer, const QString &file, const KateSessionSnapshot &changes)
+        : m_writer(writer)
+        , m_file(file)
+        , m_changes(changes)
+    {
+    }
+
+    void run() override
+    {
+        /**
+         * KConfig only merges the changes, the file is replaced atomically
+         */
+        KConfig config(m_file, KConfig::SimpleConfig);
+        KateSessionWriter::apply(&config, m_changes);
+        const bool success = config.sync();
+
+        /**
+         * try to sync file to disk
+         */
+        QFile fileToSync(m_file);
+        if (success && fileToSync.open(QIODevice::ReadOnly)) {
+#ifndef Q_OS_WIN
+            // ensure that the file is written to disk
+#ifdef HAVE_FDATASYNC
+            fdatasync(fileToSync.handle());
+#else
+            fsync(fileToSync.handle());
+#endif
+#endif
+        }
+
+        QMetaObject::invokeMethod(m_writer, "changesWritten", Qt::QueuedConnection, Q_ARG(QString, m_file), Q_ARG(bool, success));
+    }
+
+private:
+    KateSessionWriter *const m_writer;
+    const QString m_file;
+    const KateSessionSnapshot m_changes;
+};
+
+KateSessionWriter::KateSessionWriter(QObject *parent)
+    : QObject(parent)
+{
+    m_writer.setMaxThreadCount(1);
+}
+
+KateSessionWriter::~KateSessionWriter()
+{
+    m_writer.waitForDone();
+}
+
+KateSessionSnapshot KateSessionWriter::capture(const KConfig &config)
+{
+    KateSessionSnapshot snapshot;
+    foreach (const QString &name, config.groupList()) {
+        captureGroup(config.group(name), name, snapshot);
+    }
+    return snapshot;
+}
+
+KateSessionSnapshot KateSessionWriter::changes(const KateSessionSnapshot &saved, const KateSessionSnapshot &current)
+{
+    KateSessionSnapshot changes;
+    for (auto group = current.constBegin(); group != current.constEnd(); ++group) {
+        /**
+         * unchanged groups share their data with the saved snapshot, nothing to compare
+         */
+        const auto savedGroup = saved.constFind(group.key());
+        if (savedGroup == saved.constEnd()) {
+            changes.insert(group.key(), group.value());
+            continue;
+        }
+        if (savedGroup.value() == group.value()) {
+            continue;
+        }
+
+        QMap<QString, QString> &changedEntries = changes[group.key()];
+        for (auto it = group.value().constBegin(); it != group.value().constEnd(); ++it) {
+            const auto savedEntry = savedGroup.value().constFind(it.key());
+            if (savedEntry == savedGroup.value().constEnd() || savedEntry.value() != it.value()) {
+                changedEntries.insert(it.key(), it.value());
+            }
+        }
+
+        /**
+         * only removed entries, the file keeps them as before
+         */
+        if (changedEntries.isEmpty()) {
+            changes.remove(group.key());
+        }
+    }
+    return changes;
+}
+
+void KateSessionWriter::apply(KConfig *config, const KateSessionSnapshot &changes)
+{
+    for (auto group = changes.constBegin(); group != changes.constEnd(); ++group) {
+        const QStringList names = group.key().split(GroupSeparator);
+        KConfigGroup cg(config, names.first());
+        for (int i = 1; i < names.size(); ++i) {
+            cg = cg.group(names[i]);
+        }
+
+        for (auto it = group.value().constBegin(); it != group.value().constEnd(); ++it) {
+            cg.writeEntry(it.key(), it.value());
+        }
+    }
+}
+
+void KateSessionWriter::write(const QString &file, const KateSessionSnapshot &changes)
+{
+    if (changes.isEmpty()) {
+        return;
+    }
+
+    m_writer.start(new KateSessionWriterJob(this, file, changes));
+}
+
+void KateSessionWriter::waitForDone()
+{
+    m_writer.waitForDone();
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+void KateSessionWriter::changesWritten(const QString &file, bool success)
+{
+    if (!success) {
+        qCWarning(LOG_KATE) << "Can't write session file" << file;
+        emit writeFailed(file);
+    }
+}
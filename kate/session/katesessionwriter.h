@@ -0,0 +1,113 @@
+/*   This file is part of the KDE project
+ *
+ *   Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Library General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Library General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Library General Public License
+ *   along with this library; see the file COPYING.LIB.  If not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_SESSION_WRITER_H
+#define KATE_SESSION_WRITER_H
+
+#include "katesession.h"
+
+#include <QObject>
+#include <QThreadPool>
+
+#include "kateprivate_export.h"
+
+class KConfig;
+
+/**
+ * Writes sessions in the background.
+ *
+ * The state of a session is captured on the GUI thread into a snapshot of
+ * plain strings. Only the entries that differ from the last saved snapshot
+ * are handed to the writer thread, which merges them into the session file
+ * and atomically replaces it. Writes happen in order, one at a time.
+ */
+class KATE_TESTS_EXPORT KateSessionWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * construct idle writer
+     * @param parent parent object
+     */
+    explicit KateSessionWriter(QObject *parent = nullptr);
+
+    /**
+     * deconstruct writer, waits for all pending writes
+     */
+    ~KateSessionWriter() override;
+
+    /**
+     * Capture all entries of the config, including nested groups.
+     * @param config config to capture
+     * @return snapshot of the config
+     */
+    static KateSessionSnapshot capture(const KConfig &config);
+
+    /**
+     * Entries of @p current that are new or differ from @p saved.
+     * @param saved last saved snapshot
+     * @param current current snapshot
+     * @return changed entries, empty if nothing changed
+     */
+    static KateSessionSnapshot changes(const KateSessionSnapshot &saved, const KateSessionSnapshot &current);
+
+    /**
+     * Write the changed entries into the config, without syncing it.
+     * @param config config to change
+     * @param changes changed entries
+     */
+    static void apply(KConfig *config, const KateSessionSnapshot &changes);
+
+    /**
+     * Merge the changed entries into the session file, in the background.
+     * @param file session file
+     * @param changes changed entries
+     */
+    void write(const QString &file, const KateSessionSnapshot &changes);
+
+    /**
+     * Wait until all pending writes are on disk.
+     */
+    void waitForDone();
+
+Q_SIGNALS:
+    /**
+     * Writing the session file failed, the file doesn't match the last snapshot.
+     * @param file session file
+     */
+    void writeFailed(const QString &file);
+
+private Q_SLOTS:
+    /**
+     * the writer thread did write a session file
+     * @param file session file
+     * @param success was the file written?
+     */
+    void changesWritten(const QString &file, bool success);
+
+private:
+    /**
+     * single writer thread, writes are done in order
+     */
+    QThreadPool m_writer;
+};
+
+#endif
@@ -0,0 +1,132 @@
+/*  This file is part of the Kate project.
+ *
+ *  Copyright (C) 2018 Christoph Cullmann <cullmann@kde.org>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public License
+ *  along with this library; see the file COPYING.LIB.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KATE_FILE_LIST_SNAPSHOT_H
+#define KATE_FILE_LIST_SNAPSHOT_H
+
+#include <QMetaType>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+
+/**
+ * Immutable snapshot of a list of files, e.g. all files of a project.
+ *
+ * Snapshots are passed around as KateSharedFileListSnapshot, e.g. by the
+ * project plugin view via the "projectFilesSnapshot" and "allProjectsFilesSnapshot"
+ * properties. Consumers can keep them without copying anything and compare the
+ * generation to detect changes: a new generation means a new file list.
+ *
+ * The paths are interned with the previous snapshot of the same producer,
+ * unchanged paths share their memory. Membership tests use a hash set.
+ *
+ * Header only, shared between the application and the plugins.
+ */
+class KateFileListSnapshot
+{
+public:
+    /**
+     * construct empty snapshot
+     */
+    KateFileListSnapshot()
+        : m_generation(0)
+    {
+    }
+
+    /**
+     * construct snapshot for the given files
+     * @param files files, order is kept
+     * @param generation generation of this snapshot, unique per producer
+     * @param previous previous snapshot to share unchanged paths with, may be null
+     */
+    KateFileListSnapshot(const QStringList &files, quint64 generation, const KateFileListSnapshot *previous = nullptr)
+        : m_generation(generation)
+    {
+        m_files.reserve(files.size());
+        m_fileSet.reserve(files.size());
+        for (const QString &file : files) {
+            /**
+             * reuse the string of the previous snapshot if possible
+             */
+            if (previous) {
+                const auto it = previous->m_fileSet.constFind(file);
+                if (it != previous->m_fileSet.constEnd()) {
+                    m_files.append(*it);
+                    m_fileSet.insert(*it);
+                    continue;
+                }
+            }
+
+            m_files.append(file);
+            m_fileSet.insert(file);
+        }
+    }
+
+    /**
+     * generation of this snapshot, 0 for empty default snapshots
+     * @return generation
+     */
+    quint64 generation() const {
+        return m_generation;
+    }
+
+    /**
+     * all files, the list is implicitly shared, copies are cheap
+     * @return files
+     */
+    const QStringList &files() const {
+        return m_files;
+    }
+
+    /**
+     * is the file part of the snapshot?
+     * @param file full path of file
+     * @return true if contained
+     */
+    bool contains(const QString &file) const {
+        return m_fileSet.contains(file);
+    }
+
+    /**
+     * number of files
+     * @return size
+     */
+    int size() const {
+        return m_files.size();
+    }
+
+    bool isEmpty() const {
+        return m_files.isEmpty();
+    }
+
+private:
+    quint64 m_generation;
+    QStringList m_files;
+    QSet<QString> m_fileSet;
+};
+
+/**
+ * Shared pointer data type.
+ * Used to pass snapshots via properties and queued connected slots
+ */
+typedef QSharedPointer<const KateFileListSnapshot> KateSharedFileListSnapshot;
+Q_DECLARE_METATYPE(KateSharedFileListSnapshot)
+
+#endif